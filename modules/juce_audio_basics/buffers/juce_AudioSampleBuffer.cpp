@@ -22,521 +22,108 @@
   ==============================================================================
 */
 
-AudioSampleBuffer::AudioSampleBuffer (const int numChans,
-                                      const int numSamples) noexcept
-  : numChannels (numChans),
-    size (numSamples)
-{
-    jassert (numSamples >= 0);
-    jassert (numChans > 0);
-
-    allocateData();
-}
-
-AudioSampleBuffer::AudioSampleBuffer (const AudioSampleBuffer& other) noexcept
-  : numChannels (other.numChannels),
-    size (other.size),
-    allocatedBytes (other.allocatedBytes)
-{
-    if (allocatedBytes == 0)
-    {
-        allocateChannels (other.channels, 0);
-    }
-    else
-    {
-        allocateData();
-
-        for (int i = 0; i < numChannels; ++i)
-            FloatVectorOperations::copy (channels[i], other.channels[i], size);
-    }
-}
-
-void AudioSampleBuffer::allocateData()
-{
-    const size_t channelListSize = sizeof (float*) * (size_t) (numChannels + 1);
-    allocatedBytes = (size_t) numChannels * (size_t) size * sizeof (float) + channelListSize + 32;
-    allocatedData.malloc (allocatedBytes);
-    channels = reinterpret_cast <float**> (allocatedData.getData());
-
-    float* chan = (float*) (allocatedData + channelListSize);
-    for (int i = 0; i < numChannels; ++i)
-    {
-        channels[i] = chan;
-        chan += size;
-    }
-
-    channels [numChannels] = nullptr;
-}
-
-AudioSampleBuffer::AudioSampleBuffer (float* const* dataToReferTo,
-                                      const int numChans,
-                                      const int numSamples) noexcept
-    : numChannels (numChans),
-      size (numSamples),
-      allocatedBytes (0)
-{
-    jassert (numChans > 0);
-    allocateChannels (dataToReferTo, 0);
-}
-
-AudioSampleBuffer::AudioSampleBuffer (float* const* dataToReferTo,
-                                      const int numChans,
-                                      const int startSample,
-                                      const int numSamples) noexcept
-    : numChannels (numChans),
-      size (numSamples),
-      allocatedBytes (0)
-{
-    jassert (numChans > 0);
-    allocateChannels (dataToReferTo, startSample);
-}
-
-void AudioSampleBuffer::setDataToReferTo (float** dataToReferTo,
-                                          const int newNumChannels,
-                                          const int newNumSamples) noexcept
-{
-    jassert (newNumChannels > 0);
-
-    allocatedBytes = 0;
-    allocatedData.free();
-
-    numChannels = newNumChannels;
-    size = newNumSamples;
-
-    allocateChannels (dataToReferTo, 0);
-}
+#if JUCE_UNIT_TESTS
 
-void AudioSampleBuffer::allocateChannels (float* const* const dataToReferTo, int offset)
+class AudioBufferTests  : public UnitTest
 {
-    // (try to avoid doing a malloc here, as that'll blow up things like Pro-Tools)
-    if (numChannels < (int) numElementsInArray (preallocatedChannelSpace))
-    {
-        channels = static_cast <float**> (preallocatedChannelSpace);
-    }
-    else
-    {
-        allocatedData.malloc ((size_t) numChannels + 1, sizeof (float*));
-        channels = reinterpret_cast <float**> (allocatedData.getData());
-    }
+public:
+    AudioBufferTests()  : UnitTest ("AudioBuffer") {}
 
-    for (int i = 0; i < numChannels; ++i)
+    template <typename Type>
+    void fillWithRamp (AudioBuffer<Type>& buffer)
     {
-        // you have to pass in the same number of valid pointers as numChannels
-        jassert (dataToReferTo[i] != nullptr);
-
-        channels[i] = dataToReferTo[i] + offset;
+        for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.getSampleData (chan)[i] = (Type) (chan * 1000 + i);
     }
 
-    channels [numChannels] = nullptr;
-}
-
-AudioSampleBuffer& AudioSampleBuffer::operator= (const AudioSampleBuffer& other) noexcept
-{
-    if (this != &other)
+    template <typename Type>
+    bool isRamp (const AudioBuffer<Type>& buffer, int chan, int start, int num, Type gain = (Type) 1)
     {
-        setSize (other.getNumChannels(), other.getNumSamples(), false, false, false);
+        for (int i = start; i < start + num; ++i)
+            if (buffer.getSampleData (chan)[i] != (Type) ((chan * 1000 + i) * gain))
+                return false;
 
-        for (int i = 0; i < numChannels; ++i)
-            FloatVectorOperations::copy (channels[i], other.channels[i], size);
+        return true;
     }
 
-    return *this;
-}
-
-AudioSampleBuffer::~AudioSampleBuffer() noexcept
-{
-}
-
-void AudioSampleBuffer::setSize (const int newNumChannels,
-                                 const int newNumSamples,
-                                 const bool keepExistingContent,
-                                 const bool clearExtraSpace,
-                                 const bool avoidReallocating) noexcept
-{
-    jassert (newNumChannels > 0);
-    jassert (newNumSamples >= 0);
-
-    if (newNumSamples != size || newNumChannels != numChannels)
+    template <typename Type>
+    void runTestsForType()
     {
-        const size_t allocatedSamplesPerChannel = ((size_t) newNumSamples + 3) & ~3u;
-        const size_t channelListSize = ((sizeof (float*) * (size_t) (newNumChannels + 1)) + 15) & ~15u;
-        const size_t newTotalBytes = ((size_t) newNumChannels * (size_t) allocatedSamplesPerChannel * sizeof (float))
-                                        + channelListSize + 32;
+        AudioBuffer<Type> buffer (3, 100);
+        fillWithRamp (buffer);
+        expect (isRamp (buffer, 2, 0, 100));
 
-        if (keepExistingContent)
-        {
-            HeapBlock <char, true> newData;
-            newData.allocate (newTotalBytes, clearExtraSpace);
-
-            const size_t numSamplesToCopy = (size_t) jmin (newNumSamples, size);
+        buffer.clear (1, 10, 20);
+        expect (isRamp (buffer, 1, 0, 10) && isRamp (buffer, 1, 30, 70));
+        expectEquals (buffer.getMagnitude (1, 10, 20), (Type) 0);
+        expectEquals (buffer.getMagnitude (1, 0, 100), (Type) 1099);
 
-            float** const newChannels = reinterpret_cast <float**> (newData.getData());
-            float* newChan = reinterpret_cast <float*> (newData + channelListSize);
+        fillWithRamp (buffer);
+        buffer.applyGain (0, 50, 50, (Type) 2);
+        expect (isRamp (buffer, 0, 0, 50) && isRamp (buffer, 0, 50, 50, (Type) 2));
 
-            for (int j = 0; j < newNumChannels; ++j)
-            {
-                newChannels[j] = newChan;
-                newChan += allocatedSamplesPerChannel;
-            }
+        fillWithRamp (buffer);
+        buffer.copyFrom (0, 0, buffer, 1, 0, 100);
+        buffer.addFrom (0, 0, buffer, 1, 0, 100, (Type) -1);
+        expectEquals (buffer.getMagnitude (0, 0, 100), (Type) 0);
 
-            const int numChansToCopy = jmin (numChannels, newNumChannels);
-            for (int i = 0; i < numChansToCopy; ++i)
-                FloatVectorOperations::copy (newChannels[i], channels[i], (int) numSamplesToCopy);
+        fillWithRamp (buffer);
+        buffer.setSize (2, 200, true, true);
+        expect (isRamp (buffer, 1, 0, 100));
+        expectEquals (buffer.getMagnitude (1, 100, 100), (Type) 0);
 
-            allocatedData.swapWith (newData);
-            allocatedBytes = newTotalBytes;
-            channels = newChannels;
-        }
-        else
         {
-            if (avoidReallocating && allocatedBytes >= newTotalBytes)
-            {
-                if (clearExtraSpace)
-                    allocatedData.clear (newTotalBytes);
-            }
-            else
-            {
-                allocatedBytes = newTotalBytes;
-                allocatedData.allocate (newTotalBytes, clearExtraSpace);
-                channels = reinterpret_cast <float**> (allocatedData.getData());
-            }
-
-            float* chan = reinterpret_cast <float*> (allocatedData + channelListSize);
-            for (int i = 0; i < newNumChannels; ++i)
-            {
-                channels[i] = chan;
-                chan += allocatedSamplesPerChannel;
-            }
+            AudioBuffer<Type> copy (buffer);
+            expect (isRamp (copy, 1, 0, 100));
+            copy.clear();
+            expect (isRamp (buffer, 1, 0, 100));
         }
 
-        channels [newNumChannels] = 0;
-        size = newNumSamples;
-        numChannels = newNumChannels;
-    }
-}
-
-void AudioSampleBuffer::clear() noexcept
-{
-    for (int i = 0; i < numChannels; ++i)
-        FloatVectorOperations::clear (channels[i], size);
-}
-
-void AudioSampleBuffer::clear (const int startSample,
-                               const int numSamples) noexcept
-{
-    jassert (startSample >= 0 && startSample + numSamples <= size);
-
-    for (int i = 0; i < numChannels; ++i)
-        FloatVectorOperations::clear (channels[i] + startSample, numSamples);
-}
-
-void AudioSampleBuffer::clear (const int channel,
-                               const int startSample,
-                               const int numSamples) noexcept
-{
-    jassert (isPositiveAndBelow (channel, numChannels));
-    jassert (startSample >= 0 && startSample + numSamples <= size);
-
-    FloatVectorOperations::clear (channels [channel] + startSample, numSamples);
-}
-
-void AudioSampleBuffer::applyGain (const int channel,
-                                   const int startSample,
-                                   int numSamples,
-                                   const float gain) noexcept
-{
-    jassert (isPositiveAndBelow (channel, numChannels));
-    jassert (startSample >= 0 && startSample + numSamples <= size);
-
-    if (gain != 1.0f)
-    {
-        float* const d = channels [channel] + startSample;
-
-        if (gain == 0.0f)
-            FloatVectorOperations::clear (d, numSamples);
-        else
-            FloatVectorOperations::multiply (d, gain, numSamples);
-    }
-}
-
-void AudioSampleBuffer::applyGainRamp (const int channel,
-                                       const int startSample,
-                                       int numSamples,
-                                       float startGain,
-                                       float endGain) noexcept
-{
-    if (startGain == endGain)
-    {
-        applyGain (channel, startSample, numSamples, startGain);
-    }
-    else
-    {
-        jassert (isPositiveAndBelow (channel, numChannels));
-        jassert (startSample >= 0 && startSample + numSamples <= size);
-
-        const float increment = (endGain - startGain) / numSamples;
-        float* d = channels [channel] + startSample;
-
-        while (--numSamples >= 0)
         {
-            *d++ *= startGain;
-            startGain += increment;
+            Type* channels[] = { buffer.getSampleData (0), buffer.getSampleData (1) };
+            AudioBuffer<Type> referringBuffer (channels, 2, 10, 50);
+            referringBuffer.clear();
+            expect (isRamp (buffer, 1, 0, 10) && isRamp (buffer, 1, 60, 40));
+            expectEquals (buffer.getMagnitude (1, 10, 50), (Type) 0);
         }
-    }
-}
 
-void AudioSampleBuffer::applyGain (const int startSample,
-                                   const int numSamples,
-                                   const float gain) noexcept
-{
-    for (int i = 0; i < numChannels; ++i)
-        applyGain (i, startSample, numSamples, gain);
-}
-
-void AudioSampleBuffer::applyGain (const float gain) noexcept
-{
-    applyGain (0, size, gain);
-}
-
-void AudioSampleBuffer::applyGainRamp (const int startSample,
-                                       const int numSamples,
-                                       const float startGain,
-                                       const float endGain) noexcept
-{
-    for (int i = 0; i < numChannels; ++i)
-        applyGainRamp (i, startSample, numSamples, startGain, endGain);
-}
-
-void AudioSampleBuffer::addFrom (const int destChannel,
-                                 const int destStartSample,
-                                 const AudioSampleBuffer& source,
-                                 const int sourceChannel,
-                                 const int sourceStartSample,
-                                 int numSamples,
-                                 const float gain) noexcept
-{
-    jassert (&source != this || sourceChannel != destChannel);
-    jassert (isPositiveAndBelow (destChannel, numChannels));
-    jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
-    jassert (isPositiveAndBelow (sourceChannel, source.numChannels));
-    jassert (sourceStartSample >= 0 && sourceStartSample + numSamples <= source.size);
-
-    if (gain != 0.0f && numSamples > 0)
-    {
-        float* const d = channels [destChannel] + destStartSample;
-        const float* const s  = source.channels [sourceChannel] + sourceStartSample;
-
-        if (gain != 1.0f)
-            FloatVectorOperations::addWithMultiply (d, s, gain, numSamples);
-        else
-            FloatVectorOperations::add (d, s, numSamples);
-    }
-}
-
-void AudioSampleBuffer::addFrom (const int destChannel,
-                                 const int destStartSample,
-                                 const float* source,
-                                 int numSamples,
-                                 const float gain) noexcept
-{
-    jassert (isPositiveAndBelow (destChannel, numChannels));
-    jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
-    jassert (source != nullptr);
-
-    if (gain != 0.0f && numSamples > 0)
-    {
-        float* const d = channels [destChannel] + destStartSample;
-
-        if (gain != 1.0f)
-            FloatVectorOperations::addWithMultiply (d, source, gain, numSamples);
-        else
-            FloatVectorOperations::add (d, source, numSamples);
-    }
-}
-
-void AudioSampleBuffer::addFromWithRamp (const int destChannel,
-                                         const int destStartSample,
-                                         const float* source,
-                                         int numSamples,
-                                         float startGain,
-                                         const float endGain) noexcept
-{
-    jassert (isPositiveAndBelow (destChannel, numChannels));
-    jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
-    jassert (source != nullptr);
-
-    if (startGain == endGain)
-    {
-        addFrom (destChannel, destStartSample, source, numSamples, startGain);
-    }
-    else
-    {
-        if (numSamples > 0 && (startGain != 0.0f || endGain != 0.0f))
         {
-            const float increment = (endGain - startGain) / numSamples;
-            float* d = channels [destChannel] + destStartSample;
-
-            while (--numSamples >= 0)
-            {
-                *d++ += startGain * *source++;
-                startGain += increment;
-            }
-        }
-    }
-}
-
-void AudioSampleBuffer::copyFrom (const int destChannel,
-                                  const int destStartSample,
-                                  const AudioSampleBuffer& source,
-                                  const int sourceChannel,
-                                  const int sourceStartSample,
-                                  int numSamples) noexcept
-{
-    jassert (&source != this || sourceChannel != destChannel);
-    jassert (isPositiveAndBelow (destChannel, numChannels));
-    jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
-    jassert (isPositiveAndBelow (sourceChannel, source.numChannels));
-    jassert (sourceStartSample >= 0 && sourceStartSample + numSamples <= source.size);
-
-    if (numSamples > 0)
-    {
-        FloatVectorOperations::copy (channels [destChannel] + destStartSample,
-                                     source.channels [sourceChannel] + sourceStartSample,
-                                     numSamples);
-    }
-}
+            AudioBuffer<Type> constant (1, 1000);
 
-void AudioSampleBuffer::copyFrom (const int destChannel,
-                                  const int destStartSample,
-                                  const float* source,
-                                  int numSamples) noexcept
-{
-    jassert (isPositiveAndBelow (destChannel, numChannels));
-    jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
-    jassert (source != nullptr);
+            for (int i = 0; i < constant.getNumSamples(); ++i)
+                constant.getSampleData (0)[i] = (Type) ((i & 1) != 0 ? 0.5 : -0.5);
 
-    if (numSamples > 0)
-    {
-        FloatVectorOperations::copy (channels [destChannel] + destStartSample,
-                                     source,
-                                     numSamples);
+            expect (std::abs (constant.getRMSLevel (0, 0, 1000) - (Type) 0.5) < (Type) 0.0001);
+        }
     }
-}
-
-void AudioSampleBuffer::copyFrom (const int destChannel,
-                                  const int destStartSample,
-                                  const float* source,
-                                  int numSamples,
-                                  const float gain) noexcept
-{
-    jassert (isPositiveAndBelow (destChannel, numChannels));
-    jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
-    jassert (source != nullptr);
 
-    if (numSamples > 0)
+    void runTest()
     {
-        float* d = channels [destChannel] + destStartSample;
-
-        if (gain != 1.0f)
-        {
-            if (gain == 0)
-                FloatVectorOperations::clear (d, numSamples);
-            else
-                FloatVectorOperations::copyWithMultiply (d, source, gain, numSamples);
-        }
-        else
-        {
-            FloatVectorOperations::copy (d, source, numSamples);
-        }
-    }
-}
+        beginTest ("Float buffers");
+        runTestsForType<float>();
 
-void AudioSampleBuffer::copyFromWithRamp (const int destChannel,
-                                          const int destStartSample,
-                                          const float* source,
-                                          int numSamples,
-                                          float startGain,
-                                          float endGain) noexcept
-{
-    jassert (isPositiveAndBelow (destChannel, numChannels));
-    jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
-    jassert (source != nullptr);
+        beginTest ("Double buffers");
+        runTestsForType<double>();
 
-    if (startGain == endGain)
-    {
-        copyFrom (destChannel, destStartSample, source, numSamples, startGain);
-    }
-    else
-    {
-        if (numSamples > 0 && (startGain != 0.0f || endGain != 0.0f))
+        beginTest ("Conversion");
         {
-            const float increment = (endGain - startGain) / numSamples;
-            float* d = channels [destChannel] + destStartSample;
-
-            while (--numSamples >= 0)
-            {
-                *d++ = startGain * *source++;
-                startGain += increment;
-            }
+            AudioSampleBuffer floatBuffer (2, 64);
+            DoubleAudioSampleBuffer doubleBuffer (2, 64);
+            fillWithRamp (floatBuffer);
+
+            doubleBuffer.clear();
+            doubleBuffer.copyFrom (1, 0, floatBuffer, 1, 0, 64);
+            expect (isRamp (doubleBuffer, 1, 0, 64));
+
+            // values that need double precision are rounded when they're copied to floats
+            doubleBuffer.getSampleData (0)[0] = 1.0 + 1.0e-10;
+            floatBuffer.copyFrom (0, 0, doubleBuffer, 0, 0, 1);
+            expectEquals (floatBuffer.getSampleData (0)[0], 1.0f);
         }
     }
-}
-
-void AudioSampleBuffer::findMinMax (const int channel,
-                                    const int startSample,
-                                    int numSamples,
-                                    float& minVal,
-                                    float& maxVal) const noexcept
-{
-    jassert (isPositiveAndBelow (channel, numChannels));
-    jassert (startSample >= 0 && startSample + numSamples <= size);
+};
 
-    FloatVectorOperations::findMinAndMax (channels [channel] + startSample,
-                                          numSamples, minVal, maxVal);
-}
-
-float AudioSampleBuffer::getMagnitude (const int channel,
-                                       const int startSample,
-                                       const int numSamples) const noexcept
-{
-    jassert (isPositiveAndBelow (channel, numChannels));
-    jassert (startSample >= 0 && startSample + numSamples <= size);
-
-    float mn, mx;
-    findMinMax (channel, startSample, numSamples, mn, mx);
-
-    return jmax (mn, -mn, mx, -mx);
-}
-
-float AudioSampleBuffer::getMagnitude (const int startSample,
-                                       const int numSamples) const noexcept
-{
-    float mag = 0.0f;
-
-    for (int i = 0; i < numChannels; ++i)
-        mag = jmax (mag, getMagnitude (i, startSample, numSamples));
-
-    return mag;
-}
-
-float AudioSampleBuffer::getRMSLevel (const int channel,
-                                      const int startSample,
-                                      const int numSamples) const noexcept
-{
-    jassert (isPositiveAndBelow (channel, numChannels));
-    jassert (startSample >= 0 && startSample + numSamples <= size);
-
-    if (numSamples <= 0 || channel < 0 || channel >= numChannels)
-        return 0.0f;
-
-    const float* const data = channels [channel] + startSample;
-    double sum = 0.0;
-
-    for (int i = 0; i < numSamples; ++i)
-    {
-        const float sample = data [i];
-        sum += sample * sample;
-    }
+static AudioBufferTests audioBufferTests;
 
-    return (float) std::sqrt (sum / numSamples);
-}
+#endif
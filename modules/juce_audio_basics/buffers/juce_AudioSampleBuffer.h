@@ -26,12 +26,18 @@
 #define JUCE_AUDIOSAMPLEBUFFER_H_INCLUDED
 
 
+
 //==============================================================================
 /**
-    A multi-channel buffer of 32-bit floating point audio samples.
+    A multi-channel buffer of floating point audio samples.
+
+    The sample type is either float or double - the AudioSampleBuffer and
+    DoubleAudioSampleBuffer typedefs are the names that you'd normally use.
 
+    @see AudioSampleBuffer, DoubleAudioSampleBuffer
 */
-class JUCE_API  AudioSampleBuffer
+template <typename Type>
+class AudioBuffer
 {
 public:
     //==============================================================================
@@ -44,8 +50,16 @@ public:
         when the buffer is deleted. If the memory can't be allocated, this will
         throw a std::bad_alloc exception.
     */
-    AudioSampleBuffer (int numChannels,
-                       int numSamples) noexcept;
+    AudioBuffer (int numChannelsToAllocate,
+                 int numSamplesToAllocate) noexcept
+       : numChannels (numChannelsToAllocate),
+         size (numSamplesToAllocate)
+    {
+        jassert (size >= 0);
+        jassert (numChannels > 0);
+
+        allocateData();
+    }
 
     /** Creates a buffer using a pre-allocated block of memory.
 
@@ -57,14 +71,21 @@ public:
                                 for each channel that should be used by this buffer. The
                                 buffer will only refer to this memory, it won't try to delete
                                 it when the buffer is deleted or resized.
-        @param numChannels      the number of channels to use - this must correspond to the
+        @param numChannelsToUse the number of channels to use - this must correspond to the
                                 number of elements in the array passed in
         @param numSamples       the number of samples to use - this must correspond to the
                                 size of the arrays passed in
     */
-    AudioSampleBuffer (float* const* dataToReferTo,
-                       int numChannels,
-                       int numSamples) noexcept;
+    AudioBuffer (Type* const* dataToReferTo,
+                 int numChannelsToUse,
+                 int numSamples) noexcept
+        : numChannels (numChannelsToUse),
+          size (numSamples),
+          allocatedBytes (0)
+    {
+        jassert (numChannelsToUse > 0);
+        allocateChannels (dataToReferTo, 0);
+    }
 
     /** Creates a buffer using a pre-allocated block of memory.
 
@@ -76,16 +97,23 @@ public:
                                 for each channel that should be used by this buffer. The
                                 buffer will only refer to this memory, it won't try to delete
                                 it when the buffer is deleted or resized.
-        @param numChannels      the number of channels to use - this must correspond to the
+        @param numChannelsToUse the number of channels to use - this must correspond to the
                                 number of elements in the array passed in
         @param startSample      the offset within the arrays at which the data begins
         @param numSamples       the number of samples to use - this must correspond to the
                                 size of the arrays passed in
     */
-    AudioSampleBuffer (float* const* dataToReferTo,
-                       int numChannels,
-                       int startSample,
-                       int numSamples) noexcept;
+    AudioBuffer (Type* const* dataToReferTo,
+                 int numChannelsToUse,
+                 int startSample,
+                 int numSamples) noexcept
+        : numChannels (numChannelsToUse),
+          size (numSamples),
+          allocatedBytes (0)
+    {
+        jassert (numChannelsToUse > 0);
+        allocateChannels (dataToReferTo, startSample);
+    }
 
     /** Copies another buffer.
 
@@ -93,17 +121,44 @@ public:
         using an external data buffer, in which case boths buffers will just point to the same
         shared block of data.
     */
-    AudioSampleBuffer (const AudioSampleBuffer& other) noexcept;
+    AudioBuffer (const AudioBuffer& other) noexcept
+       : numChannels (other.numChannels),
+         size (other.size),
+         allocatedBytes (other.allocatedBytes)
+    {
+        if (allocatedBytes == 0)
+        {
+            allocateChannels (other.channels, 0);
+        }
+        else
+        {
+            allocateData();
+
+            for (int i = 0; i < numChannels; ++i)
+                FloatVectorOperations::copy (channels[i], other.channels[i], size);
+        }
+    }
 
     /** Copies another buffer onto this one.
         This buffer's size will be changed to that of the other buffer.
     */
-    AudioSampleBuffer& operator= (const AudioSampleBuffer& other) noexcept;
+    AudioBuffer& operator= (const AudioBuffer& other) noexcept
+    {
+        if (this != &other)
+        {
+            setSize (other.getNumChannels(), other.getNumSamples(), false, false, false);
+
+            for (int i = 0; i < numChannels; ++i)
+                FloatVectorOperations::copy (channels[i], other.channels[i], size);
+        }
+
+        return *this;
+    }
 
     /** Destructor.
         This will free any memory allocated by the buffer.
     */
-    ~AudioSampleBuffer() noexcept;
+    ~AudioBuffer() noexcept {}
 
     //==============================================================================
     /** Returns the number of channels of audio data that this buffer contains.
@@ -123,7 +178,7 @@ public:
         For speed, this doesn't check whether the channel number is out of range,
         so be careful when using it!
     */
-    float* getSampleData (const int channelNumber) const noexcept
+    Type* getSampleData (const int channelNumber) const noexcept
     {
         jassert (isPositiveAndBelow (channelNumber, numChannels));
         return channels [channelNumber];
@@ -134,8 +189,8 @@ public:
         For speed, this doesn't check whether the channel and sample number
         are out-of-range, so be careful when using it!
     */
-    float* getSampleData (const int channelNumber,
-                          const int sampleOffset) const noexcept
+    Type* getSampleData (const int channelNumber,
+                         const int sampleOffset) const noexcept
     {
         jassert (isPositiveAndBelow (channelNumber, numChannels));
         jassert (isPositiveAndBelow (sampleOffset, size));
@@ -147,7 +202,7 @@ public:
         Don't modify any of the pointers that are returned, and bear in mind that
         these will become invalid if the buffer is resized.
     */
-    float** getArrayOfChannels() const noexcept         { return channels; }
+    Type** getArrayOfChannels() const noexcept          { return channels; }
 
     //==============================================================================
     /** Changes the buffer's size or number of channels.
@@ -173,8 +228,69 @@ public:
                   int newNumSamples,
                   bool keepExistingContent = false,
                   bool clearExtraSpace = false,
-                  bool avoidReallocating = false) noexcept;
-
+                  bool avoidReallocating = false) noexcept
+    {
+        jassert (newNumChannels > 0);
+        jassert (newNumSamples >= 0);
+
+        if (newNumSamples != size || newNumChannels != numChannels)
+        {
+            const size_t allocatedSamplesPerChannel = ((size_t) newNumSamples + 3) & ~3u;
+            const size_t channelListSize = ((sizeof (Type*) * (size_t) (newNumChannels + 1)) + 15) & ~15u;
+            const size_t newTotalBytes = ((size_t) newNumChannels * (size_t) allocatedSamplesPerChannel * sizeof (Type))
+                                            + channelListSize + 32;
+
+            if (keepExistingContent)
+            {
+                HeapBlock <char, true> newData;
+                newData.allocate (newTotalBytes, clearExtraSpace);
+
+                const size_t numSamplesToCopy = (size_t) jmin (newNumSamples, size);
+
+                Type** const newChannels = reinterpret_cast <Type**> (newData.getData());
+                Type* newChan = reinterpret_cast <Type*> (newData + channelListSize);
+
+                for (int j = 0; j < newNumChannels; ++j)
+                {
+                    newChannels[j] = newChan;
+                    newChan += allocatedSamplesPerChannel;
+                }
+
+                const int numChansToCopy = jmin (numChannels, newNumChannels);
+                for (int i = 0; i < numChansToCopy; ++i)
+                    FloatVectorOperations::copy (newChannels[i], channels[i], (int) numSamplesToCopy);
+
+                allocatedData.swapWith (newData);
+                allocatedBytes = newTotalBytes;
+                channels = newChannels;
+            }
+            else
+            {
+                if (avoidReallocating && allocatedBytes >= newTotalBytes)
+                {
+                    if (clearExtraSpace)
+                        allocatedData.clear (newTotalBytes);
+                }
+                else
+                {
+                    allocatedBytes = newTotalBytes;
+                    allocatedData.allocate (newTotalBytes, clearExtraSpace);
+                    channels = reinterpret_cast <Type**> (allocatedData.getData());
+                }
+
+                Type* chan = reinterpret_cast <Type*> (allocatedData + channelListSize);
+                for (int i = 0; i < newNumChannels; ++i)
+                {
+                    channels[i] = chan;
+                    chan += allocatedSamplesPerChannel;
+                }
+            }
+
+            channels [newNumChannels] = 0;
+            size = newNumSamples;
+            numChannels = newNumChannels;
+        }
+    }
 
     /** Makes this buffer point to a pre-allocated set of channel data arrays.
 
@@ -189,18 +305,33 @@ public:
                                 for each channel that should be used by this buffer. The
                                 buffer will only refer to this memory, it won't try to delete
                                 it when the buffer is deleted or resized.
-        @param numChannels      the number of channels to use - this must correspond to the
+        @param newNumChannels   the number of channels to use - this must correspond to the
                                 number of elements in the array passed in
-        @param numSamples       the number of samples to use - this must correspond to the
+        @param newNumSamples    the number of samples to use - this must correspond to the
                                 size of the arrays passed in
     */
-    void setDataToReferTo (float** dataToReferTo,
-                           int numChannels,
-                           int numSamples) noexcept;
+    void setDataToReferTo (Type** dataToReferTo,
+                           const int newNumChannels,
+                           const int newNumSamples) noexcept
+    {
+        jassert (newNumChannels > 0);
+
+        allocatedBytes = 0;
+        allocatedData.free();
+
+        numChannels = newNumChannels;
+        size = newNumSamples;
+
+        allocateChannels (dataToReferTo, 0);
+    }
 
     //==============================================================================
     /** Clears all the samples in all channels. */
-    void clear() noexcept;
+    void clear() noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            FloatVectorOperations::clear (channels[i], size);
+    }
 
     /** Clears a specified region of all the channels.
 
@@ -208,7 +339,13 @@ public:
         are in-range, so be careful!
     */
     void clear (int startSample,
-                int numSamples) noexcept;
+                int numSamples) noexcept
+    {
+        jassert (startSample >= 0 && startSample + numSamples <= size);
+
+        for (int i = 0; i < numChannels; ++i)
+            FloatVectorOperations::clear (channels[i] + startSample, numSamples);
+    }
 
     /** Clears a specified region of just one channel.
 
@@ -217,7 +354,13 @@ public:
     */
     void clear (int channel,
                 int startSample,
-                int numSamples) noexcept;
+                int numSamples) noexcept
+    {
+        jassert (isPositiveAndBelow (channel, numChannels));
+        jassert (startSample >= 0 && startSample + numSamples <= size);
+
+        FloatVectorOperations::clear (channels [channel] + startSample, numSamples);
+    }
 
     /** Applies a gain multiple to a region of one channel.
 
@@ -227,7 +370,21 @@ public:
     void applyGain (int channel,
                     int startSample,
                     int numSamples,
-                    float gain) noexcept;
+                    Type gain) noexcept
+    {
+        jassert (isPositiveAndBelow (channel, numChannels));
+        jassert (startSample >= 0 && startSample + numSamples <= size);
+
+        if (gain != (Type) 1)
+        {
+            Type* const d = channels [channel] + startSample;
+
+            if (gain == 0)
+                FloatVectorOperations::clear (d, numSamples);
+            else
+                FloatVectorOperations::multiply (d, gain, numSamples);
+        }
+    }
 
     /** Applies a gain multiple to a region of all the channels.
 
@@ -236,10 +393,17 @@ public:
     */
     void applyGain (int startSample,
                     int numSamples,
-                    float gain) noexcept;
+                    Type gain) noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            applyGain (i, startSample, numSamples, gain);
+    }
 
     /** Applies a gain multiple to all the audio data. */
-    void applyGain (float gain) noexcept;
+    void applyGain (Type gain) noexcept
+    {
+        applyGain (0, size, gain);
+    }
 
     /** Applies a range of gains to a region of a channel.
 
@@ -253,8 +417,28 @@ public:
     void applyGainRamp (int channel,
                         int startSample,
                         int numSamples,
-                        float startGain,
-                        float endGain) noexcept;
+                        Type startGain,
+                        Type endGain) noexcept
+    {
+        if (startGain == endGain)
+        {
+            applyGain (channel, startSample, numSamples, startGain);
+        }
+        else
+        {
+            jassert (isPositiveAndBelow (channel, numChannels));
+            jassert (startSample >= 0 && startSample + numSamples <= size);
+
+            const Type increment = (endGain - startGain) / numSamples;
+            Type* d = channels [channel] + startSample;
+
+            while (--numSamples >= 0)
+            {
+                *d++ *= startGain;
+                startGain += increment;
+            }
+        }
+    }
 
     /** Applies a range of gains to a region of all channels.
 
@@ -267,8 +451,12 @@ public:
     */
     void applyGainRamp (int startSample,
                         int numSamples,
-                        float startGain,
-                        float endGain) noexcept;
+                        Type startGain,
+                        Type endGain) noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            applyGainRamp (i, startSample, numSamples, startGain, endGain);
+    }
 
     /** Adds samples from another buffer to this one.
 
@@ -285,11 +473,29 @@ public:
     */
     void addFrom (int destChannel,
                   int destStartSample,
-                  const AudioSampleBuffer& source,
+                  const AudioBuffer& source,
                   int sourceChannel,
                   int sourceStartSample,
                   int numSamples,
-                  float gainToApplyToSource = 1.0f) noexcept;
+                  Type gainToApplyToSource = (Type) 1) noexcept
+    {
+        jassert (&source != this || sourceChannel != destChannel);
+        jassert (isPositiveAndBelow (destChannel, numChannels));
+        jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
+        jassert (isPositiveAndBelow (sourceChannel, source.numChannels));
+        jassert (sourceStartSample >= 0 && sourceStartSample + numSamples <= source.size);
+
+        if (gainToApplyToSource != 0 && numSamples > 0)
+        {
+            Type* const d = channels [destChannel] + destStartSample;
+            const Type* const s  = source.channels [sourceChannel] + sourceStartSample;
+
+            if (gainToApplyToSource != (Type) 1)
+                FloatVectorOperations::addWithMultiply (d, s, gainToApplyToSource, numSamples);
+            else
+                FloatVectorOperations::add (d, s, numSamples);
+        }
+    }
 
     /** Adds samples from an array of floats to one of the channels.
 
@@ -304,9 +510,24 @@ public:
     */
     void addFrom (int destChannel,
                   int destStartSample,
-                  const float* source,
+                  const Type* source,
                   int numSamples,
-                  float gainToApplyToSource = 1.0f) noexcept;
+                  Type gainToApplyToSource = (Type) 1) noexcept
+    {
+        jassert (isPositiveAndBelow (destChannel, numChannels));
+        jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
+        jassert (source != nullptr);
+
+        if (gainToApplyToSource != 0 && numSamples > 0)
+        {
+            Type* const d = channels [destChannel] + destStartSample;
+
+            if (gainToApplyToSource != (Type) 1)
+                FloatVectorOperations::addWithMultiply (d, source, gainToApplyToSource, numSamples);
+            else
+                FloatVectorOperations::add (d, source, numSamples);
+        }
+    }
 
     /** Adds samples from an array of floats, applying a gain ramp to them.
 
@@ -321,10 +542,34 @@ public:
     */
     void addFromWithRamp (int destChannel,
                           int destStartSample,
-                          const float* source,
+                          const Type* source,
                           int numSamples,
-                          float startGain,
-                          float endGain) noexcept;
+                          Type startGain,
+                          Type endGain) noexcept
+    {
+        jassert (isPositiveAndBelow (destChannel, numChannels));
+        jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
+        jassert (source != nullptr);
+
+        if (startGain == endGain)
+        {
+            addFrom (destChannel, destStartSample, source, numSamples, startGain);
+        }
+        else
+        {
+            if (numSamples > 0 && (startGain != 0 || endGain != 0))
+            {
+                const Type increment = (endGain - startGain) / numSamples;
+                Type* d = channels [destChannel] + destStartSample;
+
+                while (--numSamples >= 0)
+                {
+                    *d++ += startGain * *source++;
+                    startGain += increment;
+                }
+            }
+        }
+    }
 
     /** Copies samples from another buffer to this one.
 
@@ -339,10 +584,54 @@ public:
     */
     void copyFrom (int destChannel,
                    int destStartSample,
-                   const AudioSampleBuffer& source,
+                   const AudioBuffer& source,
+                   int sourceChannel,
+                   int sourceStartSample,
+                   int numSamples) noexcept
+    {
+        jassert (&source != this || sourceChannel != destChannel);
+        jassert (isPositiveAndBelow (destChannel, numChannels));
+        jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
+        jassert (isPositiveAndBelow (sourceChannel, source.numChannels));
+        jassert (sourceStartSample >= 0 && sourceStartSample + numSamples <= source.size);
+
+        if (numSamples > 0)
+        {
+            FloatVectorOperations::copy (channels [destChannel] + destStartSample,
+                                         source.channels [sourceChannel] + sourceStartSample,
+                                         numSamples);
+        }
+    }
+
+    /** Copies samples from a buffer with a different sample type, converting them
+        to this buffer's type.
+
+        @param destChannel          the channel within this buffer to copy the samples to
+        @param destStartSample      the start sample within this buffer's channel
+        @param source               the source buffer to read from
+        @param sourceChannel        the channel within the source buffer to read from
+        @param sourceStartSample    the offset within the source buffer's channel to start reading samples from
+        @param numSamples           the number of samples to process
+    */
+    template <typename OtherType>
+    void copyFrom (int destChannel,
+                   int destStartSample,
+                   const AudioBuffer<OtherType>& source,
                    int sourceChannel,
                    int sourceStartSample,
-                   int numSamples) noexcept;
+                   int numSamples) noexcept
+    {
+        jassert (isPositiveAndBelow (destChannel, numChannels));
+        jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
+        jassert (isPositiveAndBelow (sourceChannel, source.getNumChannels()));
+        jassert (sourceStartSample >= 0 && sourceStartSample + numSamples <= source.getNumSamples());
+
+        Type* d = channels [destChannel] + destStartSample;
+        const OtherType* s = source.getArrayOfChannels() [sourceChannel] + sourceStartSample;
+
+        while (--numSamples >= 0)
+            *d++ = (Type) *s++;
+    }
 
     /** Copies samples from an array of floats into one of the channels.
 
@@ -355,8 +644,16 @@ public:
     */
     void copyFrom (int destChannel,
                    int destStartSample,
-                   const float* source,
-                   int numSamples) noexcept;
+                   const Type* source,
+                   int numSamples) noexcept
+    {
+        jassert (isPositiveAndBelow (destChannel, numChannels));
+        jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
+        jassert (source != nullptr);
+
+        if (numSamples > 0)
+            FloatVectorOperations::copy (channels [destChannel] + destStartSample, source, numSamples);
+    }
 
     /** Copies samples from an array of floats into one of the channels, applying a gain to it.
 
@@ -370,9 +667,31 @@ public:
     */
     void copyFrom (int destChannel,
                    int destStartSample,
-                   const float* source,
+                   const Type* source,
                    int numSamples,
-                   float gain) noexcept;
+                   Type gain) noexcept
+    {
+        jassert (isPositiveAndBelow (destChannel, numChannels));
+        jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
+        jassert (source != nullptr);
+
+        if (numSamples > 0)
+        {
+            Type* d = channels [destChannel] + destStartSample;
+
+            if (gain != (Type) 1)
+            {
+                if (gain == 0)
+                    FloatVectorOperations::clear (d, numSamples);
+                else
+                    FloatVectorOperations::copyWithMultiply (d, source, gain, numSamples);
+            }
+            else
+            {
+                FloatVectorOperations::copy (d, source, numSamples);
+            }
+        }
+    }
 
     /** Copies samples from an array of floats into one of the channels, applying a gain ramp.
 
@@ -389,11 +708,34 @@ public:
     */
     void copyFromWithRamp (int destChannel,
                            int destStartSample,
-                           const float* source,
+                           const Type* source,
                            int numSamples,
-                           float startGain,
-                           float endGain) noexcept;
-
+                           Type startGain,
+                           Type endGain) noexcept
+    {
+        jassert (isPositiveAndBelow (destChannel, numChannels));
+        jassert (destStartSample >= 0 && destStartSample + numSamples <= size);
+        jassert (source != nullptr);
+
+        if (startGain == endGain)
+        {
+            copyFrom (destChannel, destStartSample, source, numSamples, startGain);
+        }
+        else
+        {
+            if (numSamples > 0 && (startGain != 0 || endGain != 0))
+            {
+                const Type increment = (endGain - startGain) / numSamples;
+                Type* d = channels [destChannel] + destStartSample;
+
+                while (--numSamples >= 0)
+                {
+                    *d++ = startGain * *source++;
+                    startGain += increment;
+                }
+            }
+        }
+    }
 
     /** Finds the highest and lowest sample values in a given range.
 
@@ -406,39 +748,131 @@ public:
     void findMinMax (int channel,
                      int startSample,
                      int numSamples,
-                     float& minVal,
-                     float& maxVal) const noexcept;
+                     Type& minVal,
+                     Type& maxVal) const noexcept
+    {
+        jassert (isPositiveAndBelow (channel, numChannels));
+        jassert (startSample >= 0 && startSample + numSamples <= size);
+
+        FloatVectorOperations::findMinAndMax (channels [channel] + startSample,
+                                              numSamples, minVal, maxVal);
+    }
 
     /** Finds the highest absolute sample value within a region of a channel.
     */
-    float getMagnitude (int channel,
-                        int startSample,
-                        int numSamples) const noexcept;
+    Type getMagnitude (int channel,
+                       int startSample,
+                       int numSamples) const noexcept
+    {
+        jassert (isPositiveAndBelow (channel, numChannels));
+        jassert (startSample >= 0 && startSample + numSamples <= size);
+
+        Type mn, mx;
+        findMinMax (channel, startSample, numSamples, mn, mx);
+
+        return jmax (mn, -mn, mx, -mx);
+    }
 
     /** Finds the highest absolute sample value within a region on all channels.
     */
-    float getMagnitude (int startSample,
-                        int numSamples) const noexcept;
+    Type getMagnitude (int startSample,
+                       int numSamples) const noexcept
+    {
+        Type mag = 0;
+
+        for (int i = 0; i < numChannels; ++i)
+            mag = jmax (mag, getMagnitude (i, startSample, numSamples));
+
+        return mag;
+    }
 
     /** Returns the root mean squared level for a region of a channel.
     */
-    float getRMSLevel (int channel,
-                       int startSample,
-                       int numSamples) const noexcept;
+    Type getRMSLevel (int channel,
+                      int startSample,
+                      int numSamples) const noexcept
+    {
+        jassert (isPositiveAndBelow (channel, numChannels));
+        jassert (startSample >= 0 && startSample + numSamples <= size);
+
+        if (numSamples <= 0 || channel < 0 || channel >= numChannels)
+            return 0;
+
+        const Type* const data = channels [channel] + startSample;
+        double sum = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const Type sample = data [i];
+            sum += sample * sample;
+        }
+
+        return (Type) std::sqrt (sum / numSamples);
+    }
 
 private:
     //==============================================================================
     int numChannels, size;
     size_t allocatedBytes;
-    float** channels;
+    Type** channels;
     HeapBlock <char, true> allocatedData;
-    float* preallocatedChannelSpace [32];
+    Type* preallocatedChannelSpace [32];
 
-    void allocateData();
-    void allocateChannels (float* const* dataToReferTo, int offset);
+    void allocateData()
+    {
+        const size_t channelListSize = ((sizeof (Type*) * (size_t) (numChannels + 1)) + 15) & ~15u;
+        allocatedBytes = (size_t) numChannels * (size_t) size * sizeof (Type) + channelListSize + 32;
+        allocatedData.malloc (allocatedBytes);
+        channels = reinterpret_cast <Type**> (allocatedData.getData());
+
+        Type* chan = reinterpret_cast <Type*> (allocatedData + channelListSize);
+        for (int i = 0; i < numChannels; ++i)
+        {
+            channels[i] = chan;
+            chan += size;
+        }
+
+        channels [numChannels] = nullptr;
+    }
 
-    JUCE_LEAK_DETECTOR (AudioSampleBuffer)
+    void allocateChannels (Type* const* const dataToReferTo, int offset)
+    {
+        // (try to avoid doing a malloc here, as that'll blow up things like Pro-Tools)
+        if (numChannels < (int) numElementsInArray (preallocatedChannelSpace))
+        {
+            channels = static_cast <Type**> (preallocatedChannelSpace);
+        }
+        else
+        {
+            allocatedData.malloc ((size_t) numChannels + 1, sizeof (Type*));
+            channels = reinterpret_cast <Type**> (allocatedData.getData());
+        }
+
+        for (int i = 0; i < numChannels; ++i)
+        {
+            // you have to pass in the same number of valid pointers as numChannels
+            jassert (dataToReferTo[i] != nullptr);
+
+            channels[i] = dataToReferTo[i] + offset;
+        }
+
+        channels [numChannels] = nullptr;
+    }
+
+    JUCE_LEAK_DETECTOR (AudioBuffer)
 };
 
+//==============================================================================
+/** A multi-channel buffer of 32-bit floating point audio samples.
+    @see AudioBuffer
+*/
+typedef AudioBuffer<float> AudioSampleBuffer;
+
+/** A multi-channel buffer of 64-bit floating point audio samples, used by processors
+    that can render in double precision - see AudioProcessor::supportsDoublePrecisionProcessing().
+    @see AudioBuffer
+*/
+typedef AudioBuffer<double> DoubleAudioSampleBuffer;
+
 
 #endif   // JUCE_AUDIOSAMPLEBUFFER_H_INCLUDED
@@ -342,3 +342,71 @@ float JUCE_CALLTYPE FloatVectorOperations::findMaximum (const float* src, int nu
     return juce::findMaximum (src, num);
    #endif
 }
+
+//==============================================================================
+void JUCE_CALLTYPE FloatVectorOperations::clear (double* dest, int num) noexcept
+{
+    zeromem (dest, (size_t) num * sizeof (double));
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::fill (double* dest, double valueToFill, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        dest[i] = valueToFill;
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::copy (double* dest, const double* src, int num) noexcept
+{
+    memcpy (dest, src, (size_t) num * sizeof (double));
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (double* dest, const double* src, double multiplier, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        dest[i] = src[i] * multiplier;
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        dest[i] += src[i];
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, double amount, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        dest[i] += amount;
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const double* src, double multiplier, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        dest[i] += src[i] * multiplier;
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, const double* src, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        dest[i] *= src[i];
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, double multiplier, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        dest[i] *= multiplier;
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const double* src, int num, double& minResult, double& maxResult) noexcept
+{
+    juce::findMinAndMax (src, num, minResult, maxResult);
+}
+
+double JUCE_CALLTYPE FloatVectorOperations::findMinimum (const double* src, int num) noexcept
+{
+    return juce::findMinimum (src, num);
+}
+
+double JUCE_CALLTYPE FloatVectorOperations::findMaximum (const double* src, int num) noexcept
+{
+    return juce::findMaximum (src, num);
+}
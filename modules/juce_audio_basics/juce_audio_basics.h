@@ -32,8 +32,8 @@ namespace juce
 {
 
 #include "buffers/juce_AudioDataConverters.h"
-#include "buffers/juce_AudioSampleBuffer.h"
 #include "buffers/juce_FloatVectorOperations.h"
+#include "buffers/juce_AudioSampleBuffer.h"
 #include "effects/juce_Decibels.h"
 #include "effects/juce_IIRFilter.h"
 #include "effects/juce_LagrangeInterpolator.h"
@@ -41,7 +41,10 @@ namespace juce
 #include "midi/juce_MidiMessage.h"
 #include "midi/juce_MidiBuffer.h"
 #include "midi/juce_MidiMessageSequence.h"
+#include "midi/juce_PackedMidiSequence.h"
 #include "midi/juce_MidiFile.h"
+#include "midi/juce_MidiFileReader.h"
+#include "midi/juce_MidiFileWriter.h"
 #include "midi/juce_MidiKeyboardState.h"
 #include "sources/juce_AudioSource.h"
 #include "sources/juce_PositionableAudioSource.h"
@@ -69,28 +69,70 @@ namespace MidiBufferHelpers
     }
 }
 
+//==============================================================================
+struct MidiBuffer::MergeSource
+{
+    const uint8* data;
+    const uint8* end;
+    int sampleDelta;
+};
+
 //==============================================================================
 MidiBuffer::MidiBuffer() noexcept
-    : bytesUsed (0)
+    : bytesUsed (0), lastEventTime (0), numDroppedEvents (0), reallocationAllowed (true)
 {
 }
 
 MidiBuffer::MidiBuffer (const MidiMessage& message) noexcept
-    : bytesUsed (0)
+    : bytesUsed (0), lastEventTime (0), numDroppedEvents (0), reallocationAllowed (true)
 {
     addEvent (message, 0);
 }
 
 MidiBuffer::MidiBuffer (const MidiBuffer& other) noexcept
     : data (other.data),
-      bytesUsed (other.bytesUsed)
+      bytesUsed (other.bytesUsed),
+      lastEventTime (other.lastEventTime),
+      numDroppedEvents (0),
+      reallocationAllowed (true)
 {
 }
 
 MidiBuffer& MidiBuffer::operator= (const MidiBuffer& other) noexcept
 {
-    bytesUsed = other.bytesUsed;
-    data = other.data;
+    if (this != &other)
+    {
+        if (reallocationAllowed)
+        {
+            data = other.data;
+            bytesUsed = other.bytesUsed;
+        }
+        else
+        {
+            // copy as many whole events as will fit into the space we've already got
+            const uint8* const source = other.getData();
+            const int spaceAvailable = (int) jmin (data.getSize(), (size_t) other.bytesUsed);
+            int numBytes = 0;
+
+            while (numBytes < other.bytesUsed)
+            {
+                const int next = numBytes + MidiBufferHelpers::getEventTotalSize (source + numBytes);
+
+                if (next > spaceAvailable)
+                    break;
+
+                numBytes = next;
+            }
+
+            memcpy (getData(), source, (size_t) numBytes);
+            bytesUsed = numBytes;
+
+            for (const uint8* d = source + numBytes; d < source + other.bytesUsed; d += MidiBufferHelpers::getEventTotalSize (d))
+                ++numDroppedEvents;
+        }
+
+        lastEventTime = bytesUsed == other.bytesUsed ? other.lastEventTime : findLastEventTime();
+    }
 
     return *this;
 }
@@ -99,6 +141,8 @@ void MidiBuffer::swapWith (MidiBuffer& other) noexcept
 {
     data.swapWith (other.data);
     std::swap (bytesUsed, other.bytesUsed);
+    std::swap (lastEventTime, other.lastEventTime);
+    std::swap (numDroppedEvents, other.numDroppedEvents);
 }
 
 MidiBuffer::~MidiBuffer()
@@ -113,6 +157,7 @@ inline uint8* MidiBuffer::getData() const noexcept
 void MidiBuffer::clear() noexcept
 {
     bytesUsed = 0;
+    numDroppedEvents = 0;
 }
 
 void MidiBuffer::clear (const int startSample, const int numSamples)
@@ -128,9 +173,24 @@ void MidiBuffer::clear (const int startSample, const int numSamples)
             memmove (start, end, (size_t) bytesToMove);
 
         bytesUsed -= (int) (end - start);
+
+        if (bytesToMove == 0)
+            lastEventTime = findLastEventTime();
     }
 }
 
+bool MidiBuffer::ensureSpaceFor (const size_t totalBytes)
+{
+    if (totalBytes <= data.getSize())
+        return true;
+
+    if (! reallocationAllowed)
+        return false;
+
+    data.ensureSize ((totalBytes + totalBytes / 2 + 8) & ~(size_t) 7);
+    return true;
+}
+
 void MidiBuffer::addEvent (const MidiMessage& m, const int sampleNumber)
 {
     addEvent (m.getRawData(), m.getRawDataSize(), sampleNumber);
@@ -142,14 +202,27 @@ void MidiBuffer::addEvent (const void* const newData, const int maxBytes, const
 
     if (numBytes > 0)
     {
-        size_t spaceNeeded = (size_t) bytesUsed + (size_t) numBytes + sizeof (int) + sizeof (uint16);
-        data.ensureSize ((spaceNeeded + spaceNeeded / 2 + 8) & ~(size_t) 7);
+        const size_t newItemSize = (size_t) numBytes + sizeof (int) + sizeof (uint16);
+
+        if (! ensureSpaceFor ((size_t) bytesUsed + newItemSize))
+        {
+            ++numDroppedEvents;
+            return;
+        }
 
-        uint8* d = findEventAfter (getData(), sampleNumber);
-        const int bytesToMove = bytesUsed - (int) (d - getData());
+        uint8* d;
 
-        if (bytesToMove > 0)
-            memmove (d + numBytes + sizeof (int) + sizeof (uint16), d, (size_t) bytesToMove);
+        if (bytesUsed == 0 || sampleNumber >= lastEventTime)
+        {
+            // the common case of events arriving in order can just be appended
+            d = getData() + bytesUsed;
+            lastEventTime = sampleNumber;
+        }
+        else
+        {
+            d = findEventAfter (getData(), sampleNumber);
+            memmove (d + newItemSize, d, (size_t) (bytesUsed - (int) (d - getData())));
+        }
 
         *reinterpret_cast <int*> (d) = sampleNumber;
         d += sizeof (int);
@@ -158,7 +231,7 @@ void MidiBuffer::addEvent (const void* const newData, const int maxBytes, const
 
         memcpy (d, newData, (size_t) numBytes);
 
-        bytesUsed += sizeof (int) + sizeof (uint16) + (size_t) numBytes;
+        bytesUsed += (int) newItemSize;
     }
 }
 
@@ -167,17 +240,165 @@ void MidiBuffer::addEvents (const MidiBuffer& otherBuffer,
                             const int numSamples,
                             const int sampleDeltaToAdd)
 {
-    Iterator i (otherBuffer);
-    i.setNextSamplePosition (startSample);
+    jassert (&otherBuffer != this);
+
+    MergeSource source;
+    source.data = otherBuffer.getData();
+    source.end = source.data + otherBuffer.bytesUsed;
+    source.sampleDelta = sampleDeltaToAdd;
+
+    while (source.data < source.end && MidiBufferHelpers::getEventTime (source.data) < startSample)
+        source.data += MidiBufferHelpers::getEventTotalSize (source.data);
+
+    if (numSamples >= 0)
+        source.end = otherBuffer.findEventAfter (const_cast <uint8*> (source.data), startSample + numSamples - 1);
+
+    mergeFrom (&source, 1);
+}
 
-    const uint8* eventData;
-    int eventSize, position;
+void MidiBuffer::addEvents (const MidiBuffer* const* const buffersToMerge, const int numBuffers)
+{
+    // (each pass merges up to this many buffers, which keeps the cursors on the stack)
+    const int maxSourcesPerPass = 16;
+    MergeSource sources [maxSourcesPerPass];
 
-    while (i.getNextEvent (eventData, eventSize, position)
-            && (position < startSample + numSamples || numSamples < 0))
+    for (int i = 0; i < numBuffers;)
     {
-        addEvent (eventData, eventSize, position + sampleDeltaToAdd);
+        int numSources = 0;
+
+        for (; i < numBuffers && numSources < maxSourcesPerPass; ++i)
+        {
+            if (const MidiBuffer* const other = buffersToMerge[i])
+            {
+                jassert (other != this);
+
+                if (other->bytesUsed > 0)
+                {
+                    MergeSource& source = sources [numSources++];
+                    source.data = other->getData();
+                    source.end = source.data + other->bytesUsed;
+                    source.sampleDelta = 0;
+                }
+            }
+        }
+
+        mergeFrom (sources, numSources);
+    }
+}
+
+void MidiBuffer::mergeFrom (const MergeSource* const sources, const int numSources)
+{
+    using namespace MidiBufferHelpers;
+
+    const int maxSources = 16;
+    jassert (numSources <= maxSources);
+
+    MergeSource cursors [maxSources];
+    size_t incomingBytes = 0;
+
+    for (int i = 0; i < numSources; ++i)
+    {
+        cursors[i] = sources[i];
+        incomingBytes += (size_t) (sources[i].end - sources[i].data);
+    }
+
+    if (incomingBytes == 0)
+        return;
+
+    const size_t existingBytes = (size_t) bytesUsed;
+
+    if (numSources == 1
+         && (bytesUsed == 0 || getEventTime (cursors[0].data) + cursors[0].sampleDelta >= lastEventTime)
+         && ensureSpaceFor (existingBytes + incomingBytes))
+    {
+        // everything arrives after our existing events, so it can be appended in one go..
+        uint8* d = getData() + bytesUsed;
+        uint8* const end = d + incomingBytes;
+        memcpy (d, cursors[0].data, incomingBytes);
+
+        for (; d < end; d += getEventTotalSize (d))
+        {
+            lastEventTime = getEventTime (d) + cursors[0].sampleDelta;
+            *reinterpret_cast <int*> (d) = lastEventTime;
+        }
+
+        bytesUsed += (int) incomingBytes;
+        return;
+    }
+
+    ensureSpaceFor (existingBytes + incomingBytes);
+    const size_t spaceAvailable = jmin (data.getSize(), existingBytes + incomingBytes);
+    const size_t incomingSpace = spaceAvailable - existingBytes;
+    size_t incomingBytesUsed = 0;
+
+    // Our existing events are moved up to the end of the space, and then merged back down
+    // with the incoming ones. Because the incoming events can never use more than the gap
+    // this leaves, the write position can't overtake the unread existing events.
+    uint8* const base = getData();
+    uint8* dest = base;
+    const uint8* existing = base + incomingSpace;
+    const uint8* const existingEnd = base + spaceAvailable;
+
+    memmove (base + incomingSpace, base, existingBytes);
+
+    for (;;)
+    {
+        int best = -1, bestTime = 0;
+
+        // existing events come before incoming ones with the same time, and incoming
+        // ones are taken in the order of their sources
+        if (existing < existingEnd)
+        {
+            best = numSources;
+            bestTime = getEventTime (existing);
+        }
+
+        for (int i = 0; i < numSources; ++i)
+        {
+            if (cursors[i].data < cursors[i].end)
+            {
+                const int time = getEventTime (cursors[i].data) + cursors[i].sampleDelta;
+
+                if (best < 0 || time < bestTime)
+                {
+                    best = i;
+                    bestTime = time;
+                }
+            }
+        }
+
+        if (best < 0)
+            break;
+
+        if (best == numSources)
+        {
+            const int size = getEventTotalSize (existing);
+            memmove (dest, existing, (size_t) size);
+            existing += size;
+            dest += size;
+        }
+        else
+        {
+            const uint8* const eventData = cursors[best].data;
+            const int size = getEventTotalSize (eventData);
+            cursors[best].data += size;
+
+            if (incomingBytesUsed + (size_t) size > incomingSpace)
+            {
+                ++numDroppedEvents;
+                continue;
+            }
+
+            memcpy (dest, eventData, (size_t) size);
+            *reinterpret_cast <int*> (dest) = bestTime;
+            incomingBytesUsed += (size_t) size;
+            dest += size;
+        }
+
+        lastEventTime = bestTime;
     }
+
+    bytesUsed = (int) (dest - base);
 }
 
 void MidiBuffer::ensureSize (size_t minimumNumBytes)
@@ -185,6 +406,11 @@ void MidiBuffer::ensureSize (size_t minimumNumBytes)
     data.ensureSize (minimumNumBytes);
 }
 
+void MidiBuffer::setReallocationAllowed (const bool shouldBeAllowed) noexcept
+{
+    reallocationAllowed = shouldBeAllowed;
+}
+
 bool MidiBuffer::isEmpty() const noexcept
 {
     return bytesUsed == 0;
@@ -211,6 +437,11 @@ int MidiBuffer::getFirstEventTime() const noexcept
 }
 
 int MidiBuffer::getLastEventTime() const noexcept
+{
+    return bytesUsed > 0 ? lastEventTime : 0;
+}
+
+int MidiBuffer::findLastEventTime() const noexcept
 {
     if (bytesUsed == 0)
         return 0;
@@ -287,3 +518,211 @@ bool MidiBuffer::Iterator::getNextEvent (MidiMessage& result, int& samplePositio
 
     return true;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MidiBufferTests  : public UnitTest
+{
+public:
+    MidiBufferTests() : UnitTest ("MidiBuffer") {}
+
+    struct Event
+    {
+        int time, id;
+    };
+
+    static void addEventWithId (MidiBuffer& buffer, int time, int id)
+    {
+        const uint8 bytes[] = { 0xb0, (uint8) ((id >> 7) & 0x7f), (uint8) (id & 0x7f) };
+        buffer.addEvent (bytes, 3, time);
+    }
+
+    static void addReferenceEvent (Array<Event>& events, int time, int id)
+    {
+        // stays sorted, with new events after any existing ones at the same time
+        int i = events.size();
+
+        while (i > 0 && events.getReference (i - 1).time > time)
+            --i;
+
+        const Event e = { time, id };
+        events.insert (i, e);
+    }
+
+    void expectContents (const MidiBuffer& buffer, const Array<Event>& expected)
+    {
+        MidiBuffer::Iterator iter (buffer);
+        const uint8* data;
+        int numBytes, time, index = 0;
+
+        while (iter.getNextEvent (data, numBytes, time))
+        {
+            if (index >= expected.size())
+                break;
+
+            expectEquals (time, expected.getReference (index).time);
+            expectEquals ((int) (data[1] << 7) + data[2], expected.getReference (index).id);
+            ++index;
+        }
+
+        expectEquals (buffer.getNumEvents(), expected.size());
+        expectEquals (buffer.getLastEventTime(), expected.size() > 0 ? expected.getLast().time : 0);
+    }
+
+    void runTest()
+    {
+        Random r;
+
+        beginTest ("Unordered insertion");
+
+        {
+            MidiBuffer buffer;
+            Array<Event> expected;
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                const int time = r.nextInt (200);
+                addEventWithId (buffer, time, i);
+                addReferenceEvent (expected, time, i);
+            }
+
+            expectContents (buffer, expected);
+
+            buffer.clear (150, 100);
+
+            while (expected.size() > 0 && expected.getLast().time >= 150)
+                expected.removeLast();
+
+            expectContents (buffer, expected);
+        }
+
+        beginTest ("Merging");
+
+        {
+            MidiBuffer buffers [5], merged, sequential;
+            Array<Event> expected;
+            int id = 0;
+
+            for (int i = 0; i < 20; ++i)
+            {
+                const int time = r.nextInt (100);
+                addEventWithId (merged, time, id);
+                addEventWithId (sequential, time, id);
+                addReferenceEvent (expected, time, id++);
+            }
+
+            for (int b = 0; b < numElementsInArray (buffers); ++b)
+            {
+                for (int i = 0; i < 200; ++i)
+                    addEventWithId (buffers[b], r.nextInt (100), id++);
+
+                sequential.addEvents (buffers[b], 0, -1, 0);
+
+                MidiBuffer::Iterator iter (buffers[b]);
+                const uint8* data;
+                int numBytes, time;
+
+                while (iter.getNextEvent (data, numBytes, time))
+                    addReferenceEvent (expected, time, (data[1] << 7) + data[2]);
+            }
+
+            const MidiBuffer* bufferList[] = { buffers, buffers + 1, buffers + 2, buffers + 3, buffers + 4 };
+            merged.addEvents (bufferList, numElementsInArray (bufferList));
+
+            expectContents (merged, expected);
+            expectContents (sequential, expected);
+
+            MidiBuffer ranged;
+            Array<Event> expectedRange;
+            ranged.addEvents (buffers[0], 25, 50, 1000);
+
+            MidiBuffer::Iterator iter (buffers[0]);
+            const uint8* data;
+            int numBytes, time;
+
+            while (iter.getNextEvent (data, numBytes, time))
+                if (time >= 25 && time < 75)
+                    addReferenceEvent (expectedRange, time + 1000, (data[1] << 7) + data[2]);
+
+            expectContents (ranged, expectedRange);
+        }
+
+        beginTest ("Fixed capacity");
+
+        {
+            MidiBuffer buffer, source;
+            buffer.ensureSize (90);
+            buffer.setReallocationAllowed (false);
+
+            for (int i = 0; i < 20; ++i)
+                addEventWithId (buffer, i, i);
+
+            // each event takes 9 bytes
+            expectEquals (buffer.getNumEvents(), 10);
+            expectEquals (buffer.getNumDroppedEvents(), 10);
+
+            buffer.clear();
+
+            for (int i = 0; i < 20; ++i)
+                addEventWithId (source, i, i);
+
+            buffer.addEvents (source, 0, -1, 0);
+            expectEquals (buffer.getNumEvents(), 10);
+            expectEquals (buffer.getLastEventTime(), 9);
+
+            buffer = source;
+            expectEquals (buffer.getNumEvents(), 10);
+            expectEquals (buffer.getNumDroppedEvents(), 20);
+        }
+
+        beginTest ("Performance");
+
+        {
+            const int numEventsPerBlock = 10000, numBlocks = 50, numSources = 8;
+            MidiBuffer buffer, sources [numSources];
+            const MidiBuffer* sourceList [numSources];
+
+            for (int i = 0; i < numSources; ++i)
+            {
+                sourceList[i] = sources + i;
+
+                for (int j = 0; j < numEventsPerBlock / numSources; ++j)
+                    addEventWithId (sources[i], j * numSources + i, j);
+            }
+
+            buffer.ensureSize (numEventsPerBlock * 16);
+            buffer.setReallocationAllowed (false);
+
+            double appendTime = 0, mergeTime = 0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                buffer.clear();
+                double start = Time::getMillisecondCounterHiRes();
+
+                for (int i = 0; i < numEventsPerBlock; ++i)
+                    addEventWithId (buffer, i / 4, i);
+
+                appendTime += Time::getMillisecondCounterHiRes() - start;
+
+                buffer.clear();
+                start = Time::getMillisecondCounterHiRes();
+                buffer.addEvents (sourceList, numSources);
+                mergeTime += Time::getMillisecondCounterHiRes() - start;
+            }
+
+            expectEquals (buffer.getNumEvents(), numEventsPerBlock);
+            expectEquals (buffer.getNumDroppedEvents(), 0);
+
+            logMessage ("Appending " + String (numEventsPerBlock) + " events: "
+                          + String (appendTime / numBlocks, 3) + "ms per block");
+            logMessage ("Merging " + String (numSources) + " buffers of " + String (numEventsPerBlock / numSources)
+                          + " events: " + String (mergeTime / numBlocks, 3) + "ms per block");
+        }
+    }
+};
+
+static MidiBufferTests midiBufferTests;
+
+#endif
@@ -93,6 +93,9 @@ public:
         If an event is added whose sample position is the same as one or more events
         already in the buffer, the new event will be placed after the existing ones.
 
+        Adding events in time order is the fastest way to fill a buffer, because an event
+        whose position is not earlier than the last one can simply be appended.
+
         To retrieve events, use a MidiBuffer::Iterator object
     */
     void addEvent (const MidiMessage& midiMessage, int sampleNumber);
@@ -130,12 +133,26 @@ public:
                                     startSample will be taken.
         @param sampleDeltaToAdd     a value which will be added to the source timestamps of the events
                                     that are added to this buffer
+
+        The events are merged in a single pass, so this takes time proportional to the
+        total size of the two buffers, however the events are ordered.
     */
     void addEvents (const MidiBuffer& otherBuffer,
                     int startSample,
                     int numSamples,
                     int sampleDeltaToAdd);
 
+    /** Merges all the events from a set of other buffers into this one in a single pass.
+
+        This gives the same result as calling addEvents() for each of the buffers in turn:
+        events with the same sample position end up in the order of the buffers that they
+        came from, after any events that were already in this buffer. But it does it in
+        one pass over all the buffers rather than one pass per buffer.
+
+        None of the buffers in the list may be this buffer.
+    */
+    void addEvents (const MidiBuffer* const* buffersToMerge, int numBuffers);
+
     /** Returns the sample number of the first event in the buffer.
 
         If the buffer's empty, this will just return 0.
@@ -162,6 +179,27 @@ public:
     */
     void ensureSize (size_t minimumNumBytes);
 
+    /** Stops the buffer from reallocating its storage, or allows it to do so again.
+
+        While reallocation is disabled, the buffer only uses the space that was already
+        allocated, e.g. by ensureSize(). Any events that won't fit are dropped rather than
+        making the buffer grow, and are counted by getNumDroppedEvents(). Assigning another
+        buffer to this one still copies its data into the existing space if it fits. This
+        makes it safe to fill the buffer on the audio thread.
+
+        @see ensureSize, getNumDroppedEvents
+    */
+    void setReallocationAllowed (bool shouldBeAllowed) noexcept;
+
+    /** Returns true unless setReallocationAllowed (false) has been called. */
+    bool isReallocationAllowed() const noexcept                 { return reallocationAllowed; }
+
+    /** Returns the number of events that were dropped since the buffer was last cleared,
+        because reallocation was disabled and they didn't fit.
+        @see setReallocationAllowed
+    */
+    int getNumDroppedEvents() const noexcept                    { return numDroppedEvents; }
+
     //==============================================================================
     /**
         Used to iterate through the events in a MidiBuffer.
@@ -226,10 +264,16 @@ private:
     //==============================================================================
     friend class MidiBuffer::Iterator;
     MemoryBlock data;
-    int bytesUsed;
+    int bytesUsed, lastEventTime, numDroppedEvents;
+    bool reallocationAllowed;
+
+    struct MergeSource;
 
     uint8* getData() const noexcept;
     uint8* findEventAfter (uint8*, int samplePosition) const noexcept;
+    bool ensureSpaceFor (size_t totalBytes);
+    void mergeFrom (const MergeSource* sources, int numSources);
+    int findLastEventTime() const noexcept;
 
     JUCE_LEAK_DETECTOR (MidiBuffer)
 };
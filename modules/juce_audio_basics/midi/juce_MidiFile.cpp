@@ -24,27 +24,6 @@
 
 namespace MidiFileHelpers
 {
-    static void writeVariableLengthInt (OutputStream& out, unsigned int v)
-    {
-        unsigned int buffer = v & 0x7f;
-
-        while ((v >>= 7) != 0)
-        {
-            buffer <<= 8;
-            buffer |= ((v & 0x7f) | 0x80);
-        }
-
-        for (;;)
-        {
-            out.writeByte ((char) buffer);
-
-            if (buffer & 0x80)
-                buffer >>= 8;
-            else
-                break;
-        }
-    }
-
     static bool parseMidiHeader (const uint8* &data, short& timeFormat, short& fileType, short& numberOfTracks) noexcept
     {
         unsigned int ch = ByteOrder::bigEndianInt (data);
@@ -352,73 +331,18 @@ void MidiFile::convertTimestampTicksToSeconds()
 //==============================================================================
 bool MidiFile::writeTo (OutputStream& out)
 {
-    out.writeIntBigEndian ((int) ByteOrder::bigEndianInt ("MThd"));
-    out.writeIntBigEndian (6);
-    out.writeShortBigEndian (1); // type
-    out.writeShortBigEndian ((short) tracks.size());
-    out.writeShortBigEndian (timeFormat);
+    MidiFileWriter writer (out, timeFormat, tracks.size());
 
     for (int i = 0; i < tracks.size(); ++i)
-        writeTrack (out, i);
-
-    out.flush();
-    return true;
-}
-
-void MidiFile::writeTrack (OutputStream& mainOut, const int trackNum)
-{
-    MemoryOutputStream out;
-    const MidiMessageSequence& ms = *tracks.getUnchecked (trackNum);
-
-    int lastTick = 0;
-    uint8 lastStatusByte = 0;
-
-    for (int i = 0; i < ms.getNumEvents(); ++i)
     {
-        const MidiMessage& mm = ms.getEventPointer(i)->message;
-
-        if (! mm.isEndOfTrackMetaEvent())
-        {
-            const int tick = roundToInt (mm.getTimeStamp());
-            const int delta = jmax (0, tick - lastTick);
-            MidiFileHelpers::writeVariableLengthInt (out, (uint32) delta);
-            lastTick = tick;
-
-            const uint8* data = mm.getRawData();
-            int dataSize = mm.getRawDataSize();
-
-            const uint8 statusByte = data[0];
-
-            if (statusByte == lastStatusByte
-                 && (statusByte & 0xf0) != 0xf0
-                 && dataSize > 1
-                 && i > 0)
-            {
-                ++data;
-                --dataSize;
-            }
-            else if (statusByte == 0xf0)  // Write sysex message with length bytes.
-            {
-                out.writeByte ((char) statusByte);
-
-                ++data;
-                --dataSize;
-
-                MidiFileHelpers::writeVariableLengthInt (out, (uint32) dataSize);
-            }
+        const MidiMessageSequence& ms = *tracks.getUnchecked (i);
+        writer.startTrack();
 
-            out.write (data, (size_t) dataSize);
-            lastStatusByte = statusByte;
-        }
-    }
+        for (int j = 0; j < ms.getNumEvents(); ++j)
+            writer.writeEvent (ms.getEventPointer (j)->message);
 
-    {
-        out.writeByte (0); // (tick delta)
-        const MidiMessage m (MidiMessage::endOfTrack());
-        out.write (m.getRawData(), (size_t) m.getRawDataSize());
+        writer.endTrack();
     }
 
-    mainOut.writeIntBigEndian ((int) ByteOrder::bigEndianInt ("MTrk"));
-    mainOut.writeIntBigEndian ((int) out.getDataSize());
-    mainOut << out;
+    return writer.finish();
 }
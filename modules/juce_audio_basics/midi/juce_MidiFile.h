@@ -175,7 +175,6 @@ private:
     short timeFormat;
 
     void readNextTrack (const uint8* data, int size);
-    void writeTrack (OutputStream& mainOut, int trackNum);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiFile)
 };
@@ -0,0 +1,483 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+namespace MidiFileReaderHelpers
+{
+    static bool readVariableLength (const uint8*& data, const uint8* const end, int& result) noexcept
+    {
+        int value = 0;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            if (data >= end)
+                return false;
+
+            const uint8 byte = *data++;
+            value = (value << 7) | (byte & 0x7f);
+
+            if ((byte & 0x80) == 0)
+            {
+                result = value;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static int writeVariableLength (uint8* dest, unsigned int value) noexcept
+    {
+        int numBytes = 1;
+
+        for (unsigned int v = value >> 7; v != 0; v >>= 7)
+            ++numBytes;
+
+        for (int i = numBytes; --i >= 0;)
+        {
+            dest[i] = (uint8) ((value & 0x7f) | (i < numBytes - 1 ? 0x80 : 0));
+            value >>= 7;
+        }
+
+        return numBytes;
+    }
+}
+
+//==============================================================================
+MidiFileReader::MidiFileReader (const void* fileData, const size_t fileDataSize)
+{
+    parseHeader (fileData, fileDataSize);
+}
+
+MidiFileReader::MidiFileReader (const File& file)
+    : mappedFile (new MemoryMappedFile (file, MemoryMappedFile::readOnly))
+{
+    parseHeader (mappedFile->getData(), mappedFile->getSize());
+}
+
+MidiFileReader::~MidiFileReader()
+{
+}
+
+void MidiFileReader::parseHeader (const void* const fileData, const size_t fileDataSize) noexcept
+{
+    fileStart = static_cast<const uint8*> (fileData);
+    fileEnd = fileStart + (fileData != nullptr ? fileDataSize : 0);
+    firstChunk = nullptr;
+    fileType = 0;
+    numTracks = 0;
+    timeFormat = 0;
+
+    const uint8* d = fileStart;
+
+    // skip over a RIFF wrapper, if there is one
+    if (fileEnd - d >= 12 && ByteOrder::bigEndianInt (d) == ByteOrder::bigEndianInt ("RIFF"))
+    {
+        for (int i = 0; i < 8 && fileEnd - d >= 4; ++i, d += 4)
+            if (ByteOrder::bigEndianInt (d) == ByteOrder::bigEndianInt ("MThd"))
+                break;
+    }
+
+    if (fileEnd - d < 14 || ByteOrder::bigEndianInt (d) != ByteOrder::bigEndianInt ("MThd"))
+        return;
+
+    const uint32 headerSize = ByteOrder::bigEndianInt (d + 4);
+
+    if (headerSize < 6 || (size_t) (fileEnd - d) < headerSize + 8)
+        return;
+
+    fileType = (int) ByteOrder::bigEndianShort (d + 8);
+    const int expectedTracks = (int) ByteOrder::bigEndianShort (d + 10);
+    timeFormat = (short) ByteOrder::bigEndianShort (d + 12);
+    firstChunk = d + 8 + headerSize;
+
+    for (const uint8* chunk = firstChunk; fileEnd - chunk >= 8 && numTracks < expectedTracks;)
+    {
+        const uint32 chunkSize = jmin ((uint32) (fileEnd - chunk - 8), ByteOrder::bigEndianInt (chunk + 4));
+
+        if (ByteOrder::bigEndianInt (chunk) == ByteOrder::bigEndianInt ("MTrk"))
+            ++numTracks;
+
+        chunk += 8 + chunkSize;
+    }
+}
+
+bool MidiFileReader::findTrack (int index, const uint8*& start, const uint8*& end) const noexcept
+{
+    if (isPositiveAndBelow (index, numTracks))
+    {
+        for (const uint8* chunk = firstChunk; fileEnd - chunk >= 8;)
+        {
+            const uint32 chunkSize = jmin ((uint32) (fileEnd - chunk - 8), ByteOrder::bigEndianInt (chunk + 4));
+
+            if (ByteOrder::bigEndianInt (chunk) == ByteOrder::bigEndianInt ("MTrk") && --index < 0)
+            {
+                start = chunk + 8;
+                end = start + chunkSize;
+                return true;
+            }
+
+            chunk += 8 + chunkSize;
+        }
+    }
+
+    return false;
+}
+
+//==============================================================================
+bool MidiFileReader::Event::isNoteOff() const noexcept
+{
+    return ((statusByte & 0xf0) == 0x80 && statusByte < 0xf0)
+            || ((statusByte & 0xf0) == 0x90 && dataSize > 1 && data[1] == 0);
+}
+
+MidiMessage MidiFileReader::Event::toMidiMessage() const
+{
+    const double time = (double) tick;
+
+    if (statusByte == 0xff)
+    {
+        HeapBlock<uint8> m ((size_t) dataSize + 6);
+        m[0] = 0xff;
+        m[1] = (uint8) metaEventType;
+        const int headerSize = 2 + MidiFileReaderHelpers::writeVariableLength (m + 2, (unsigned int) dataSize);
+        memcpy (m + headerSize, data, (size_t) dataSize);
+
+        return MidiMessage (m, headerSize + dataSize, time);
+    }
+
+    if (statusByte == 0xf0)
+    {
+        // the sysex data in a file normally includes the terminating 0xf7
+        const int size = (dataSize > 0 && data[dataSize - 1] == 0xf7) ? dataSize - 1 : dataSize;
+        return MidiMessage (MidiMessage::createSysExMessage (data, size), time);
+    }
+
+    if (statusByte == 0xf7)
+        return dataSize > 0 ? MidiMessage (data, dataSize, time) : MidiMessage();
+
+    uint8 m[3] = { statusByte, 0, 0 };
+    memcpy (m + 1, data, (size_t) jmin (2, dataSize));
+    return MidiMessage (m, dataSize + 1, time);
+}
+
+//==============================================================================
+MidiFileReader::TrackIterator::TrackIterator (const MidiFileReader& reader, const int trackIndex) noexcept
+    : trackStart (nullptr), trackEnd (nullptr)
+{
+    reader.findTrack (trackIndex, trackStart, trackEnd);
+    reset();
+}
+
+bool MidiFileReader::TrackIterator::setError() noexcept
+{
+    error = true;
+    position = trackEnd;
+    return false;
+}
+
+void MidiFileReader::TrackIterator::reset() noexcept
+{
+    position = trackStart;
+    currentTick = 0;
+    lastStatusByte = 0;
+    error = false;
+}
+
+bool MidiFileReader::TrackIterator::getNextEvent (Event& result) noexcept
+{
+    using namespace MidiFileReaderHelpers;
+
+    if (position >= trackEnd)
+        return false;
+
+    int delta;
+
+    if (! readVariableLength (position, trackEnd, delta) || position >= trackEnd)
+        return setError();
+
+    currentTick += delta;
+
+    uint8 status = *position;
+
+    // (like MidiFile, this keeps the running status across meta and sysex events)
+    if (status >= 0x80)
+        ++position;
+    else if (lastStatusByte != 0)
+        status = lastStatusByte;
+    else
+        return setError();
+
+    result.tick = currentTick;
+    result.statusByte = status;
+    result.metaEventType = -1;
+
+    if (status == 0xff)
+    {
+        if (position >= trackEnd)
+            return setError();
+
+        const int type = *position++;
+        int length;
+
+        if (! readVariableLength (position, trackEnd, length) || length > trackEnd - position)
+            return setError();
+
+        result.metaEventType = type;
+        result.data = position;
+        result.dataSize = length;
+        position += length;
+
+        if (type == 0x2f)
+        {
+            position = trackEnd;
+            return false;
+        }
+
+        return true;
+    }
+
+    if (status == 0xf0 || status == 0xf7)
+    {
+        int length;
+
+        if (! readVariableLength (position, trackEnd, length) || length > trackEnd - position)
+            return setError();
+
+        result.data = position;
+        result.dataSize = length;
+        position += length;
+        return true;
+    }
+
+    const int numDataBytes = MidiMessage::getMessageLengthFromFirstByte (status) - 1;
+
+    if (numDataBytes > trackEnd - position)
+        return setError();
+
+    result.data = position;
+    result.dataSize = numDataBytes;
+    position += numDataBytes;
+
+    if (status < 0xf0)
+        lastStatusByte = status;
+
+    return true;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MidiFileReaderTests  : public UnitTest
+{
+public:
+    MidiFileReaderTests() : UnitTest ("MidiFileReader and MidiFileWriter") {}
+
+    static bool messagesMatch (const MidiMessage& a, const MidiMessage& b)
+    {
+        return a.getTimeStamp() == b.getTimeStamp()
+                && a.getRawDataSize() == b.getRawDataSize()
+                && memcmp (a.getRawData(), b.getRawData(), (size_t) a.getRawDataSize()) == 0;
+    }
+
+    void runTest()
+    {
+        beginTest ("Reading");
+
+        const uint8 sysex[] = { 0x43, 0x12, 0x00, 0x07 };
+
+        MidiMessageSequence track1, track2;
+        track1.addEvent (MidiMessage::tempoMetaEvent (500000), 0);
+        track1.addEvent (MidiMessage::timeSignatureMetaEvent (3, 4), 0);
+        track2.addEvent (MidiMessage::noteOn (1, 60, (uint8) 100), 10);
+        track2.addEvent (MidiMessage::controllerEvent (1, 7, 90), 10);
+        track2.addEvent (MidiMessage::controllerEvent (1, 7, 80), 20);
+        track2.addEvent (MidiMessage::createSysExMessage (sysex, sizeof (sysex)), 30);
+        track2.addEvent (MidiMessage::noteOff (1, 60), 500);
+
+        MidiFile midiFile;
+        midiFile.setTicksPerQuarterNote (960);
+        midiFile.addTrack (track1);
+        midiFile.addTrack (track2);
+
+        MemoryOutputStream original;
+        expect (midiFile.writeTo (original));
+
+        MidiFileReader reader (original.getData(), original.getDataSize());
+        expect (reader.isValid());
+        expectEquals (reader.getFileType(), 1);
+        expectEquals (reader.getNumTracks(), 2);
+        expectEquals ((int) reader.getTimeFormat(), 960);
+
+        for (int i = 0; i < reader.getNumTracks(); ++i)
+        {
+            const MidiMessageSequence& expected = *midiFile.getTrack (i);
+            MidiFileReader::TrackIterator iter (reader, i);
+            MidiFileReader::Event e;
+            int numEvents = 0;
+
+            while (iter.getNextEvent (e))
+            {
+                expect (messagesMatch (e.toMidiMessage(), expected.getEventPointer (numEvents)->message));
+                ++numEvents;
+            }
+
+            expect (! iter.hasError());
+            expectEquals (numEvents, expected.getNumEvents());
+        }
+
+        beginTest ("Writing");
+
+        MemoryOutputStream copy;
+
+        {
+            MidiFileWriter writer (copy, reader.getTimeFormat());
+
+            for (int i = 0; i < reader.getNumTracks(); ++i)
+            {
+                MidiFileReader::TrackIterator iter (reader, i);
+                MidiFileReader::Event e;
+
+                writer.startTrack();
+
+                while (iter.getNextEvent (e))
+                    writer.writeEvent (e);
+
+                writer.endTrack();
+            }
+
+            expect (writer.finish());
+            expectEquals (writer.getNumTracksWritten(), 2);
+        }
+
+        expect (copy.getMemoryBlock() == original.getMemoryBlock());
+
+        beginTest ("Unsorted events");
+
+        {
+            // an event that goes back in time gets a delta of zero, like MidiFile has always written
+            MemoryOutputStream unsorted;
+
+            {
+                MidiFileWriter writer (unsorted, 960, 1, 0);
+                writer.startTrack();
+                writer.writeEvent (MidiMessage (MidiMessage::noteOn (1, 60, (uint8) 100), 100));
+                writer.writeEvent (MidiMessage (MidiMessage::noteOn (1, 62, (uint8) 100), 50));
+                writer.writeEvent (MidiMessage (MidiMessage::noteOff (1, 60), 150));
+                writer.endTrack();
+                expect (writer.finish());
+            }
+
+            MidiFileReader unsortedReader (unsorted.getData(), unsorted.getDataSize());
+            MidiFileReader::TrackIterator iter (unsortedReader, 0);
+            MidiFileReader::Event e;
+            int64 ticks[3] = { 0 };
+            int numEvents = 0;
+
+            while (numEvents < 3 && iter.getNextEvent (e))
+                ticks [numEvents++] = e.tick;
+
+            expectEquals (numEvents, 3);
+            expect (ticks[0] == 100 && ticks[1] == 100 && ticks[2] == 200);
+        }
+
+        beginTest ("Corrupt data");
+
+        MidiFileReader truncated (original.getData(), original.getDataSize() - 3);
+        expectEquals (truncated.getNumTracks(), 2);
+
+        {
+            MidiFileReader::TrackIterator iter (truncated, 1);
+            MidiFileReader::Event e;
+
+            while (iter.getNextEvent (e))
+            {}
+
+            expect (iter.hasError());
+        }
+
+        expect (! MidiFileReader (sysex, sizeof (sysex)).isValid());
+
+        beginTest ("Throughput");
+
+        Random r;
+        MemoryOutputStream big;
+
+        {
+            MidiFileWriter writer (big, 960, 16);
+
+            for (int track = 0; track < 16; ++track)
+            {
+                writer.startTrack();
+
+                for (int i = 0; i < 10000; ++i)
+                {
+                    const int note = r.nextInt (128);
+                    writer.writeEvent (MidiMessage (MidiMessage::noteOn (1 + track, note, (uint8) 100), i * 10));
+                    writer.writeEvent (MidiMessage (MidiMessage::noteOff (1 + track, note), i * 10 + 5));
+                }
+
+                writer.endTrack();
+            }
+        }
+
+        const double megabytes = big.getDataSize() / (1024.0 * 1024.0);
+        int64 startTicks = Time::getHighResolutionTicks();
+
+        MidiFile loaded;
+        MemoryInputStream in (big.getData(), big.getDataSize(), false);
+        expect (loaded.readFrom (in));
+
+        int numLoaded = 0;
+        for (int i = 0; i < loaded.getNumTracks(); ++i)
+            numLoaded += loaded.getTrack (i)->getNumEvents();
+
+        const double midiFileSeconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+        startTicks = Time::getHighResolutionTicks();
+
+        MidiFileReader bigReader (big.getData(), big.getDataSize());
+        int numRead = 0;
+
+        for (int i = 0; i < bigReader.getNumTracks(); ++i)
+        {
+            MidiFileReader::TrackIterator iter (bigReader, i);
+            MidiFileReader::Event e;
+
+            while (iter.getNextEvent (e))
+                ++numRead;
+        }
+
+        const double readerSeconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+
+        expectEquals (numRead, 16 * 20000);
+        expectEquals (numLoaded, numRead + loaded.getNumTracks()); // (MidiFile keeps the end-of-track events)
+
+        logMessage ("MidiFile::readFrom: " + String (megabytes / jmax (1.0e-9, midiFileSeconds), 1)
+                     + " MB/sec, MidiFileReader: " + String (megabytes / jmax (1.0e-9, readerSeconds), 1) + " MB/sec");
+    }
+};
+
+static MidiFileReaderTests midiFileReaderTests;
+
+#endif
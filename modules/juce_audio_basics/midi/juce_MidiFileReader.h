@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_MIDIFILEREADER_H_INCLUDED
+#define JUCE_MIDIFILEREADER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Reads the events from a standard midi file, one at a time, without loading
+    the whole file into MidiMessageSequence objects.
+
+    The reader works directly on a block of memory containing the file, or on a
+    memory-mapped copy of a file on disk. Opening a file only parses its header; each
+    track is decoded lazily by a TrackIterator as you ask for its events, and the events
+    that are returned point straight into the file's data, so reading a file doesn't
+    allocate any memory for the events.
+
+    This is intended for jobs that need to scan through large numbers of files. If you
+    want to edit the contents of a file, the MidiFile class is more convenient.
+
+    E.g.
+    @code
+    MidiFileReader reader (myFile);
+
+    for (int i = 0; i < reader.getNumTracks(); ++i)
+    {
+        MidiFileReader::TrackIterator iter (reader, i);
+        MidiFileReader::Event e;
+
+        while (iter.getNextEvent (e))
+            if (e.isNoteOn())
+                ++numNotes;
+    }
+    @endcode
+
+    @see MidiFile, MidiFileWriter
+*/
+class JUCE_API  MidiFileReader
+{
+public:
+    //==============================================================================
+    /** Creates a reader for a midi file that's held in memory.
+        The data isn't copied, so it must remain valid for as long as the reader, and any
+        events that have been read from it, are in use.
+    */
+    MidiFileReader (const void* fileData, size_t fileDataSize);
+
+    /** Creates a reader that memory-maps a midi file on disk.
+        If the file can't be opened, isValid() will return false.
+    */
+    explicit MidiFileReader (const File& file);
+
+    /** Destructor. */
+    ~MidiFileReader();
+
+    //==============================================================================
+    /** Returns true if the data has a valid midi file header. */
+    bool isValid() const noexcept                       { return firstChunk != nullptr; }
+
+    /** Returns the file type from the header - 0, 1 or 2. */
+    int getFileType() const noexcept                    { return fileType; }
+
+    /** Returns the raw time format code from the file's header.
+        @see MidiFile::getTimeFormat
+    */
+    short getTimeFormat() const noexcept                { return timeFormat; }
+
+    /** Returns the number of tracks that are actually present in the file. */
+    int getNumTracks() const noexcept                   { return numTracks; }
+
+    //==============================================================================
+    /** A single event that has been read from a midi file.
+
+        The data pointer refers directly to the file's contents, so it's only valid for
+        as long as the MidiFileReader that produced it.
+    */
+    struct JUCE_API  Event
+    {
+        /** The event's position in midi ticks from the start of the track. */
+        int64 tick;
+
+        /** The status byte, with any running status filled in. This is 0xff for
+            meta-events, and 0xf0 or 0xf7 for sysex data.
+        */
+        uint8 statusByte;
+
+        /** For meta-events, this is the meta-event type, otherwise it's -1. */
+        int metaEventType;
+
+        /** The bytes that follow the status byte. For meta-events and sysex data, this
+            is the payload after the type and length bytes.
+        */
+        const uint8* data;
+
+        /** The number of bytes in data. */
+        int dataSize;
+
+        /** Returns true if this is a meta-event. */
+        bool isMetaEvent() const noexcept               { return statusByte == 0xff; }
+
+        /** Returns true if this is sysex data. */
+        bool isSysEx() const noexcept                   { return statusByte == 0xf0 || statusByte == 0xf7; }
+
+        /** Returns the midi channel 1 to 16, or 0 if this isn't a channel message. */
+        int getChannel() const noexcept                 { return statusByte < 0xf0 ? (statusByte & 0xf) + 1 : 0; }
+
+        /** Returns true if this is a note-on with a non-zero velocity. */
+        bool isNoteOn() const noexcept                  { return (statusByte & 0xf0) == 0x90 && dataSize > 1 && data[1] != 0; }
+
+        /** Returns true if this is a note-off, or a note-on with zero velocity. */
+        bool isNoteOff() const noexcept;
+
+        /** Creates a MidiMessage from this event, using the tick as its timestamp. */
+        MidiMessage toMidiMessage() const;
+    };
+
+    //==============================================================================
+    /**
+        Reads through the events in one of the tracks of a MidiFileReader.
+
+        Events are returned in the order in which they appear in the file. The end-of-track
+        meta-event isn't returned.
+    */
+    class JUCE_API  TrackIterator
+    {
+    public:
+        /** Creates an iterator for one of the reader's tracks.
+            If the track index is out of range, the iterator will have no events.
+        */
+        TrackIterator (const MidiFileReader& reader, int trackIndex) noexcept;
+
+        /** Reads the next event.
+            @returns false if there are no more events, or if the track data is corrupt
+        */
+        bool getNextEvent (Event& result) noexcept;
+
+        /** Returns true if the iterator stopped because the track's data was malformed. */
+        bool hasError() const noexcept                  { return error; }
+
+        /** Moves the iterator back to the start of the track. */
+        void reset() noexcept;
+
+    private:
+        const uint8* trackStart;
+        const uint8* trackEnd;
+        const uint8* position;
+        int64 currentTick;
+        uint8 lastStatusByte;
+        bool error;
+
+        bool setError() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (TrackIterator)
+    };
+
+private:
+    //==============================================================================
+    ScopedPointer<MemoryMappedFile> mappedFile;
+    const uint8* fileStart;
+    const uint8* fileEnd;
+    const uint8* firstChunk;
+    int fileType, numTracks;
+    short timeFormat;
+
+    void parseHeader (const void*, size_t) noexcept;
+    bool findTrack (int index, const uint8*& start, const uint8*& end) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiFileReader)
+};
+
+
+#endif   // JUCE_MIDIFILEREADER_H_INCLUDED
@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+MidiFileWriter::MidiFileWriter (OutputStream& destStream, const short timeFormat,
+                                const int numTracks, const int fileType)
+    : out (destStream),
+      headerPosition (destStream.getPosition()),
+      lastTick (0),
+      numTracksExpected (numTracks),
+      numTracksWritten (0),
+      lastStatusByte (0),
+      trackInProgress (false),
+      isFinished (false)
+{
+    out.writeIntBigEndian ((int) ByteOrder::bigEndianInt ("MThd"));
+    out.writeIntBigEndian (6);
+    out.writeShortBigEndian ((short) fileType);
+    out.writeShortBigEndian ((short) jmax (0, numTracks));
+    out.writeShortBigEndian (timeFormat);
+}
+
+MidiFileWriter::~MidiFileWriter()
+{
+    finish();
+}
+
+//==============================================================================
+void MidiFileWriter::startTrack()
+{
+    jassert (! isFinished);
+
+    if (trackInProgress)
+        endTrack();
+
+    trackData.reset();
+    lastTick = 0;
+    lastStatusByte = 0;
+    trackInProgress = true;
+}
+
+void MidiFileWriter::endTrack()
+{
+    if (trackInProgress)
+    {
+        trackData.writeByte (0); // (tick delta)
+        const MidiMessage m (MidiMessage::endOfTrack());
+        trackData.write (m.getRawData(), (size_t) m.getRawDataSize());
+
+        out.writeIntBigEndian ((int) ByteOrder::bigEndianInt ("MTrk"));
+        out.writeIntBigEndian ((int) trackData.getDataSize());
+        out.write (trackData.getData(), trackData.getDataSize());
+
+        trackInProgress = false;
+        ++numTracksWritten;
+    }
+}
+
+bool MidiFileWriter::finish()
+{
+    if (isFinished)
+        return true;
+
+    endTrack();
+    isFinished = true;
+    bool ok = true;
+
+    if (numTracksExpected < 0)
+    {
+        const int64 endPosition = out.getPosition();
+
+        ok = out.setPosition (headerPosition + 10);
+
+        if (ok)
+        {
+            out.writeShortBigEndian ((short) numTracksWritten);
+            ok = out.setPosition (endPosition);
+        }
+
+        // If you don't know the number of tracks in advance, you need to write
+        // to a stream that can go back and fill in the header!
+        jassert (ok);
+    }
+    else
+    {
+        // The number of tracks written didn't match the number given to the constructor.
+        jassert (numTracksWritten == numTracksExpected);
+    }
+
+    out.flush();
+    return ok;
+}
+
+//==============================================================================
+void MidiFileWriter::writeEvent (const int64 tick, const uint8* const midiData, const int numBytes)
+{
+    jassert (midiData != nullptr && numBytes > 0);
+
+    const uint8 statusByte = midiData[0];
+
+    if (statusByte == 0xff && numBytes > 2)
+    {
+        int lengthBytes;
+        const int length = MidiMessage::readVariableLengthVal (midiData + 2, lengthBytes);
+        const int headerSize = 2 + lengthBytes;
+
+        writeEventData (tick, statusByte, midiData[1],
+                        midiData + headerSize, jmin (length, numBytes - headerSize));
+    }
+    else
+    {
+        writeEventData (tick, statusByte, -1, midiData + 1, numBytes - 1);
+    }
+}
+
+void MidiFileWriter::writeEvent (const MidiMessage& message)
+{
+    writeEvent (roundToInt (message.getTimeStamp()), message.getRawData(), message.getRawDataSize());
+}
+
+void MidiFileWriter::writeEvent (const MidiFileReader::Event& event)
+{
+    writeEventData (event.tick, event.statusByte, event.metaEventType, event.data, event.dataSize);
+}
+
+void MidiFileWriter::writeEventData (const int64 tick, const uint8 statusByte, const int metaEventType,
+                                     const uint8* const data, const int dataSize)
+{
+    // You need to call startTrack() before writing any events!
+    jassert (trackInProgress);
+
+    if (! trackInProgress)
+        startTrack();
+
+    if (statusByte == 0xff && metaEventType == 0x2f)
+        return;
+
+    // An event that's earlier than the previous one (e.g. from a track that was never
+    // sorted) is given a delta of zero, just as MidiFile has always written them.
+    writeVariableLength ((unsigned int) jmax ((int64) 0, tick - lastTick));
+    lastTick = tick;
+
+    if (statusByte == 0xff)
+    {
+        trackData.writeByte ((char) statusByte);
+        trackData.writeByte ((char) metaEventType);
+        writeVariableLength ((unsigned int) dataSize);
+    }
+    else if (statusByte == 0xf0 || statusByte == 0xf7)
+    {
+        trackData.writeByte ((char) statusByte);
+        writeVariableLength ((unsigned int) dataSize);
+    }
+    else if (statusByte != lastStatusByte
+              || (statusByte & 0xf0) == 0xf0
+              || dataSize == 0)
+    {
+        trackData.writeByte ((char) statusByte);
+    }
+
+    trackData.write (data, (size_t) dataSize);
+    lastStatusByte = statusByte;
+}
+
+void MidiFileWriter::writeVariableLength (unsigned int v)
+{
+    unsigned int buffer = v & 0x7f;
+
+    while ((v >>= 7) != 0)
+    {
+        buffer <<= 8;
+        buffer |= ((v & 0x7f) | 0x80);
+    }
+
+    for (;;)
+    {
+        trackData.writeByte ((char) buffer);
+
+        if (buffer & 0x80)
+            buffer >>= 8;
+        else
+            break;
+    }
+}
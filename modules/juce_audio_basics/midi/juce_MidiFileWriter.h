@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_MIDIFILEWRITER_H_INCLUDED
+#define JUCE_MIDIFILEWRITER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Writes a standard midi file to a stream, one event at a time.
+
+    Unlike MidiFile::writeTo(), this doesn't need the tracks to be built as
+    MidiMessageSequence objects first - you just start a track, write its events
+    in time order, and end it. (An event that's earlier than the one before it is
+    written with a delta-time of zero.) Each track's data is collected in an internal buffer
+    which is re-used for the next track, so once that buffer has grown to the size
+    of the largest track, writing doesn't allocate any memory.
+
+    E.g.
+    @code
+    MidiFileWriter writer (stream, 960, 1);
+
+    writer.startTrack();
+    writer.writeEvent (MidiMessage (MidiMessage::noteOn (1, 60, (uint8) 100), 0));
+    writer.writeEvent (MidiMessage (MidiMessage::noteOff (1, 60), 960));
+    writer.endTrack();
+
+    writer.finish();
+    @endcode
+
+    @see MidiFile, MidiFileReader
+*/
+class JUCE_API  MidiFileWriter
+{
+public:
+    //==============================================================================
+    /** Creates a writer and writes the file header to the stream.
+
+        @param destStream   the stream to write to - this must stay valid for the lifetime
+                            of the writer
+        @param timeFormat   the time format code for the header - see MidiFile::getTimeFormat()
+        @param numTracks    the number of tracks that will be written. If this is less than 0,
+                            the header is filled-in by finish(), which needs a stream that
+                            supports setPosition()
+        @param fileType     the midi file type, normally 1
+    */
+    MidiFileWriter (OutputStream& destStream, short timeFormat,
+                    int numTracks = -1, int fileType = 1);
+
+    /** Destructor.
+        If finish() hasn't been called yet, this will call it.
+    */
+    ~MidiFileWriter();
+
+    //==============================================================================
+    /** Begins a new track.
+        If a track is already in progress, it will be ended first.
+    */
+    void startTrack();
+
+    /** Writes an event to the current track.
+
+        The data should be a complete midi message in the same format as
+        MidiMessage::getRawData(). Ticks must not go backwards within a track.
+        End-of-track meta-events are ignored, because endTrack() adds one.
+    */
+    void writeEvent (int64 tick, const uint8* midiData, int numBytes);
+
+    /** Writes a MidiMessage to the current track, using its timestamp as the tick. */
+    void writeEvent (const MidiMessage& message);
+
+    /** Writes an event that was read by a MidiFileReader to the current track. */
+    void writeEvent (const MidiFileReader::Event& event);
+
+    /** Finishes the current track and writes it to the stream. */
+    void endTrack();
+
+    /** Ends any track that's in progress and flushes the stream.
+        @returns false if the header couldn't be completed
+    */
+    bool finish();
+
+    /** Returns the number of tracks that have been written so far. */
+    int getNumTracksWritten() const noexcept                { return numTracksWritten; }
+
+private:
+    //==============================================================================
+    OutputStream& out;
+    MemoryOutputStream trackData;
+    int64 headerPosition, lastTick;
+    int numTracksExpected, numTracksWritten;
+    uint8 lastStatusByte;
+    bool trackInProgress, isFinished;
+
+    void writeEventData (int64 tick, uint8 statusByte, int metaEventType, const uint8* data, int dataSize);
+    void writeVariableLength (unsigned int value);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiFileWriter)
+};
+
+
+#endif   // JUCE_MIDIFILEWRITER_H_INCLUDED
@@ -77,26 +77,66 @@ double MidiMessageSequence::getTimeOfMatchingKeyUp (const int index) const
 int MidiMessageSequence::getIndexOfMatchingKeyUp (const int index) const
 {
     if (const MidiEventHolder* const meh = list [index])
-        return list.indexOf (meh->noteOffObject);
+        return getIndexOf (meh->noteOffObject);
 
     return -1;
 }
 
 int MidiMessageSequence::getIndexOf (MidiEventHolder* const event) const
 {
+    if (event == nullptr)
+        return -1;
+
+    // the list is sorted, so we only need to look among the events that share its time..
+    const double time = event->message.getTimeStamp();
+
+    for (int i = getNextIndexAtTime (time); i < list.size(); ++i)
+    {
+        const MidiEventHolder* const meh = list.getUnchecked(i);
+
+        if (meh == event)
+            return i;
+
+        if (meh->message.getTimeStamp() != time)
+            break;
+    }
+
+    // ..unless its timestamp has been changed without the sequence being re-sorted
     return list.indexOf (event);
 }
 
 int MidiMessageSequence::getNextIndexAtTime (const double timeStamp) const
 {
-    const int numEvents = list.size();
+    int start = 0, end = list.size();
 
-    int i;
-    for (i = 0; i < numEvents; ++i)
-        if (list.getUnchecked(i)->message.getTimeStamp() >= timeStamp)
-            break;
+    while (start < end)
+    {
+        const int mid = (start + end) / 2;
+
+        if (list.getUnchecked (mid)->message.getTimeStamp() < timeStamp)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start;
+}
+
+int MidiMessageSequence::getIndexAfterTime (const double timeStamp) const
+{
+    int start = 0, end = list.size();
+
+    while (start < end)
+    {
+        const int mid = (start + end) / 2;
 
-    return i;
+        if (list.getUnchecked (mid)->message.getTimeStamp() <= timeStamp)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start;
 }
 
 //==============================================================================
@@ -127,12 +167,7 @@ MidiMessageSequence::MidiEventHolder* MidiMessageSequence::addEvent (const MidiM
     timeAdjustment += newMessage.getTimeStamp();
     newOne->message.setTimeStamp (timeAdjustment);
 
-    int i;
-    for (i = list.size(); --i >= 0;)
-        if (list.getUnchecked(i)->message.getTimeStamp() <= timeAdjustment)
-            break;
-
-    list.insert (i + 1, newOne);
+    list.insert (getIndexAfterTime (timeAdjustment), newOne);
     return newOne;
 }
 
@@ -192,40 +227,60 @@ void MidiMessageSequence::sort()
 
 void MidiMessageSequence::updateMatchedPairs()
 {
+    // This makes a single pass, keeping track of the note-on that's still waiting for its
+    // note-off on each channel and note. If another note-on for the same note arrives first,
+    // a note-off is inserted just before it.
+    HeapBlock<MidiEventHolder*> waitingNoteOns (16 * 128, true);
+    Array<MidiEventHolder*> newList;
+    bool needsNewList = false;
+
     for (int i = 0; i < list.size(); ++i)
     {
         MidiEventHolder* const meh = list.getUnchecked(i);
-        const MidiMessage& m1 = meh->message;
+        const MidiMessage& m = meh->message;
 
-        if (m1.isNoteOn())
+        if (m.isNoteOnOrOff())
         {
-            meh->noteOffObject = nullptr;
-            const int note = m1.getNoteNumber();
-            const int chan = m1.getChannel();
-            const int len = list.size();
+            MidiEventHolder*& waiting = waitingNoteOns [(m.getChannel() - 1) * 128 + m.getNoteNumber()];
 
-            for (int j = i + 1; j < len; ++j)
+            if (m.isNoteOn())
             {
-                const MidiMessage& m = list.getUnchecked(j)->message;
-
-                if (m.getNoteNumber() == note && m.getChannel() == chan)
+                if (waiting != nullptr)
                 {
-                    if (m.isNoteOff())
-                    {
-                        meh->noteOffObject = list[j];
-                        break;
-                    }
-                    else if (m.isNoteOn())
+                    if (! needsNewList)
                     {
-                        MidiEventHolder* const newEvent = new MidiEventHolder (MidiMessage::noteOff (chan, note));
-                        list.insert (j, newEvent);
-                        newEvent->message.setTimeStamp (m.getTimeStamp());
-                        meh->noteOffObject = newEvent;
-                        break;
+                        newList.ensureStorageAllocated (list.size() + 16);
+
+                        for (int j = 0; j < i; ++j)
+                            newList.add (list.getUnchecked (j));
+
+                        needsNewList = true;
                     }
+
+                    MidiEventHolder* const newEvent = new MidiEventHolder (MidiMessage::noteOff (m.getChannel(), m.getNoteNumber()));
+                    newEvent->message.setTimeStamp (m.getTimeStamp());
+                    waiting->noteOffObject = newEvent;
+                    newList.add (newEvent);
                 }
+
+                meh->noteOffObject = nullptr;
+                waiting = meh;
+            }
+            else if (waiting != nullptr)
+            {
+                waiting->noteOffObject = meh;
+                waiting = nullptr;
             }
         }
+
+        if (needsNewList)
+            newList.add (meh);
+    }
+
+    if (needsNewList)
+    {
+        list.clear (false);
+        list.addArray (newList);
     }
 }
 
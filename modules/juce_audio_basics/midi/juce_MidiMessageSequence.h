@@ -123,6 +123,11 @@ public:
     */
     int getNextIndexAtTime (double timeStamp) const;
 
+    /** Returns the index of the first event whose timestamp is later than the given time.
+        If there's no such event, this will return the number of events.
+    */
+    int getIndexAfterTime (double timeStamp) const;
+
     //==============================================================================
     /** Returns the timestamp of the first event in the sequence.
 
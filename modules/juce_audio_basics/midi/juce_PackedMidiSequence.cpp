@@ -0,0 +1,295 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+PackedMidiSequence::PackedMidiSequence() noexcept
+    : numEvents (0), eventCapacity (0), dataCapacity (0)
+{
+}
+
+PackedMidiSequence::PackedMidiSequence (const MidiMessageSequence& sequence)
+    : numEvents (0), eventCapacity (0), dataCapacity (0)
+{
+    loadFrom (sequence);
+}
+
+PackedMidiSequence::~PackedMidiSequence()
+{
+}
+
+//==============================================================================
+void PackedMidiSequence::loadFrom (const MidiMessageSequence& sequence)
+{
+    const int num = sequence.getNumEvents();
+    size_t totalBytes = 0;
+
+    for (int i = 0; i < num; ++i)
+        totalBytes += (size_t) sequence.getEventPointer (i)->message.getRawDataSize();
+
+    if (num > eventCapacity)
+    {
+        eventCapacity = num;
+        times.malloc ((size_t) eventCapacity);
+        noteOffIndexes.malloc ((size_t) eventCapacity);
+        dataOffsets.malloc ((size_t) eventCapacity + 1);
+    }
+    else if (dataOffsets == nullptr)
+    {
+        dataOffsets.malloc (1);
+    }
+
+    if (totalBytes > dataCapacity)
+    {
+        dataCapacity = totalBytes;
+        data.malloc (dataCapacity);
+    }
+
+    int offset = 0;
+
+    for (int i = 0; i < num; ++i)
+    {
+        const MidiMessageSequence::MidiEventHolder* const e = sequence.getEventPointer (i);
+        const int size = e->message.getRawDataSize();
+
+        times[i] = e->message.getTimeStamp();
+        dataOffsets[i] = offset;
+        noteOffIndexes[i] = e->noteOffObject != nullptr ? sequence.getIndexOf (e->noteOffObject) : -1;
+
+        memcpy (data + offset, e->message.getRawData(), (size_t) size);
+        offset += size;
+    }
+
+    dataOffsets[num] = offset;
+    numEvents = num;
+}
+
+void PackedMidiSequence::clear() noexcept
+{
+    numEvents = 0;
+}
+
+//==============================================================================
+double PackedMidiSequence::getEventTime (const int index) const noexcept
+{
+    jassert (isPositiveAndBelow (index, numEvents));
+    return times[index];
+}
+
+const uint8* PackedMidiSequence::getEventData (const int index) const noexcept
+{
+    jassert (isPositiveAndBelow (index, numEvents));
+    return data + dataOffsets[index];
+}
+
+int PackedMidiSequence::getEventDataSize (const int index) const noexcept
+{
+    jassert (isPositiveAndBelow (index, numEvents));
+    return dataOffsets[index + 1] - dataOffsets[index];
+}
+
+MidiMessage PackedMidiSequence::getEventAsMessage (const int index) const
+{
+    return MidiMessage (getEventData (index), getEventDataSize (index), getEventTime (index));
+}
+
+int PackedMidiSequence::getIndexOfMatchingNoteOff (const int index) const noexcept
+{
+    jassert (isPositiveAndBelow (index, numEvents));
+    return noteOffIndexes[index];
+}
+
+double PackedMidiSequence::getStartTime() const noexcept
+{
+    return numEvents > 0 ? times[0] : 0.0;
+}
+
+double PackedMidiSequence::getEndTime() const noexcept
+{
+    return numEvents > 0 ? times[numEvents - 1] : 0.0;
+}
+
+int PackedMidiSequence::getNextIndexAtTime (const double timeStamp) const noexcept
+{
+    int start = 0, end = numEvents;
+
+    while (start < end)
+    {
+        const int mid = (start + end) >> 1;
+
+        if (times[mid] < timeStamp)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start;
+}
+
+//==============================================================================
+PackedMidiSequence::Iterator::Iterator (const PackedMidiSequence& s) noexcept
+    : sequence (s), nextIndex (0)
+{
+}
+
+void PackedMidiSequence::Iterator::setTime (const double time) noexcept
+{
+    nextIndex = sequence.getNextIndexAtTime (time);
+}
+
+bool PackedMidiSequence::Iterator::getNextEvent (const double endTime, const uint8*& midiData,
+                                                 int& numBytes, double& time) noexcept
+{
+    if (nextIndex >= sequence.numEvents || sequence.times[nextIndex] >= endTime)
+        return false;
+
+    time = sequence.times[nextIndex];
+    midiData = sequence.data + sequence.dataOffsets[nextIndex];
+    numBytes = sequence.dataOffsets[nextIndex + 1] - sequence.dataOffsets[nextIndex];
+    ++nextIndex;
+    return true;
+}
+
+int PackedMidiSequence::Iterator::addEventsToBuffer (MidiBuffer& buffer, const double blockStartTime,
+                                                     const double endTime, const double samplesPerTimeUnit) noexcept
+{
+    const uint8* midiData;
+    int numBytes, numAdded = 0;
+    double time;
+
+    while (getNextEvent (endTime, midiData, numBytes, time))
+    {
+        buffer.addEvent (midiData, numBytes, jmax (0, roundToInt ((time - blockStartTime) * samplesPerTimeUnit)));
+        ++numAdded;
+    }
+
+    return numAdded;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PackedMidiSequenceTests  : public UnitTest
+{
+public:
+    PackedMidiSequenceTests() : UnitTest ("PackedMidiSequence") {}
+
+    void runTest()
+    {
+        beginTest ("Basics");
+
+        MidiMessageSequence seq;
+        seq.addEvent (MidiMessage::noteOn (1, 60, 0.5f), 10.0);
+        seq.addEvent (MidiMessage::noteOff (1, 60), 20.0);
+        seq.addEvent (MidiMessage::controllerEvent (1, 7, 100), 15.0);
+        seq.addEvent (MidiMessage::noteOn (2, 64, 0.5f), 20.0);
+        seq.addEvent (MidiMessage::noteOff (2, 64), 30.0);
+        seq.updateMatchedPairs();
+
+        PackedMidiSequence packed (seq);
+        expectEquals (packed.getNumEvents(), 5);
+        expectEquals (packed.getStartTime(), 10.0);
+        expectEquals (packed.getEndTime(), 30.0);
+
+        for (int i = 0; i < seq.getNumEvents(); ++i)
+        {
+            const MidiMessage& m = seq.getEventPointer (i)->message;
+            expectEquals (packed.getEventTime (i), m.getTimeStamp());
+            expectEquals (packed.getEventDataSize (i), m.getRawDataSize());
+            expect (memcmp (packed.getEventData (i), m.getRawData(), (size_t) m.getRawDataSize()) == 0);
+            expectEquals (packed.getIndexOfMatchingNoteOff (i), seq.getIndexOfMatchingKeyUp (i));
+        }
+
+        expectEquals (packed.getNextIndexAtTime (0.0), 0);
+        expectEquals (packed.getNextIndexAtTime (15.0), 1);
+        expectEquals (packed.getNextIndexAtTime (16.0), 2);
+        expectEquals (packed.getNextIndexAtTime (31.0), 5);
+
+        beginTest ("Iterator");
+
+        MidiBuffer buffer;
+        PackedMidiSequence::Iterator iter (packed);
+        iter.setTime (12.0);
+        expectEquals (iter.addEventsToBuffer (buffer, 12.0, 22.0, 2.0), 3);
+        expectEquals (buffer.getNumEvents(), 3);
+        expectEquals (buffer.getFirstEventTime(), 6);
+        expectEquals (buffer.getLastEventTime(), 16);
+        expectEquals (iter.addEventsToBuffer (buffer, 22.0, 32.0, 2.0), 1);
+        expectEquals (iter.getNextIndex(), 5);
+
+        beginTest ("Large sequences");
+
+        Random r;
+        MidiMessageSequence big;
+        const int numNotes = 100000;
+
+        for (int i = 0; i < numNotes; ++i)
+        {
+            const double t = r.nextInt (1000000);
+            const int note = r.nextInt (128);
+            big.addEvent (MidiMessage::noteOn (1 + (i & 15), note, 0.5f), t);
+            big.addEvent (MidiMessage::noteOff (1 + (i & 15), note), t + 1 + r.nextInt (100));
+        }
+
+        big.updateMatchedPairs();
+
+        const int64 startTicks = Time::getHighResolutionTicks();
+        PackedMidiSequence packedBig (big);
+
+        const int64 loadTicks = Time::getHighResolutionTicks();
+        PackedMidiSequence::Iterator bigIter (packedBig);
+        const uint8* midiData;
+        int numBytes, numRead = 0;
+        double time, lastTime = 0;
+        bool inOrder = true;
+
+        while (bigIter.getNextEvent (2000000.0, midiData, numBytes, time))
+        {
+            inOrder = inOrder && time >= lastTime;
+            lastTime = time;
+            ++numRead;
+        }
+
+        const int64 endTicks = Time::getHighResolutionTicks();
+
+        expect (inOrder);
+        expectEquals (numRead, big.getNumEvents());
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            const int index = r.nextInt (packedBig.getNumEvents());
+            expectEquals (packedBig.getIndexOfMatchingNoteOff (index), big.getIndexOfMatchingKeyUp (index));
+            expectEquals (packedBig.getNextIndexAtTime (packedBig.getEventTime (index)),
+                          big.getNextIndexAtTime (big.getEventTime (index)));
+        }
+
+        logMessage ("Packed " + String (numRead) + " events in "
+                     + String (Time::highResolutionTicksToSeconds (loadTicks - startTicks) * 1000.0, 2)
+                     + "ms, read in "
+                     + String (Time::highResolutionTicksToSeconds (endTicks - loadTicks) * 1000.0, 2) + "ms");
+    }
+};
+
+static PackedMidiSequenceTests packedMidiSequenceTests;
+
+#endif
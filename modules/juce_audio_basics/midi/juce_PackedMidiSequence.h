@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_PACKEDMIDISEQUENCE_H_INCLUDED
+#define JUCE_PACKEDMIDISEQUENCE_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A read-only copy of a MidiMessageSequence, laid out for fast playback.
+
+    A MidiMessageSequence keeps each event in its own heap-allocated object, which is
+    convenient for editing, but means that reading through a large sequence jumps
+    all over memory. A PackedMidiSequence instead holds the timestamps, the raw
+    midi data and the note-off indexes in separate contiguous arrays, so time
+    lookups are binary searches over a single array of doubles, and playback
+    reads memory in order.
+
+    Once it has been loaded, a PackedMidiSequence::Iterator can read from it on the
+    audio thread without allocating or locking. To change the events, edit the original
+    MidiMessageSequence and call loadFrom() again; this only reallocates if the
+    sequence has grown beyond its previous size.
+
+    @see MidiMessageSequence
+*/
+class JUCE_API  PackedMidiSequence
+{
+public:
+    //==============================================================================
+    /** Creates an empty sequence. */
+    PackedMidiSequence() noexcept;
+
+    /** Creates a packed copy of a MidiMessageSequence. */
+    explicit PackedMidiSequence (const MidiMessageSequence& sequence);
+
+    /** Destructor. */
+    ~PackedMidiSequence();
+
+    //==============================================================================
+    /** Replaces the contents of this object with a copy of the given sequence.
+        The note-off indexes are taken from the sequence's MidiEventHolder::noteOffObject
+        pointers, so call MidiMessageSequence::updateMatchedPairs() first if they need to be
+        up to date.
+    */
+    void loadFrom (const MidiMessageSequence& sequence);
+
+    /** Removes all the events, without releasing any memory. */
+    void clear() noexcept;
+
+    //==============================================================================
+    /** Returns the number of events in the sequence. */
+    int getNumEvents() const noexcept                           { return numEvents; }
+
+    /** Returns the timestamp of one of the events. */
+    double getEventTime (int index) const noexcept;
+
+    /** Returns a pointer to the raw midi data for one of the events. */
+    const uint8* getEventData (int index) const noexcept;
+
+    /** Returns the number of bytes of raw midi data in one of the events. */
+    int getEventDataSize (int index) const noexcept;
+
+    /** Creates a MidiMessage from one of the events. */
+    MidiMessage getEventAsMessage (int index) const;
+
+    /** Returns the index of the note-off that matches the note-on at this index, or -1
+        if the event isn't a note-on or has no matching note-off.
+    */
+    int getIndexOfMatchingNoteOff (int index) const noexcept;
+
+    /** Returns the timestamp of the first event, or 0 if the sequence is empty. */
+    double getStartTime() const noexcept;
+
+    /** Returns the timestamp of the last event, or 0 if the sequence is empty. */
+    double getEndTime() const noexcept;
+
+    /** Returns the index of the first event on or after the given timestamp.
+        If the time is beyond the end of the sequence, this will return the number of events.
+    */
+    int getNextIndexAtTime (double timeStamp) const noexcept;
+
+    //==============================================================================
+    /**
+        Reads through a PackedMidiSequence in time order.
+
+        An iterator doesn't allocate any memory, so it can be used on the audio thread,
+        as long as the sequence isn't reloaded while it's being read.
+    */
+    class JUCE_API  Iterator
+    {
+    public:
+        /** Creates an iterator that starts at the beginning of a sequence. */
+        explicit Iterator (const PackedMidiSequence& sequence) noexcept;
+
+        /** Moves the iterator so that the next event it returns will be the first
+            one whose time is at or after the given time.
+        */
+        void setTime (double time) noexcept;
+
+        /** Returns the index of the next event that will be returned. */
+        int getNextIndex() const noexcept                       { return nextIndex; }
+
+        /** Retrieves the next event, if its time is earlier than the given end time.
+
+            @param endTime          only events whose time is less than this will be returned
+            @param midiData         on return, points to the event's raw midi data, which stays
+                                    valid until the sequence is changed
+            @param numBytes         on return, the number of bytes of midi data
+            @param time             on return, the event's timestamp
+            @returns                true if an event was found, or false if there are no more
+                                    events before the end time
+        */
+        bool getNextEvent (double endTime, const uint8*& midiData, int& numBytes, double& time) noexcept;
+
+        /** Adds all the events up to the given end time to a MidiBuffer.
+
+            Each event's sample position in the buffer is calculated as
+            (eventTime - blockStartTime) * samplesPerTimeUnit. To avoid any allocation, give
+            the buffer enough space and call MidiBuffer::setReallocationAllowed (false).
+
+            Returns the number of events that were added.
+        */
+        int addEventsToBuffer (MidiBuffer& buffer, double blockStartTime,
+                               double endTime, double samplesPerTimeUnit) noexcept;
+
+    private:
+        const PackedMidiSequence& sequence;
+        int nextIndex;
+
+        JUCE_DECLARE_NON_COPYABLE (Iterator)
+    };
+
+private:
+    //==============================================================================
+    HeapBlock<double> times;
+    HeapBlock<int> dataOffsets, noteOffIndexes;
+    HeapBlock<uint8> data;
+    int numEvents, eventCapacity;
+    size_t dataCapacity;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PackedMidiSequence)
+};
+
+
+#endif   // JUCE_PACKEDMIDISEQUENCE_H_INCLUDED
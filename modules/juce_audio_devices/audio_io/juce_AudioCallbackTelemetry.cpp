@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+void AudioCallbackTelemetry::Histogram::clear() noexcept
+{
+    for (int i = 0; i < numBuckets; ++i)
+        buckets[i] = 0;
+
+    total = 0;
+}
+
+void AudioCallbackTelemetry::Histogram::add (const double proportionOfBlock) noexcept
+{
+    ++(buckets [jlimit (0, numBuckets - 1, roundToInt (proportionOfBlock * 100.0))]);
+    ++total;
+}
+
+double AudioCallbackTelemetry::Histogram::getPercentile (const double percentile) const noexcept
+{
+    const int numNeeded = (int) std::ceil (total.get() * percentile / 100.0);
+    int count = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        count += buckets[i].get();
+
+        if (count >= numNeeded && count > 0)
+            return i / 100.0;
+    }
+
+    return 0.0;
+}
+
+//==============================================================================
+AudioCallbackTelemetry::Statistics::Statistics() noexcept
+    : blockPeriodMs (0), numCallbacks (0),
+      processingTime50th (0), processingTime90th (0), processingTime99th (0), processingTimeMax (0),
+      jitter50th (0), jitter99th (0), jitterMax (0),
+      numOverloads (0), numXRuns (0), lastOverloadTime (0), lastXRunTime (0)
+{
+}
+
+//==============================================================================
+AudioCallbackTelemetry::AudioCallbackTelemetry()
+    : blockPeriodMs (0), callbackStartTime (0), lastCallbackStartTime (0)
+{
+    reset();
+}
+
+AudioCallbackTelemetry::~AudioCallbackTelemetry() {}
+
+void AudioCallbackTelemetry::prepare (const double sampleRate, const int blockSize) noexcept
+{
+    blockPeriodMs = (sampleRate > 0 && blockSize > 0) ? (1000.0 * blockSize / sampleRate) : 0.0;
+    lastCallbackStartTime = 0;
+    lastDeviceXRunCount = 0;
+    reset();
+}
+
+void AudioCallbackTelemetry::reset() noexcept
+{
+    processingTimes.clear();
+    jitters.clear();
+    numCallbacks = 0;
+    numOverloads = 0;
+    numXRuns = 0;
+    deviceReportsXRuns = 0;
+    lastOverloadTime = 0;
+    lastXRunTime = 0;
+    maxProcessingTimeMicros = 0;
+    maxJitterMicros = 0;
+}
+
+void AudioCallbackTelemetry::callbackStarted() noexcept
+{
+    callbackStartTime = Time::getMillisecondCounterHiRes();
+
+    if (lastCallbackStartTime > 0 && blockPeriodMs > 0)
+    {
+        const double jitterMs = std::abs ((callbackStartTime - lastCallbackStartTime) - blockPeriodMs);
+        jitters.add (jitterMs / blockPeriodMs);
+
+        const int micros = roundToInt (jitterMs * 1000.0);
+        if (micros > maxJitterMicros.get())
+            maxJitterMicros = micros;
+    }
+
+    lastCallbackStartTime = callbackStartTime;
+}
+
+void AudioCallbackTelemetry::callbackFinished (const int deviceXRunCount) noexcept
+{
+    const double timeTakenMs = Time::getMillisecondCounterHiRes() - callbackStartTime;
+    ++numCallbacks;
+
+    if (blockPeriodMs > 0)
+    {
+        processingTimes.add (timeTakenMs / blockPeriodMs);
+
+        if (timeTakenMs > blockPeriodMs)
+        {
+            ++numOverloads;
+            lastOverloadTime = Time::getMillisecondCounter();
+        }
+    }
+
+    const int micros = roundToInt (timeTakenMs * 1000.0);
+    if (micros > maxProcessingTimeMicros.get())
+        maxProcessingTimeMicros = micros;
+
+    if (deviceXRunCount >= 0)
+    {
+        deviceReportsXRuns = 1;
+        const int newXRuns = deviceXRunCount - lastDeviceXRunCount.get();
+
+        if (newXRuns > 0)
+        {
+            numXRuns += newXRuns;
+            lastXRunTime = Time::getMillisecondCounter();
+        }
+
+        lastDeviceXRunCount = deviceXRunCount;
+    }
+}
+
+AudioCallbackTelemetry::Statistics AudioCallbackTelemetry::getStatistics() const noexcept
+{
+    Statistics s;
+    s.blockPeriodMs         = blockPeriodMs;
+    s.numCallbacks          = numCallbacks.get();
+    s.processingTime50th    = processingTimes.getPercentile (50.0) * blockPeriodMs;
+    s.processingTime90th    = processingTimes.getPercentile (90.0) * blockPeriodMs;
+    s.processingTime99th    = processingTimes.getPercentile (99.0) * blockPeriodMs;
+    s.processingTimeMax     = maxProcessingTimeMicros.get() / 1000.0;
+    s.jitter50th            = jitters.getPercentile (50.0) * blockPeriodMs;
+    s.jitter99th            = jitters.getPercentile (99.0) * blockPeriodMs;
+    s.jitterMax             = maxJitterMicros.get() / 1000.0;
+    s.numOverloads          = numOverloads.get();
+    s.numXRuns              = deviceReportsXRuns.get() != 0 ? numXRuns.get() : -1;
+    s.lastOverloadTime      = lastOverloadTime.get();
+    s.lastXRunTime          = lastXRunTime.get();
+    return s;
+}
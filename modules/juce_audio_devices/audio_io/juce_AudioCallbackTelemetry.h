@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_AUDIOCALLBACKTELEMETRY_H_INCLUDED
+#define JUCE_AUDIOCALLBACKTELEMETRY_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Collects timing statistics about an audio callback, so that you can find out
+    when and why the audio is glitching.
+
+    The audio thread calls callbackStarted() and callbackFinished() around each
+    callback, which just update some atomic counters and histograms, so it never blocks
+    or allocates. Any other thread can then call getStatistics() to get a summary.
+
+    For each callback, it records:
+    - the jitter, i.e. how far the time since the previous callback started differs from
+      the expected block period
+    - how long the callback took to run, from which percentiles are calculated
+    - an overload, if the callback took longer than the block period
+    - any new xruns that the device has reported (see AudioIODevice::getXRunCount())
+
+    An AudioDeviceManager keeps one of these for its device - see
+    AudioDeviceManager::getCallbackTelemetry().
+*/
+class JUCE_API  AudioCallbackTelemetry
+{
+public:
+    //==============================================================================
+    /** Creates an empty set of statistics. */
+    AudioCallbackTelemetry();
+
+    /** Destructor. */
+    ~AudioCallbackTelemetry();
+
+    //==============================================================================
+    /** Clears the statistics, and sets up the expected block period.
+        This shouldn't be called while the audio callback is running.
+    */
+    void prepare (double sampleRate, int blockSize) noexcept;
+
+    /** Clears the statistics, keeping the current block period.
+        This can be called while the callback is running, though a callback that's in progress
+        may be partially counted.
+    */
+    void reset() noexcept;
+
+    /** Must be called by the audio thread at the start of each callback. */
+    void callbackStarted() noexcept;
+
+    /** Must be called by the audio thread at the end of each callback.
+        @param deviceXRunCount  the device's current total from AudioIODevice::getXRunCount(),
+                                or -1 if the device doesn't report them
+    */
+    void callbackFinished (int deviceXRunCount) noexcept;
+
+    //==============================================================================
+    /** A summary of the statistics that have been collected. All times are in milliseconds. */
+    struct Statistics
+    {
+        Statistics() noexcept;
+
+        /** The length of one block at the current sample rate. */
+        double blockPeriodMs;
+
+        /** The number of callbacks that have been timed. */
+        int numCallbacks;
+
+        /** Percentiles of the time spent inside the callback. */
+        double processingTime50th, processingTime90th, processingTime99th, processingTimeMax;
+
+        /** Percentiles of the difference between the actual and expected interval between callbacks. */
+        double jitter50th, jitter99th, jitterMax;
+
+        /** The number of callbacks that took longer than the block period. */
+        int numOverloads;
+
+        /** The number of xruns reported by the device, or -1 if it doesn't report them. */
+        int numXRuns;
+
+        /** The Time::getMillisecondCounter() value at the last overload or xrun, or 0 if there hasn't been one. */
+        uint32 lastOverloadTime, lastXRunTime;
+    };
+
+    /** Returns a summary of the statistics.
+        This can be called from any thread, and won't block the audio callback.
+    */
+    Statistics getStatistics() const noexcept;
+
+private:
+    //==============================================================================
+    // Each bucket is 1% of the block period, and the last one catches everything bigger.
+    enum { numBuckets = 400 };
+
+    struct Histogram
+    {
+        void clear() noexcept;
+        void add (double proportionOfBlock) noexcept;
+        double getPercentile (double percentile) const noexcept;
+
+        Atomic<int> buckets [numBuckets];
+        Atomic<int> total;
+    };
+
+    Histogram processingTimes, jitters;
+    double blockPeriodMs, callbackStartTime, lastCallbackStartTime;
+    Atomic<int> numCallbacks, numOverloads, numXRuns, lastDeviceXRunCount, deviceReportsXRuns;
+    Atomic<uint32> lastOverloadTime, lastXRunTime;
+    Atomic<int> maxProcessingTimeMicros, maxJitterMicros;
+
+    JUCE_DECLARE_NON_COPYABLE (AudioCallbackTelemetry)
+};
+
+
+#endif   // JUCE_AUDIOCALLBACKTELEMETRY_H_INCLUDED
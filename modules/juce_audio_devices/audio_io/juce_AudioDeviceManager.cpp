@@ -164,6 +164,7 @@ void AudioDeviceManager::createAudioDeviceTypes (OwnedArray <AudioIODeviceType>&
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_JACK());
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_OpenSLES());
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_Android());
+    addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_Virtual());
 }
 
 void AudioDeviceManager::addAudioDeviceType (AudioIODeviceType* newDeviceType)
@@ -673,6 +674,7 @@ void AudioDeviceManager::audioDeviceIOCallbackInt (const float** inputChannelDat
                                                    int numSamples)
 {
     const ScopedLock sl (audioCallbackLock);
+    callbackTelemetry.callbackStarted();
 
     if (inputLevelMeasurementEnabledCount.get() > 0 && numInputChannels > 0)
     {
@@ -748,6 +750,8 @@ void AudioDeviceManager::audioDeviceIOCallbackInt (const float** inputChannelDat
         if (testSoundPosition >= testSound->getNumSamples())
             testSound = nullptr;
     }
+
+    callbackTelemetry.callbackFinished (currentAudioDevice != nullptr ? currentAudioDevice->getXRunCount() : -1);
 }
 
 void AudioDeviceManager::audioDeviceAboutToStartInt (AudioIODevice* const device)
@@ -763,6 +767,8 @@ void AudioDeviceManager::audioDeviceAboutToStartInt (AudioIODevice* const device
         timeToCpuScale = (msPerBlock > 0.0) ? (1.0 / msPerBlock) : 0.0;
     }
 
+    callbackTelemetry.prepare (sampleRate, blockSize);
+
     {
         const ScopedLock sl (audioCallbackLock);
         for (int i = callbacks.size(); --i >= 0;)
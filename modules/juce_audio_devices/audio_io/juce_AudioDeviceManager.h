@@ -26,6 +26,7 @@
 #define JUCE_AUDIODEVICEMANAGER_H_INCLUDED
 
 #include "juce_AudioIODeviceType.h"
+#include "juce_AudioCallbackTelemetry.h"
 #include "../midi_io/juce_MidiInput.h"
 #include "../midi_io/juce_MidiOutput.h"
 
@@ -310,6 +311,12 @@ public:
     */
     double getCpuUsage() const;
 
+    /** Returns the object that collects timing statistics for the audio callback.
+        You can call AudioCallbackTelemetry::getStatistics() on it from any thread to find out
+        about processing-time percentiles, callback jitter, overloads and xruns.
+    */
+    AudioCallbackTelemetry& getCallbackTelemetry() noexcept     { return callbackTelemetry; }
+
     //==============================================================================
     /** Enables or disables a midi input device.
 
@@ -477,6 +484,7 @@ private:
     CriticalSection audioCallbackLock, midiCallbackLock;
 
     double cpuUsageMs, timeToCpuScale;
+    AudioCallbackTelemetry callbackTelemetry;
 
     //==============================================================================
     class CallbackHandler;
@@ -32,6 +32,11 @@ AudioIODevice::~AudioIODevice()
 {
 }
 
+int AudioIODevice::getXRunCount() const noexcept
+{
+    return -1;
+}
+
 bool AudioIODevice::hasControlPanel() const
 {
     return false;
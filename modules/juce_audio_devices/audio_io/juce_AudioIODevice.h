@@ -302,6 +302,13 @@ public:
     */
     virtual int getInputLatencyInSamples() = 0;
 
+    /** Returns the number of buffer under- or over-runs that the device has reported since
+        it was opened, or -1 if the device doesn't provide this information.
+
+        This may be called by any thread, including the audio callback thread.
+    */
+    virtual int getXRunCount() const noexcept;
+
 
     //==============================================================================
     /** True if this device can show a pop-up control panel for editing its settings.
@@ -167,6 +167,8 @@ public:
     static AudioIODeviceType* createAudioIODeviceType_Android();
     /** Creates an Android OpenSLES device type if it's available on this platform, or returns null. */
     static AudioIODeviceType* createAudioIODeviceType_OpenSLES();
+    /** Creates a VirtualAudioIODeviceType if JUCE_USE_VIRTUAL_AUDIO_DEVICE is enabled, or returns null. */
+    static AudioIODeviceType* createAudioIODeviceType_Virtual();
 
 protected:
     explicit AudioIODeviceType (const String& typeName);
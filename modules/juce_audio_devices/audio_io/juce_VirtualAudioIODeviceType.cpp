@@ -0,0 +1,509 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+VirtualAudioIODeviceType::Options::Options()
+    : numInputChannels (2),
+      numOutputChannels (2),
+      clockMode (realTimeClock),
+      maxJitterMs (0),
+      xrunProbability (0),
+      randomSeed (0),
+      inputSignal (1, 0),
+      maxRecordedSamples (0)
+{
+    const double defaultRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+    sampleRates.addArray (defaultRates, numElementsInArray (defaultRates));
+
+    for (int size = 16; size <= 4096; size *= 2)
+        bufferSizes.add (size);
+}
+
+//==============================================================================
+VirtualAudioIODeviceType::VirtualAudioIODeviceType (const Options& opts)
+    : AudioIODeviceType ("Virtual"),
+      options (opts)
+{
+}
+
+VirtualAudioIODeviceType::~VirtualAudioIODeviceType()
+{
+}
+
+void VirtualAudioIODeviceType::setOptions (const Options& newOptions)
+{
+    options = newOptions;
+}
+
+static const char* const virtualDeviceName = "Virtual Audio Device";
+
+void VirtualAudioIODeviceType::scanForDevices() {}
+
+StringArray VirtualAudioIODeviceType::getDeviceNames (bool /*wantInputNames*/) const
+{
+    return StringArray (virtualDeviceName);
+}
+
+int VirtualAudioIODeviceType::getDefaultDeviceIndex (bool /*forInput*/) const
+{
+    return 0;
+}
+
+int VirtualAudioIODeviceType::getIndexOfDevice (AudioIODevice* device, bool /*asInput*/) const
+{
+    return dynamic_cast<VirtualAudioIODevice*> (device) != nullptr ? 0 : -1;
+}
+
+bool VirtualAudioIODeviceType::hasSeparateInputsAndOutputs() const
+{
+    return false;
+}
+
+AudioIODevice* VirtualAudioIODeviceType::createDevice (const String& outputDeviceName,
+                                                       const String& inputDeviceName)
+{
+    if (outputDeviceName == virtualDeviceName || inputDeviceName == virtualDeviceName)
+        return new VirtualAudioIODevice (virtualDeviceName, options);
+
+    return nullptr;
+}
+
+AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_Virtual()
+{
+   #if JUCE_USE_VIRTUAL_AUDIO_DEVICE
+    return new VirtualAudioIODeviceType();
+   #else
+    return nullptr;
+   #endif
+}
+
+//==============================================================================
+VirtualAudioIODevice::VirtualAudioIODevice (const String& deviceName,
+                                            const VirtualAudioIODeviceType::Options& opts)
+    : AudioIODevice (deviceName, "Virtual"),
+      Thread ("Juce Virtual Audio"),
+      options (opts),
+      currentSampleRate (0),
+      currentBufferSize (0),
+      inputSignalPosition (0),
+      deviceIsOpen (false),
+      inputBuffer (1, 1),
+      outputBuffer (1, 1),
+      recordedOutput (1, 1),
+      random (opts.randomSeed),
+      callback (nullptr)
+{
+    jassert (options.sampleRates.size() > 0 && options.bufferSizes.size() > 0);
+}
+
+VirtualAudioIODevice::~VirtualAudioIODevice()
+{
+    close();
+}
+
+//==============================================================================
+static StringArray createVirtualChannelNames (const char* prefix, int numChannels)
+{
+    StringArray names;
+
+    for (int i = 0; i < numChannels; ++i)
+        names.add (prefix + String (i + 1));
+
+    return names;
+}
+
+StringArray VirtualAudioIODevice::getOutputChannelNames()    { return createVirtualChannelNames ("Output ", options.numOutputChannels); }
+StringArray VirtualAudioIODevice::getInputChannelNames()     { return createVirtualChannelNames ("Input ", options.numInputChannels); }
+
+int VirtualAudioIODevice::getNumSampleRates()                { return options.sampleRates.size(); }
+double VirtualAudioIODevice::getSampleRate (int index)       { return options.sampleRates [index]; }
+int VirtualAudioIODevice::getNumBufferSizesAvailable()       { return options.bufferSizes.size(); }
+int VirtualAudioIODevice::getBufferSizeSamples (int index)   { return options.bufferSizes [index]; }
+
+int VirtualAudioIODevice::getDefaultBufferSize()
+{
+    return options.bufferSizes.contains (512) ? 512 : options.bufferSizes.getFirst();
+}
+
+bool VirtualAudioIODevice::isOpen()                          { return deviceIsOpen; }
+bool VirtualAudioIODevice::isPlaying()                       { return callback != nullptr; }
+String VirtualAudioIODevice::getLastError()                  { return lastError; }
+int VirtualAudioIODevice::getCurrentBufferSizeSamples()      { return currentBufferSize; }
+double VirtualAudioIODevice::getCurrentSampleRate()          { return currentSampleRate; }
+int VirtualAudioIODevice::getCurrentBitDepth()               { return 32; }
+BigInteger VirtualAudioIODevice::getActiveOutputChannels() const    { return activeOutputChannels; }
+BigInteger VirtualAudioIODevice::getActiveInputChannels() const     { return activeInputChannels; }
+int VirtualAudioIODevice::getOutputLatencyInSamples()        { return 0; }
+int VirtualAudioIODevice::getInputLatencyInSamples()         { return 0; }
+int VirtualAudioIODevice::getXRunCount() const noexcept      { return numXRuns.get(); }
+int VirtualAudioIODevice::getNumBlocksProcessed() const noexcept    { return numBlocksProcessed.get(); }
+int VirtualAudioIODevice::getNumRecordedSamples() const noexcept    { return numRecordedSamples.get(); }
+
+//==============================================================================
+String VirtualAudioIODevice::open (const BigInteger& inputChannels, const BigInteger& outputChannels,
+                                   double sampleRate, int bufferSizeSamples)
+{
+    close();
+    lastError = String::empty;
+
+    currentSampleRate = sampleRate > 0 ? sampleRate : options.sampleRates.getFirst();
+    currentBufferSize = bufferSizeSamples > 0 ? bufferSizeSamples : getDefaultBufferSize();
+
+    activeInputChannels = inputChannels;
+    activeInputChannels.setRange (options.numInputChannels, activeInputChannels.getHighestBit() + 1, false);
+    activeOutputChannels = outputChannels;
+    activeOutputChannels.setRange (options.numOutputChannels, activeOutputChannels.getHighestBit() + 1, false);
+
+    const int numIns  = activeInputChannels.countNumberOfSetBits();
+    const int numOuts = activeOutputChannels.countNumberOfSetBits();
+
+    inputBuffer.setSize (jmax (1, numIns), currentBufferSize);
+    outputBuffer.setSize (jmax (1, numOuts), currentBufferSize);
+    inputBuffer.clear();
+    outputBuffer.clear();
+
+    inputChannelData.clearQuick();
+    outputChannelData.clearQuick();
+
+    for (int i = 0; i < numIns; ++i)   inputChannelData.add (inputBuffer.getSampleData (i));
+    for (int i = 0; i < numOuts; ++i)  outputChannelData.add (outputBuffer.getSampleData (i));
+
+    recordedOutput.setSize (jmax (1, numOuts), jmax (1, options.maxRecordedSamples));
+    recordedOutput.clear();
+
+    if (options.recordingFile != File::nonexistent && numOuts > 0)
+    {
+        options.recordingFile.deleteFile();
+
+        if (FileOutputStream* out = options.recordingFile.createOutputStream())
+        {
+            WavAudioFormat wav;
+            recordingWriter = wav.createWriterFor (out, currentSampleRate, (unsigned int) numOuts,
+                                                   24, StringPairArray(), 0);
+
+            if (recordingWriter == nullptr)
+                delete out;
+        }
+
+        if (recordingWriter == nullptr)
+        {
+            lastError = "Couldn't create the recording file " + options.recordingFile.getFullPathName();
+            return lastError;
+        }
+    }
+
+    random.setSeed (options.randomSeed);
+    inputSignalPosition = 0;
+    numBlocksProcessed = 0;
+    numXRuns = 0;
+    numRecordedSamples = 0;
+    deviceIsOpen = true;
+
+    if (options.clockMode != VirtualAudioIODeviceType::manualClock)
+        startThread (8);
+
+    return lastError;
+}
+
+void VirtualAudioIODevice::close()
+{
+    stop();
+    stopThread (5000);
+
+    recordingWriter = nullptr;
+    deviceIsOpen = false;
+}
+
+void VirtualAudioIODevice::start (AudioIODeviceCallback* newCallback)
+{
+    if (deviceIsOpen && newCallback != callback)
+    {
+        if (newCallback != nullptr)
+            newCallback->audioDeviceAboutToStart (this);
+
+        AudioIODeviceCallback* const oldCallback = callback;
+
+        {
+            const ScopedLock sl (callbackLock);
+            callback = newCallback;
+        }
+
+        if (oldCallback != nullptr)
+            oldCallback->audioDeviceStopped();
+    }
+}
+
+void VirtualAudioIODevice::stop()
+{
+    AudioIODeviceCallback* const oldCallback = callback;
+
+    if (oldCallback != nullptr)
+    {
+        {
+            const ScopedLock sl (callbackLock);
+            callback = nullptr;
+        }
+
+        oldCallback->audioDeviceStopped();
+    }
+}
+
+//==============================================================================
+int VirtualAudioIODevice::renderBlocks (const int numBlocks)
+{
+    if (! deviceIsOpen || options.clockMode != VirtualAudioIODeviceType::manualClock)
+        return 0;
+
+    for (int i = 0; i < numBlocks; ++i)
+        processNextBlock();
+
+    return jmax (0, numBlocks);
+}
+
+bool VirtualAudioIODevice::waitForBlocks (const int numBlocks, const int timeOutMilliseconds)
+{
+    const uint32 endTime = Time::getMillisecondCounter() + (uint32) jmax (0, timeOutMilliseconds);
+
+    while (numBlocksProcessed.get() < numBlocks)
+    {
+        const int msLeft = (int) (endTime - Time::getMillisecondCounter());
+
+        if (msLeft <= 0 || ! isThreadRunning())
+            return numBlocksProcessed.get() >= numBlocks;
+
+        blockProcessedEvent.wait (jmin (msLeft, 100));
+    }
+
+    return true;
+}
+
+void VirtualAudioIODevice::run()
+{
+    const double blockPeriodMs = 1000.0 * currentBufferSize / currentSampleRate;
+    double nextBlockTime = Time::getMillisecondCounterHiRes();
+
+    while (! threadShouldExit())
+    {
+        if (options.clockMode == VirtualAudioIODeviceType::realTimeClock)
+        {
+            double dueTime = nextBlockTime;
+
+            if (options.maxJitterMs > 0)
+                dueTime += random.nextDouble() * options.maxJitterMs;
+
+            for (;;)
+            {
+                const double msLeft = dueTime - Time::getMillisecondCounterHiRes();
+
+                if (msLeft <= 0 || threadShouldExit())
+                    break;
+
+                // sleep for the bulk of the wait, and only yield for the last millisecond
+                if (msLeft > 1.5)
+                    wait ((int) (msLeft - 1.0));
+                else
+                    Thread::yield();
+            }
+
+            nextBlockTime += blockPeriodMs;
+
+            // if the callback is running too slowly to keep up, don't try to catch up later
+            nextBlockTime = jmax (nextBlockTime, Time::getMillisecondCounterHiRes() - blockPeriodMs);
+        }
+
+        if (threadShouldExit())
+            break;
+
+        processNextBlock();
+    }
+}
+
+void VirtualAudioIODevice::processNextBlock()
+{
+    const int numSamples = currentBufferSize;
+    fillInputChannels();
+
+    if (options.xrunProbability > 0 && random.nextDouble() < options.xrunProbability)
+    {
+        ++numXRuns;
+        outputBuffer.clear();
+    }
+    else
+    {
+        const ScopedLock sl (callbackLock);
+
+        if (callback != nullptr)
+            callback->audioDeviceIOCallback ((const float**) inputChannelData.getRawDataPointer(),
+                                             inputChannelData.size(),
+                                             outputChannelData.getRawDataPointer(),
+                                             outputChannelData.size(),
+                                             numSamples);
+        else
+            outputBuffer.clear();
+    }
+
+    recordOutput (numSamples);
+
+    ++numBlocksProcessed;
+    blockProcessedEvent.signal();
+}
+
+void VirtualAudioIODevice::fillInputChannels()
+{
+    const int signalLength = options.inputSignal.getNumSamples();
+
+    if (signalLength == 0)
+    {
+        inputBuffer.clear();
+        return;
+    }
+
+    const int numSignalChannels = options.inputSignal.getNumChannels();
+
+    for (int done = 0; done < currentBufferSize;)
+    {
+        const int num = jmin (currentBufferSize - done, signalLength - inputSignalPosition);
+
+        for (int i = 0; i < inputChannelData.size(); ++i)
+            inputBuffer.copyFrom (i, done, options.inputSignal, i % numSignalChannels, inputSignalPosition, num);
+
+        done += num;
+        inputSignalPosition = (inputSignalPosition + num) % signalLength;
+    }
+}
+
+void VirtualAudioIODevice::recordOutput (const int numSamples)
+{
+    if (outputChannelData.size() == 0)
+        return;
+
+    const int numRecorded = numRecordedSamples.get();
+    const int numToKeep = jmin (numSamples, options.maxRecordedSamples - numRecorded);
+
+    if (numToKeep > 0)
+    {
+        for (int i = 0; i < outputChannelData.size(); ++i)
+            recordedOutput.copyFrom (i, numRecorded, outputBuffer, i, 0, numToKeep);
+
+        numRecordedSamples = numRecorded + numToKeep;
+    }
+
+    if (recordingWriter != nullptr)
+        recordingWriter->writeFromAudioSampleBuffer (outputBuffer, 0, numSamples);
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class VirtualAudioIODeviceTests  : public UnitTest
+{
+public:
+    VirtualAudioIODeviceTests()  : UnitTest ("Virtual audio devices") {}
+
+    struct PassThroughCallback  : public AudioIODeviceCallback
+    {
+        PassThroughCallback() : numCallbacks (0) {}
+
+        void audioDeviceIOCallback (const float** inputs, int numInputs,
+                                    float** outputs, int numOutputs, int numSamples)
+        {
+            for (int i = 0; i < numOutputs; ++i)
+                for (int j = 0; j < numSamples; ++j)
+                    outputs[i][j] = inputs [i % numInputs][j] * 0.5f;
+
+            ++numCallbacks;
+        }
+
+        void audioDeviceAboutToStart (AudioIODevice*) {}
+        void audioDeviceStopped() {}
+
+        int numCallbacks;
+    };
+
+    void runTest()
+    {
+        beginTest ("Manual clocking");
+
+        VirtualAudioIODeviceType::Options options;
+        options.clockMode = VirtualAudioIODeviceType::manualClock;
+        options.maxRecordedSamples = 1000;
+        options.inputSignal.setSize (1, 100);
+
+        for (int i = 0; i < 100; ++i)
+            *options.inputSignal.getSampleData (0, i) = (float) i;
+
+        VirtualAudioIODeviceType type (options);
+        ScopedPointer<AudioIODevice> device (type.createDevice (type.getDeviceNames()[0], String::empty));
+        VirtualAudioIODevice* virtualDevice = dynamic_cast<VirtualAudioIODevice*> (device.get());
+        expect (virtualDevice != nullptr);
+
+        BigInteger channels;
+        channels.setRange (0, 2, true);
+        expect (device->open (channels, channels, 48000.0, 64).isEmpty());
+
+        PassThroughCallback callback;
+        device->start (&callback);
+        expectEquals (virtualDevice->renderBlocks (4), 4);
+        device->stop();
+
+        expectEquals (callback.numCallbacks, 4);
+        expectEquals (virtualDevice->getNumRecordedSamples(), 256);
+
+        const AudioSampleBuffer& recording = virtualDevice->getRecordedOutput();
+
+        for (int i = 0; i < 256; ++i)
+            expectEquals (*recording.getSampleData (1, i), (i % 100) * 0.5f);
+
+        beginTest ("Simulated xruns");
+
+        options.xrunProbability = 0.5;
+        type.setOptions (options);
+        device = type.createDevice (type.getDeviceNames()[0], String::empty);
+        virtualDevice = dynamic_cast<VirtualAudioIODevice*> (device.get());
+        expect (device->open (channels, channels, 48000.0, 64).isEmpty());
+
+        callback.numCallbacks = 0;
+        device->start (&callback);
+        virtualDevice->renderBlocks (100);
+        device->stop();
+
+        expectEquals (device->getXRunCount() + callback.numCallbacks, 100);
+        expect (device->getXRunCount() > 10 && device->getXRunCount() < 90);
+
+        beginTest ("Free-running clock");
+
+        options.clockMode = VirtualAudioIODeviceType::freeRunning;
+        options.xrunProbability = 0;
+        type.setOptions (options);
+        device = type.createDevice (type.getDeviceNames()[0], String::empty);
+        virtualDevice = dynamic_cast<VirtualAudioIODevice*> (device.get());
+        expect (device->open (channels, channels, 48000.0, 64).isEmpty());
+        expect (virtualDevice->waitForBlocks (50, 5000));
+        device->close();
+    }
+};
+
+static VirtualAudioIODeviceTests virtualAudioIODeviceTests;
+
+#endif
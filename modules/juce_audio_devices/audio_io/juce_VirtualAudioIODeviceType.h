@@ -0,0 +1,276 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_VIRTUALAUDIOIODEVICETYPE_H_INCLUDED
+#define JUCE_VIRTUALAUDIOIODEVICETYPE_H_INCLUDED
+
+
+//==============================================================================
+/**
+    An AudioIODeviceType whose devices aren't connected to any audio hardware.
+
+    The devices it creates are VirtualAudioIODevice objects, which call their
+    AudioIODeviceCallback from a background thread, either paced by the high-resolution
+    clock so that they behave like a real sound card, or as fast as the callback can
+    run, or one block at a time under your control. They can add random jitter to the
+    callback timing, simulate xruns, and record their output into memory and/or a WAV
+    file, which makes them useful for benchmarking and testing audio pipelines on
+    machines that have no sound card.
+
+    AudioDeviceManager::createAudioDeviceTypes() only includes this type if
+    JUCE_USE_VIRTUAL_AUDIO_DEVICE is enabled, but you can always register one yourself:
+    @code
+    VirtualAudioIODeviceType::Options options;
+    options.clockMode = VirtualAudioIODeviceType::freeRunning;
+    options.maxRecordedSamples = 48000 * 10;
+
+    deviceManager.addAudioDeviceType (new VirtualAudioIODeviceType (options));
+    deviceManager.setCurrentAudioDeviceType ("Virtual", true);
+    @endcode
+
+    @see VirtualAudioIODevice
+*/
+class JUCE_API  VirtualAudioIODeviceType  : public AudioIODeviceType
+{
+public:
+    //==============================================================================
+    /** The ways in which a virtual device can decide when to make its next callback. */
+    enum ClockMode
+    {
+        realTimeClock,  /**< Callbacks happen at the rate that a real device would make them. */
+        freeRunning,    /**< Each callback follows immediately after the previous one finishes. */
+        manualClock     /**< No thread is used: blocks are only processed when you call
+                             VirtualAudioIODevice::renderBlocks(). */
+    };
+
+    /** Describes the behaviour of the devices that a VirtualAudioIODeviceType creates. */
+    struct JUCE_API  Options
+    {
+        /** Creates a default set of options: a stereo in/out device running in real-time,
+            with no jitter, xruns or recording.
+        */
+        Options();
+
+        /** The number of input and output channels that the devices will have. */
+        int numInputChannels, numOutputChannels;
+
+        /** The sample rates that the devices will offer. */
+        Array<double> sampleRates;
+
+        /** The buffer sizes that the devices will offer. */
+        Array<int> bufferSizes;
+
+        /** How the devices are clocked. */
+        ClockMode clockMode;
+
+        /** In realTimeClock mode, each callback is delayed by a random amount of up to this
+            many milliseconds after the time at which it was due.
+        */
+        double maxJitterMs;
+
+        /** The chance (0 to 1) that any given block will be dropped as a simulated xrun.
+            A dropped block doesn't reach the callback, and is recorded as silence.
+        */
+        double xrunProbability;
+
+        /** The seed used for the jitter and xrun generator, so that runs are repeatable. */
+        int64 randomSeed;
+
+        /** A signal that is looped into the input channels. If it's empty, the inputs are
+            silent. Its channels are assigned to the device's inputs cyclically.
+        */
+        AudioSampleBuffer inputSignal;
+
+        /** The maximum number of output samples that the device will keep in memory. */
+        int maxRecordedSamples;
+
+        /** If this isn't File::nonexistent, the device's output is written to it as a WAV file
+            each time the device is opened. Any existing file is replaced.
+        */
+        File recordingFile;
+    };
+
+    //==============================================================================
+    /** Creates a device type whose devices will use the given options. */
+    explicit VirtualAudioIODeviceType (const Options& options = Options());
+
+    /** Destructor. */
+    ~VirtualAudioIODeviceType();
+
+    /** Changes the options that will be used by any devices created after this call. */
+    void setOptions (const Options& newOptions);
+
+    /** Returns the options that new devices will be given. */
+    const Options& getOptions() const noexcept                  { return options; }
+
+    //==============================================================================
+    /** @internal */
+    void scanForDevices() override;
+    /** @internal */
+    StringArray getDeviceNames (bool wantInputNames = false) const override;
+    /** @internal */
+    int getDefaultDeviceIndex (bool forInput) const override;
+    /** @internal */
+    int getIndexOfDevice (AudioIODevice* device, bool asInput) const override;
+    /** @internal */
+    bool hasSeparateInputsAndOutputs() const override;
+    /** @internal */
+    AudioIODevice* createDevice (const String& outputDeviceName, const String& inputDeviceName) override;
+
+private:
+    Options options;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VirtualAudioIODeviceType)
+};
+
+
+//==============================================================================
+/**
+    An AudioIODevice that isn't connected to any hardware.
+
+    You'll normally get one of these from a VirtualAudioIODeviceType, which will
+    explain the options it uses. Because it's a real AudioIODevice, it can be
+    used with an AudioDeviceManager in the same way as any other device.
+
+    @see VirtualAudioIODeviceType
+*/
+class JUCE_API  VirtualAudioIODevice  : public AudioIODevice,
+                                        private Thread
+{
+public:
+    //==============================================================================
+    /** Creates a device with the given options. */
+    VirtualAudioIODevice (const String& deviceName,
+                          const VirtualAudioIODeviceType::Options& options);
+
+    /** Destructor. */
+    ~VirtualAudioIODevice();
+
+    //==============================================================================
+    /** When the device uses the manualClock mode, this processes the given number of
+        blocks synchronously on the calling thread.
+
+        Returns the number of blocks that were processed, which will be 0 if the
+        device isn't open, or isn't using the manual clock.
+    */
+    int renderBlocks (int numBlocks);
+
+    /** Returns the number of blocks that the device has processed since it was opened,
+        including any that were dropped as simulated xruns.
+    */
+    int getNumBlocksProcessed() const noexcept;
+
+    /** Waits until the device has processed at least the given number of blocks since it
+        was opened. Returns false if the timeout expires first.
+    */
+    bool waitForBlocks (int numBlocks, int timeOutMilliseconds);
+
+    /** Returns the output that has been recorded since the device was opened.
+
+        The buffer has one channel for each active output channel, in ascending order, and
+        only the first getNumRecordedSamples() samples of it are valid. It's only safe to
+        read this while the device is stopped.
+    */
+    const AudioSampleBuffer& getRecordedOutput() const noexcept     { return recordedOutput; }
+
+    /** Returns the number of samples that have been recorded since the device was opened. */
+    int getNumRecordedSamples() const noexcept;
+
+    //==============================================================================
+    /** @internal */
+    StringArray getOutputChannelNames() override;
+    /** @internal */
+    StringArray getInputChannelNames() override;
+    /** @internal */
+    int getNumSampleRates() override;
+    /** @internal */
+    double getSampleRate (int index) override;
+    /** @internal */
+    int getNumBufferSizesAvailable() override;
+    /** @internal */
+    int getBufferSizeSamples (int index) override;
+    /** @internal */
+    int getDefaultBufferSize() override;
+    /** @internal */
+    String open (const BigInteger& inputChannels, const BigInteger& outputChannels,
+                 double sampleRate, int bufferSizeSamples) override;
+    /** @internal */
+    void close() override;
+    /** @internal */
+    bool isOpen() override;
+    /** @internal */
+    void start (AudioIODeviceCallback* callback) override;
+    /** @internal */
+    void stop() override;
+    /** @internal */
+    bool isPlaying() override;
+    /** @internal */
+    String getLastError() override;
+    /** @internal */
+    int getCurrentBufferSizeSamples() override;
+    /** @internal */
+    double getCurrentSampleRate() override;
+    /** @internal */
+    int getCurrentBitDepth() override;
+    /** @internal */
+    BigInteger getActiveOutputChannels() const override;
+    /** @internal */
+    BigInteger getActiveInputChannels() const override;
+    /** @internal */
+    int getOutputLatencyInSamples() override;
+    /** @internal */
+    int getInputLatencyInSamples() override;
+    /** @internal */
+    int getXRunCount() const noexcept override;
+
+private:
+    //==============================================================================
+    const VirtualAudioIODeviceType::Options options;
+    double currentSampleRate;
+    int currentBufferSize, inputSignalPosition;
+    BigInteger activeInputChannels, activeOutputChannels;
+    bool deviceIsOpen;
+    String lastError;
+
+    AudioSampleBuffer inputBuffer, outputBuffer, recordedOutput;
+    Array<float*> inputChannelData, outputChannelData;
+    ScopedPointer<AudioFormatWriter> recordingWriter;
+    Random random;
+
+    CriticalSection callbackLock;
+    AudioIODeviceCallback* callback;
+    Atomic<int> numBlocksProcessed, numXRuns, numRecordedSamples;
+    WaitableEvent blockProcessedEvent;
+
+    void run() override;
+    void processNextBlock();
+    void fillInputChannels();
+    void recordOutput (int numSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VirtualAudioIODevice)
+};
+
+
+#endif   // JUCE_VIRTUALAUDIOIODEVICETYPE_H_INCLUDED
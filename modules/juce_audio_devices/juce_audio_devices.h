@@ -63,6 +63,16 @@
  #define JUCE_ALSA 1
 #endif
 
+/** Config: JUCE_ALSA_USE_MMAP
+    If enabled, ALSA devices that support it will be driven through the memory-mapped
+    ring buffer, converting samples directly into and out of the hardware buffer and
+    using poll() to schedule the audio thread. Devices that can't be memory-mapped
+    will still use the normal read/write calls.
+*/
+#ifndef JUCE_ALSA_USE_MMAP
+ #define JUCE_ALSA_USE_MMAP 0
+#endif
+
 /** Config: JUCE_JACK
     Enables JACK audio devices (Linux only).
 */
@@ -82,6 +92,15 @@
 #endif
 
 //=============================================================================
+/** Config: JUCE_USE_VIRTUAL_AUDIO_DEVICE
+    Adds a VirtualAudioIODeviceType to the list of device types that the AudioDeviceManager
+    creates. Its devices aren't connected to any hardware, which makes this useful when
+    testing or benchmarking on machines that have no sound card.
+*/
+#ifndef JUCE_USE_VIRTUAL_AUDIO_DEVICE
+ #define JUCE_USE_VIRTUAL_AUDIO_DEVICE 0
+#endif
+
 /** Config: JUCE_USE_CDREADER
     Enables the AudioCDReader class (on supported platforms).
 */
@@ -101,10 +120,12 @@ namespace juce
 {
 
 // START_AUTOINCLUDE audio_io, midi_io, sources, audio_cd
+#include "audio_io/juce_AudioCallbackTelemetry.h"
 #include "audio_io/juce_AudioDeviceManager.h"
 #include "audio_io/juce_AudioIODevice.h"
 #include "audio_io/juce_AudioIODeviceType.h"
 #include "audio_io/juce_SystemAudioVolume.h"
+#include "audio_io/juce_VirtualAudioIODeviceType.h"
 #include "midi_io/juce_MidiInput.h"
 #include "midi_io/juce_MidiMessageCollector.h"
 #include "midi_io/juce_MidiOutput.h"
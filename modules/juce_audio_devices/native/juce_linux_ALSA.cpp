@@ -153,9 +153,14 @@ public:
           bitDepth (16),
           numChannelsRunning (0),
           latency (0),
+          isMMap (false),
           deviceID (devID),
           isInput (forInput),
-          isInterleaved (true)
+          isInterleaved (true),
+          xrunPending (false),
+          sampleFormat (SND_PCM_FORMAT_UNKNOWN),
+          ringBufferSize (0),
+          numPollFds (0)
     {
         JUCE_ALSA_LOG ("snd_pcm_open (" << deviceID.toUTF8().getAddress() << ", forInput=" << forInput << ")");
 
@@ -209,6 +214,16 @@ public:
             return false;
         }
 
+        isMMap = false;
+
+       #if JUCE_ALSA_USE_MMAP
+        if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED) >= 0)
+        {
+            isMMap = true;
+            isInterleaved = true;
+        }
+        else
+       #endif
         if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED) >= 0) // works better for plughw..
             isInterleaved = true;
         else if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_NONINTERLEAVED) >= 0)
@@ -238,6 +253,7 @@ public:
             {
                 const int type = formatsToTry [i + 1];
                 bitDepth = type & 255;
+                sampleFormat = (snd_pcm_format_t) formatsToTry [i];
 
                 converter = createConverter (isInput, bitDepth,
                                              (type & isFloatBit) != 0,
@@ -256,7 +272,7 @@ public:
         }
 
         int dir = 0;
-        unsigned int periods = 4;
+        unsigned int periods = isMMap ? 2 : 4; // when memory-mapped, we can keep the ring double-buffered
         snd_pcm_uframes_t samplesPerPeriod = bufferSize;
 
         if (JUCE_ALSA_FAILED (snd_pcm_hw_params_set_rate_near (handle, hwParams, &sampleRate, 0))
@@ -279,6 +295,9 @@ public:
         JUCE_ALSA_LOG ("frames: " << (int) frames << ", periods: " << (int) periods
                           << ", samplesPerPeriod: " << (int) samplesPerPeriod);
 
+        if (JUCE_ALSA_FAILED (snd_pcm_hw_params_get_buffer_size (hwParams, &ringBufferSize)))
+            return false;
+
         snd_pcm_sw_params_t* swParams;
         snd_pcm_sw_params_alloca (&swParams);
         snd_pcm_uframes_t boundary;
@@ -289,11 +308,28 @@ public:
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_silence_size (handle, swParams, boundary))
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_start_threshold (handle, swParams, samplesPerPeriod))
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_stop_threshold (handle, swParams, boundary))
+            || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_avail_min (handle, swParams, samplesPerPeriod))
             || JUCE_ALSA_FAILED (snd_pcm_sw_params (handle, swParams)))
         {
             return false;
         }
 
+        if (isMMap)
+        {
+            numPollFds = snd_pcm_poll_descriptors_count (handle);
+
+            if (numPollFds <= 0)
+            {
+                error = "couldn't get the poll descriptors for this PCM";
+                return false;
+            }
+
+            pollFds.calloc ((size_t) numPollFds);
+
+            if (JUCE_ALSA_FAILED (snd_pcm_poll_descriptors (handle, pollFds, (unsigned int) numPollFds)))
+                return false;
+        }
+
        #if JUCE_ALSA_LOGGING
         // enable this to dump the config of the devices that get opened
         snd_output_t* out;
@@ -321,7 +357,8 @@ public:
             for (int i = 0; i < numChannelsRunning; ++i)
                 converter->convertSamples (scratch.getData(), i, data[i], 0, numSamples);
 
-            numDone = snd_pcm_writei (handle, scratch.getData(), numSamples);
+            numDone = isMMap ? snd_pcm_mmap_writei (handle, scratch.getData(), numSamples)
+                             : snd_pcm_writei (handle, scratch.getData(), numSamples);
         }
         else
         {
@@ -331,8 +368,13 @@ public:
             numDone = snd_pcm_writen (handle, (void**) data, numSamples);
         }
 
-        if (numDone < 0 && JUCE_ALSA_FAILED (snd_pcm_recover (handle, numDone, 1 /* silent */)))
-            return false;
+        if (numDone < 0)
+        {
+            ++numXRuns;
+
+            if (JUCE_ALSA_FAILED (snd_pcm_recover (handle, numDone, 1 /* silent */)))
+                return false;
+        }
 
         if (numDone < numSamples)
             JUCE_ALSA_LOG ("Did not write all samples: numDone: " << numDone << ", numSamples: " << numSamples);
@@ -350,10 +392,16 @@ public:
             scratch.ensureSize (sizeof (float) * numSamples * numChannelsRunning, false);
             scratch.fillWith (0); // (not clearing this data causes warnings in valgrind)
 
-            snd_pcm_sframes_t num = snd_pcm_readi (handle, scratch.getData(), numSamples);
+            snd_pcm_sframes_t num = isMMap ? snd_pcm_mmap_readi (handle, scratch.getData(), numSamples)
+                                           : snd_pcm_readi (handle, scratch.getData(), numSamples);
 
-            if (num < 0 && JUCE_ALSA_FAILED (snd_pcm_recover (handle, num, 1 /* silent */)))
-                return false;
+            if (num < 0)
+            {
+                ++numXRuns;
+
+                if (JUCE_ALSA_FAILED (snd_pcm_recover (handle, num, 1 /* silent */)))
+                    return false;
+            }
 
             if (num < numSamples)
                 JUCE_ALSA_LOG ("Did not read all samples: num: " << num << ", numSamples: " << numSamples);
@@ -365,8 +413,13 @@ public:
         {
             snd_pcm_sframes_t num = snd_pcm_readn (handle, (void**) data, numSamples);
 
-            if (num < 0 && JUCE_ALSA_FAILED (snd_pcm_recover (handle, num, 1 /* silent */)))
-                return false;
+            if (num < 0)
+            {
+                ++numXRuns;
+
+                if (JUCE_ALSA_FAILED (snd_pcm_recover (handle, num, 1 /* silent */)))
+                    return false;
+            }
 
             if (num < numSamples)
                 JUCE_ALSA_LOG ("Did not read all samples: num: " << num << ", numSamples: " << numSamples);
@@ -378,18 +431,206 @@ public:
         return true;
     }
 
+    //==============================================================================
+    /** Checks how much space (or data) is in the ring buffer, and if there isn't enough,
+        sleeps in poll() until the device wakes us or the timeout expires.
+
+        Returns 1 if numFrames can be transferred, 0 if the caller should check again (because
+        of a timeout or an xrun that has been recovered), or -1 if the device has failed.
+    */
+    int waitForFrames (const int numFrames, const int timeoutMs)
+    {
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update (handle);
+
+        if (avail < 0)
+            return handleXRun ((int) avail) ? 0 : -1;
+
+        if (avail >= numFrames)
+            return 1;
+
+        const int result = poll (pollFds, (nfds_t) numPollFds, timeoutMs);
+
+        if (result < 0 && errno != EINTR)
+        {
+            error = "poll() failed";
+            return -1;
+        }
+
+        if (result > 0)
+        {
+            unsigned short revents = 0;
+            snd_pcm_poll_descriptors_revents (handle, pollFds, (unsigned int) numPollFds, &revents);
+        }
+
+        return 0;
+    }
+
+    /** Converts directly from the float buffer into the memory-mapped hardware ring. */
+    bool writeToMappedBuffer (AudioSampleBuffer& outputChannelBuffer, const int numSamples)
+    {
+        jassert (isMMap && numChannelsRunning <= outputChannelBuffer.getNumChannels());
+        const float* const* const data = outputChannelBuffer.getArrayOfChannels();
+
+        for (int done = 0; done < numSamples;)
+        {
+            const snd_pcm_channel_area_t* areas;
+            snd_pcm_uframes_t offset, frames = (snd_pcm_uframes_t) (numSamples - done);
+
+            const int err = snd_pcm_mmap_begin (handle, &areas, &offset, &frames);
+
+            if (err < 0)
+                return handleXRun (err);
+
+            char* const dest = getFrameAddress (areas, offset);
+
+            for (int i = 0; i < numChannelsRunning; ++i)
+                converter->convertSamples (dest, i, data[i] + done, 0, (int) frames);
+
+            if (! commitMappedFrames (offset, frames))
+                return error.isEmpty();
+
+            done += (int) frames;
+        }
+
+        updateMeasuredLatency();
+        return true;
+    }
+
+    /** Converts directly from the memory-mapped hardware ring into the float buffer. */
+    bool readFromMappedBuffer (AudioSampleBuffer& inputChannelBuffer, const int numSamples)
+    {
+        jassert (isMMap && numChannelsRunning <= inputChannelBuffer.getNumChannels());
+        float* const* const data = inputChannelBuffer.getArrayOfChannels();
+
+        for (int done = 0; done < numSamples;)
+        {
+            const snd_pcm_channel_area_t* areas;
+            snd_pcm_uframes_t offset, frames = (snd_pcm_uframes_t) (numSamples - done);
+
+            const int err = snd_pcm_mmap_begin (handle, &areas, &offset, &frames);
+
+            if (err < 0)
+                return handleXRun (err);
+
+            const char* const source = getFrameAddress (areas, offset);
+
+            for (int i = 0; i < numChannelsRunning; ++i)
+                converter->convertSamples (data[i] + done, 0, source, i, (int) frames);
+
+            if (! commitMappedFrames (offset, frames))
+                return error.isEmpty();
+
+            done += (int) frames;
+        }
+
+        updateMeasuredLatency();
+        return true;
+    }
+
+    /** Fills the part of the output ring that isn't needed for the first block with silence,
+        so that the device has something to play while that block is being rendered.
+    */
+    bool prefillWithSilence (const int blockSize)
+    {
+        jassert (isMMap && ! isInput);
+
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update (handle);
+
+        if (JUCE_ALSA_FAILED ((int) avail))
+            return false;
+
+        snd_pcm_sframes_t numToFill = jmin (avail, (snd_pcm_sframes_t) ringBufferSize) - blockSize;
+
+        while (numToFill > 0)
+        {
+            const snd_pcm_channel_area_t* areas;
+            snd_pcm_uframes_t offset, frames = (snd_pcm_uframes_t) numToFill;
+
+            if (JUCE_ALSA_FAILED (snd_pcm_mmap_begin (handle, &areas, &offset, &frames))
+                 || JUCE_ALSA_FAILED (snd_pcm_areas_silence (areas, offset, (unsigned int) numChannelsRunning,
+                                                             frames, sampleFormat)))
+                return false;
+
+            if (frames == 0)
+                break;
+
+            if (! commitMappedFrames (offset, frames))
+                return error.isEmpty();
+
+            numToFill -= (snd_pcm_sframes_t) frames;
+        }
+
+        return true;
+    }
+
+    bool startIfPrepared()
+    {
+        return snd_pcm_state (handle) != SND_PCM_STATE_PREPARED
+                || ! JUCE_ALSA_FAILED (snd_pcm_start (handle));
+    }
+
+    /** Returns true if an xrun has happened since the last call, and the stream needs restarting. */
+    bool checkAndClearXRun() noexcept
+    {
+        const bool wasPending = xrunPending;
+        xrunPending = false;
+        return wasPending;
+    }
+
+    int getMeasuredLatency() const noexcept        { return measuredLatency.get(); }
+
     //==============================================================================
     snd_pcm_t* handle;
     String error;
     int bitDepth, numChannelsRunning, latency;
+    Atomic<int> numXRuns;
+    bool isMMap;
 
 private:
     //==============================================================================
     String deviceID;
     const bool isInput;
-    bool isInterleaved;
+    bool isInterleaved, xrunPending;
     MemoryBlock scratch;
     ScopedPointer<AudioData::Converter> converter;
+    snd_pcm_format_t sampleFormat;
+    snd_pcm_uframes_t ringBufferSize;
+    HeapBlock<struct pollfd> pollFds;
+    int numPollFds;
+    Atomic<int> measuredLatency;
+
+    //==============================================================================
+    static char* getFrameAddress (const snd_pcm_channel_area_t* areas, snd_pcm_uframes_t offset) noexcept
+    {
+        // in an interleaved buffer, all the channels share the first area's address and step
+        return static_cast<char*> (areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+    }
+
+    bool commitMappedFrames (snd_pcm_uframes_t offset, snd_pcm_uframes_t frames)
+    {
+        const snd_pcm_sframes_t numCommitted = snd_pcm_mmap_commit (handle, offset, frames);
+
+        if (numCommitted >= 0 && (snd_pcm_uframes_t) numCommitted == frames)
+            return true;
+
+        handleXRun (numCommitted < 0 ? (int) numCommitted : -EPIPE);
+        return false;
+    }
+
+    bool handleXRun (const int errorNum)
+    {
+        ++numXRuns;
+        xrunPending = true;
+        return ! JUCE_ALSA_FAILED (snd_pcm_recover (handle, errorNum, 1 /* silent */));
+    }
+
+    void updateMeasuredLatency()
+    {
+        snd_pcm_sframes_t delay = 0;
+
+        if (snd_pcm_delay (handle, &delay) >= 0)
+            measuredLatency = (int) delay;
+    }
 
     //==============================================================================
     template <class SampleType>
@@ -642,6 +883,12 @@ public:
 
     void run() override
     {
+        if (isUsingMappedBuffers())
+        {
+            runWithMappedBuffers();
+            return;
+        }
+
         while (! threadShouldExit())
         {
             if (inputDevice != nullptr && inputDevice->handle)
@@ -660,24 +907,7 @@ public:
             if (threadShouldExit())
                 break;
 
-            {
-                const ScopedLock sl (callbackLock);
-                ++numCallbacks;
-
-                if (callback != nullptr)
-                {
-                    callback->audioDeviceIOCallback ((const float**) inputChannelDataForCallback.getRawDataPointer(),
-                                                     inputChannelDataForCallback.size(),
-                                                     outputChannelDataForCallback.getRawDataPointer(),
-                                                     outputChannelDataForCallback.size(),
-                                                     bufferSize);
-                }
-                else
-                {
-                    for (int i = 0; i < outputChannelDataForCallback.size(); ++i)
-                        zeromem (outputChannelDataForCallback[i], sizeof (float) * bufferSize);
-                }
-            }
+            invokeCallback();
 
             if (outputDevice != nullptr && outputDevice->handle)
             {
@@ -689,7 +919,10 @@ public:
                 snd_pcm_sframes_t avail = snd_pcm_avail_update (outputDevice->handle);
 
                 if (avail < 0)
+                {
+                    ++(outputDevice->numXRuns);
                     JUCE_ALSA_FAILED (snd_pcm_recover (outputDevice->handle, avail, 0));
+                }
 
                 audioIoInProgress = true;
 
@@ -705,6 +938,35 @@ public:
         audioIoInProgress = false;
     }
 
+    int getOutputLatency() const noexcept
+    {
+        if (outputDevice != nullptr && outputDevice->getMeasuredLatency() > 0)
+            return outputDevice->getMeasuredLatency();
+
+        return outputLatency;
+    }
+
+    int getInputLatency() const noexcept
+    {
+        if (inputDevice != nullptr && inputDevice->getMeasuredLatency() > 0)
+            return inputDevice->getMeasuredLatency();
+
+        return inputLatency;
+    }
+
+    int getXRunCount() const noexcept
+    {
+        int total = 0;
+
+        if (outputDevice != nullptr)
+            total += outputDevice->numXRuns.get();
+
+        if (inputDevice != nullptr)
+            total += inputDevice->numXRuns.get();
+
+        return total;
+    }
+
     int getBitDepth() const noexcept
     {
         if (outputDevice != nullptr)
@@ -741,6 +1003,130 @@ private:
     unsigned int minChansOut, maxChansOut;
     unsigned int minChansIn, maxChansIn;
 
+    void invokeCallback()
+    {
+        const ScopedLock sl (callbackLock);
+        ++numCallbacks;
+
+        if (callback != nullptr)
+        {
+            callback->audioDeviceIOCallback ((const float**) inputChannelDataForCallback.getRawDataPointer(),
+                                             inputChannelDataForCallback.size(),
+                                             outputChannelDataForCallback.getRawDataPointer(),
+                                             outputChannelDataForCallback.size(),
+                                             bufferSize);
+        }
+        else
+        {
+            for (int i = 0; i < outputChannelDataForCallback.size(); ++i)
+                zeromem (outputChannelDataForCallback[i], sizeof (float) * bufferSize);
+        }
+    }
+
+    //==============================================================================
+    bool isUsingMappedBuffers() const noexcept
+    {
+        return (outputDevice != nullptr || inputDevice != nullptr)
+                && (outputDevice == nullptr || outputDevice->isMMap)
+                && (inputDevice == nullptr || inputDevice->isMMap);
+    }
+
+    bool startMappedDevices()
+    {
+        if (outputDevice != nullptr)
+        {
+            outputDevice->checkAndClearXRun();
+
+            if (! (outputDevice->prefillWithSilence (bufferSize) && outputDevice->startIfPrepared()))
+                return false;
+        }
+
+        // (if the devices are linked, this will already have been started along with the output)
+        if (inputDevice != nullptr)
+        {
+            inputDevice->checkAndClearXRun();
+
+            if (! inputDevice->startIfPrepared())
+                return false;
+        }
+
+        return true;
+    }
+
+    // Returns false if the device failed, the thread needs to exit, or an xrun needs handling.
+    bool waitForMappedDevice (ALSADevice& device)
+    {
+        for (;;)
+        {
+            const int result = device.waitForFrames (bufferSize, 50);
+
+            if (result != 0)
+                return result > 0;
+
+            if (threadShouldExit() || device.checkAndClearXRun())
+                return false;
+        }
+    }
+
+    void runWithMappedBuffers()
+    {
+        bool needsStarting = true;
+
+        while (! threadShouldExit())
+        {
+            if (needsStarting)
+            {
+                if (! startMappedDevices())
+                {
+                    JUCE_ALSA_LOG ("Couldn't start mapped devices");
+                    break;
+                }
+
+                needsStarting = false;
+            }
+
+            if (inputDevice != nullptr)
+            {
+                if (! (waitForMappedDevice (*inputDevice)
+                        && inputDevice->readFromMappedBuffer (inputChannelBuffer, bufferSize)))
+                {
+                    if (inputDevice->error.isNotEmpty())
+                    {
+                        JUCE_ALSA_LOG ("Read failure");
+                        break;
+                    }
+
+                    needsStarting = true;
+                    continue;
+                }
+            }
+
+            if (threadShouldExit())
+                break;
+
+            invokeCallback();
+
+            if (outputDevice != nullptr)
+            {
+                if (! (waitForMappedDevice (*outputDevice)
+                        && outputDevice->writeToMappedBuffer (outputChannelBuffer, bufferSize)))
+                {
+                    if (outputDevice->error.isNotEmpty())
+                    {
+                        JUCE_ALSA_LOG ("write failure");
+                        break;
+                    }
+
+                    needsStarting = true;
+                    continue;
+                }
+            }
+
+            needsStarting = (inputDevice != nullptr && inputDevice->checkAndClearXRun())
+                             || (outputDevice != nullptr && outputDevice->checkAndClearXRun());
+        }
+    }
+
     bool failed (const int errorNum)
     {
         if (errorNum >= 0)
@@ -866,8 +1252,9 @@ public:
     BigInteger getActiveOutputChannels() const    { return internal.currentOutputChans; }
     BigInteger getActiveInputChannels() const     { return internal.currentInputChans; }
 
-    int getOutputLatencyInSamples()         { return internal.outputLatency; }
-    int getInputLatencyInSamples()          { return internal.inputLatency; }
+    int getOutputLatencyInSamples()         { return internal.getOutputLatency(); }
+    int getInputLatencyInSamples()          { return internal.getInputLatency(); }
+    int getXRunCount() const noexcept       { return internal.getXRunCount(); }
 
     void start (AudioIODeviceCallback* callback)
     {
@@ -62,6 +62,7 @@ JUCE_DECL_JACK_FUNCTION (jack_nframes_t, jack_port_get_total_latency, (jack_clie
 JUCE_DECL_JACK_FUNCTION (jack_port_t* , jack_port_register, (jack_client_t* client, const char* port_name, const char* port_type, unsigned long flags, unsigned long buffer_size), (client, port_name, port_type, flags, buffer_size));
 JUCE_DECL_VOID_JACK_FUNCTION (jack_set_error_function, (void (*func)(const char*)), (func));
 JUCE_DECL_JACK_FUNCTION (int, jack_set_process_callback, (jack_client_t* client, JackProcessCallback process_callback, void* arg), (client, process_callback, arg));
+JUCE_DECL_JACK_FUNCTION (int, jack_set_xrun_callback, (jack_client_t* client, JackXRunCallback xrun_callback, void* arg), (client, xrun_callback, arg));
 JUCE_DECL_JACK_FUNCTION (const char**, jack_get_ports, (jack_client_t* client, const char* port_name_pattern, const char* type_name_pattern, unsigned long flags), (client, port_name_pattern, type_name_pattern, flags));
 JUCE_DECL_JACK_FUNCTION (int, jack_connect, (jack_client_t* client, const char* source_port, const char* destination_port), (client, source_port, destination_port));
 JUCE_DECL_JACK_FUNCTION (const char*, jack_port_name, (const jack_port_t* port), (port));
@@ -238,7 +239,9 @@ public:
         lastError = String::empty;
         close();
 
+        numXRuns = 0;
         juce::jack_set_process_callback (client, processCallback, this);
+        juce::jack_set_xrun_callback (client, xrunCallback, this);
         juce::jack_set_port_connect_callback (client, portConnectCallback, this);
         juce::jack_on_shutdown (client, shutdownCallback, this);
         juce::jack_activate (client);
@@ -281,6 +284,7 @@ public:
         {
             juce::jack_deactivate (client);
             juce::jack_set_process_callback (client, processCallback, nullptr);
+            juce::jack_set_xrun_callback (client, xrunCallback, nullptr);
             juce::jack_set_port_connect_callback (client, portConnectCallback, nullptr);
             juce::jack_on_shutdown (client, shutdownCallback, nullptr);
         }
@@ -342,6 +346,11 @@ public:
         return latency;
     }
 
+    int getXRunCount() const noexcept
+    {
+        return numXRuns.get();
+    }
+
     String inputId, outputId;
 
 private:
@@ -417,6 +426,14 @@ private:
         }
     }
 
+    static int xrunCallback (void* callbackArgument)
+    {
+        if (JackAudioIODevice* device = static_cast <JackAudioIODevice*> (callbackArgument))
+            ++(device->numXRuns);
+
+        return 0;
+    }
+
     static void portConnectCallback (jack_port_id_t, jack_port_id_t, int, void* arg)
     {
         if (JackAudioIODevice* device = static_cast <JackAudioIODevice*> (arg))
@@ -451,6 +468,7 @@ private:
     String lastError;
     AudioIODeviceCallback* callback;
     CriticalSection callbackLock;
+    Atomic<int> numXRuns;
 
     HeapBlock <float*> inChans, outChans;
     int totalNumberOfInputChannels;
@@ -483,7 +483,7 @@ struct AAXClasses
             AAX_Result result = AAX_CEffectParameters::UpdateParameterNormalizedValue (paramID, value, source);
 
             if (! isBypassParam (paramID))
-                pluginInstance->setParameter (getParamIndexFromID (paramID), (float) value);
+                pluginInstance->scheduleParameterChange (getParamIndexFromID (paramID), (float) value);
 
             return result;
         }
@@ -769,6 +769,8 @@ struct AAXClasses
 
                 const ScopedLock sl (pluginInstance->getCallbackLock());
 
+                pluginInstance->prepareParameterChanges (bufferSize);
+
                 if (bypass)
                     pluginInstance->processBlockBypassed (buffer, midiBuffer);
                 else
@@ -452,7 +452,7 @@ public:
     {
         if (inScope == kAudioUnitScope_Global && juceFilter != nullptr)
         {
-            juceFilter->setParameter ((int) inID, inValue);
+            juceFilter->scheduleParameterChange ((int) inID, inValue, (int) inBufferOffsetInFrames);
             return noErr;
         }
 
@@ -784,6 +784,8 @@ public:
 
                 const ScopedLock sl (juceFilter->getCallbackLock());
 
+                juceFilter->prepareParameterChanges ((int) numSamples);
+
                 if (juceFilter->isSuspended())
                 {
                     for (int j = 0; j < numOut; ++j)
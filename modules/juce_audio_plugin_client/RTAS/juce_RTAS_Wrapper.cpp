@@ -597,6 +597,8 @@ protected:
 
                 AudioSampleBuffer chans (channels, totalChans, numSamples);
 
+                juceFilter->prepareParameterChanges (numSamples);
+
                 if (mBypassed)
                     juceFilter->processBlockBypassed (chans, midiEvents);
                 else
@@ -681,7 +683,7 @@ protected:
     ComponentResult UpdateControlValue (long controlIndex, long value)
     {
         if (controlIndex != bypassControlIndex)
-            juceFilter->setParameter (controlIndex - 2, longToFloat (value));
+            juceFilter->scheduleParameterChange (controlIndex - 2, longToFloat (value));
         else
             mBypassed = (value > 0);
 
@@ -257,6 +257,29 @@ juce_ImplementSingleton (SharedMessageThread)
 
 static Array<void*> activePlugins;
 
+//==============================================================================
+// The channel pointers and temporary channels used by internalProcessReplacing(), one set
+// for each sample type.
+template <typename FloatType>
+struct VstTempBuffers
+{
+    VstTempBuffers() {}
+    ~VstTempBuffers()   { release(); }
+
+    void release() noexcept
+    {
+        for (int i = tempChannels.size(); --i >= 0;)
+            delete[] (tempChannels.getUnchecked(i));
+
+        tempChannels.clear();
+    }
+
+    HeapBlock<FloatType*> channels;
+    Array<FloatType*> tempChannels;  // see note in internalProcessReplacing()
+
+    JUCE_DECLARE_NON_COPYABLE (VstTempBuffers)
+};
+
 //==============================================================================
 /**
     This is an AudioEffectX object that holds and wraps our AudioProcessor...
@@ -296,6 +319,7 @@ public:
         setNumOutputs (numOutChans);
 
         canProcessReplacing (true);
+        canDoubleReplacing (filter->supportsDoublePrecisionProcessing());
 
         isSynth ((JucePlugin_IsSynth) != 0);
         noTail (filter->getTailLengthSeconds() <= 0);
@@ -323,7 +347,8 @@ public:
 
                 jassert (editorComp == 0);
 
-                channels.free();
+                floatTempBuffers.channels.free();
+                doubleTempBuffers.channels.free();
                 deleteTempChannels();
 
                 jassert (activePlugins.contains (this));
@@ -504,6 +529,22 @@ public:
     }
 
     void processReplacing (float** inputs, float** outputs, VstInt32 numSamples)
+    {
+        jassert (! filter->isUsingDoublePrecision());
+        internalProcessReplacing (inputs, outputs, numSamples, floatTempBuffers);
+    }
+
+    void processDoubleReplacing (double** inputs, double** outputs, VstInt32 numSamples)
+    {
+        jassert (filter->isUsingDoublePrecision());
+        internalProcessReplacing (inputs, outputs, numSamples, doubleTempBuffers);
+    }
+
+    // The host's buffers are processed in-place for both sample types - temporary
+    // channels are only used when the host passes the same buffer for several outputs.
+    template <typename FloatType>
+    void internalProcessReplacing (FloatType** inputs, FloatType** outputs,
+                                   VstInt32 numSamples, VstTempBuffers<FloatType>& tmpBuffers)
     {
         if (firstProcessCallback)
         {
@@ -548,7 +589,7 @@ public:
                 int i;
                 for (i = 0; i < numOut; ++i)
                 {
-                    float* chan = tempChannels.getUnchecked(i);
+                    FloatType* chan = tmpBuffers.tempChannels.getUnchecked(i);
 
                     if (chan == nullptr)
                     {
@@ -561,35 +602,33 @@ public:
                         {
                             if (outputs[j] == chan)
                             {
-                                chan = new float [blockSize * 2];
-                                tempChannels.set (i, chan);
+                                chan = new FloatType [blockSize * 2];
+                                tmpBuffers.tempChannels.set (i, chan);
                                 break;
                             }
                         }
                     }
 
                     if (i < numIn && chan != inputs[i])
-                        memcpy (chan, inputs[i], sizeof (float) * (size_t) numSamples);
+                        memcpy (chan, inputs[i], sizeof (FloatType) * (size_t) numSamples);
 
-                    channels[i] = chan;
+                    tmpBuffers.channels[i] = chan;
                 }
 
                 for (; i < numIn; ++i)
-                    channels[i] = inputs[i];
+                    tmpBuffers.channels[i] = inputs[i];
 
                 {
-                    AudioSampleBuffer chans (channels, jmax (numIn, numOut), numSamples);
+                    AudioBuffer<FloatType> chans (tmpBuffers.channels, jmax (numIn, numOut), numSamples);
 
-                    if (isBypassed)
-                        filter->processBlockBypassed (chans, midiEvents);
-                    else
-                        filter->processBlock (chans, midiEvents);
+                    filter->prepareParameterChanges (numSamples);
+                    processBlockForBuffer (chans);
                 }
 
                 // copy back any temp channels that may have been used..
                 for (i = 0; i < numOut; ++i)
-                    if (const float* const chan = tempChannels.getUnchecked(i))
-                        memcpy (outputs[i], chan, sizeof (float) * (size_t) numSamples);
+                    if (const FloatType* const chan = tmpBuffers.tempChannels.getUnchecked(i))
+                        memcpy (outputs[i], chan, sizeof (FloatType) * (size_t) numSamples);
             }
         }
 
@@ -635,16 +674,51 @@ public:
         }
     }
 
+    void processBlockForBuffer (AudioSampleBuffer& buffer)
+    {
+        if (isBypassed)
+            filter->processBlockBypassed (buffer, midiEvents);
+        else
+            filter->processBlock (buffer, midiEvents);
+    }
+
+    void processBlockForBuffer (DoubleAudioSampleBuffer& buffer)
+    {
+        if (isBypassed)
+            filter->processBlockBypassedDouble (buffer, midiEvents);
+        else
+            filter->processBlockDouble (buffer, midiEvents);
+    }
+
     //==============================================================================
     VstInt32 startProcess()  { return 0; }
     VstInt32 stopProcess()   { return 0; }
 
+    bool setProcessPrecision (VstInt32 precision)
+    {
+        // (the host only calls this while the plugin is suspended)
+        if (precision == kVstProcessPrecision64)
+        {
+            if (! filter->supportsDoublePrecisionProcessing())
+                return false;
+
+            filter->setProcessingPrecision (AudioProcessor::doublePrecision);
+        }
+        else
+        {
+            filter->setProcessingPrecision (AudioProcessor::singlePrecision);
+        }
+
+        return true;
+    }
+
     void resume()
     {
         if (filter != nullptr)
         {
             isProcessing = true;
-            channels.calloc ((size_t) (numInChans + numOutChans));
+            floatTempBuffers.channels.calloc ((size_t) (numInChans + numOutChans));
+            doubleTempBuffers.channels.calloc ((size_t) (numInChans + numOutChans));
 
             double rate = getSampleRate();
             jassert (rate > 0);
@@ -686,7 +760,8 @@ public:
             outgoingEvents.freeEvents();
 
             isProcessing = false;
-            channels.free();
+            floatTempBuffers.channels.free();
+            doubleTempBuffers.channels.free();
 
             deleteTempChannels();
         }
@@ -820,7 +895,7 @@ public:
         if (filter != nullptr)
         {
             jassert (isPositiveAndBelow (index, filter->getNumParameters()));
-            filter->setParameter (index, value);
+            filter->scheduleParameterChange (index, value);
         }
     }
 
@@ -1398,8 +1473,8 @@ private:
     VstSpeakerArrangementType speakerIn, speakerOut;
     int numInChans, numOutChans;
     bool isProcessing, isBypassed, hasShutdown, firstProcessCallback, shouldDeleteEditor;
-    HeapBlock<float*> channels;
-    Array<float*> tempChannels;  // see note in processReplacing()
+    VstTempBuffers<float> floatTempBuffers;
+    VstTempBuffers<double> doubleTempBuffers;
 
    #if JUCE_MAC
     void* hostWindow;
@@ -1459,13 +1534,15 @@ private:
     //==============================================================================
     void deleteTempChannels()
     {
-        for (int i = tempChannels.size(); --i >= 0;)
-            delete[] (tempChannels.getUnchecked(i));
-
-        tempChannels.clear();
+        floatTempBuffers.release();
+        doubleTempBuffers.release();
 
         if (filter != nullptr)
-            tempChannels.insertMultiple (0, 0, filter->getNumInputChannels() + filter->getNumOutputChannels());
+        {
+            const int numChannels = filter->getNumInputChannels() + filter->getNumOutputChannels();
+            floatTempBuffers.tempChannels.insertMultiple (0, nullptr, numChannels);
+            doubleTempBuffers.tempChannels.insertMultiple (0, nullptr, numChannels);
+        }
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JuceVSTWrapper)
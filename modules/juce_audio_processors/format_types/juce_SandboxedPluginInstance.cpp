@@ -0,0 +1,1656 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+namespace SandboxHelpers
+{
+    static const char* const commandLineArgument = "--juce-plugin-sandbox";
+    static const uint32 magicMessageHeader = 0x5a4e4253;
+
+    static MemoryBlock toMemoryBlock (const XmlElement& xml)
+    {
+        const String text (xml.createDocument (String::empty, true, false));
+        return MemoryBlock (text.toRawUTF8(), text.getNumBytesAsUTF8());
+    }
+
+    static XmlElement* createError (const String& message)
+    {
+        XmlElement* const e = new XmlElement ("ERROR");
+        e->setAttribute ("message", message);
+        return e;
+    }
+
+    //==============================================================================
+    /*  Lets one process sleep until another one changes a word in the memory they share.
+
+        On Linux this is a futex on the word itself, so the name isn't used. Elsewhere
+        both sides open a kernel object with the same name: an auto-reset event on
+        Windows, or a FIFO on other platforms, which the waiting side selects on and the
+        waking side writes a byte into. In each case a wake-up that's sent before the
+        other side starts waiting isn't lost, and a spurious one does no harm, because
+        the waiting side always re-checks the word.
+    */
+    class WordSignal
+    {
+    public:
+        WordSignal (Atomic<int32>& word_, const String& name, const bool createObject)
+            : word (word_)
+        {
+           #if JUCE_LINUX
+            (void) name; (void) createObject;
+           #elif JUCE_WINDOWS
+            // CreateEvent will open the event if the other side has already created it
+            (void) createObject;
+            event = CreateEventW (nullptr, FALSE, FALSE, name.toWideCharPointer());
+           #else
+            fifo = File::getSpecialLocation (File::tempDirectory).getChildFile (name + ".fifo");
+            isOwner = createObject;
+
+            if (isOwner)
+            {
+                fifo.deleteFile();
+                mkfifo (fifo.getFullPathName().toUTF8(), 0600);
+            }
+
+            // opening it for both reading and writing means that this doesn't block
+            // waiting for the other side, and that writes never fail for lack of a reader
+            fd = open (fifo.getFullPathName().toUTF8(), O_RDWR | O_NONBLOCK);
+           #endif
+        }
+
+        ~WordSignal()
+        {
+           #if JUCE_WINDOWS
+            if (event != 0)
+                CloseHandle (event);
+           #elif ! JUCE_LINUX
+            if (fd >= 0)
+                close (fd);
+
+            if (isOwner)
+                fifo.deleteFile();
+           #endif
+        }
+
+        // Blocks while the word still has the given value, until woken or timed-out.
+        void waitWhileEqual (const int32 value, const int timeoutMs) noexcept
+        {
+            if (word.get() != value || timeoutMs <= 0)
+                return;
+
+           #if JUCE_LINUX
+            struct timespec timeout;
+            timeout.tv_sec  = timeoutMs / 1000;
+            timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+
+            syscall (SYS_futex, (int32*) &(word.value), FUTEX_WAIT, value, &timeout, nullptr, 0);
+           #elif JUCE_WINDOWS
+            if (event != 0)
+                WaitForSingleObject (event, (DWORD) timeoutMs);
+            else
+                Thread::sleep (1);
+           #else
+            if (fd < 0)
+            {
+                Thread::sleep (1);
+                return;
+            }
+
+            fd_set readSet;
+            FD_ZERO (&readSet);
+            FD_SET (fd, &readSet);
+
+            struct timeval timeout;
+            timeout.tv_sec  = timeoutMs / 1000;
+            timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+            if (select (fd + 1, &readSet, nullptr, nullptr, &timeout) > 0)
+            {
+                char buffer[64];
+                while (read (fd, buffer, sizeof (buffer)) > 0) {}
+            }
+           #endif
+        }
+
+        // Wakes the other side, after it has changed the word.
+        void wake() noexcept
+        {
+           #if JUCE_LINUX
+            syscall (SYS_futex, (int32*) &(word.value), FUTEX_WAKE, 0x7fffffff, nullptr, nullptr, 0);
+           #elif JUCE_WINDOWS
+            if (event != 0)
+                SetEvent (event);
+           #else
+            // if the FIFO's full, the waiting side already has plenty to wake it
+            const char byte = 0;
+
+            if (fd >= 0)
+                (void) write (fd, &byte, 1);
+           #endif
+        }
+
+    private:
+        Atomic<int32>& word;
+
+       #if JUCE_WINDOWS
+        HANDLE event;
+       #elif ! JUCE_LINUX
+        File fifo;
+        int fd;
+        bool isOwner;
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (WordSignal)
+    };
+
+    // Waits for a shared word to reach a target value. The other side normally answers
+    // within a few microseconds, so this spins for a moment before going to sleep.
+    static bool waitForValue (WordSignal& signal, Atomic<int32>& word, const int32 target, const int timeoutMs) noexcept
+    {
+        for (int i = 0; i < 2000; ++i)
+            if (word.get() == target)
+                return true;
+
+        const uint32 startTime = Time::getMillisecondCounter();
+
+        for (;;)
+        {
+            const int32 current = word.get();
+
+            if (current == target)
+                return true;
+
+            const int elapsed = (int) (Time::getMillisecondCounter() - startTime);
+
+            if (elapsed >= timeoutMs)
+                return false;
+
+            signal.waitWhileEqual (current, jmin (100, timeoutMs - elapsed));
+        }
+    }
+
+    // The audio thread can't wait as long as a control request can, because it's holding
+    // the callback lock and the host's own deadline is the length of the block. So the
+    // worker gets two block lengths, and never more than a few ms beyond the first one.
+    enum { maxAudioOverrunMs = 5 };
+
+    static int getAudioTimeoutMs (const int numSamples, const double sampleRate) noexcept
+    {
+        const int blockMs = sampleRate > 0 ? (int) std::ceil (numSamples * 1000.0 / sampleRate) : 0;
+        return jmax (1, blockMs + jmin (blockMs, (int) maxAudioOverrunMs));
+    }
+}
+
+//==============================================================================
+/*  The block of shared memory that carries each block of audio between the host
+    and the worker.
+
+    The host writes the audio, MIDI and parameter changes into it, then increments
+    requestNumber. The worker processes the block in-place, writes back any MIDI
+    output, and sets replyNumber to match.
+
+    Both sides must use the same signal name, which identifies the objects that they
+    use to wake each other. The host creates these objects, and the worker opens them.
+
+    The layout of the block is fixed when each side creates its transport, so nothing
+    that the worker writes into the header later can move the host's reads and writes
+    outside the block.
+*/
+class SandboxedPluginInstance::AudioTransport
+{
+public:
+    /** Creates the host's end, and sets up the block for the given layout. */
+    AudioTransport (void* const memory, const size_t size, const String& signalName,
+                    const int numChannels_, const int maxNumSamples_)
+        : header (static_cast <Header*> (memory)), memorySize (size),
+          numChannels (numChannels_), maxNumSamples (maxNumSamples_), lastRequestNumber (0),
+          requestSignal (header->requestNumber, signalName + "_request", true),
+          replySignal (header->replyNumber, signalName + "_reply", true)
+    {
+        jassert (memory != nullptr);
+        jassert (getRequiredSize (numChannels, maxNumSamples) <= memorySize);
+
+        zeromem (header, sizeof (Header));
+        header->numChannels = numChannels;
+        header->maxNumSamples = maxNumSamples;
+        Atomic<int32>::memoryBarrier();
+        header->magic = magicNumber;
+    }
+
+    /** Creates the worker's end, which takes its layout from a block that the host has
+        already set up. Check isValid() before using it.
+    */
+    AudioTransport (void* const memory, const size_t size, const String& signalName)
+        : header (static_cast <Header*> (memory)), memorySize (size),
+          numChannels (readLayout (memory, size, &Header::numChannels)),
+          maxNumSamples (readLayout (memory, size, &Header::maxNumSamples)), lastRequestNumber (0),
+          requestSignal (header->requestNumber, signalName + "_request", false),
+          replySignal (header->replyNumber, signalName + "_reply", false)
+    {
+        jassert (memory != nullptr);
+    }
+
+    enum
+    {
+        midiCapacity = 32768,
+        maxParameterChanges = 512
+    };
+
+    static size_t getRequiredSize (const int numChannels, const int maxNumSamples) noexcept
+    {
+        return getParameterChangeOffset (numChannels, maxNumSamples)
+                 + maxParameterChanges * sizeof (ParameterChangeBuffer::Change);
+    }
+
+    /** Called by the worker to check that the block it has mapped is complete. */
+    bool isValid() const noexcept
+    {
+        return memorySize >= sizeof (Header)
+                && header->magic == magicNumber
+                && numChannels > 0 && maxNumSamples > 0
+                && getRequiredSize (numChannels, maxNumSamples) <= memorySize;
+    }
+
+    int getNumChannels() const noexcept     { return numChannels; }
+    int getMaxNumSamples() const noexcept   { return maxNumSamples; }
+
+    float* getChannel (const int channel) const noexcept
+    {
+        jassert (isPositiveAndBelow (channel, numChannels));
+
+        return reinterpret_cast <float*> (getData (getAudioOffset()))
+                 + channel * (size_t) maxNumSamples;
+    }
+
+    //==============================================================================
+    /** Called by the host to send part of a block to the worker and wait for the result.
+        Only the reply number, the audio and the MIDI output are read back from the block.
+        @returns false if the worker didn't respond within the timeout
+    */
+    bool process (AudioSampleBuffer& buffer, const int startSample, const int numSamples,
+                  const MidiBuffer& midiIn, MidiBuffer& midiOut,
+                  const ParameterChangeBuffer::Change* const changes, const int numChanges,
+                  const int timeoutMs) noexcept
+    {
+        jassert (numSamples <= maxNumSamples);
+
+        const int numChannelsToCopy = jmin (numChannels, buffer.getNumChannels());
+
+        for (int i = 0; i < numChannels; ++i)
+        {
+            if (i < numChannelsToCopy)
+                FloatVectorOperations::copy (getChannel (i), buffer.getSampleData (i, startSample), numSamples);
+            else
+                FloatVectorOperations::clear (getChannel (i), numSamples);
+        }
+
+        header->numSamples = numSamples;
+        header->numMidiBytesIn = writeMidi (midiIn, startSample, numSamples);
+
+        ParameterChangeBuffer::Change* const dest = getParameterChanges();
+        int numChangesInBlock = 0;
+
+        for (int i = 0; i < numChanges && numChangesInBlock < maxParameterChanges; ++i)
+        {
+            const ParameterChangeBuffer::Change& c = changes[i];
+
+            if (c.samplePosition >= startSample && c.samplePosition < startSample + numSamples)
+            {
+                dest [numChangesInBlock] = c;
+                dest [numChangesInBlock].samplePosition -= startSample;
+                ++numChangesInBlock;
+            }
+        }
+
+        header->numParameterChanges = numChangesInBlock;
+
+        const int32 request = ++lastRequestNumber;
+        Atomic<int32>::memoryBarrier();
+        header->requestNumber.set (request);
+        requestSignal.wake();
+
+        if (! SandboxHelpers::waitForValue (replySignal, header->replyNumber, request, timeoutMs))
+            return false;
+
+        for (int i = 0; i < numChannelsToCopy; ++i)
+            FloatVectorOperations::copy (buffer.getSampleData (i, startSample), getChannel (i), numSamples);
+
+        readMidi (midiOut, header->numMidiBytesOut, startSample, numSamples);
+        return true;
+    }
+
+    //==============================================================================
+    /** Called by the worker to wait for the host to send a block.
+        @returns true if there's a block ready to be processed
+    */
+    bool waitForRequest (const int timeoutMs) noexcept
+    {
+        const int32 lastRequest = header->replyNumber.get();
+
+        if (header->requestNumber.get() == lastRequest)
+            requestSignal.waitWhileEqual (lastRequest, timeoutMs);
+
+        return header->requestNumber.get() != lastRequest;
+    }
+
+    /** Called by the worker to process the block that the host has sent, and reply to it.
+        The first getNumChannels() channel pointers must point at this block's own channels.
+    */
+    void serveRequest (AudioProcessor& processor, float* const* channels, const int numChannelsToUse,
+                       MidiBuffer& midiBuffer) noexcept
+    {
+        jassert (numChannelsToUse >= numChannels && channels[0] == getChannel (0));
+
+        const int numSamples = jlimit (0, maxNumSamples, header->numSamples);
+        AudioSampleBuffer buffer (channels, numChannelsToUse, numSamples);
+
+        for (int i = numChannels; i < numChannelsToUse; ++i)
+            buffer.clear (i, 0, numSamples);
+
+        midiBuffer.clear();
+        readMidi (midiBuffer, header->numMidiBytesIn, 0, numSamples);
+
+        const ParameterChangeBuffer::Change* const changes = getParameterChanges();
+
+        // these must be passed on in order, as a processor that doesn't take timestamped
+        // changes will apply each one immediately, and so ends up with the last value
+        const int numChanges = jmin ((int) maxParameterChanges, header->numParameterChanges);
+
+        for (int i = 0; i < numChanges; ++i)
+            processor.scheduleParameterChange (changes[i].parameterIndex, changes[i].value, changes[i].samplePosition);
+
+        processor.prepareParameterChanges (numSamples);
+
+        {
+            const ScopedLock sl (processor.getCallbackLock());
+
+            if (processor.isSuspended())
+                buffer.clear();
+            else
+                processor.processBlock (buffer, midiBuffer);
+        }
+
+        header->numMidiBytesOut = writeMidi (midiBuffer, 0, numSamples);
+
+        Atomic<int32>::memoryBarrier();
+        header->replyNumber.set (header->requestNumber.get());
+        replySignal.wake();
+    }
+
+private:
+    //==============================================================================
+    enum { magicNumber = 0x4a534258 };
+
+    struct Header
+    {
+        int32 magic, numChannels, maxNumSamples;
+        int32 numSamples, numMidiBytesIn, numMidiBytesOut, numParameterChanges;
+        Atomic<int32> requestNumber, replyNumber;
+    };
+
+    Header* const header;
+    const size_t memorySize;
+    const int numChannels, maxNumSamples;
+    int32 lastRequestNumber;
+    SandboxHelpers::WordSignal requestSignal, replySignal;
+
+    static int readLayout (const void* const memory, const size_t size, int32 Header::* const field) noexcept
+    {
+        return memory != nullptr && size >= sizeof (Header) ? static_cast <const Header*> (memory)->*field : 0;
+    }
+
+    static size_t getAudioOffset() noexcept
+    {
+        return (sizeof (Header) + 63) & ~(size_t) 63;
+    }
+
+    static size_t getMidiOffset (const int numChannels, const int maxNumSamples) noexcept
+    {
+        return getAudioOffset() + sizeof (float) * (size_t) numChannels * (size_t) maxNumSamples;
+    }
+
+    static size_t getParameterChangeOffset (const int numChannels, const int maxNumSamples) noexcept
+    {
+        return getMidiOffset (numChannels, maxNumSamples) + midiCapacity;
+    }
+
+    char* getData (const size_t offset) const noexcept
+    {
+        return reinterpret_cast <char*> (header) + offset;
+    }
+
+    uint8* getMidiData() const noexcept
+    {
+        return reinterpret_cast <uint8*> (getData (getMidiOffset (numChannels, maxNumSamples)));
+    }
+
+    ParameterChangeBuffer::Change* getParameterChanges() const noexcept
+    {
+        return reinterpret_cast <ParameterChangeBuffer::Change*> (getData (getParameterChangeOffset (numChannels, maxNumSamples)));
+    }
+
+    // Each event is stored as its time, its size and then its data. Events that
+    // don't fit are dropped.
+    int writeMidi (const MidiBuffer& midi, const int startSample, const int numSamples) const noexcept
+    {
+        uint8* const dest = getMidiData();
+        int numBytesUsed = 0;
+
+        MidiBuffer::Iterator i (midi);
+        i.setNextSamplePosition (startSample);
+
+        const uint8* data;
+        int numBytes, samplePosition;
+
+        while (i.getNextEvent (data, numBytes, samplePosition))
+        {
+            if (samplePosition >= startSample + numSamples)
+                break;
+
+            const int32 eventHeader[2] = { samplePosition - startSample, numBytes };
+
+            if (numBytesUsed + (int) sizeof (eventHeader) + numBytes > midiCapacity)
+                break;
+
+            memcpy (dest + numBytesUsed, eventHeader, sizeof (eventHeader));
+            memcpy (dest + numBytesUsed + sizeof (eventHeader), data, (size_t) numBytes);
+            numBytesUsed += (int) sizeof (eventHeader) + numBytes;
+        }
+
+        return numBytesUsed;
+    }
+
+    // The byte count and the events come from the other side, so they're kept within
+    // the MIDI area and the block.
+    void readMidi (MidiBuffer& midi, const int numBytes, const int timeOffset, const int numSamples) const noexcept
+    {
+        const uint8* const src = getMidiData();
+        const int numBytesAvailable = jlimit (0, (int) midiCapacity, numBytes);
+        int pos = 0;
+
+        while (pos + 8 <= numBytesAvailable)
+        {
+            int32 eventHeader[2];
+            memcpy (eventHeader, src + pos, sizeof (eventHeader));
+            pos += (int) sizeof (eventHeader);
+
+            if (eventHeader[1] <= 0 || pos + eventHeader[1] > numBytesAvailable)
+                break;
+
+            midi.addEvent (src + pos, eventHeader[1], jlimit (0, jmax (0, numSamples - 1), eventHeader[0]) + timeOffset);
+            pos += eventHeader[1];
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (AudioTransport)
+};
+
+//==============================================================================
+class SandboxedPluginInstance::Connection  : public InterprocessConnection
+{
+public:
+    Connection (SandboxedPluginInstance& o)
+        : InterprocessConnection (false, SandboxHelpers::magicMessageHeader),
+          owner (o)
+    {
+    }
+
+    ~Connection()
+    {
+        disconnect();
+    }
+
+    XmlElement* sendRequest (const XmlElement& request, const int timeoutMs)
+    {
+        XmlElement message (request);
+        message.setAttribute ("id", ++lastRequestId);
+
+        {
+            const ScopedLock sl (replyLock);
+            reply = nullptr;
+            replyReceived.reset();
+        }
+
+        if (! sendMessage (SandboxHelpers::toMemoryBlock (message)))
+            return nullptr;
+
+        const uint32 startTime = Time::getMillisecondCounter();
+
+        while (! replyReceived.wait (50))
+            if (owner.hasWorkerFailed() || (int) (Time::getMillisecondCounter() - startTime) > timeoutMs)
+                return nullptr;
+
+        const ScopedLock sl (replyLock);
+        return reply.release();
+    }
+
+    void connectionMade() override {}
+
+    void connectionLost() override
+    {
+        owner.setWorkerFailed();
+    }
+
+    void messageReceived (const MemoryBlock& message) override
+    {
+        ScopedPointer<XmlElement> xml (XmlDocument::parse (message.toString()));
+
+        // replies to requests that have already timed out are ignored
+        if (xml != nullptr && xml->getIntAttribute ("id") == lastRequestId.get())
+        {
+            const ScopedLock sl (replyLock);
+            reply = xml;
+            replyReceived.signal();
+        }
+    }
+
+private:
+    SandboxedPluginInstance& owner;
+    CriticalSection replyLock;
+    ScopedPointer<XmlElement> reply;
+    WaitableEvent replyReceived;
+    Atomic<int> lastRequestId;
+
+    JUCE_DECLARE_NON_COPYABLE (Connection)
+};
+
+//==============================================================================
+// Reads and discards anything that the worker prints, so that its output pipe
+// never fills up. When the pipe closes, the worker has gone away.
+class SandboxedPluginInstance::OutputReader  : public Thread
+{
+public:
+    OutputReader (SandboxedPluginInstance& o)
+        : Thread ("Plugin sandbox output"), owner (o)
+    {
+        startThread();
+    }
+
+    ~OutputReader()
+    {
+        stopThread (5000);
+    }
+
+    void run() override
+    {
+        char buffer [1024];
+
+        while (! threadShouldExit())
+            if (owner.process.readProcessOutput (buffer, sizeof (buffer)) <= 0)
+                break;
+
+        if (! threadShouldExit())
+            owner.setWorkerFailed();
+    }
+
+private:
+    SandboxedPluginInstance& owner;
+
+    JUCE_DECLARE_NON_COPYABLE (OutputReader)
+};
+
+//==============================================================================
+SandboxedPluginInstance::SandboxedPluginInstance (const int timeout)
+    : timeoutMs (timeout),
+      currentProgram (0),
+      tailLengthSeconds (0),
+      pluginAcceptsMidi (false),
+      pluginProducesMidi (false),
+      pluginSilenceInProducesSilenceOut (false),
+      pendingParameterChanges ((int) AudioTransport::maxParameterChanges)
+{
+    blockParameterChanges.malloc ((size_t) AudioTransport::maxParameterChanges);
+}
+
+SandboxedPluginInstance::~SandboxedPluginInstance()
+{
+    if (connection != nullptr && ! hasWorkerFailed())
+        sendSimpleRequest ("QUIT");
+
+    connection = nullptr;
+
+    if (outputReader != nullptr)
+        outputReader->signalThreadShouldExit();
+
+    if (! process.waitForProcessToFinish (1000))
+        process.kill();
+
+    outputReader = nullptr;
+    closeSharedMemory();
+}
+
+SandboxedPluginInstance* SandboxedPluginInstance::create (const StringArray& workerCommand,
+                                                          const PluginDescription& desc,
+                                                          const double initialSampleRate,
+                                                          const int initialBufferSize,
+                                                          String& errorMessage,
+                                                          const int timeout)
+{
+    jassert (workerCommand.size() > 0);
+
+    ScopedPointer<SandboxedPluginInstance> instance (new SandboxedPluginInstance (timeout));
+    instance->setPlayConfigDetails (desc.numInputChannels, desc.numOutputChannels,
+                                    initialSampleRate, initialBufferSize);
+
+    if (instance->launchWorker (workerCommand, errorMessage)
+         && instance->loadPlugin (desc, errorMessage))
+        return instance.release();
+
+    return nullptr;
+}
+
+bool SandboxedPluginInstance::launchWorker (const StringArray& workerCommand, String& errorMessage)
+{
+    const String pipeName ("juce_plugin_sandbox_" + String::toHexString (Random::getSystemRandom().nextInt64()));
+
+    connection = new Connection (*this);
+
+    if (! connection->createPipe (pipeName, timeoutMs))
+    {
+        errorMessage = "Couldn't create a pipe to talk to the plugin worker";
+        return false;
+    }
+
+    StringArray args (workerCommand);
+    args.add (SandboxHelpers::commandLineArgument);
+    args.add (pipeName);
+
+    if (! process.start (args))
+    {
+        errorMessage = "Couldn't launch the plugin worker process";
+        return false;
+    }
+
+    outputReader = new OutputReader (*this);
+    return true;
+}
+
+bool SandboxedPluginInstance::loadPlugin (const PluginDescription& desc, String& errorMessage)
+{
+    XmlElement request ("LOAD");
+    request.setAttribute ("sampleRate", getSampleRate());
+    request.setAttribute ("blockSize", getBlockSize());
+    request.addChildElement (desc.createXml());
+
+    ScopedPointer<XmlElement> reply (sendRequest (request));
+
+    if (reply == nullptr)
+    {
+        errorMessage = "The plugin worker process didn't respond";
+        return false;
+    }
+
+    if (! reply->hasTagName ("INFO"))
+    {
+        errorMessage = reply->getStringAttribute ("message", "The plugin couldn't be loaded");
+        return false;
+    }
+
+    description = desc;
+    updateFromWorkerInfo (*reply);
+    return true;
+}
+
+XmlElement* SandboxedPluginInstance::sendRequest (const XmlElement& request)
+{
+    const ScopedLock sl (requestLock);
+
+    if (connection == nullptr || hasWorkerFailed())
+        return nullptr;
+
+    XmlElement* const reply = connection->sendRequest (request, timeoutMs);
+
+    if (reply == nullptr)
+    {
+        // the worker has crashed or hung, so make sure it's gone
+        setWorkerFailed();
+        process.kill();
+    }
+
+    return reply;
+}
+
+bool SandboxedPluginInstance::sendSimpleRequest (const String& type)
+{
+    ScopedPointer<XmlElement> reply (sendRequest (XmlElement (type)));
+    return reply != nullptr && ! reply->hasTagName ("ERROR");
+}
+
+void SandboxedPluginInstance::setWorkerFailed()
+{
+    workerFailed = 1;
+}
+
+void SandboxedPluginInstance::updateFromWorkerInfo (const XmlElement& info)
+{
+    if (const XmlElement* const desc = info.getChildByName ("PLUGIN"))
+        description.loadFromXml (*desc);
+
+    const ScopedLock sl (getCallbackLock());
+
+    parameterNames.clear();
+    parameterValues.clearQuick();
+    programNames.clear();
+
+    forEachXmlChildElementWithTagName (info, e, "PARAM")
+    {
+        parameterNames.add (e->getStringAttribute ("name"));
+        parameterValues.add ((float) e->getDoubleAttribute ("value"));
+    }
+
+    forEachXmlChildElementWithTagName (info, e, "PROGRAM")
+        programNames.add (e->getStringAttribute ("name"));
+
+    currentProgram = info.getIntAttribute ("currentProgram");
+    tailLengthSeconds = info.getDoubleAttribute ("tailLength");
+    pluginAcceptsMidi = info.getBoolAttribute ("acceptsMidi");
+    pluginProducesMidi = info.getBoolAttribute ("producesMidi");
+    pluginSilenceInProducesSilenceOut = info.getBoolAttribute ("silenceInProducesSilenceOut");
+
+    setPlayConfigDetails (info.getIntAttribute ("numInputs"), info.getIntAttribute ("numOutputs"),
+                          getSampleRate(), getBlockSize());
+    setLatencySamples (info.getIntAttribute ("latency"));
+}
+
+void SandboxedPluginInstance::closeSharedMemory()
+{
+    {
+        const ScopedLock sl (getCallbackLock());
+        transport = nullptr;
+    }
+
+    sharedMemory = nullptr;
+
+    if (sharedMemoryFile != File::nonexistent)
+    {
+        sharedMemoryFile.deleteFile();
+        sharedMemoryFile = File::nonexistent;
+    }
+}
+
+//==============================================================================
+void SandboxedPluginInstance::fillInPluginDescription (PluginDescription& desc) const
+{
+    desc = description;
+}
+
+const String SandboxedPluginInstance::getName() const
+{
+    return description.name;
+}
+
+void SandboxedPluginInstance::prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)
+{
+    closeSharedMemory();
+
+    if (hasWorkerFailed())
+        return;
+
+    const int numChannels = jmax (1, getNumInputChannels(), getNumOutputChannels());
+    const int maxNumSamples = jmax (64, estimatedSamplesPerBlock);
+    const size_t size = AudioTransport::getRequiredSize (numChannels, maxNumSamples);
+
+   #if JUCE_LINUX
+    const File sharedMemoryDir ("/dev/shm");
+
+    if (sharedMemoryDir.isDirectory())
+        sharedMemoryFile = sharedMemoryDir.getNonexistentChildFile ("juce_plugin_sandbox", ".tmp", false);
+    else
+   #endif
+        sharedMemoryFile = File::getSpecialLocation (File::tempDirectory)
+                               .getNonexistentChildFile ("juce_plugin_sandbox", ".tmp", false);
+
+    {
+        FileOutputStream out (sharedMemoryFile);
+
+        if (out.openedOk())
+            out.writeRepeatedByte (0, size);
+    }
+
+    sharedMemory = new MemoryMappedFile (sharedMemoryFile, MemoryMappedFile::readWrite);
+
+    if (sharedMemory->getData() == nullptr || sharedMemory->getSize() < size)
+    {
+        jassertfalse; // couldn't create the shared memory file
+        closeSharedMemory();
+        return;
+    }
+
+    ScopedPointer<AudioTransport> newTransport (new AudioTransport (sharedMemory->getData(), sharedMemory->getSize(),
+                                                                    sharedMemoryFile.getFileNameWithoutExtension(),
+                                                                    numChannels, maxNumSamples));
+
+    XmlElement request ("PREPARE");
+    request.setAttribute ("sampleRate", sampleRate);
+    request.setAttribute ("blockSize", estimatedSamplesPerBlock);
+    request.setAttribute ("numInputs", getNumInputChannels());
+    request.setAttribute ("numOutputs", getNumOutputChannels());
+    request.setAttribute ("sharedMemory", sharedMemoryFile.getFullPathName());
+
+    ScopedPointer<XmlElement> reply (sendRequest (request));
+
+    if (reply == nullptr || ! reply->hasTagName ("INFO"))
+    {
+        closeSharedMemory();
+        return;
+    }
+
+    updateFromWorkerInfo (*reply);
+    midiOutput.ensureSize (AudioTransport::midiCapacity);
+
+    const ScopedLock sl (getCallbackLock());
+    transport = newTransport;
+}
+
+void SandboxedPluginInstance::releaseResources()
+{
+    if (transport != nullptr)
+        sendSimpleRequest ("RELEASE");
+
+    closeSharedMemory();
+}
+
+void SandboxedPluginInstance::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    if (transport == nullptr || hasWorkerFailed())
+    {
+        buffer.clear();
+        midiMessages.clear();
+        return;
+    }
+
+    // Changes set from other threads all happen at the start of the block, so they go
+    // first, followed by the host's timestamped ones, which are already in time order.
+    int numChanges = 0;
+
+    while (numChanges < AudioTransport::maxParameterChanges
+            && pendingParameterChanges.pop (blockParameterChanges [numChanges]))
+        ++numChanges;
+
+    const ParameterChangeBuffer& changes = getParameterChanges();
+
+    for (int i = 0; i < changes.getNumChanges() && numChanges < AudioTransport::maxParameterChanges; ++i)
+    {
+        const ParameterChangeBuffer::Change& c = changes.getChange (i);
+        blockParameterChanges [numChanges++] = c;
+
+        if (isPositiveAndBelow (c.parameterIndex, parameterValues.size()))
+            parameterValues.setUnchecked (c.parameterIndex, c.value);
+    }
+
+    midiOutput.clear();
+
+    for (int start = 0; start < numSamples;)
+    {
+        const int numThisTime = jmin (numSamples - start, transport->getMaxNumSamples());
+
+        if (! transport->process (buffer, start, numThisTime, midiMessages, midiOutput,
+                                  blockParameterChanges, numChanges,
+                                  SandboxHelpers::getAudioTimeoutMs (numThisTime, getSampleRate())))
+        {
+            setWorkerFailed();
+            process.kill();
+            buffer.clear();
+            midiMessages.clear();
+            return;
+        }
+
+        start += numThisTime;
+    }
+
+    midiMessages.swapWith (midiOutput);
+}
+
+void SandboxedPluginInstance::reset()
+{
+    sendSimpleRequest ("RESET");
+}
+
+bool SandboxedPluginInstance::wantsSampleAccurateParameterChanges() const   { return true; }
+
+//==============================================================================
+const String SandboxedPluginInstance::getInputChannelName (int index) const     { return String (index + 1); }
+const String SandboxedPluginInstance::getOutputChannelName (int index) const    { return String (index + 1); }
+bool SandboxedPluginInstance::isInputChannelStereoPair (int) const              { return true; }
+bool SandboxedPluginInstance::isOutputChannelStereoPair (int) const             { return true; }
+bool SandboxedPluginInstance::silenceInProducesSilenceOut() const               { return pluginSilenceInProducesSilenceOut; }
+double SandboxedPluginInstance::getTailLengthSeconds() const                    { return tailLengthSeconds; }
+bool SandboxedPluginInstance::acceptsMidi() const                               { return pluginAcceptsMidi; }
+bool SandboxedPluginInstance::producesMidi() const                              { return pluginProducesMidi; }
+bool SandboxedPluginInstance::hasEditor() const                                 { return false; }
+AudioProcessorEditor* SandboxedPluginInstance::createEditor()                   { return nullptr; }
+
+//==============================================================================
+int SandboxedPluginInstance::getNumParameters()
+{
+    return parameterNames.size();
+}
+
+const String SandboxedPluginInstance::getParameterName (int index)
+{
+    return parameterNames [index];
+}
+
+float SandboxedPluginInstance::getParameter (int index)
+{
+    return parameterValues [index];
+}
+
+const String SandboxedPluginInstance::getParameterText (int index)
+{
+    XmlElement request ("PARAMTEXT");
+    request.setAttribute ("index", index);
+
+    ScopedPointer<XmlElement> reply (sendRequest (request));
+
+    if (reply != nullptr && reply->hasTagName ("TEXT"))
+        return reply->getStringAttribute ("text");
+
+    return String (getParameter (index), 2);
+}
+
+void SandboxedPluginInstance::setParameter (int index, float newValue)
+{
+    if (isPositiveAndBelow (index, parameterValues.size()))
+        parameterValues.setUnchecked (index, newValue);
+
+    if (transport != nullptr)
+    {
+        const ParameterChangeBuffer::Change change = { 0, index, newValue };
+
+        if (pendingParameterChanges.push (change))
+            return;
+    }
+
+    // when the worker isn't playing, the change has to be sent directly
+    XmlElement request ("SETPARAM");
+    request.setAttribute ("index", index);
+    request.setAttribute ("value", newValue);
+
+    ScopedPointer<XmlElement> reply (sendRequest (request));
+}
+
+//==============================================================================
+int SandboxedPluginInstance::getNumPrograms()
+{
+    return programNames.size();
+}
+
+int SandboxedPluginInstance::getCurrentProgram()
+{
+    return currentProgram;
+}
+
+void SandboxedPluginInstance::setCurrentProgram (int index)
+{
+    XmlElement request ("SETPROGRAM");
+    request.setAttribute ("index", index);
+
+    ScopedPointer<XmlElement> reply (sendRequest (request));
+
+    if (reply != nullptr && reply->hasTagName ("INFO"))
+        updateFromWorkerInfo (*reply);
+}
+
+const String SandboxedPluginInstance::getProgramName (int index)
+{
+    return programNames [index];
+}
+
+void SandboxedPluginInstance::changeProgramName (int index, const String& newName)
+{
+    XmlElement request ("CHANGEPROGRAMNAME");
+    request.setAttribute ("index", index);
+    request.setAttribute ("name", newName);
+
+    ScopedPointer<XmlElement> reply (sendRequest (request));
+
+    if (reply != nullptr && ! reply->hasTagName ("ERROR"))
+        programNames.set (index, newName);
+}
+
+//==============================================================================
+static void getStateFromReply (XmlElement* const reply, juce::MemoryBlock& destData)
+{
+    ScopedPointer<XmlElement> xml (reply);
+
+    if (xml != nullptr && xml->hasTagName ("STATE"))
+        destData.fromBase64Encoding (xml->getStringAttribute ("data"));
+    else
+        destData.setSize (0);
+}
+
+void SandboxedPluginInstance::getStateInformation (juce::MemoryBlock& destData)
+{
+    XmlElement request ("GETSTATE");
+    request.setAttribute ("program", false);
+    getStateFromReply (sendRequest (request), destData);
+}
+
+void SandboxedPluginInstance::getCurrentProgramStateInformation (juce::MemoryBlock& destData)
+{
+    XmlElement request ("GETSTATE");
+    request.setAttribute ("program", true);
+    getStateFromReply (sendRequest (request), destData);
+}
+
+void SandboxedPluginInstance::setStateInformation (const void* data, int sizeInBytes)
+{
+    XmlElement request ("SETSTATE");
+    request.setAttribute ("program", false);
+    request.setAttribute ("data", juce::MemoryBlock (data, (size_t) sizeInBytes).toBase64Encoding());
+
+    ScopedPointer<XmlElement> reply (sendRequest (request));
+
+    if (reply != nullptr && reply->hasTagName ("INFO"))
+        updateFromWorkerInfo (*reply);
+}
+
+void SandboxedPluginInstance::setCurrentProgramStateInformation (const void* data, int sizeInBytes)
+{
+    XmlElement request ("SETSTATE");
+    request.setAttribute ("program", true);
+    request.setAttribute ("data", juce::MemoryBlock (data, (size_t) sizeInBytes).toBase64Encoding());
+
+    ScopedPointer<XmlElement> reply (sendRequest (request));
+
+    if (reply != nullptr && reply->hasTagName ("INFO"))
+        updateFromWorkerInfo (*reply);
+}
+
+//==============================================================================
+// The worker end: loads the plugin, answers requests from the host on the
+// message thread, and processes audio on a thread of its own.
+class SandboxedPluginInstance::Worker  : public InterprocessConnection
+{
+public:
+    Worker (AudioPluginFormatManager& fm)
+        // plugins expect to be loaded and have their state changed on the message thread,
+        // which runWorkerIfRequested() keeps running. Without modal loops it can't do that,
+        // so the requests are answered on the connection's thread instead.
+        : InterprocessConnection (JUCE_MODAL_LOOPS_PERMITTED != 0, SandboxHelpers::magicMessageHeader),
+          formatManager (fm),
+          audioThread (*this),
+          scratchBuffer (1, 1),
+          numChannels (0)
+    {
+    }
+
+    ~Worker()
+    {
+        release();
+        disconnect();
+        plugin = nullptr;
+    }
+
+    bool isFinished() const noexcept    { return finished.get() != 0; }
+
+    void connectionMade() override {}
+    void connectionLost() override      { finished = 1; }
+
+    void messageReceived (const MemoryBlock& message) override
+    {
+        ScopedPointer<XmlElement> request (XmlDocument::parse (message.toString()));
+
+        if (request == nullptr)
+            return;
+
+        ScopedPointer<XmlElement> reply (handleRequest (*request));
+
+        if (reply == nullptr)
+            reply = new XmlElement ("OK");
+
+        reply->setAttribute ("id", request->getIntAttribute ("id"));
+        sendMessage (SandboxHelpers::toMemoryBlock (*reply));
+
+        if (request->hasTagName ("QUIT"))
+            finished = 1;
+    }
+
+private:
+    struct AudioThread  : public juce::Thread
+    {
+        AudioThread (Worker& w)  : juce::Thread ("Plugin sandbox audio"), owner (w) {}
+
+        void run() override
+        {
+            while (! threadShouldExit())
+                if (owner.transport->waitForRequest (100))
+                    owner.transport->serveRequest (*owner.plugin, owner.channels, owner.numChannels, owner.midiBuffer);
+        }
+
+        Worker& owner;
+
+        JUCE_DECLARE_NON_COPYABLE (AudioThread)
+    };
+
+    AudioPluginFormatManager& formatManager;
+    AudioThread audioThread;
+    ScopedPointer<AudioPluginInstance> plugin;
+    ScopedPointer<MemoryMappedFile> sharedMemory;
+    ScopedPointer<AudioTransport> transport;
+    AudioSampleBuffer scratchBuffer;
+    HeapBlock<float*> channels;
+    int numChannels;
+    MidiBuffer midiBuffer;
+    Atomic<int> finished;
+
+    XmlElement* handleRequest (const XmlElement& request)
+    {
+        if (request.hasTagName ("LOAD"))
+        {
+            PluginDescription desc;
+
+            if (const XmlElement* const descXml = request.getFirstChildElement())
+                desc.loadFromXml (*descXml);
+
+            String error;
+            plugin = formatManager.createPluginInstance (desc, error);
+
+            if (plugin == nullptr)
+                return SandboxHelpers::createError (error.isNotEmpty() ? error : String ("The plugin couldn't be loaded"));
+
+            plugin->setPlayConfigDetails (plugin->getNumInputChannels(), plugin->getNumOutputChannels(),
+                                          request.getDoubleAttribute ("sampleRate"),
+                                          request.getIntAttribute ("blockSize"));
+            return createInfo();
+        }
+
+        if (request.hasTagName ("QUIT"))
+            return nullptr;
+
+        if (plugin == nullptr)
+            return SandboxHelpers::createError ("No plugin has been loaded");
+
+        if (request.hasTagName ("PREPARE"))         return prepare (request);
+        if (request.hasTagName ("RELEASE"))         { release(); return nullptr; }
+        if (request.hasTagName ("RESET"))           { plugin->reset(); return nullptr; }
+
+        if (request.hasTagName ("SETPARAM"))
+        {
+            plugin->setParameter (request.getIntAttribute ("index"),
+                                  (float) request.getDoubleAttribute ("value"));
+            return nullptr;
+        }
+
+        if (request.hasTagName ("PARAMTEXT"))
+        {
+            XmlElement* const e = new XmlElement ("TEXT");
+            e->setAttribute ("text", plugin->getParameterText (request.getIntAttribute ("index")));
+            return e;
+        }
+
+        if (request.hasTagName ("SETPROGRAM"))
+        {
+            plugin->setCurrentProgram (request.getIntAttribute ("index"));
+            return createInfo();
+        }
+
+        if (request.hasTagName ("CHANGEPROGRAMNAME"))
+        {
+            plugin->changeProgramName (request.getIntAttribute ("index"),
+                                       request.getStringAttribute ("name"));
+            return nullptr;
+        }
+
+        if (request.hasTagName ("GETSTATE"))
+        {
+            juce::MemoryBlock data;
+
+            if (request.getBoolAttribute ("program"))
+                plugin->getCurrentProgramStateInformation (data);
+            else
+                plugin->getStateInformation (data);
+
+            XmlElement* const e = new XmlElement ("STATE");
+            e->setAttribute ("data", data.toBase64Encoding());
+            return e;
+        }
+
+        if (request.hasTagName ("SETSTATE"))
+        {
+            juce::MemoryBlock data;
+            data.fromBase64Encoding (request.getStringAttribute ("data"));
+
+            if (request.getBoolAttribute ("program"))
+                plugin->setCurrentProgramStateInformation (data.getData(), (int) data.getSize());
+            else
+                plugin->setStateInformation (data.getData(), (int) data.getSize());
+
+            return createInfo();
+        }
+
+        return SandboxHelpers::createError ("Unknown request");
+    }
+
+    XmlElement* createInfo() const
+    {
+        XmlElement* const info = new XmlElement ("INFO");
+
+        PluginDescription desc;
+        plugin->fillInPluginDescription (desc);
+        info->addChildElement (desc.createXml());
+
+        info->setAttribute ("numInputs", plugin->getNumInputChannels());
+        info->setAttribute ("numOutputs", plugin->getNumOutputChannels());
+        info->setAttribute ("latency", plugin->getLatencySamples());
+        info->setAttribute ("tailLength", plugin->getTailLengthSeconds());
+        info->setAttribute ("acceptsMidi", plugin->acceptsMidi());
+        info->setAttribute ("producesMidi", plugin->producesMidi());
+        info->setAttribute ("silenceInProducesSilenceOut", plugin->silenceInProducesSilenceOut());
+        info->setAttribute ("currentProgram", plugin->getCurrentProgram());
+
+        for (int i = 0; i < plugin->getNumParameters(); ++i)
+        {
+            XmlElement* const e = info->createNewChildElement ("PARAM");
+            e->setAttribute ("name", plugin->getParameterName (i));
+            e->setAttribute ("value", plugin->getParameter (i));
+        }
+
+        for (int i = 0; i < plugin->getNumPrograms(); ++i)
+            info->createNewChildElement ("PROGRAM")->setAttribute ("name", plugin->getProgramName (i));
+
+        return info;
+    }
+
+    XmlElement* prepare (const XmlElement& request)
+    {
+        release();
+
+        const double sampleRate = request.getDoubleAttribute ("sampleRate");
+        const int blockSize = request.getIntAttribute ("blockSize");
+
+        const File sharedMemoryFile (request.getStringAttribute ("sharedMemory"));
+        sharedMemory = new MemoryMappedFile (sharedMemoryFile, MemoryMappedFile::readWrite);
+
+        if (sharedMemory->getData() == nullptr)
+            return SandboxHelpers::createError ("Couldn't open the shared memory");
+
+        transport = new AudioTransport (sharedMemory->getData(), sharedMemory->getSize(),
+                                        sharedMemoryFile.getFileNameWithoutExtension());
+
+        if (! transport->isValid())
+        {
+            transport = nullptr;
+            return SandboxHelpers::createError ("The shared memory block is invalid");
+        }
+
+        plugin->setPlayConfigDetails (request.getIntAttribute ("numInputs"),
+                                      request.getIntAttribute ("numOutputs"),
+                                      sampleRate, blockSize);
+        plugin->prepareToPlay (sampleRate, blockSize);
+
+        // if the plugin wants more channels than the host sent, the extra ones are
+        // given some scratch space
+        const int numShared = transport->getNumChannels();
+        numChannels = jmax (numShared, plugin->getNumInputChannels(), plugin->getNumOutputChannels());
+        scratchBuffer.setSize (jmax (1, numChannels - numShared), transport->getMaxNumSamples());
+        channels.malloc ((size_t) numChannels);
+
+        for (int i = 0; i < numChannels; ++i)
+            channels[i] = i < numShared ? transport->getChannel (i)
+                                        : scratchBuffer.getSampleData (i - numShared);
+
+        midiBuffer.ensureSize (AudioTransport::midiCapacity);
+
+        audioThread.startThread (9);
+        return createInfo();
+    }
+
+    void release()
+    {
+        if (transport != nullptr)
+        {
+            stopAudio();
+            plugin->releaseResources();
+            transport = nullptr;
+        }
+
+        sharedMemory = nullptr;
+    }
+
+    void stopAudio()
+    {
+        audioThread.stopThread (5000);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+bool SandboxedPluginInstance::runWorkerIfRequested (AudioPluginFormatManager& formatManager,
+                                                    const StringArray& args)
+{
+    const int index = args.indexOf (SandboxHelpers::commandLineArgument);
+
+    if (index < 0)
+        return false;
+
+    Worker worker (formatManager);
+
+    if (worker.connectToPipe (args [index + 1], 10000))
+    {
+       #if ! JUCE_WINDOWS
+        const pid_t parentProcess = getppid();
+       #endif
+
+        while (! worker.isFinished())
+        {
+           #if JUCE_MODAL_LOOPS_PERMITTED
+            MessageManager::getInstance()->runDispatchLoopUntil (50);
+           #else
+            Thread::sleep (50);
+           #endif
+
+           #if ! JUCE_WINDOWS
+            // stop if the host has died without saying goodbye
+            if (getppid() != parentProcess)
+                break;
+           #endif
+        }
+    }
+
+    return true;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SandboxedPluginInstanceTests  : public UnitTest
+{
+public:
+    SandboxedPluginInstanceTests()  : UnitTest ("SandboxedPluginInstance") {}
+
+    // A processor that applies a gain. If it's sample-accurate, it changes the gain at the
+    // exact sample of each parameter change, otherwise it gets them via setParameter().
+    struct GainProcessor  : public AudioProcessor
+    {
+        GainProcessor (bool isSampleAccurate = true)
+            : gain (0.5f), sampleAccurate (isSampleAccurate)
+        {
+        }
+
+        const String getName() const                    { return "Gain"; }
+        void prepareToPlay (double, int)                {}
+        void releaseResources()                         {}
+
+        void processBlock (AudioSampleBuffer& buffer, MidiBuffer&)
+        {
+            ParameterChangeBuffer::Iterator i (getParameterChanges());
+            int index, position, start = 0;
+            float value;
+
+            while (i.getNextChange (index, value, position))
+            {
+                applyGain (buffer, start, position - start);
+                setParameter (index, value);
+                start = position;
+            }
+
+            applyGain (buffer, start, buffer.getNumSamples() - start);
+        }
+
+        void applyGain (AudioSampleBuffer& buffer, int start, int num)
+        {
+            for (int i = buffer.getNumChannels(); --i >= 0;)
+                buffer.applyGain (i, start, num, gain);
+        }
+
+        bool wantsSampleAccurateParameterChanges() const    { return sampleAccurate; }
+        const String getInputChannelName (int) const        { return String::empty; }
+        const String getOutputChannelName (int) const       { return String::empty; }
+        bool isInputChannelStereoPair (int) const           { return true; }
+        bool isOutputChannelStereoPair (int) const          { return true; }
+        bool silenceInProducesSilenceOut() const            { return true; }
+        double getTailLengthSeconds() const                 { return 0; }
+        bool acceptsMidi() const                            { return true; }
+        bool producesMidi() const                           { return true; }
+        bool hasEditor() const                              { return false; }
+        AudioProcessorEditor* createEditor()                { return nullptr; }
+        int getNumParameters()                              { return 1; }
+        const String getParameterName (int)                 { return "Gain"; }
+        float getParameter (int)                            { return gain; }
+        const String getParameterText (int)                 { return String (gain); }
+        void setParameter (int, float newValue)             { gain = newValue; }
+        int getNumPrograms()                                { return 0; }
+        int getCurrentProgram()                             { return 0; }
+        void setCurrentProgram (int)                        {}
+        const String getProgramName (int)                   { return String::empty; }
+        void changeProgramName (int, const String&)         {}
+        void getStateInformation (juce::MemoryBlock&)       {}
+        void setStateInformation (const void*, int)         {}
+
+        float gain;
+        const bool sampleAccurate;
+    };
+
+    // A processor that plays the part of a worker which overwrites the layout in the header.
+    struct ScribblingProcessor  : public GainProcessor
+    {
+        ScribblingProcessor (void* memory)  : header (static_cast <int32*> (memory)) {}
+
+        void processBlock (AudioSampleBuffer& buffer, MidiBuffer& midi)
+        {
+            GainProcessor::processBlock (buffer, midi);
+            header[1] = header[2] = 0x7fffffff;
+        }
+
+        int32* const header;
+    };
+
+    // Plays the part of the worker process. It runs on a thread here, but it waits
+    // and signals in just the same way as it would in another process.
+    struct WorkerThread  : public Thread
+    {
+        WorkerThread (SandboxedPluginInstance::AudioTransport& t, AudioProcessor& p)
+            : Thread ("Sandbox test worker"), transport (t), processor (p)
+        {
+            for (int i = 0; i < transport.getNumChannels(); ++i)
+                channels.add (transport.getChannel (i));
+        }
+
+        void run() override
+        {
+            MidiBuffer midi;
+
+            while (! threadShouldExit())
+                if (transport.waitForRequest (10))
+                    transport.serveRequest (processor, channels.getRawDataPointer(), channels.size(), midi);
+        }
+
+        SandboxedPluginInstance::AudioTransport& transport;
+        AudioProcessor& processor;
+        Array<float*> channels;
+    };
+
+    static void fillBuffer (AudioSampleBuffer& buffer)
+    {
+        for (int i = buffer.getNumChannels(); --i >= 0;)
+            FloatVectorOperations::fill (buffer.getSampleData (i), 1.0f, buffer.getNumSamples());
+    }
+
+    static String createSignalName()
+    {
+        return "juce_sandbox_test_" + String::toHexString (Random::getSystemRandom().nextInt64());
+    }
+
+    void runTest()
+    {
+        typedef SandboxedPluginInstance::AudioTransport AudioTransport;
+
+        const int numChannels = 2, blockSize = 256, numBlocks = 2000;
+        const size_t size = AudioTransport::getRequiredSize (numChannels, blockSize);
+        HeapBlock<char> sharedMemory (size, true);
+        const String signalName (createSignalName());
+
+        AudioTransport hostSide (sharedMemory, size, signalName, numChannels, blockSize);
+        AudioTransport workerSide (sharedMemory, size, signalName);
+
+        GainProcessor inProcessGain, sandboxedGain;
+        sandboxedGain.setPlayConfigDetails (numChannels, numChannels, 44100.0, blockSize);
+        WorkerThread worker (workerSide, sandboxedGain);
+        worker.startThread();
+
+        AudioSampleBuffer buffer (numChannels, blockSize);
+        MidiBuffer midiIn, midiOut;
+
+        beginTest ("Shared memory transport");
+        {
+            expect (workerSide.isValid());
+            fillBuffer (buffer);
+            midiIn.addEvent (MidiMessage::noteOn (1, 60, 0.5f), 10);
+
+            const ParameterChangeBuffer::Change change = { 100, 0, 0.25f };
+
+            expect (hostSide.process (buffer, 0, blockSize, midiIn, midiOut, &change, 1, 5000));
+            expectEquals (buffer.getSampleData (1)[50], 0.5f);
+            expectEquals (buffer.getSampleData (1)[200], 0.25f);
+            expectEquals (sandboxedGain.gain, 0.25f);
+
+            MidiBuffer::Iterator i (midiOut);
+            MidiMessage message;
+            int position;
+            expect (i.getNextEvent (message, position) && message.isNoteOn() && position == 10);
+        }
+
+        beginTest ("Several changes for a processor without timestamps");
+        {
+            // a processor that hasn't asked for timestamped changes gets each one as soon
+            // as it arrives, so it must get them in order to end up with the last value
+            HeapBlock<char> otherMemory (size, true);
+            const String otherSignalName (createSignalName());
+
+            AudioTransport otherHostSide (otherMemory, size, otherSignalName, numChannels, blockSize);
+            AudioTransport otherWorkerSide (otherMemory, size, otherSignalName);
+
+            GainProcessor untimedGain (false);
+            untimedGain.setPlayConfigDetails (numChannels, numChannels, 44100.0, blockSize);
+            WorkerThread otherWorker (otherWorkerSide, untimedGain);
+            otherWorker.startThread();
+
+            const ParameterChangeBuffer::Change changes[] = { { 0,  0, 0.1f },
+                                                              { 10, 0, 0.2f },
+                                                              { 10, 0, 0.3f },
+                                                              { 20, 0, 0.75f } };
+            MidiBuffer noMidi;
+            fillBuffer (buffer);
+
+            expect (otherHostSide.process (buffer, 0, blockSize, noMidi, midiOut, changes, 4, 5000));
+            expectEquals (untimedGain.gain, 0.75f);
+            expectEquals (buffer.getSampleData (0)[0], 0.75f);
+            expectEquals (buffer.getSampleData (1)[blockSize - 1], 0.75f);
+
+            otherWorker.stopThread (5000);
+            midiOut.clear();
+        }
+
+        beginTest ("A worker that overwrites the header");
+        {
+            HeapBlock<char> otherMemory (size, true);
+            const String otherSignalName (createSignalName());
+
+            AudioTransport otherHostSide (otherMemory, size, otherSignalName, numChannels, blockSize);
+            AudioTransport otherWorkerSide (otherMemory, size, otherSignalName);
+
+            ScribblingProcessor scribbler (otherMemory);
+            scribbler.setPlayConfigDetails (numChannels, numChannels, 44100.0, blockSize);
+            WorkerThread otherWorker (otherWorkerSide, scribbler);
+            otherWorker.startThread();
+
+            MidiBuffer noMidi;
+
+            for (int i = 0; i < 2; ++i)
+            {
+                fillBuffer (buffer);
+                midiOut.clear();
+
+                expect (otherHostSide.process (buffer, 0, blockSize, noMidi, midiOut, nullptr, 0, 5000));
+                expectEquals (otherHostSide.getNumChannels(), numChannels);
+                expectEquals (otherHostSide.getMaxNumSamples(), blockSize);
+                expectEquals (buffer.getSampleData (1)[blockSize - 1], 0.5f);
+            }
+
+            otherWorker.stopThread (5000);
+            midiOut.clear();
+        }
+
+        beginTest ("Audio deadline");
+        {
+            // with nobody serving the other end, a block must give up within its deadline
+            HeapBlock<char> otherMemory (size, true);
+            AudioTransport otherHostSide (otherMemory, size, createSignalName(), numChannels, blockSize);
+            MidiBuffer noMidi;
+
+            const int deadline = SandboxHelpers::getAudioTimeoutMs (blockSize, 44100.0);
+            expect (deadline > 5 && deadline <= 6 + SandboxHelpers::maxAudioOverrunMs);
+            expectEquals (SandboxHelpers::getAudioTimeoutMs (64, 48000.0), 4);
+            expectEquals (SandboxHelpers::getAudioTimeoutMs (48000, 48000.0), 1000 + SandboxHelpers::maxAudioOverrunMs);
+
+            const uint32 startTime = Time::getMillisecondCounter();
+            expect (! otherHostSide.process (buffer, 0, blockSize, noMidi, midiOut, nullptr, 0, deadline));
+            expect ((int) (Time::getMillisecondCounter() - startTime) < 1000);
+        }
+
+        beginTest ("Round-trip overhead");
+        {
+            midiIn.clear();
+            midiOut.clear();
+
+            const int64 startTime = Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                fillBuffer (buffer);
+                inProcessGain.processBlock (buffer, midiIn);
+            }
+
+            const int64 middleTime = Time::getHighResolutionTicks();
+            bool allSucceeded = true;
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                fillBuffer (buffer);
+                allSucceeded = hostSide.process (buffer, 0, blockSize, midiIn, midiOut, nullptr, 0, 5000) && allSucceeded;
+            }
+
+            const int64 endTime = Time::getHighResolutionTicks();
+            expect (allSucceeded);
+
+            const double inProcessMicros = 1.0e6 * Time::highResolutionTicksToSeconds (middleTime - startTime) / numBlocks;
+            const double sandboxedMicros = 1.0e6 * Time::highResolutionTicksToSeconds (endTime - middleTime) / numBlocks;
+
+            logMessage ("Block of " + String (blockSize) + " samples: in-process "
+                          + String (inProcessMicros, 2) + "us, sandboxed "
+                          + String (sandboxedMicros, 2) + "us, overhead "
+                          + String (sandboxedMicros - inProcessMicros, 2) + "us");
+        }
+
+        worker.stopThread (5000);
+    }
+};
+
+static SandboxedPluginInstanceTests sandboxedPluginInstanceTests;
+
+#endif
@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_SANDBOXEDPLUGININSTANCE_H_INCLUDED
+#define JUCE_SANDBOXEDPLUGININSTANCE_H_INCLUDED
+
+#include "../processors/juce_AudioPluginInstance.h"
+#include "../format/juce_AudioPluginFormatManager.h"
+
+
+//==============================================================================
+/**
+    An AudioPluginInstance that runs the real plugin inside a separate worker process,
+    so that a plugin which crashes or hangs can't take the host down with it.
+
+    The worker is your own app (or a small helper app), launched with the command you
+    supply plus some extra arguments. It must call runWorkerIfRequested() at startup,
+    which loads the plugin and serves requests until the host closes the connection.
+
+    Audio, MIDI and parameter changes are passed to the worker through a block of
+    shared memory, with no extra latency: each call to processBlock() writes the block
+    into the shared memory, wakes the worker, and waits for it to finish processing.
+    On Linux the two processes signal each other with futexes, on Windows with named
+    events, and elsewhere with named FIFOs. Other requests, such as loading the plugin
+    or getting its state, go through a named pipe.
+
+    If the worker dies or stops responding, hasWorkerFailed() returns true and the
+    processor outputs silence from then on.
+
+    The plugin's editor isn't available from the host process, so hasEditor() always
+    returns false.
+
+    E.g.
+    @code
+    // in the host:
+    String error;
+    AudioPluginInstance* instance
+        = SandboxedPluginInstance::create (File::getSpecialLocation (File::currentExecutableFile).getFullPathName(),
+                                           description, 44100.0, 512, error);
+
+    // at the start of the worker's initialise() method:
+    if (SandboxedPluginInstance::runWorkerIfRequested (formatManager, getCommandLineParameterArray()))
+    {
+        quit();
+        return;
+    }
+    @endcode
+
+    @see ChildProcessPluginScanner
+*/
+class JUCE_API  SandboxedPluginInstance  : public AudioPluginInstance
+{
+public:
+    //==============================================================================
+    /** Launches a worker process and asks it to load a plugin.
+
+        @param workerCommand        the executable to launch, followed by any arguments it needs
+        @param description          the plugin to load
+        @param initialSampleRate    the sample rate that the plugin is first prepared with
+        @param initialBufferSize    the block size that the plugin is first prepared with
+        @param errorMessage         if the plugin can't be loaded, this is set to a description
+                                    of the problem
+        @param timeoutMs            how long the worker is given to respond to each request
+                                    before it's assumed to have hung. This doesn't apply to
+                                    blocks of audio, which must come back within a couple of
+                                    block lengths
+
+        @returns a new instance, or nullptr if the worker or the plugin couldn't be started.
+                 The caller is responsible for deleting the object that is returned.
+    */
+    static SandboxedPluginInstance* create (const StringArray& workerCommand,
+                                            const PluginDescription& description,
+                                            double initialSampleRate,
+                                            int initialBufferSize,
+                                            String& errorMessage,
+                                            int timeoutMs = 10000);
+
+    /** Destructor. This tells the worker to quit, and kills it if it doesn't. */
+    ~SandboxedPluginInstance();
+
+    //==============================================================================
+    /** Returns true if the worker process has crashed, hung, or lost its connection. */
+    bool hasWorkerFailed() const noexcept                   { return workerFailed.get() != 0; }
+
+    //==============================================================================
+    /** Checks whether the command-line that a process was launched with is a request
+        from a SandboxedPluginInstance, and if so, acts as the worker for it.
+
+        This doesn't return until the host deletes the SandboxedPluginInstance (or dies).
+
+        @returns true if the process was launched as a worker, in which case it should exit
+    */
+    static bool runWorkerIfRequested (AudioPluginFormatManager& formatManager,
+                                      const StringArray& commandLineArguments);
+
+    //==============================================================================
+    /** @internal */
+    void fillInPluginDescription (PluginDescription&) const override;
+    /** @internal */
+    const String getName() const override;
+    /** @internal */
+    void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock) override;
+    /** @internal */
+    void releaseResources() override;
+    /** @internal */
+    void processBlock (AudioSampleBuffer&, MidiBuffer&) override;
+    /** @internal */
+    void reset() override;
+    /** @internal */
+    bool wantsSampleAccurateParameterChanges() const override;
+
+    /** @internal */
+    const String getInputChannelName (int channelIndex) const override;
+    /** @internal */
+    const String getOutputChannelName (int channelIndex) const override;
+    /** @internal */
+    bool isInputChannelStereoPair (int index) const override;
+    /** @internal */
+    bool isOutputChannelStereoPair (int index) const override;
+    /** @internal */
+    bool silenceInProducesSilenceOut() const override;
+    /** @internal */
+    double getTailLengthSeconds() const override;
+    /** @internal */
+    bool acceptsMidi() const override;
+    /** @internal */
+    bool producesMidi() const override;
+
+    /** @internal */
+    bool hasEditor() const override;
+    /** @internal */
+    AudioProcessorEditor* createEditor() override;
+
+    /** @internal */
+    int getNumParameters() override;
+    /** @internal */
+    const String getParameterName (int) override;
+    /** @internal */
+    float getParameter (int) override;
+    /** @internal */
+    const String getParameterText (int) override;
+    /** @internal */
+    void setParameter (int, float) override;
+
+    /** @internal */
+    int getNumPrograms() override;
+    /** @internal */
+    int getCurrentProgram() override;
+    /** @internal */
+    void setCurrentProgram (int) override;
+    /** @internal */
+    const String getProgramName (int) override;
+    /** @internal */
+    void changeProgramName (int, const String&) override;
+
+    /** @internal */
+    void getStateInformation (juce::MemoryBlock&) override;
+    /** @internal */
+    void getCurrentProgramStateInformation (juce::MemoryBlock&) override;
+    /** @internal */
+    void setStateInformation (const void*, int) override;
+    /** @internal */
+    void setCurrentProgramStateInformation (const void*, int) override;
+
+private:
+    //==============================================================================
+    class AudioTransport;
+    class Connection;
+    class OutputReader;
+    class Worker;
+    friend class Connection;
+    friend class OutputReader;
+    friend class Worker;
+    friend class SandboxedPluginInstanceTests;
+
+    const int timeoutMs;
+    ChildProcess process;
+    ScopedPointer<Connection> connection;
+    ScopedPointer<OutputReader> outputReader;
+    CriticalSection requestLock;
+    Atomic<int> workerFailed;
+
+    PluginDescription description;
+    StringArray parameterNames, programNames;
+    Array<float> parameterValues;
+    int currentProgram;
+    double tailLengthSeconds;
+    bool pluginAcceptsMidi, pluginProducesMidi, pluginSilenceInProducesSilenceOut;
+
+    File sharedMemoryFile;
+    ScopedPointer<MemoryMappedFile> sharedMemory;
+    ScopedPointer<AudioTransport> transport;
+    ConcurrentFifo<ParameterChangeBuffer::Change> pendingParameterChanges;
+    HeapBlock<ParameterChangeBuffer::Change> blockParameterChanges;
+    MidiBuffer midiOutput;
+
+    explicit SandboxedPluginInstance (int timeoutMs);
+    bool launchWorker (const StringArray& workerCommand, String& errorMessage);
+    bool loadPlugin (const PluginDescription&, String& errorMessage);
+    XmlElement* sendRequest (const XmlElement& request);
+    bool sendSimpleRequest (const String& type);
+    void updateFromWorkerInfo (const XmlElement&);
+    void closeSharedMemory();
+    void setWorkerFailed();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SandboxedPluginInstance)
+};
+
+
+#endif   // JUCE_SANDBOXEDPLUGININSTANCE_H_INCLUDED
@@ -51,6 +51,16 @@
  #endif
 #endif
 
+#if JUCE_LINUX
+ #include <unistd.h>
+ #include <sys/syscall.h>
+ #include <linux/futex.h>
+#elif JUCE_MAC
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <sys/select.h>
+#endif
+
 #if JUCE_PLUGINHOST_VST && JUCE_LINUX
  #include <X11/Xlib.h>
  #include <X11/Xutil.h>
@@ -79,10 +89,13 @@ static inline bool arrayContainsPlugin (const OwnedArray<PluginDescription>& lis
 #include "processors/juce_AudioProcessorEditor.cpp"
 #include "processors/juce_AudioProcessorGraph.cpp"
 #include "processors/juce_GenericAudioProcessorEditor.cpp"
+#include "processors/juce_ParameterChangeBuffer.cpp"
 #include "processors/juce_PluginDescription.cpp"
 #include "format_types/juce_LADSPAPluginFormat.cpp"
+#include "format_types/juce_SandboxedPluginInstance.cpp"
 #include "format_types/juce_VSTPluginFormat.cpp"
 #include "format_types/juce_AudioUnitPluginFormat.mm"
+#include "scanning/juce_ChildProcessPluginScanner.cpp"
 #include "scanning/juce_KnownPluginList.cpp"
 #include "scanning/juce_PluginDirectoryScanner.cpp"
 #include "scanning/juce_PluginListComponent.cpp"
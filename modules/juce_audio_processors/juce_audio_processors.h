@@ -72,13 +72,16 @@ namespace juce
 #include "processors/juce_AudioProcessorGraph.h"
 #include "processors/juce_AudioProcessorListener.h"
 #include "processors/juce_GenericAudioProcessorEditor.h"
+#include "processors/juce_ParameterChangeBuffer.h"
 #include "processors/juce_PluginDescription.h"
 #include "format/juce_AudioPluginFormat.h"
 #include "format/juce_AudioPluginFormatManager.h"
 #include "format_types/juce_AudioUnitPluginFormat.h"
 #include "format_types/juce_LADSPAPluginFormat.h"
+#include "format_types/juce_SandboxedPluginInstance.h"
 #include "format_types/juce_VSTMidiEventList.h"
 #include "format_types/juce_VSTPluginFormat.h"
+#include "scanning/juce_ChildProcessPluginScanner.h"
 #include "scanning/juce_KnownPluginList.h"
 #include "scanning/juce_PluginDirectoryScanner.h"
 #include "scanning/juce_PluginListComponent.h"
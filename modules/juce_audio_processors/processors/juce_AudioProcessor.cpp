@@ -24,6 +24,8 @@
 
 static ThreadLocalValue<AudioProcessor::WrapperType> wrapperTypeBeingCreated;
 
+enum { maxPendingParameterChanges = 512 };
+
 void JUCE_CALLTYPE AudioProcessor::setTypeOfNextNewPlugin (AudioProcessor::WrapperType type)
 {
     wrapperTypeBeingCreated = type;
@@ -38,7 +40,8 @@ AudioProcessor::AudioProcessor()
       numOutputChannels (0),
       latencySamples (0),
       suspended (false),
-      nonRealtime (false)
+      nonRealtime (false),
+      processingPrecision (singlePrecision)
 {
 }
 
@@ -53,6 +56,8 @@ AudioProcessor::~AudioProcessor()
     // or more parameters without having made a corresponding call to endParameterChangeGesture...
     jassert (changingParams.countNumberOfSetBits() == 0);
    #endif
+
+    delete pendingParameterChanges.get();
 }
 
 void AudioProcessor::setPlayHead (AudioPlayHead* const newPlayHead) noexcept
@@ -75,11 +80,20 @@ void AudioProcessor::removeListener (AudioProcessorListener* const listenerToRem
 void AudioProcessor::setPlayConfigDetails (const int newNumIns,
                                            const int newNumOuts,
                                            const double newSampleRate,
-                                           const int newBlockSize) noexcept
+                                           const int newBlockSize)
 {
     sampleRate = newSampleRate;
     blockSize  = newBlockSize;
 
+    // The parameter queue is only created for processors that ask for one, and once
+    // it's been published it's never replaced, so other threads can push into it
+    // without locking.
+    if (pendingParameterChanges.get() == nullptr && wantsSampleAccurateParameterChanges())
+    {
+        parameterChanges.ensureSize (maxPendingParameterChanges);
+        pendingParameterChanges = new ConcurrentFifo<ParameterChangeBuffer::Change> (maxPendingParameterChanges);
+    }
+
     if (numInputChannels != newNumIns || numOutputChannels != newNumOuts)
     {
         numInputChannels  = newNumIns;
@@ -102,6 +116,81 @@ void AudioProcessor::setNonRealtime (const bool newNonRealtime) noexcept
     nonRealtime = newNonRealtime;
 }
 
+bool AudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return false;
+}
+
+void AudioProcessor::setProcessingPrecision (const ProcessingPrecision newPrecision) noexcept
+{
+    // If you hit this assertion then you're trying to use double-precision
+    // processing on a processor which doesn't support it!
+    jassert (newPrecision != doublePrecision || supportsDoublePrecisionProcessing());
+
+    if (newPrecision == singlePrecision || supportsDoublePrecisionProcessing())
+        processingPrecision = newPrecision;
+}
+
+bool AudioProcessor::wantsSampleAccurateParameterChanges() const
+{
+    return false;
+}
+
+void AudioProcessor::scheduleParameterChange (const int parameterIndex, const float newValue,
+                                              const int samplePosition)
+{
+    if (ConcurrentFifo<ParameterChangeBuffer::Change>* const queue = pendingParameterChanges.get())
+    {
+        const ParameterChangeBuffer::Change change = { jmax (0, samplePosition), parameterIndex, newValue };
+
+        if (queue->push (change))
+            return;
+
+        // The queue has overflowed - either the host isn't calling prepareParameterChanges(),
+        // or changes are arriving far faster than blocks are being processed.
+        jassertfalse;
+    }
+
+    setParameter (parameterIndex, newValue);
+}
+
+void AudioProcessor::scheduleParameterChange (const int parameterIndex, const float newValue)
+{
+    int samplePosition = 0;
+
+    if (Thread::getCurrentThreadId() != renderThreadId.get())
+    {
+        const int64 startTicks = blockStartTicks.get();
+
+        if (startTicks != 0 && sampleRate > 0)
+            samplePosition = roundToInt (Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks)
+                                          * sampleRate);
+    }
+
+    scheduleParameterChange (parameterIndex, newValue, samplePosition);
+}
+
+void AudioProcessor::prepareParameterChanges (const int numSamples) noexcept
+{
+    parameterChanges.clear();
+
+    ConcurrentFifo<ParameterChangeBuffer::Change>* const queue = pendingParameterChanges.get();
+
+    if (queue == nullptr)
+        return;
+
+    blockStartTicks = Time::getHighResolutionTicks();
+    renderThreadId = Thread::getCurrentThreadId();
+
+    const int lastSample = jmax (0, numSamples - 1);
+    ParameterChangeBuffer::Change change;
+
+    while (parameterChanges.getNumChanges() < maxPendingParameterChanges
+            && queue->pop (change))
+        parameterChanges.addChange (change.parameterIndex, change.value,
+                                    jmin (change.samplePosition, lastSample));
+}
+
 void AudioProcessor::setLatencySamples (const int newLatency)
 {
     if (latencySamples != newLatency)
@@ -198,6 +287,16 @@ void AudioProcessor::suspendProcessing (const bool shouldBeSuspended)
 
 void AudioProcessor::reset() {}
 void AudioProcessor::processBlockBypassed (AudioSampleBuffer&, MidiBuffer&) {}
+void AudioProcessor::processBlockBypassedDouble (DoubleAudioSampleBuffer&, MidiBuffer&) {}
+
+void AudioProcessor::processBlockDouble (DoubleAudioSampleBuffer&, MidiBuffer&)
+{
+    // If you hit this assertion then either the caller called processBlockDouble()
+    // on a processor which does not support it
+    // (i.e. supportsDoublePrecisionProcessing() returns false), or the
+    // implementation of the processor forgot to override it.
+    jassertfalse;
+}
 
 //==============================================================================
 void AudioProcessor::editorBeingDeleted (AudioProcessorEditor* const editor) noexcept
@@ -28,6 +28,7 @@
 #include "juce_AudioProcessorEditor.h"
 #include "juce_AudioProcessorListener.h"
 #include "juce_AudioPlayHead.h"
+#include "juce_ParameterChangeBuffer.h"
 
 
 //==============================================================================
@@ -144,6 +145,56 @@ public:
     virtual void processBlockBypassed (AudioSampleBuffer& buffer,
                                        MidiBuffer& midiMessages);
 
+    /** Renders the next block using double-precision samples.
+
+        This is only called if supportsDoublePrecisionProcessing() returns true and
+        the host has switched the processor into double-precision mode with
+        setProcessingPrecision(). The rules for the buffer's layout and the midi
+        messages are exactly the same as for processBlock().
+
+        The buffer may refer directly to the host's own data, so processing is done
+        in-place and no conversion to floats takes place on the way in or out.
+
+        @see supportsDoublePrecisionProcessing, setProcessingPrecision
+    */
+    virtual void processBlockDouble (DoubleAudioSampleBuffer& buffer,
+                                     MidiBuffer& midiMessages);
+
+    /** The double-precision version of processBlockBypassed().
+        The default implementation leaves the buffer untouched, so that the audio is
+        passed through unchanged.
+    */
+    virtual void processBlockBypassedDouble (DoubleAudioSampleBuffer& buffer,
+                                             MidiBuffer& midiMessages);
+
+    //==============================================================================
+    /** The sample formats that a processor can be asked to render with. */
+    enum ProcessingPrecision
+    {
+        singlePrecision,    /**< processBlock() is called with an AudioSampleBuffer. */
+        doublePrecision     /**< processBlockDouble() is called with a DoubleAudioSampleBuffer. */
+    };
+
+    /** Subclasses should return true if they've overridden the double-precision
+        processBlockDouble() and can be run in doublePrecision mode.
+        The default implementation returns false.
+    */
+    virtual bool supportsDoublePrecisionProcessing() const;
+
+    /** Called by the host to choose which version of processBlock() will be used.
+
+        This must only be called while the processor isn't playing, i.e. before
+        prepareToPlay() or after releaseResources(). Asking for doublePrecision
+        from a processor that doesn't support it will be ignored.
+    */
+    void setProcessingPrecision (ProcessingPrecision newPrecision) noexcept;
+
+    /** Returns the precision that the host has asked this processor to use. */
+    ProcessingPrecision getProcessingPrecision() const noexcept         { return processingPrecision; }
+
+    /** Returns true if the host will call processBlockDouble() rather than processBlock(). */
+    bool isUsingDoublePrecision() const noexcept                        { return processingPrecision == doublePrecision; }
+
     //==============================================================================
     /** Returns the current AudioPlayHead object that should be used to find
         out the state and position of the playhead.
@@ -507,6 +558,53 @@ public:
     */
     void updateHostDisplay();
 
+    //==============================================================================
+    /** Subclasses should return true if they want parameter changes from the host to be
+        delivered as a timestamped stream, rather than by calls to setParameter().
+
+        If this returns true, changes passed to scheduleParameterChange() are queued, and
+        then handed to processBlock() in time order via getParameterChanges(). It's then
+        up to the processor to apply each one (e.g. by calling its own setParameter()
+        method) at the right sample position. The default implementation returns false.
+
+        The queue is only created for processors that return true here, when the host
+        calls setPlayConfigDetails() before playback starts, so the value returned must
+        not change after that.
+    */
+    virtual bool wantsSampleAccurateParameterChanges() const;
+
+    /** Called by the host to change a parameter at a particular sample position within
+        the next block that will be processed.
+
+        This is lock-free and can be called from any thread. If the processor's
+        wantsSampleAccurateParameterChanges() method returns false, or it hasn't been
+        prepared yet, or the queue is full, this just calls setParameter() immediately.
+    */
+    void scheduleParameterChange (int parameterIndex, float newValue, int samplePosition);
+
+    /** Called by the host to change a parameter when it has no sample position for the
+        change.
+
+        If this is called on the audio thread between blocks, the change is applied at the
+        start of the next block. If it's called from another thread, its position in the
+        next block is estimated from the time that has passed since the current one began,
+        so that a stream of changes made while the audio is running keeps its spacing.
+    */
+    void scheduleParameterChange (int parameterIndex, float newValue);
+
+    /** Called by the host on the audio thread just before each call to processBlock(),
+        to move any queued changes into the buffer returned by getParameterChanges().
+        Changes with the same position are kept in the order in which they were
+        scheduled, and positions beyond the end of the block are clipped to its last sample.
+    */
+    void prepareParameterChanges (int numSamples) noexcept;
+
+    /** Returns the parameter changes that fall within the block currently being processed.
+        This is only valid while processBlock() is being called.
+        @see scheduleParameterChange, wantsSampleAccurateParameterChanges
+    */
+    const ParameterChangeBuffer& getParameterChanges() const noexcept   { return parameterChanges; }
+
     //==============================================================================
     /** Returns the number of preset programs the filter supports.
 
@@ -598,8 +696,12 @@ public:
     void setPlayHead (AudioPlayHead* newPlayHead) noexcept;
 
     //==============================================================================
-    /** This is called by the processor to specify its details before being played. */
-    void setPlayConfigDetails (int numIns, int numOuts, double sampleRate, int blockSize) noexcept;
+    /** This is called by the processor to specify its details before being played.
+
+        If the processor wants sample-accurate parameter changes, this is also where the
+        space for them gets allocated, so it must be called before the processor is played.
+    */
+    void setPlayConfigDetails (int numIns, int numOuts, double sampleRate, int blockSize);
 
     //==============================================================================
     /** Not for public use - this is called before deleting an editor component. */
@@ -659,6 +761,11 @@ private:
     double sampleRate;
     int blockSize, numInputChannels, numOutputChannels, latencySamples;
     bool suspended, nonRealtime;
+    ProcessingPrecision processingPrecision;
+    Atomic<ConcurrentFifo<ParameterChangeBuffer::Change>*> pendingParameterChanges;
+    ParameterChangeBuffer parameterChanges;
+    Atomic<int64> blockStartTicks;
+    Atomic<Thread::ThreadID> renderThreadId;
     CriticalSection callbackLock, listenerLock;
     String inputSpeakerArrangement, outputSpeakerArrangement;
 
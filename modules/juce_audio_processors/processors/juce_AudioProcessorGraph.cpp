@@ -39,18 +39,44 @@ public:
                           const OwnedArray <MidiBuffer>& sharedMidiBuffers,
                           const int numSamples) = 0;
 
+    virtual void perform (DoubleAudioSampleBuffer& sharedBufferChans,
+                          const OwnedArray <MidiBuffer>& sharedMidiBuffers,
+                          const int numSamples) = 0;
+
     JUCE_LEAK_DETECTOR (AudioGraphRenderingOp)
 };
 
 //==============================================================================
-class ClearChannelOp : public AudioGraphRenderingOp
+/** Forwards both versions of perform() to the subclass's performOn() method, so
+    that each op only needs to be written once for either sample type.
+*/
+template <class OpType>
+class AudioGraphRenderingOpBase  : public AudioGraphRenderingOp
+{
+public:
+    AudioGraphRenderingOpBase() {}
+
+    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
+    {
+        static_cast<OpType*> (this)->performOn (sharedBufferChans, sharedMidiBuffers, numSamples);
+    }
+
+    void perform (DoubleAudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
+    {
+        static_cast<OpType*> (this)->performOn (sharedBufferChans, sharedMidiBuffers, numSamples);
+    }
+};
+
+//==============================================================================
+class ClearChannelOp : public AudioGraphRenderingOpBase<ClearChannelOp>
 {
 public:
     ClearChannelOp (const int channelNum_)
         : channelNum (channelNum_)
     {}
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    template <class BufferType>
+    void performOn (BufferType& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
     {
         sharedBufferChans.clear (channelNum, 0, numSamples);
     }
@@ -62,7 +88,7 @@ private:
 };
 
 //==============================================================================
-class CopyChannelOp : public AudioGraphRenderingOp
+class CopyChannelOp : public AudioGraphRenderingOpBase<CopyChannelOp>
 {
 public:
     CopyChannelOp (const int srcChannelNum_, const int dstChannelNum_)
@@ -70,7 +96,8 @@ public:
           dstChannelNum (dstChannelNum_)
     {}
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    template <class BufferType>
+    void performOn (BufferType& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
     {
         sharedBufferChans.copyFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
     }
@@ -82,7 +109,7 @@ private:
 };
 
 //==============================================================================
-class AddChannelOp : public AudioGraphRenderingOp
+class AddChannelOp : public AudioGraphRenderingOpBase<AddChannelOp>
 {
 public:
     AddChannelOp (const int srcChannelNum_, const int dstChannelNum_)
@@ -90,7 +117,8 @@ public:
           dstChannelNum (dstChannelNum_)
     {}
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    template <class BufferType>
+    void performOn (BufferType& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
     {
         sharedBufferChans.addFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
     }
@@ -102,14 +130,15 @@ private:
 };
 
 //==============================================================================
-class ClearMidiBufferOp : public AudioGraphRenderingOp
+class ClearMidiBufferOp : public AudioGraphRenderingOpBase<ClearMidiBufferOp>
 {
 public:
     ClearMidiBufferOp (const int bufferNum_)
         : bufferNum (bufferNum_)
     {}
 
-    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int)
+    template <class BufferType>
+    void performOn (BufferType&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int)
     {
         sharedMidiBuffers.getUnchecked (bufferNum)->clear();
     }
@@ -121,7 +150,7 @@ private:
 };
 
 //==============================================================================
-class CopyMidiBufferOp : public AudioGraphRenderingOp
+class CopyMidiBufferOp : public AudioGraphRenderingOpBase<CopyMidiBufferOp>
 {
 public:
     CopyMidiBufferOp (const int srcBufferNum_, const int dstBufferNum_)
@@ -129,7 +158,8 @@ public:
           dstBufferNum (dstBufferNum_)
     {}
 
-    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int)
+    template <class BufferType>
+    void performOn (BufferType&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int)
     {
         *sharedMidiBuffers.getUnchecked (dstBufferNum) = *sharedMidiBuffers.getUnchecked (srcBufferNum);
     }
@@ -141,7 +171,7 @@ private:
 };
 
 //==============================================================================
-class AddMidiBufferOp : public AudioGraphRenderingOp
+class AddMidiBufferOp : public AudioGraphRenderingOpBase<AddMidiBufferOp>
 {
 public:
     AddMidiBufferOp (const int srcBufferNum_, const int dstBufferNum_)
@@ -149,7 +179,8 @@ public:
           dstBufferNum (dstBufferNum_)
     {}
 
-    void perform (AudioSampleBuffer&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
+    template <class BufferType>
+    void performOn (BufferType&, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
     {
         sharedMidiBuffers.getUnchecked (dstBufferNum)
             ->addEvents (*sharedMidiBuffers.getUnchecked (srcBufferNum), 0, numSamples, 0);
@@ -162,76 +193,281 @@ private:
 };
 
 //==============================================================================
-class DelayChannelOp : public AudioGraphRenderingOp
+/** A delay line used for latency compensation.
+
+    One of these is shared by all the connections that need a delayed copy of the
+    same source channel: a WriteDelayLineOp pushes each block of the source into it,
+    and any number of ReadDelayLineOps can then pull out copies at different delays.
+
+    This base class just keeps track of the taps while the rendering sequence is being
+    built. The samples are held by a TypedDelayLine of the graph's own sample type.
+*/
+class DelayLine  : public ReferenceCountedObject
 {
 public:
-    DelayChannelOp (const int channel_, const int numSamplesDelay_)
-        : channel (channel_),
-          bufferSize (numSamplesDelay_ + 1),
-          readIndex (0), writeIndex (numSamplesDelay_)
+    DelayLine (const uint32 sourceNodeId_, const int sourceChannel_) noexcept
+        : sourceNodeId (sourceNodeId_), sourceChannel (sourceChannel_), maxDelay (0)
     {
-        buffer.calloc ((size_t) bufferSize);
     }
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    virtual ~DelayLine() {}
+
+    const uint32 sourceNodeId;
+    const int sourceChannel;
+
+    void addTap (const int delay) noexcept              { maxDelay = jmax (maxDelay, delay); }
+
+    /** Allocates the space needed for the longest tap, plus the largest block that the
+        graph will render, which is all the space the delay line will ever use.
+    */
+    virtual void allocate (int maxBlockSize) = 0;
+    virtual size_t getMemoryUsage() const noexcept = 0;
+
+protected:
+    int maxDelay;
+
+    JUCE_DECLARE_NON_COPYABLE (DelayLine)
+};
+
+//==============================================================================
+/** The ring buffer behind a DelayLine.
+
+    The data is moved in contiguous segments of the ring buffer rather than one
+    sample at a time.
+*/
+template <typename SampleType>
+class TypedDelayLine  : public DelayLine
+{
+public:
+    TypedDelayLine (const uint32 sourceNodeId_, const int sourceChannel_) noexcept
+        : DelayLine (sourceNodeId_, sourceChannel_),
+          size (0), maxBlockSize (0), writePosition (0)
     {
-        float* data = sharedBufferChans.getSampleData (channel, 0);
+    }
 
-        for (int i = numSamples; --i >= 0;)
-        {
-            buffer [writeIndex] = *data;
-            *data++ = buffer [readIndex];
+    typedef ReferenceCountedObjectPtr<TypedDelayLine> Ptr;
 
-            if (++readIndex  >= bufferSize) readIndex = 0;
-            if (++writeIndex >= bufferSize) writeIndex = 0;
-        }
+    void allocate (const int maxBlockSize_)
+    {
+        // as well as the longest delay, this needs to hold the block that's just been written
+        maxBlockSize = jmax (1, maxBlockSize_);
+        size = maxDelay + maxBlockSize;
+        buffer.calloc ((size_t) size);
+        writePosition = 0;
+    }
+
+    size_t getMemoryUsage() const noexcept              { return (size_t) size * sizeof (SampleType); }
+
+    void write (const SampleType* source, int numSamples) noexcept
+    {
+        numSamples = clampBlockSize (numSamples);
+
+        const int numBeforeWrap = jmin (numSamples, size - writePosition);
+        copySamples (buffer + writePosition, source, numBeforeWrap);
+        copySamples (buffer.getData(), source + numBeforeWrap, numSamples - numBeforeWrap);
+
+        writePosition = (writePosition + numSamples) % size;
+    }
+
+    void read (SampleType* dest, int numSamples, const int delay) const noexcept
+    {
+        numSamples = clampBlockSize (numSamples);
+
+        const int readPosition = getReadPosition (numSamples, delay);
+        const int numBeforeWrap = jmin (numSamples, size - readPosition);
+        copySamples (dest, buffer + readPosition, numBeforeWrap);
+        copySamples (dest + numBeforeWrap, buffer.getData(), numSamples - numBeforeWrap);
+    }
+
+    void readAndAdd (SampleType* dest, int numSamples, const int delay) const noexcept
+    {
+        numSamples = clampBlockSize (numSamples);
+
+        const int readPosition = getReadPosition (numSamples, delay);
+        const int numBeforeWrap = jmin (numSamples, size - readPosition);
+        addSamples (dest, buffer + readPosition, numBeforeWrap);
+        addSamples (dest + numBeforeWrap, buffer.getData(), numSamples - numBeforeWrap);
     }
 
 private:
-    HeapBlock<float> buffer;
-    const int channel, bufferSize;
-    int readIndex, writeIndex;
+    HeapBlock<SampleType> buffer;
+    int size, maxBlockSize, writePosition;
 
-    JUCE_DECLARE_NON_COPYABLE (DelayChannelOp)
+    int clampBlockSize (const int numSamples) const noexcept
+    {
+        // The delay line was sized for the block size that the graph was prepared with,
+        // and it can't be resized on the audio thread, so the graph must never be asked
+        // to render a bigger block than that.
+        jassert (numSamples <= maxBlockSize);
+        return jmin (numSamples, maxBlockSize);
+    }
+
+    int getReadPosition (const int numSamples, const int delay) const noexcept
+    {
+        jassert (numSamples + delay <= size);
+
+        const int pos = writePosition - numSamples - delay;
+        return pos < 0 ? pos + size : pos;
+    }
+
+    static void copySamples (SampleType* dest, const SampleType* src, const int num) noexcept
+    {
+        memcpy (dest, src, (size_t) num * sizeof (SampleType));
+    }
+
+    static void addSamples (SampleType* dest, const SampleType* src, const int num) noexcept
+    {
+        FloatVectorOperations::add (dest, src, num);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (TypedDelayLine)
 };
 
+//==============================================================================
+template <typename SampleType>
+class WriteDelayLineOp : public AudioGraphRenderingOpBase<WriteDelayLineOp<SampleType> >
+{
+public:
+    WriteDelayLineOp (const int channel_, TypedDelayLine<SampleType>* const delayLine_)
+        : channel (channel_), delayLine (delayLine_)
+    {}
+
+    void performOn (AudioBuffer<SampleType>& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    {
+        delayLine->write (sharedBufferChans.getSampleData (channel, 0), numSamples);
+    }
+
+    template <class OtherBufferType>
+    void performOn (OtherBufferType&, const OwnedArray <MidiBuffer>&, const int)
+    {
+        jassertfalse; // the graph can only render with the precision it was prepared for
+    }
+
+private:
+    const int channel;
+    const typename TypedDelayLine<SampleType>::Ptr delayLine;
+
+    JUCE_DECLARE_NON_COPYABLE (WriteDelayLineOp)
+};
+
+//==============================================================================
+template <typename SampleType>
+class ReadDelayLineOp : public AudioGraphRenderingOpBase<ReadDelayLineOp<SampleType> >
+{
+public:
+    ReadDelayLineOp (TypedDelayLine<SampleType>* const delayLine_, const int delay_,
+                     const int channel_, const bool addToChannel_)
+        : delayLine (delayLine_), delay (delay_),
+          channel (channel_), addToChannel (addToChannel_)
+    {}
+
+    void performOn (AudioBuffer<SampleType>& sharedBufferChans, const OwnedArray <MidiBuffer>&, const int numSamples)
+    {
+        if (addToChannel)
+            delayLine->readAndAdd (sharedBufferChans.getSampleData (channel, 0), numSamples, delay);
+        else
+            delayLine->read (sharedBufferChans.getSampleData (channel, 0), numSamples, delay);
+    }
+
+    template <class OtherBufferType>
+    void performOn (OtherBufferType&, const OwnedArray <MidiBuffer>&, const int)
+    {
+        jassertfalse; // the graph can only render with the precision it was prepared for
+    }
+
+private:
+    const typename TypedDelayLine<SampleType>::Ptr delayLine;
+    const int delay, channel;
+    const bool addToChannel;
+
+    JUCE_DECLARE_NON_COPYABLE (ReadDelayLineOp)
+};
 
 //==============================================================================
-class ProcessBufferOp : public AudioGraphRenderingOp
+class ProcessBufferOp : public AudioGraphRenderingOpBase<ProcessBufferOp>
 {
 public:
     ProcessBufferOp (const AudioProcessorGraph::Node::Ptr& node_,
                      const Array <int>& audioChannelsToUse_,
                      const int totalChans_,
-                     const int midiBufferToUse_)
+                     const int midiBufferToUse_,
+                     const bool graphIsDoublePrecision)
         : node (node_),
           processor (node_->getProcessor()),
           audioChannelsToUse (audioChannelsToUse_),
+          conversionBuffer (1, 1),
           totalChans (jmax (1, totalChans_)),
           midiBufferToUse (midiBufferToUse_)
     {
         channels.calloc ((size_t) totalChans);
+        doubleChannels.calloc ((size_t) totalChans);
 
         while (audioChannelsToUse.size() < totalChans)
             audioChannelsToUse.add (0);
+
+        // A single-precision node inside a double-precision graph has to have its
+        // data converted, so the space for that is allocated up-front here rather
+        // than on the audio thread.
+        if (graphIsDoublePrecision && ! processor->isUsingDoublePrecision())
+            conversionBuffer.setSize (totalChans, jmax (1, processor->getBlockSize()));
     }
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
+    void performOn (AudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
     {
         for (int i = totalChans; --i >= 0;)
             channels[i] = sharedBufferChans.getSampleData (audioChannelsToUse.getUnchecked (i), 0);
 
         AudioSampleBuffer buffer (channels, totalChans, numSamples);
 
+        JUCE_TRACE_ZONE_WITH_ARG ("AudioProcessorGraph node", node->nodeId);
+        processor->prepareParameterChanges (numSamples);
         processor->processBlock (buffer, *sharedMidiBuffers.getUnchecked (midiBufferToUse));
     }
 
+    void performOn (DoubleAudioSampleBuffer& sharedBufferChans, const OwnedArray <MidiBuffer>& sharedMidiBuffers, const int numSamples)
+    {
+        for (int i = totalChans; --i >= 0;)
+            doubleChannels[i] = sharedBufferChans.getSampleData (audioChannelsToUse.getUnchecked (i), 0);
+
+        DoubleAudioSampleBuffer buffer (doubleChannels, totalChans, numSamples);
+        MidiBuffer& midiMessages = *sharedMidiBuffers.getUnchecked (midiBufferToUse);
+
+        JUCE_TRACE_ZONE_WITH_ARG ("AudioProcessorGraph node", node->nodeId);
+        processor->prepareParameterChanges (numSamples);
+
+        if (processor->isUsingDoublePrecision())
+        {
+            processor->processBlockDouble (buffer, midiMessages);
+        }
+        else
+        {
+            // The conversion buffer was allocated for the block size that the graph was
+            // prepared with, so the graph must never be asked to render a bigger block.
+            jassert (numSamples <= conversionBuffer.getNumSamples());
+            const int numToConvert = jmin (numSamples, conversionBuffer.getNumSamples());
+
+            AudioSampleBuffer floatBuffer (conversionBuffer.getArrayOfChannels(), totalChans, numToConvert);
+
+            for (int i = 0; i < totalChans; ++i)
+                floatBuffer.copyFrom (i, 0, buffer, i, 0, numToConvert);
+
+            processor->processBlock (floatBuffer, midiMessages);
+
+            // only the output channels are copied back, as any others may be
+            // shared with other nodes (or be the read-only silent buffer)
+            for (int i = jmin (totalChans, processor->getNumOutputChannels()); --i >= 0;)
+                buffer.copyFrom (i, 0, floatBuffer, i, 0, numToConvert);
+        }
+    }
+
     const AudioProcessorGraph::Node::Ptr node;
     AudioProcessor* const processor;
 
 private:
     Array <int> audioChannelsToUse;
     HeapBlock <float*> channels;
+    HeapBlock <double*> doubleChannels;
+    AudioSampleBuffer conversionBuffer;
     int totalChans;
     int midiBufferToUse;
 
@@ -251,7 +487,8 @@ public:
                                    Array<void*>& renderingOps)
         : graph (graph_),
           orderedNodes (orderedNodes_),
-          totalLatency (0)
+          totalLatency (0),
+          delayLineMemory (0)
     {
         nodeIds.add ((uint32) zeroNodeID); // first buffer is read-only zeros
         channels.add (0);
@@ -267,10 +504,24 @@ public:
         }
 
         graph.setLatencySamples (totalLatency);
+
+        for (int i = 0; i < delayLines.size(); ++i)
+        {
+            DelayLine* const d = delayLines.getUnchecked (i);
+            d->allocate (graph.getBlockSize());
+            delayLineMemory += d->getMemoryUsage();
+        }
     }
 
     int getNumBuffersNeeded() const         { return nodeIds.size(); }
     int getNumMidiBuffersNeeded() const     { return midiNodeIds.size(); }
+    size_t getDelayLineMemoryUsage() const  { return delayLineMemory; }
+
+    /** Returns the number of samples by which a node's inputs are delayed to line them up. */
+    int getNodeInputDelay (const AudioProcessorGraph::Node& node) const
+    {
+        return getNodeDelay (node.nodeId) - node.getProcessor()->getLatencySamples();
+    }
 
 private:
     //==============================================================================
@@ -279,7 +530,7 @@ private:
     Array <int> channels;
     Array <uint32> nodeIds, midiNodeIds;
 
-    enum { freeNodeID = 0xffffffff, zeroNodeID = 0xfffffffe };
+    enum { freeNodeID = 0xffffffff, zeroNodeID = 0xfffffffe, anonymousNodeID = 0xfffffffd };
 
     static bool isNodeBusy (uint32 nodeID) noexcept { return nodeID != freeNodeID && nodeID != zeroNodeID; }
 
@@ -287,6 +538,9 @@ private:
     Array <int> nodeDelays;
     int totalLatency;
 
+    ReferenceCountedArray<DelayLine> delayLines;
+    size_t delayLineMemory;
+
     int getNodeDelay (const uint32 nodeID) const          { return nodeDelays [nodeDelayIDs.indexOf (nodeID)]; }
 
     void setNodeDelay (const uint32 nodeID, const int latency)
@@ -319,6 +573,50 @@ private:
         return maxLatency;
     }
 
+    //==============================================================================
+    /** Adds ops to copy or mix a delayed version of a source channel into a buffer.
+        The first time a particular source channel needs delaying, this creates a delay
+        line and feeds it from the source's buffer, which must still be holding the
+        undelayed data. Any later connections from the same source just add another tap.
+    */
+    void addDelayOps (Array<void*>& renderingOps, const uint32 sourceNodeId, const int sourceChannel,
+                      const int sourceBufIndex, const int destBufIndex, const int delay, const bool addToDest)
+    {
+        if (graph.isUsingDoublePrecision())
+            addTypedDelayOps<double> (renderingOps, sourceNodeId, sourceChannel, sourceBufIndex, destBufIndex, delay, addToDest);
+        else
+            addTypedDelayOps<float> (renderingOps, sourceNodeId, sourceChannel, sourceBufIndex, destBufIndex, delay, addToDest);
+    }
+
+    template <typename SampleType>
+    void addTypedDelayOps (Array<void*>& renderingOps, const uint32 sourceNodeId, const int sourceChannel,
+                           const int sourceBufIndex, const int destBufIndex, const int delay, const bool addToDest)
+    {
+        // all the delay lines in a sequence have the graph's sample type
+        TypedDelayLine<SampleType>* delayLine = nullptr;
+
+        for (int i = delayLines.size(); --i >= 0;)
+        {
+            DelayLine* const d = delayLines.getUnchecked (i);
+
+            if (d->sourceNodeId == sourceNodeId && d->sourceChannel == sourceChannel)
+            {
+                delayLine = static_cast<TypedDelayLine<SampleType>*> (d);
+                break;
+            }
+        }
+
+        if (delayLine == nullptr)
+        {
+            delayLine = new TypedDelayLine<SampleType> (sourceNodeId, sourceChannel);
+            delayLines.add (delayLine);
+            renderingOps.add (new WriteDelayLineOp<SampleType> (sourceBufIndex, delayLine));
+        }
+
+        delayLine->addTap (delay);
+        renderingOps.add (new ReadDelayLineOp<SampleType> (delayLine, delay, destBufIndex, addToDest));
+    }
+
     //==============================================================================
     void createRenderingOpsForNode (AudioProcessorGraph::Node* const node,
                                     Array<void*>& renderingOps,
@@ -382,7 +680,10 @@ private:
                     jassert (bufIndex >= 0);
                 }
 
-                if (inputChan < numOuts
+                const int nodeDelay = getNodeDelay (srcNode);
+                const bool needsDelay = bufIndex != getReadOnlyEmptyBuffer() && nodeDelay < maxLatency;
+
+                if ((inputChan < numOuts || needsDelay)
                      && isBufferNeededLater (ourRenderingIndex,
                                              inputChan,
                                              srcNode, srcChan))
@@ -390,16 +691,19 @@ private:
                     // can't mess up this channel because it's needed later by another node, so we
                     // need to use a copy of it..
                     const int newFreeBuffer = getFreeBuffer (false);
+                    markBufferAsContaining (newFreeBuffer, (uint32) anonymousNodeID, 0);
 
-                    renderingOps.add (new CopyChannelOp (bufIndex, newFreeBuffer));
+                    if (needsDelay)
+                        addDelayOps (renderingOps, srcNode, srcChan, bufIndex, newFreeBuffer, maxLatency - nodeDelay, false);
+                    else
+                        renderingOps.add (new CopyChannelOp (bufIndex, newFreeBuffer));
 
                     bufIndex = newFreeBuffer;
                 }
-
-                const int nodeDelay = getNodeDelay (srcNode);
-
-                if (nodeDelay < maxLatency)
-                    renderingOps.add (new DelayChannelOp (bufIndex, maxLatency - nodeDelay));
+                else if (needsDelay)
+                {
+                    addDelayOps (renderingOps, srcNode, srcChan, bufIndex, bufIndex, maxLatency - nodeDelay, false);
+                }
             }
             else
             {
@@ -425,7 +729,8 @@ private:
 
                         const int nodeDelay = getNodeDelay (sourceNodes.getUnchecked (i));
                         if (nodeDelay < maxLatency)
-                            renderingOps.add (new DelayChannelOp (sourceBufIndex, maxLatency - nodeDelay));
+                            addDelayOps (renderingOps, sourceNodes.getUnchecked (i), sourceOutputChans.getUnchecked (i),
+                                         sourceBufIndex, sourceBufIndex, maxLatency - nodeDelay, false);
 
                         break;
                     }
@@ -436,54 +741,47 @@ private:
                     // can't re-use any of our input chans, so get a new one and copy everything into it..
                     bufIndex = getFreeBuffer (false);
                     jassert (bufIndex != 0);
+                    markBufferAsContaining (bufIndex, (uint32) anonymousNodeID, 0);
 
                     const int srcIndex = getBufferContaining (sourceNodes.getUnchecked (0),
                                                               sourceOutputChans.getUnchecked (0));
+                    const int nodeDelay = getNodeDelay (sourceNodes.getFirst());
+
                     if (srcIndex < 0)
                     {
                         // if not found, this is probably a feedback loop
                         renderingOps.add (new ClearChannelOp (bufIndex));
                     }
+                    else if (nodeDelay < maxLatency)
+                    {
+                        addDelayOps (renderingOps, sourceNodes.getFirst(), sourceOutputChans.getFirst(),
+                                     srcIndex, bufIndex, maxLatency - nodeDelay, false);
+                    }
                     else
                     {
                         renderingOps.add (new CopyChannelOp (srcIndex, bufIndex));
                     }
 
                     reusableInputIndex = 0;
-                    const int nodeDelay = getNodeDelay (sourceNodes.getFirst());
-
-                    if (nodeDelay < maxLatency)
-                        renderingOps.add (new DelayChannelOp (bufIndex, maxLatency - nodeDelay));
                 }
 
                 for (int j = 0; j < sourceNodes.size(); ++j)
                 {
                     if (j != reusableInputIndex)
                     {
-                        int srcIndex = getBufferContaining (sourceNodes.getUnchecked(j),
-                                                            sourceOutputChans.getUnchecked(j));
+                        const int srcIndex = getBufferContaining (sourceNodes.getUnchecked(j),
+                                                                  sourceOutputChans.getUnchecked(j));
                         if (srcIndex >= 0)
                         {
                             const int nodeDelay = getNodeDelay (sourceNodes.getUnchecked (j));
 
+                            // a delayed source gets mixed straight out of its delay line, so the
+                            // source buffer itself is left alone for anything else that needs it
                             if (nodeDelay < maxLatency)
-                            {
-                                if (! isBufferNeededLater (ourRenderingIndex, inputChan,
-                                                           sourceNodes.getUnchecked(j),
-                                                           sourceOutputChans.getUnchecked(j)))
-                                {
-                                    renderingOps.add (new DelayChannelOp (srcIndex, maxLatency - nodeDelay));
-                                }
-                                else // buffer is reused elsewhere, can't be delayed
-                                {
-                                    const int bufferToDelay = getFreeBuffer (false);
-                                    renderingOps.add (new CopyChannelOp (srcIndex, bufferToDelay));
-                                    renderingOps.add (new DelayChannelOp (bufferToDelay, maxLatency - nodeDelay));
-                                    srcIndex = bufferToDelay;
-                                }
-                            }
-
-                            renderingOps.add (new AddChannelOp (srcIndex, bufIndex));
+                                addDelayOps (renderingOps, sourceNodes.getUnchecked (j), sourceOutputChans.getUnchecked (j),
+                                             srcIndex, bufIndex, maxLatency - nodeDelay, true);
+                            else
+                                renderingOps.add (new AddChannelOp (srcIndex, bufIndex));
                         }
                     }
                 }
@@ -611,7 +909,8 @@ private:
             totalLatency = maxLatency;
 
         renderingOps.add (new ProcessBufferOp (node, audioChannelsToUse,
-                                               totalChans, midiBufferToUse));
+                                               totalChans, midiBufferToUse,
+                                               graph.isUsingDoublePrecision()));
     }
 
     //==============================================================================
@@ -896,6 +1195,11 @@ void AudioProcessorGraph::Node::prepare (const double sampleRate, const int bloc
         isPrepared = true;
         setParentGraph (graph);
 
+        processor->setProcessingPrecision (graph->isUsingDoublePrecision()
+                                             && processor->supportsDoublePrecisionProcessing()
+                                                ? AudioProcessor::doublePrecision
+                                                : AudioProcessor::singlePrecision);
+
         processor->setPlayConfigDetails (processor->getNumInputChannels(),
                                          processor->getNumOutputChannels(),
                                          sampleRate, blockSize);
@@ -921,12 +1225,19 @@ void AudioProcessorGraph::Node::setParentGraph (AudioProcessorGraph* const graph
 }
 
 //==============================================================================
+enum { maxPendingNodeParameterChanges = 512 };
+
 AudioProcessorGraph::AudioProcessorGraph()
     : lastNodeId (0),
       renderingBuffers (1, 1),
+      latencyCompensationMemory (0),
       currentAudioInputBuffer (nullptr),
       currentAudioOutputBuffer (1, 1),
-      currentMidiInputBuffer (nullptr)
+      doubleRenderingBuffers (1, 1),
+      currentDoubleAudioInputBuffer (nullptr),
+      currentDoubleAudioOutputBuffer (1, 1),
+      currentMidiInputBuffer (nullptr),
+      numDelayedParameterChanges (0)
 {
 }
 
@@ -934,6 +1245,8 @@ AudioProcessorGraph::~AudioProcessorGraph()
 {
     clearRenderingSequence();
     clear();
+
+    delete pendingNodeParameterChanges.get();
 }
 
 const String AudioProcessorGraph::getName() const
@@ -1181,6 +1494,8 @@ void AudioProcessorGraph::clearRenderingSequence()
     {
         const ScopedLock sl (getCallbackLock());
         renderingOps.swapWith (oldOps);
+        parameterRoutes.clear();
+        latencyCompensationMemory = 0;
     }
 
     deleteRenderOpArray (oldOps);
@@ -1209,8 +1524,10 @@ bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
 void AudioProcessorGraph::buildRenderingSequence()
 {
     Array<void*> newRenderingOps;
+    Array<ParameterRoute> newParameterRoutes;
     int numRenderingBuffersNeeded = 2;
     int numMidiBuffersNeeded = 1;
+    size_t newLatencyCompensationMemory = 0;
 
     {
         MessageManagerLock mml;
@@ -1239,14 +1556,30 @@ void AudioProcessorGraph::buildRenderingSequence()
 
         numRenderingBuffersNeeded = calculator.getNumBuffersNeeded();
         numMidiBuffersNeeded = calculator.getNumMidiBuffersNeeded();
+        newLatencyCompensationMemory = calculator.getDelayLineMemoryUsage();
+
+        for (int i = 0; i < orderedNodes.size(); ++i)
+        {
+            const Node* const node = (const Node*) orderedNodes.getUnchecked (i);
+            const ParameterRoute route = { node->nodeId, node->getProcessor(), calculator.getNodeInputDelay (*node) };
+            newParameterRoutes.add (route);
+        }
     }
 
     {
         // swap over to the new rendering sequence..
         const ScopedLock sl (getCallbackLock());
 
-        renderingBuffers.setSize (numRenderingBuffersNeeded, getBlockSize());
-        renderingBuffers.clear();
+        if (isUsingDoublePrecision())
+        {
+            doubleRenderingBuffers.setSize (numRenderingBuffersNeeded, getBlockSize());
+            doubleRenderingBuffers.clear();
+        }
+        else
+        {
+            renderingBuffers.setSize (numRenderingBuffersNeeded, getBlockSize());
+            renderingBuffers.clear();
+        }
 
         for (int i = midiBuffers.size(); --i >= 0;)
             midiBuffers.getUnchecked(i)->clear();
@@ -1255,6 +1588,8 @@ void AudioProcessorGraph::buildRenderingSequence()
             midiBuffers.add (new MidiBuffer());
 
         renderingOps.swapWith (newRenderingOps);
+        parameterRoutes.swapWith (newParameterRoutes);
+        latencyCompensationMemory = newLatencyCompensationMemory;
     }
 
     // delete the old ones..
@@ -1270,10 +1605,24 @@ void AudioProcessorGraph::handleAsyncUpdate()
 void AudioProcessorGraph::prepareToPlay (double /*sampleRate*/, int estimatedSamplesPerBlock)
 {
     currentAudioInputBuffer = nullptr;
-    currentAudioOutputBuffer.setSize (jmax (1, getNumOutputChannels()), estimatedSamplesPerBlock);
+    currentDoubleAudioInputBuffer = nullptr;
+
+    if (isUsingDoublePrecision())
+        currentDoubleAudioOutputBuffer.setSize (jmax (1, getNumOutputChannels()), estimatedSamplesPerBlock);
+    else
+        currentAudioOutputBuffer.setSize (jmax (1, getNumOutputChannels()), estimatedSamplesPerBlock);
+
     currentMidiInputBuffer = nullptr;
     currentMidiOutputBuffer.clear();
 
+    // like a processor's own parameter queue, this is only created once and then
+    // never replaced, so that other threads can push into it without locking
+    if (pendingNodeParameterChanges.get() == nullptr)
+    {
+        delayedParameterChanges.malloc ((size_t) maxPendingNodeParameterChanges);
+        pendingNodeParameterChanges = new ConcurrentFifo<NodeParameterChange> (maxPendingNodeParameterChanges);
+    }
+
     clearRenderingSequence();
     buildRenderingSequence();
 }
@@ -1284,10 +1633,13 @@ void AudioProcessorGraph::releaseResources()
         nodes.getUnchecked(i)->unprepare();
 
     renderingBuffers.setSize (1, 1);
+    doubleRenderingBuffers.setSize (1, 1);
     midiBuffers.clear();
 
     currentAudioInputBuffer = nullptr;
     currentAudioOutputBuffer.setSize (1, 1);
+    currentDoubleAudioInputBuffer = nullptr;
+    currentDoubleAudioOutputBuffer.setSize (1, 1);
     currentMidiInputBuffer = nullptr;
     currentMidiOutputBuffer.clear();
 }
@@ -1302,8 +1654,21 @@ void AudioProcessorGraph::reset()
 
 void AudioProcessorGraph::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
 {
+    JUCE_TRACE_ZONE ("AudioProcessorGraph::processBlock");
+
+    if (isUsingDoublePrecision())
+    {
+        // The graph has been prepared for double-precision, so the host should be
+        // calling processBlockDouble()!
+        jassertfalse;
+        buffer.clear();
+        return;
+    }
+
     const int numSamples = buffer.getNumSamples();
 
+    routeParameterChanges (numSamples);
+
     currentAudioInputBuffer = &buffer;
     currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples);
     currentAudioOutputBuffer.clear();
@@ -1325,6 +1690,123 @@ void AudioProcessorGraph::processBlock (AudioSampleBuffer& buffer, MidiBuffer& m
     midiMessages.addEvents (currentMidiOutputBuffer, 0, buffer.getNumSamples(), 0);
 }
 
+void AudioProcessorGraph::processBlockDouble (DoubleAudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+    JUCE_TRACE_ZONE ("AudioProcessorGraph::processBlock");
+
+    if (! isUsingDoublePrecision())
+    {
+        // You need to call setProcessingPrecision (doublePrecision) before
+        // prepareToPlay() if you want to use processBlockDouble()!
+        jassertfalse;
+        buffer.clear();
+        return;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+
+    routeParameterChanges (numSamples);
+
+    currentDoubleAudioInputBuffer = &buffer;
+    currentDoubleAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples);
+    currentDoubleAudioOutputBuffer.clear();
+    currentMidiInputBuffer = &midiMessages;
+    currentMidiOutputBuffer.clear();
+
+    for (int i = 0; i < renderingOps.size(); ++i)
+    {
+        GraphRenderingOps::AudioGraphRenderingOp* const op
+            = (GraphRenderingOps::AudioGraphRenderingOp*) renderingOps.getUnchecked(i);
+
+        op->perform (doubleRenderingBuffers, midiBuffers, numSamples);
+    }
+
+    for (int i = 0; i < buffer.getNumChannels(); ++i)
+        buffer.copyFrom (i, 0, currentDoubleAudioOutputBuffer, i, 0, numSamples);
+
+    midiMessages.clear();
+    midiMessages.addEvents (currentMidiOutputBuffer, 0, buffer.getNumSamples(), 0);
+}
+
+bool AudioProcessorGraph::supportsDoublePrecisionProcessing() const         { return true; }
+
+//==============================================================================
+void AudioProcessorGraph::scheduleNodeParameterChange (const uint32 nodeId, const int parameterIndex,
+                                                       const float newValue, const int samplePosition)
+{
+    ConcurrentFifo<NodeParameterChange>* const queue = pendingNodeParameterChanges.get();
+
+    // The graph needs to have been prepared before changes can be scheduled on it!
+    jassert (queue != nullptr);
+
+    if (queue != nullptr)
+    {
+        const NodeParameterChange c = { nodeId, { jmax (0, samplePosition), parameterIndex, newValue } };
+
+        // If this fails, the queue has overflowed because the graph isn't being played, or
+        // changes are arriving far faster than blocks are being processed.
+        const bool ok = queue->push (c);
+        jassert (ok); (void) ok;
+    }
+}
+
+const AudioProcessorGraph::ParameterRoute* AudioProcessorGraph::findParameterRoute (const uint32 nodeId) const noexcept
+{
+    for (int i = parameterRoutes.size(); --i >= 0;)
+    {
+        const ParameterRoute& route = parameterRoutes.getReference (i);
+
+        if (route.nodeId == nodeId)
+            return &route;
+    }
+
+    return nullptr;
+}
+
+void AudioProcessorGraph::routeParameterChanges (const int numSamples) noexcept
+{
+    ConcurrentFifo<NodeParameterChange>* const queue = pendingNodeParameterChanges.get();
+
+    if (queue == nullptr)
+        return;
+
+    NodeParameterChange c;
+
+    // each new change is moved later by the delay on its node's inputs..
+    while (numDelayedParameterChanges < maxPendingNodeParameterChanges && queue->pop (c))
+    {
+        if (const ParameterRoute* const route = findParameterRoute (c.nodeId))
+        {
+            c.change.samplePosition += route->inputDelay;
+            delayedParameterChanges[numDelayedParameterChanges++] = c;
+        }
+    }
+
+    // ..and then any that fall within this block are passed on to their nodes, in the
+    // order they arrived, while the rest are kept for a later block.
+    int numLeft = 0;
+
+    for (int i = 0; i < numDelayedParameterChanges; ++i)
+    {
+        NodeParameterChange& delayed = delayedParameterChanges[i];
+
+        if (delayed.change.samplePosition < numSamples)
+        {
+            if (const ParameterRoute* const route = findParameterRoute (delayed.nodeId))
+                route->processor->scheduleParameterChange (delayed.change.parameterIndex,
+                                                           delayed.change.value,
+                                                           delayed.change.samplePosition);
+        }
+        else
+        {
+            delayed.change.samplePosition -= numSamples;
+            delayedParameterChanges[numLeft++] = delayed;
+        }
+    }
+
+    numDelayedParameterChanges = numLeft;
+}
+
 const String AudioProcessorGraph::getInputChannelName (int channelIndex) const
 {
     return "Input " + String (channelIndex + 1);
@@ -1440,6 +1922,53 @@ void AudioProcessorGraph::AudioGraphIOProcessor::processBlock (AudioSampleBuffer
     }
 }
 
+void AudioProcessorGraph::AudioGraphIOProcessor::processBlockDouble (DoubleAudioSampleBuffer& buffer,
+                                                                     MidiBuffer& midiMessages)
+{
+    jassert (graph != nullptr);
+
+    switch (type)
+    {
+        case audioOutputNode:
+        {
+            for (int i = jmin (graph->currentDoubleAudioOutputBuffer.getNumChannels(),
+                               buffer.getNumChannels()); --i >= 0;)
+            {
+                graph->currentDoubleAudioOutputBuffer.addFrom (i, 0, buffer, i, 0, buffer.getNumSamples());
+            }
+
+            break;
+        }
+
+        case audioInputNode:
+        {
+            for (int i = jmin (graph->currentDoubleAudioInputBuffer->getNumChannels(),
+                               buffer.getNumChannels()); --i >= 0;)
+            {
+                buffer.copyFrom (i, 0, *graph->currentDoubleAudioInputBuffer, i, 0, buffer.getNumSamples());
+            }
+
+            break;
+        }
+
+        case midiOutputNode:
+            graph->currentMidiOutputBuffer.addEvents (midiMessages, 0, buffer.getNumSamples(), 0);
+            break;
+
+        case midiInputNode:
+            midiMessages.addEvents (*graph->currentMidiInputBuffer, 0, buffer.getNumSamples(), 0);
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool AudioProcessorGraph::AudioGraphIOProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 bool AudioProcessorGraph::AudioGraphIOProcessor::silenceInProducesSilenceOut() const
 {
     return isOutput();
@@ -1531,3 +2060,421 @@ void AudioProcessorGraph::AudioGraphIOProcessor::setParentGraph (AudioProcessorG
         updateHostDisplay();
     }
 }
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorGraphTests  : public UnitTest
+{
+public:
+    AudioProcessorGraphTests()  : UnitTest ("AudioProcessorGraph") {}
+
+    // A mono processor that applies a gain, and can optionally render in double precision.
+    struct GainProcessor  : public AudioProcessor
+    {
+        GainProcessor (double gainToApply, bool canUseDoubles)
+            : gain (gainToApply), supportsDoubles (canUseDoubles),
+              numFloatBlocks (0), numDoubleBlocks (0)
+        {
+            setPlayConfigDetails (1, 1, 44100.0, 64);
+        }
+
+        const String getName() const                    { return "Gain"; }
+        void prepareToPlay (double, int)                {}
+        void releaseResources()                         {}
+
+        void processBlock (AudioSampleBuffer& buffer, MidiBuffer&)
+        {
+            ++numFloatBlocks;
+            buffer.applyGain ((float) gain);
+        }
+
+        void processBlockDouble (DoubleAudioSampleBuffer& buffer, MidiBuffer&)
+        {
+            ++numDoubleBlocks;
+            buffer.applyGain (gain);
+        }
+
+        bool supportsDoublePrecisionProcessing() const      { return supportsDoubles; }
+        const String getInputChannelName (int) const        { return String::empty; }
+        const String getOutputChannelName (int) const       { return String::empty; }
+        bool isInputChannelStereoPair (int) const           { return false; }
+        bool isOutputChannelStereoPair (int) const          { return false; }
+        bool silenceInProducesSilenceOut() const            { return true; }
+        double getTailLengthSeconds() const                 { return 0; }
+        bool acceptsMidi() const                            { return false; }
+        bool producesMidi() const                           { return false; }
+        bool hasEditor() const                              { return false; }
+        AudioProcessorEditor* createEditor()                { return nullptr; }
+        int getNumParameters()                              { return 0; }
+        const String getParameterName (int)                 { return String::empty; }
+        float getParameter (int)                            { return 0; }
+        const String getParameterText (int)                 { return String::empty; }
+        void setParameter (int, float)                      {}
+        int getNumPrograms()                                { return 0; }
+        int getCurrentProgram()                             { return 0; }
+        void setCurrentProgram (int)                        {}
+        const String getProgramName (int)                   { return String::empty; }
+        void changeProgramName (int, const String&)         {}
+        void getStateInformation (juce::MemoryBlock&)       {}
+        void setStateInformation (const void*, int)         {}
+
+        const double gain;
+        const bool supportsDoubles;
+        int numFloatBlocks, numDoubleBlocks;
+    };
+
+    // A processor that asks for sample-accurate parameter changes, and records the
+    // time at which each one arrives, counting from the start of the first block.
+    struct AutomatedProcessor  : public GainProcessor
+    {
+        AutomatedProcessor (int latency)
+            : GainProcessor (1.0, false), numSamplesProcessed (0)
+        {
+            setLatencySamples (latency);
+        }
+
+        bool wantsSampleAccurateParameterChanges() const    { return true; }
+
+        void processBlock (AudioSampleBuffer& buffer, MidiBuffer& midi)
+        {
+            const ParameterChangeBuffer& changes = getParameterChanges();
+
+            for (int i = 0; i < changes.getNumChanges(); ++i)
+            {
+                const ParameterChangeBuffer::Change& c = changes.getChange (i);
+                changeTimes.add (numSamplesProcessed + c.samplePosition);
+                changeValues.add (c.value);
+            }
+
+            numSamplesProcessed += buffer.getNumSamples();
+            GainProcessor::processBlock (buffer, midi);
+        }
+
+        Array<int> changeTimes;
+        Array<float> changeValues;
+        int numSamplesProcessed;
+    };
+
+    // A processor that just delays its input by its own latency.
+    struct DelayProcessor  : public GainProcessor
+    {
+        DelayProcessor (int latency)
+            : GainProcessor (1.0, true), history ((size_t) latency + 1, true),
+              historySize (latency + 1), position (0)
+        {
+            setLatencySamples (latency);
+        }
+
+        void processBlock (AudioSampleBuffer& buffer, MidiBuffer&)          { process (buffer); }
+        void processBlockDouble (DoubleAudioSampleBuffer& buffer, MidiBuffer&)  { process (buffer); }
+
+        template <typename SampleType>
+        void process (AudioBuffer<SampleType>& buffer)
+        {
+            SampleType* const data = buffer.getSampleData (0);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                history[position] = data[i];
+                position = (position + 1) % historySize;
+                data[i] = (SampleType) history[position];
+            }
+        }
+
+        HeapBlock<double> history;
+        const int historySize;
+        int position;
+    };
+
+    enum { blockSize = 64, inputNodeId = 1000, outputNodeId = 1001 };
+
+    // Creates a graph that runs its input through the given processors, one after the other.
+    static void createChain (AudioProcessorGraph& graph, const Array<AudioProcessor*>& processors)
+    {
+        typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+
+        graph.setPlayConfigDetails (1, 1, 44100.0, blockSize);
+        graph.addNode (new IOProcessor (IOProcessor::audioInputNode), inputNodeId);
+        graph.addNode (new IOProcessor (IOProcessor::audioOutputNode), outputNodeId);
+
+        uint32 previousNodeId = inputNodeId;
+
+        for (int i = 0; i < processors.size(); ++i)
+        {
+            const uint32 nodeId = (uint32) i + 1;
+            graph.addNode (processors.getUnchecked (i), nodeId);
+            graph.addConnection (previousNodeId, 0, nodeId, 0);
+            previousNodeId = nodeId;
+        }
+
+        graph.addConnection (previousNodeId, 0, outputNodeId, 0);
+    }
+
+    // Feeds an impulse through three parallel paths with different latencies, and checks
+    // that the graph delays the shorter ones so that all three copies arrive together.
+    template <typename SampleType>
+    void checkParallelDelays()
+    {
+        typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+        const int latencies[] = { 0, 7, 100 };
+        const int impulsePosition = 50, numBlocks = 4;
+
+        AudioProcessorGraph graph;
+        graph.setPlayConfigDetails (1, 1, 44100.0, blockSize);
+        graph.addNode (new IOProcessor (IOProcessor::audioInputNode), inputNodeId);
+        graph.addNode (new IOProcessor (IOProcessor::audioOutputNode), outputNodeId);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            graph.addNode (new DelayProcessor (latencies[i]), (uint32) i + 1);
+            graph.addConnection (inputNodeId, 0, (uint32) i + 1, 0);
+            graph.addConnection ((uint32) i + 1, 0, outputNodeId, 0);
+        }
+
+        if (sizeof (SampleType) == sizeof (double))
+            graph.setProcessingPrecision (AudioProcessor::doublePrecision);
+
+        graph.prepareToPlay (44100.0, blockSize);
+        expectEquals (graph.getLatencySamples(), 100);
+
+        // the two shorter paths each need a delay line as long as the difference in latency,
+        // plus a block, holding samples of the graph's own type
+        expectEquals ((int) graph.getLatencyCompensationMemoryUsage(),
+                      (int) ((100 + blockSize + 93 + blockSize) * sizeof (SampleType)));
+
+        AudioBuffer<SampleType> buffer (1, blockSize);
+        MidiBuffer midi;
+        bool allCorrect = true;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            buffer.clear();
+
+            if (block == 0)
+                buffer.getSampleData (0)[impulsePosition] = (SampleType) 1;
+
+            processBlockWithPrecision (graph, buffer, midi);
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const SampleType expected = (block * blockSize + i == impulsePosition + 100) ? (SampleType) 3 : (SampleType) 0;
+                allCorrect = allCorrect && buffer.getSampleData (0)[i] == expected;
+            }
+        }
+
+        expect (allCorrect);
+        graph.releaseResources();
+    }
+
+    static void processBlockWithPrecision (AudioProcessorGraph& graph, AudioSampleBuffer& buffer, MidiBuffer& midi)
+    {
+        graph.processBlock (buffer, midi);
+    }
+
+    static void processBlockWithPrecision (AudioProcessorGraph& graph, DoubleAudioSampleBuffer& buffer, MidiBuffer& midi)
+    {
+        graph.processBlockDouble (buffer, midi);
+    }
+
+    void runTest()
+    {
+        beginTest ("Double precision");
+        {
+            // these gains cancel out, and only a double-precision path will keep the
+            // small difference between the input samples intact
+            GainProcessor* const first = new GainProcessor (0.125, true);
+            GainProcessor* const second = new GainProcessor (8.0, true);
+
+            Array<AudioProcessor*> processors;
+            processors.add (first);
+            processors.add (second);
+
+            AudioProcessorGraph graph;
+            createChain (graph, processors);
+            graph.setProcessingPrecision (AudioProcessor::doublePrecision);
+            graph.prepareToPlay (44100.0, blockSize);
+
+            expect (graph.isUsingDoublePrecision());
+            expect (first->isUsingDoublePrecision() && second->isUsingDoublePrecision());
+
+            DoubleAudioSampleBuffer buffer (1, blockSize);
+            MidiBuffer midi;
+
+            for (int i = 0; i < blockSize; ++i)
+                buffer.getSampleData (0)[i] = 1.0 + i * 1.0e-12;
+
+            graph.processBlockDouble (buffer, midi);
+
+            bool allExact = true;
+
+            for (int i = 0; i < blockSize; ++i)
+                allExact = allExact && buffer.getSampleData (0)[i] == 1.0 + i * 1.0e-12;
+
+            expect (allExact);
+            expectEquals (first->numDoubleBlocks, 1);
+            expectEquals (second->numDoubleBlocks, 1);
+            expectEquals (first->numFloatBlocks + second->numFloatBlocks, 0);
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Single-precision nodes in a double-precision graph");
+        {
+            GainProcessor* const doubleNode = new GainProcessor (2.0, true);
+            GainProcessor* const floatNode = new GainProcessor (0.25, false);
+
+            Array<AudioProcessor*> processors;
+            processors.add (doubleNode);
+            processors.add (floatNode);
+
+            AudioProcessorGraph graph;
+            createChain (graph, processors);
+            graph.setProcessingPrecision (AudioProcessor::doublePrecision);
+            graph.prepareToPlay (44100.0, blockSize);
+
+            expect (! floatNode->isUsingDoublePrecision());
+
+            DoubleAudioSampleBuffer buffer (1, blockSize);
+            MidiBuffer midi;
+
+            // a shorter block than the one the graph was prepared for
+            for (int numSamples = blockSize; numSamples > 0; numSamples -= 24)
+            {
+                DoubleAudioSampleBuffer block (buffer.getArrayOfChannels(), 1, numSamples);
+
+                for (int i = 0; i < numSamples; ++i)
+                    block.getSampleData (0)[i] = 1.0 + i;
+
+                graph.processBlockDouble (block, midi);
+
+                bool allCorrect = true;
+
+                for (int i = 0; i < numSamples; ++i)
+                    allCorrect = allCorrect && block.getSampleData (0)[i] == (1.0 + i) * 0.5;
+
+                expect (allCorrect);
+            }
+
+            expectEquals (doubleNode->numDoubleBlocks, 3);
+            expectEquals (floatNode->numFloatBlocks, 3);
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Single precision");
+        {
+            GainProcessor* const node = new GainProcessor (0.5, true);
+
+            Array<AudioProcessor*> processors;
+            processors.add (node);
+
+            AudioProcessorGraph graph;
+            createChain (graph, processors);
+            graph.prepareToPlay (44100.0, blockSize);
+
+            expect (! node->isUsingDoublePrecision());
+
+            AudioSampleBuffer buffer (1, blockSize);
+            MidiBuffer midi;
+
+            for (int i = 0; i < blockSize; ++i)
+                buffer.getSampleData (0)[i] = 1.0f;
+
+            graph.processBlock (buffer, midi);
+
+            expectEquals (buffer.getMagnitude (0, 0, blockSize), 0.5f);
+            expectEquals (node->numFloatBlocks, 1);
+            expectEquals (node->numDoubleBlocks, 0);
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Latency compensation");
+        {
+            checkParallelDelays<float>();
+            checkParallelDelays<double>();
+        }
+
+        beginTest ("Parameter change ordering");
+        {
+            AutomatedProcessor processor (0);
+
+            // nothing is queued until the processor has been prepared
+            expect (processor.getParameterChanges().isEmpty());
+            processor.setPlayConfigDetails (1, 1, 44100.0, blockSize);
+
+            processor.scheduleParameterChange (0, 0.1f, 30);
+            processor.scheduleParameterChange (1, 0.2f, 10);
+            processor.scheduleParameterChange (2, 0.3f, 30);
+            processor.scheduleParameterChange (3, 0.4f, -5);
+            processor.scheduleParameterChange (4, 0.5f, 1000);
+            processor.scheduleParameterChange (5, 0.6f, 63);
+            processor.prepareParameterChanges (blockSize);
+
+            const ParameterChangeBuffer& changes = processor.getParameterChanges();
+            const int expectedIndexes[]   = { 3, 1, 0, 2, 4, 5 };
+            const int expectedPositions[] = { 0, 10, 30, 30, 63, 63 };
+
+            expectEquals (changes.getNumChanges(), 6);
+
+            for (int i = 0; i < jmin (6, changes.getNumChanges()); ++i)
+            {
+                expectEquals (changes.getChange (i).parameterIndex, expectedIndexes[i]);
+                expectEquals (changes.getChange (i).samplePosition, expectedPositions[i]);
+            }
+
+            processor.prepareParameterChanges (blockSize);
+            expect (changes.isEmpty());
+        }
+
+        beginTest ("Parameter changes are delayed with their node's inputs");
+        {
+            // the second node's input is delayed by the first one's latency, so its changes
+            // have to be moved later by the same amount, into the following block
+            AutomatedProcessor* const first = new AutomatedProcessor (100);
+            AutomatedProcessor* const second = new AutomatedProcessor (0);
+
+            Array<AudioProcessor*> processors;
+            processors.add (first);
+            processors.add (second);
+
+            AudioProcessorGraph graph;
+            createChain (graph, processors);
+            graph.prepareToPlay (44100.0, blockSize);
+
+            expectEquals (graph.getLatencySamples(), 100);
+
+            graph.scheduleNodeParameterChange (1, 0, 0.25f, 10);
+            graph.scheduleNodeParameterChange (2, 0, 0.5f, 10);
+            graph.scheduleNodeParameterChange (2, 0, 0.75f, 20);
+            graph.scheduleNodeParameterChange (1234, 0, 1.0f, 0);
+
+            AudioSampleBuffer buffer (1, blockSize);
+            MidiBuffer midi;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                buffer.clear();
+                graph.processBlock (buffer, midi);
+            }
+
+            expectEquals (first->changeTimes.size(), 1);
+            expectEquals (first->changeTimes[0], 10);
+            expectEquals (first->changeValues[0], 0.25f);
+
+            expectEquals (second->changeTimes.size(), 2);
+            expectEquals (second->changeTimes[0], 110);
+            expectEquals (second->changeValues[0], 0.5f);
+            expectEquals (second->changeTimes[1], 120);
+            expectEquals (second->changeValues[1], 0.75f);
+
+            graph.releaseResources();
+        }
+    }
+};
+
+static AudioProcessorGraphTests audioProcessorGraphTests;
+
+#endif
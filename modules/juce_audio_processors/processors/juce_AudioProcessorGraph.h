@@ -43,6 +43,13 @@
 
     To play back a graph through an audio device, you might want to use an
     AudioProcessorPlayer object.
+
+    The graph can also render with 64-bit samples: call setProcessingPrecision
+    (AudioProcessor::doublePrecision) before prepareToPlay(), and then use the
+    processBlockDouble() instead of processBlock(). The graph keeps a separate set of
+    double-precision buffers for this, and nodes that support double-precision
+    processing work on them in-place. Any node that doesn't will have its channels
+    converted to and from floats around its own processBlock() call.
 */
 class JUCE_API  AudioProcessorGraph   : public AudioProcessor,
                                         private AsyncUpdater
@@ -247,6 +254,31 @@ public:
     */
     bool removeIllegalConnections();
 
+    //==============================================================================
+    /** Changes one of a node's parameters at a sample position within the graph's next block.
+
+        The change is handed on to the node's processor via AudioProcessor::scheduleParameterChange(),
+        but first its position is moved later by the amount that the graph is delaying that
+        node's inputs to compensate for the latency of other nodes, so that it still lines up
+        with the audio it was aimed at. If that pushes it beyond the end of the block, it's
+        held back and delivered during a later one.
+
+        This is lock-free and can be called from any thread once the graph has been prepared.
+        Changes for nodes that aren't in the graph when the block is rendered are discarded.
+    */
+    void scheduleNodeParameterChange (uint32 nodeId, int parameterIndex, float newValue, int samplePosition);
+
+    //==============================================================================
+    /** Returns the number of bytes of memory currently being used to delay signals
+        for latency compensation.
+
+        When nodes with different latencies feed into the same place, the graph delays
+        the earlier signals so that everything lines up. Each source channel that needs
+        delaying gets one delay line, shared by all its connections, long enough for its
+        longest delay plus one block.
+    */
+    size_t getLatencyCompensationMemoryUsage() const noexcept   { return latencyCompensationMemory; }
+
     //==============================================================================
     /** A special number that represents the midi channel of a node.
 
@@ -314,6 +346,8 @@ public:
         void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock);
         void releaseResources();
         void processBlock (AudioSampleBuffer&, MidiBuffer&);
+        void processBlockDouble (DoubleAudioSampleBuffer&, MidiBuffer&);
+        bool supportsDoublePrecisionProcessing() const;
 
         const String getInputChannelName (int channelIndex) const;
         const String getOutputChannelName (int channelIndex) const;
@@ -360,6 +394,8 @@ public:
     void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock);
     void releaseResources();
     void processBlock (AudioSampleBuffer&, MidiBuffer&);
+    void processBlockDouble (DoubleAudioSampleBuffer&, MidiBuffer&);
+    bool supportsDoublePrecisionProcessing() const;
     void reset();
 
     const String getInputChannelName (int channelIndex) const;
@@ -398,14 +434,38 @@ private:
     AudioSampleBuffer renderingBuffers;
     OwnedArray <MidiBuffer> midiBuffers;
     Array<void*> renderingOps;
+    size_t latencyCompensationMemory;
 
     friend class AudioGraphIOProcessor;
     AudioSampleBuffer* currentAudioInputBuffer;
     AudioSampleBuffer currentAudioOutputBuffer;
+    DoubleAudioSampleBuffer doubleRenderingBuffers;
+    DoubleAudioSampleBuffer* currentDoubleAudioInputBuffer;
+    DoubleAudioSampleBuffer currentDoubleAudioOutputBuffer;
     MidiBuffer* currentMidiInputBuffer;
     MidiBuffer currentMidiOutputBuffer;
 
+    struct NodeParameterChange
+    {
+        uint32 nodeId;
+        ParameterChangeBuffer::Change change;
+    };
+
+    struct ParameterRoute
+    {
+        uint32 nodeId;
+        AudioProcessor* processor;
+        int inputDelay;
+    };
+
+    Atomic<ConcurrentFifo<NodeParameterChange>*> pendingNodeParameterChanges;
+    HeapBlock<NodeParameterChange> delayedParameterChanges;
+    int numDelayedParameterChanges;
+    Array<ParameterRoute> parameterRoutes;
+
     void handleAsyncUpdate() override;
+    void routeParameterChanges (int numSamples) noexcept;
+    const ParameterRoute* findParameterRoute (uint32 nodeId) const noexcept;
     void clearRenderingSequence();
     void buildRenderingSequence();
     bool isAnInputTo (uint32 possibleInputId, uint32 possibleDestinationId, int recursionCheck) const;
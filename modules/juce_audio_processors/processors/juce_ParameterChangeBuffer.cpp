@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+ParameterChangeBuffer::ParameterChangeBuffer() noexcept {}
+ParameterChangeBuffer::~ParameterChangeBuffer() {}
+
+void ParameterChangeBuffer::clear() noexcept
+{
+    changes.clearQuick();
+}
+
+void ParameterChangeBuffer::ensureSize (const int minimumNumChanges)
+{
+    changes.ensureStorageAllocated (minimumNumChanges);
+}
+
+void ParameterChangeBuffer::addChange (const int parameterIndex, const float value, const int samplePosition)
+{
+    jassert (samplePosition >= 0);
+
+    const Change change = { samplePosition, parameterIndex, value };
+
+    // changes nearly always arrive in time order, so search backwards from the end
+    int insertIndex = changes.size();
+
+    while (insertIndex > 0 && changes.getReference (insertIndex - 1).samplePosition > samplePosition)
+        --insertIndex;
+
+    changes.insert (insertIndex, change);
+}
+
+int ParameterChangeBuffer::getFirstChangeTime() const noexcept
+{
+    return changes.size() > 0 ? changes.getReference (0).samplePosition : -1;
+}
+
+int ParameterChangeBuffer::getLastChangeTime() const noexcept
+{
+    return changes.size() > 0 ? changes.getReference (changes.size() - 1).samplePosition : -1;
+}
+
+//==============================================================================
+ParameterChangeBuffer::Iterator::Iterator (const ParameterChangeBuffer& b) noexcept
+    : buffer (b), nextIndex (0)
+{
+}
+
+void ParameterChangeBuffer::Iterator::setNextSamplePosition (const int samplePosition) noexcept
+{
+    nextIndex = 0;
+
+    while (nextIndex < buffer.changes.size()
+            && buffer.changes.getReference (nextIndex).samplePosition < samplePosition)
+        ++nextIndex;
+}
+
+bool ParameterChangeBuffer::Iterator::getNextChange (int& parameterIndex, float& value, int& samplePosition) noexcept
+{
+    if (nextIndex >= buffer.changes.size())
+        return false;
+
+    const Change& c = buffer.changes.getReference (nextIndex++);
+    parameterIndex = c.parameterIndex;
+    value = c.value;
+    samplePosition = c.samplePosition;
+    return true;
+}
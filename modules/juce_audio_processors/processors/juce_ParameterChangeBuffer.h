@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_PARAMETERCHANGEBUFFER_H_INCLUDED
+#define JUCE_PARAMETERCHANGEBUFFER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Holds a time-ordered list of parameter changes for one block of audio.
+
+    This is the parameter equivalent of a MidiBuffer: each change has a sample
+    position relative to the start of the block, so that a processor can apply
+    automation at the exact sample where the host wanted it, rather than once per
+    block.
+
+    A processor receives one of these via AudioProcessor::getParameterChanges() while
+    its processBlock() method is being called, e.g.
+    @code
+    void processBlock (AudioSampleBuffer& buffer, MidiBuffer&)
+    {
+        ParameterChangeBuffer::Iterator i (getParameterChanges());
+        int index, position, startSample = 0;
+        float value;
+
+        while (i.getNextChange (index, value, position))
+        {
+            renderSamples (buffer, startSample, position - startSample);
+            setParameter (index, value);
+            startSample = position;
+        }
+
+        renderSamples (buffer, startSample, buffer.getNumSamples() - startSample);
+    }
+    @endcode
+
+    @see AudioProcessor::scheduleParameterChange, AudioProcessor::getParameterChanges
+*/
+class JUCE_API  ParameterChangeBuffer
+{
+public:
+    //==============================================================================
+    /** A single timestamped parameter change. */
+    struct Change
+    {
+        int samplePosition;     /**< The position of the change, in samples from the start of the block. */
+        int parameterIndex;     /**< The index of the parameter, as used by AudioProcessor::setParameter(). */
+        float value;            /**< The new value, in the range 0 to 1. */
+    };
+
+    //==============================================================================
+    /** Creates an empty buffer. */
+    ParameterChangeBuffer() noexcept;
+
+    /** Destructor. */
+    ~ParameterChangeBuffer();
+
+    //==============================================================================
+    /** Removes all the changes from the buffer. */
+    void clear() noexcept;
+
+    /** Returns true if the buffer contains no changes. */
+    bool isEmpty() const noexcept                               { return changes.size() == 0; }
+
+    /** Returns the number of changes in the buffer. */
+    int getNumChanges() const noexcept                          { return changes.size(); }
+
+    /** Returns one of the changes, in time order.
+        The index must be between 0 and getNumChanges() - 1.
+    */
+    const Change& getChange (int index) const noexcept          { return changes.getReference (index); }
+
+    /** Adds a change to the buffer.
+
+        The change is inserted after any others with the same sample position, so that
+        changes which arrive in order are delivered in order. This won't allocate
+        unless more changes are added than the space reserved with ensureSize().
+    */
+    void addChange (int parameterIndex, float value, int samplePosition);
+
+    /** Pre-allocates space for the given number of changes, so that adding them
+        won't need to allocate any memory.
+    */
+    void ensureSize (int minimumNumChanges);
+
+    /** Returns the sample position of the first change, or -1 if the buffer is empty. */
+    int getFirstChangeTime() const noexcept;
+
+    /** Returns the sample position of the last change, or -1 if the buffer is empty. */
+    int getLastChangeTime() const noexcept;
+
+    //==============================================================================
+    /**
+        Used to step through the changes in a ParameterChangeBuffer, in time order.
+
+        The buffer mustn't be modified while an iterator is being used on it.
+    */
+    class JUCE_API  Iterator
+    {
+    public:
+        /** Creates an iterator that starts at the first change in the buffer. */
+        Iterator (const ParameterChangeBuffer& buffer) noexcept;
+
+        /** Moves the iterator to the first change at or after the given sample position. */
+        void setNextSamplePosition (int samplePosition) noexcept;
+
+        /** Retrieves the next change, and moves the iterator on.
+            @returns false if there are no more changes to read
+        */
+        bool getNextChange (int& parameterIndex, float& value, int& samplePosition) noexcept;
+
+    private:
+        const ParameterChangeBuffer& buffer;
+        int nextIndex;
+
+        JUCE_DECLARE_NON_COPYABLE (Iterator)
+    };
+
+private:
+    //==============================================================================
+    Array<Change> changes;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterChangeBuffer)
+};
+
+
+#endif   // JUCE_PARAMETERCHANGEBUFFER_H_INCLUDED
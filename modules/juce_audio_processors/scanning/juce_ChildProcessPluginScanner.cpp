@@ -0,0 +1,274 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+namespace ChildProcessPluginScannerHelpers
+{
+    static const char* const scanCommandArgument = "--juce-plugin-scan";
+    static const char* const resultStartMarker   = "<<<JUCE_PLUGIN_SCAN_RESULT>>>";
+    static const char* const resultEndMarker     = "<<<JUCE_PLUGIN_SCAN_RESULT_END>>>";
+
+    // Kills the worker if it hasn't finished when the timeout runs out. This
+    // unblocks the thread that's reading its output.
+    struct Watchdog  : public Thread
+    {
+        Watchdog (ChildProcess& p, const int timeout)
+            : Thread ("Plugin scan watchdog"), process (p), timeoutMs (timeout)
+        {
+            startThread();
+        }
+
+        ~Watchdog()
+        {
+            stopThread (5000);
+        }
+
+        void run() override
+        {
+            if (! wait (timeoutMs) && ! threadShouldExit())
+                process.kill();
+        }
+
+        ChildProcess& process;
+        const int timeoutMs;
+
+        JUCE_DECLARE_NON_COPYABLE (Watchdog)
+    };
+}
+
+//==============================================================================
+ChildProcessPluginScanner::ChildProcessPluginScanner (const StringArray& workerCommand, const int timeout)
+    : command (workerCommand), timeoutMs (timeout)
+{
+    jassert (command.size() > 0);
+}
+
+ChildProcessPluginScanner::ChildProcessPluginScanner (const String& workerExecutable, const int timeout)
+    : command (workerExecutable), timeoutMs (timeout)
+{
+}
+
+ChildProcessPluginScanner::~ChildProcessPluginScanner()
+{
+}
+
+bool ChildProcessPluginScanner::findPluginTypesFor (AudioPluginFormat& format,
+                                                    OwnedArray <PluginDescription>& result,
+                                                    const String& fileOrIdentifier)
+{
+    using namespace ChildProcessPluginScannerHelpers;
+
+    StringArray args (command);
+    args.add (scanCommandArgument);
+    args.add (format.getName());
+    args.add (fileOrIdentifier);
+
+    ChildProcess process;
+
+    // If the worker can't be launched, this is reported as a failed scan, just like a
+    // crash. Scanning the file in-process instead would defeat the point of this class.
+    if (! process.start (args))
+        return false;
+
+    String output;
+
+    {
+        const Watchdog watchdog (process, timeoutMs);
+        output = process.readAllProcessOutput();
+    }
+
+    process.waitForProcessToFinish (1000);
+
+    // Anything that a plugin prints while it's loading also comes through the pipe,
+    // so the results are wrapped in markers. If they're missing, the worker crashed
+    // or was killed.
+    const int start = output.indexOf (resultStartMarker);
+    const int end = output.indexOf (start + 1, resultEndMarker);
+
+    if (start < 0 || end < 0)
+        return false;
+
+    const ScopedPointer<XmlElement> xml (XmlDocument::parse (output.substring (start + (int) strlen (resultStartMarker), end)));
+
+    if (xml == nullptr || ! xml->hasTagName ("PLUGINSCANRESULT"))
+        return false;
+
+    forEachXmlChildElement (*xml, e)
+    {
+        PluginDescription desc;
+
+        if (desc.loadFromXml (*e))
+            result.add (new PluginDescription (desc));
+    }
+
+    return true;
+}
+
+//==============================================================================
+bool ChildProcessPluginScanner::performScanIfRequested (AudioPluginFormatManager& formatManager,
+                                                        const StringArray& commandLineArguments)
+{
+    using namespace ChildProcessPluginScannerHelpers;
+
+    const int index = commandLineArguments.indexOf (scanCommandArgument);
+
+    if (index < 0)
+        return false;
+
+    const String formatName (commandLineArguments [index + 1]);
+    const String fileOrIdentifier (commandLineArguments [index + 2]);
+
+    XmlElement xml ("PLUGINSCANRESULT");
+
+    for (int i = 0; i < formatManager.getNumFormats(); ++i)
+    {
+        AudioPluginFormat* const format = formatManager.getFormat (i);
+
+        if (format->getName() == formatName)
+        {
+            OwnedArray <PluginDescription> found;
+            format->findAllTypesForFile (found, fileOrIdentifier);
+
+            for (int j = 0; j < found.size(); ++j)
+                xml.addChildElement (found.getUnchecked (j)->createXml());
+
+            break;
+        }
+    }
+
+    std::cout << std::endl << resultStartMarker
+              << xml.createDocument (String::empty, true, false)
+              << resultEndMarker << std::endl;
+
+    return true;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS && (JUCE_MAC || JUCE_LINUX)
+
+class ChildProcessPluginScannerTests  : public UnitTest
+{
+public:
+    ChildProcessPluginScannerTests()  : UnitTest ("ChildProcessPluginScanner") {}
+
+    struct TestFormat  : public AudioPluginFormat
+    {
+        String getName() const override                                                          { return "Test"; }
+        void findAllTypesForFile (OwnedArray <PluginDescription>&, const String&) override       {}
+        AudioPluginInstance* createInstanceFromDescription (const PluginDescription&) override   { return nullptr; }
+        bool fileMightContainThisPluginType (const String&) override                             { return true; }
+        String getNameOfPluginFromIdentifier (const String& fileOrIdentifier) override          { return fileOrIdentifier; }
+        bool pluginNeedsRescanning (const PluginDescription&) override                           { return false; }
+        bool doesPluginStillExist (const PluginDescription&) override                            { return true; }
+        bool canScanForPlugins() const override                                                  { return true; }
+        StringArray searchPathsForPlugins (const FileSearchPath&, bool) override                 { return StringArray(); }
+        FileSearchPath getDefaultLocationsToSearch() override                                    { return FileSearchPath(); }
+    };
+
+    // The worker is a shell script, which gets the format name and file as $2 and $3.
+    static StringArray createWorkerCommand (const String& script)
+    {
+        StringArray command;
+        command.add ("/bin/sh");
+        command.add ("-c");
+        command.add (script);
+        command.add ("worker");
+        return command;
+    }
+
+    void runTest()
+    {
+        using namespace ChildProcessPluginScannerHelpers;
+
+        TestFormat format;
+        OwnedArray <PluginDescription> found;
+
+        beginTest ("Results");
+        {
+            PluginDescription desc;
+            desc.name = "Test plugin";
+            desc.pluginFormatName = format.getName();
+            desc.fileOrIdentifier = "test.plugin";
+
+            XmlElement xml ("PLUGINSCANRESULT");
+            xml.addChildElement (desc.createXml());
+
+            // the worker just prints the contents of the "plugin" file, with some noise around it
+            const TemporaryFile temp;
+            expect (temp.getFile().replaceWithText ("plugin noise\n" + String (resultStartMarker)
+                                                      + xml.createDocument (String::empty, true, false)
+                                                      + resultEndMarker + "\nmore noise\n"));
+
+            ChildProcessPluginScanner scanner (createWorkerCommand ("cat \"$3\""));
+            expect (scanner.findPluginTypesFor (format, found, temp.getFile().getFullPathName()));
+            expectEquals (found.size(), 1);
+            expect (found.size() == 1 && found[0]->isDuplicateOf (desc) && found[0]->name == desc.name);
+        }
+
+        beginTest ("Crashing worker");
+        {
+            found.clear();
+            ChildProcessPluginScanner scanner (createWorkerCommand ("echo \"$2 $3\"; kill -9 $$"));
+            expect (! scanner.findPluginTypesFor (format, found, "crash.plugin"));
+            expectEquals (found.size(), 0);
+        }
+
+        beginTest ("Hanging worker");
+        {
+            const uint32 startTime = Time::getMillisecondCounter();
+            ChildProcessPluginScanner scanner (createWorkerCommand ("exec sleep 30"), 200);
+            expect (! scanner.findPluginTypesFor (format, found, "hang.plugin"));
+            expect (Time::getMillisecondCounter() - startTime < 10000);
+        }
+
+        beginTest ("Worker that can't be launched");
+        {
+            found.clear();
+            ChildProcessPluginScanner scanner (String ("/nonexistent/juce_plugin_scanner_worker"));
+            expect (! scanner.findPluginTypesFor (format, found, "missing.plugin"));
+            expectEquals (found.size(), 0);
+        }
+
+        beginTest ("Blacklisting");
+        {
+            KnownPluginList list;
+            list.setCustomScanner (new ChildProcessPluginScanner (createWorkerCommand ("exit 1")));
+
+            expect (! list.scanAndAddFile ("crash.plugin", true, found, format));
+            expect (list.getBlacklistedFiles().contains ("crash.plugin"));
+            expectEquals (list.getNumFilesWithNoPlugins(), 0);
+        }
+
+        beginTest ("Scan requests");
+        {
+            AudioPluginFormatManager formatManager;
+            expect (! ChildProcessPluginScanner::performScanIfRequested (formatManager, StringArray ("--some-other-argument")));
+        }
+    }
+};
+
+static ChildProcessPluginScannerTests childProcessPluginScannerTests;
+
+#endif
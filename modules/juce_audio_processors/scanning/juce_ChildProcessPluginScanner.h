@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_CHILDPROCESSPLUGINSCANNER_H_INCLUDED
+#define JUCE_CHILDPROCESSPLUGINSCANNER_H_INCLUDED
+
+#include "juce_KnownPluginList.h"
+#include "../format/juce_AudioPluginFormatManager.h"
+
+
+//==============================================================================
+/**
+    A KnownPluginList::CustomScanner that loads each plugin in a separate worker
+    process, so that a plugin that crashes or hangs while it's being scanned can't
+    take the host down with it.
+
+    For each file, the scanner launches a worker using the command you give it, adding
+    some extra arguments that describe the file to scan. The worker should be your own
+    app (or a small helper app), which must call performScanIfRequested() at startup -
+    this does the scan, writes the results back to the host through its stdout pipe,
+    and returns true to tell the app to quit.
+
+    If the worker crashes, or doesn't finish within the timeout, it's killed and the
+    file is added to the KnownPluginList's blacklist. The same happens if the worker
+    can't be launched at all: the file is never scanned in the host's own process.
+
+    Because each file gets its own process, calling PluginDirectoryScanner::scanNextFile()
+    from several threads (e.g. with PluginListComponent::setNumberOfThreadsForScanning())
+    will scan files in parallel with a pool of worker processes.
+
+    E.g.
+    @code
+    // in the host:
+    knownPluginList.setCustomScanner (new ChildProcessPluginScanner (File::getSpecialLocation (File::currentExecutableFile)
+                                                                          .getFullPathName()));
+
+    // at the start of the worker's initialise() method:
+    if (ChildProcessPluginScanner::performScanIfRequested (formatManager, getCommandLineParameterArray()))
+    {
+        quit();
+        return;
+    }
+    @endcode
+
+    @see KnownPluginList::setCustomScanner, PluginDirectoryScanner
+*/
+class JUCE_API  ChildProcessPluginScanner  : public KnownPluginList::CustomScanner
+{
+public:
+    //==============================================================================
+    /** Creates a scanner.
+
+        @param workerCommand    the executable to launch, followed by any arguments it needs
+        @param timeoutMs        the time that a worker is given to scan a file before it's
+                                killed and the file is blacklisted
+    */
+    ChildProcessPluginScanner (const StringArray& workerCommand, int timeoutMs = 30000);
+
+    /** Creates a scanner which launches the given executable file. */
+    ChildProcessPluginScanner (const String& workerExecutable, int timeoutMs = 30000);
+
+    /** Destructor. */
+    ~ChildProcessPluginScanner();
+
+    //==============================================================================
+    /** @internal */
+    bool findPluginTypesFor (AudioPluginFormat& format,
+                             OwnedArray <PluginDescription>& result,
+                             const String& fileOrIdentifier) override;
+
+    //==============================================================================
+    /** Checks whether the command-line that a process was launched with is a scan
+        request from a ChildProcessPluginScanner, and if so, performs the scan and
+        writes the results to stdout.
+
+        @returns true if a scan was requested, in which case the process should exit
+    */
+    static bool performScanIfRequested (AudioPluginFormatManager& formatManager,
+                                        const StringArray& commandLineArguments);
+
+private:
+    //==============================================================================
+    StringArray command;
+    int timeoutMs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChildProcessPluginScanner)
+};
+
+
+#endif   // JUCE_CHILDPROCESSPLUGINSCANNER_H_INCLUDED
@@ -25,8 +25,19 @@
 KnownPluginList::KnownPluginList()  {}
 KnownPluginList::~KnownPluginList() {}
 
+static int64 getModificationTimeForScannedFile (const String& fileOrIdentifier)
+{
+    // (some formats use identifiers that aren't files, and these can't be checked)
+    if (File::isAbsolutePath (fileOrIdentifier))
+        return File (fileOrIdentifier).getLastModificationTime().toMilliseconds();
+
+    return 0;
+}
+
 void KnownPluginList::clear()
 {
+    clearFilesWithNoPlugins();
+
     if (types.size() > 0)
     {
         types.clear();
@@ -82,7 +93,10 @@ bool KnownPluginList::isListingUpToDate (const String& fileOrIdentifier,
                                          AudioPluginFormat& formatToUse) const
 {
     if (getTypeForFile (fileOrIdentifier) == nullptr)
-        return false;
+    {
+        const ScopedLock sl (scanLock);
+        return isKnownToHaveNoPlugins (fileOrIdentifier);
+    }
 
     for (int i = types.size(); --i >= 0;)
     {
@@ -108,6 +122,9 @@ bool KnownPluginList::scanAndAddFile (const String& fileOrIdentifier,
 {
     const ScopedLock sl (scanLock);
 
+    if (dontRescanIfAlreadyInList && isKnownToHaveNoPlugins (fileOrIdentifier))
+        return false;
+
     if (dontRescanIfAlreadyInList
          && getTypeForFile (fileOrIdentifier) != nullptr)
     {
@@ -134,6 +151,7 @@ bool KnownPluginList::scanAndAddFile (const String& fileOrIdentifier,
         return false;
 
     OwnedArray <PluginDescription> found;
+    bool crashed = false;
 
     {
         const ScopedUnlock sl2 (scanLock);
@@ -141,7 +159,10 @@ bool KnownPluginList::scanAndAddFile (const String& fileOrIdentifier,
         if (scanner != nullptr)
         {
             if (! scanner->findPluginTypesFor (format, found, fileOrIdentifier))
+            {
                 addToBlacklist (fileOrIdentifier);
+                crashed = true;
+            }
         }
         else
         {
@@ -149,6 +170,13 @@ bool KnownPluginList::scanAndAddFile (const String& fileOrIdentifier,
         }
     }
 
+    const int64 modTime = getModificationTimeForScannedFile (fileOrIdentifier);
+
+    if (found.size() == 0 && ! crashed && modTime != 0)
+        filesWithNoPlugins.set (fileOrIdentifier, modTime);
+    else
+        filesWithNoPlugins.remove (fileOrIdentifier);
+
     for (int i = 0; i < found.size(); ++i)
     {
         PluginDescription* const desc = found.getUnchecked(i);
@@ -238,6 +266,25 @@ void KnownPluginList::clearBlacklistedFiles()
     }
 }
 
+//==============================================================================
+int KnownPluginList::getNumFilesWithNoPlugins() const
+{
+    const ScopedLock sl (scanLock);
+    return filesWithNoPlugins.size();
+}
+
+bool KnownPluginList::isKnownToHaveNoPlugins (const String& fileOrIdentifier) const
+{
+    return filesWithNoPlugins.contains (fileOrIdentifier)
+            && filesWithNoPlugins [fileOrIdentifier] == getModificationTimeForScannedFile (fileOrIdentifier);
+}
+
+void KnownPluginList::clearFilesWithNoPlugins()
+{
+    const ScopedLock sl (scanLock);
+    filesWithNoPlugins.clear();
+}
+
 //==============================================================================
 struct PluginSorter
 {
@@ -293,6 +340,17 @@ XmlElement* KnownPluginList::createXml() const
     for (int i = 0; i < blacklist.size(); ++i)
         e->createNewChildElement ("BLACKLISTED")->setAttribute ("id", blacklist[i]);
 
+    {
+        const ScopedLock sl (scanLock);
+
+        for (HashMap<String, int64>::Iterator i (filesWithNoPlugins); i.next();)
+        {
+            XmlElement* const noPlugins = e->createNewChildElement ("NOPLUGINS");
+            noPlugins->setAttribute ("file", i.getKey());
+            noPlugins->setAttribute ("modified", String::toHexString (i.getValue()));
+        }
+    }
+
     return e;
 }
 
@@ -308,7 +366,15 @@ void KnownPluginList::recreateFromXml (const XmlElement& xml)
             PluginDescription info;
 
             if (e->hasTagName ("BLACKLISTED"))
+            {
                 blacklist.add (e->getStringAttribute ("id"));
+            }
+            else if (e->hasTagName ("NOPLUGINS"))
+            {
+                const ScopedLock sl (scanLock);
+                filesWithNoPlugins.set (e->getStringAttribute ("file"),
+                                        e->getStringAttribute ("modified").getHexValue64());
+            }
             else if (info.loadFromXml (*e))
                 addType (info);
         }
@@ -501,3 +567,106 @@ int KnownPluginList::getIndexChosenByMenu (const int menuResultCode) const
 //==============================================================================
 KnownPluginList::CustomScanner::CustomScanner() {}
 KnownPluginList::CustomScanner::~CustomScanner() {}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class KnownPluginListTests  : public UnitTest
+{
+public:
+    KnownPluginListTests()  : UnitTest ("KnownPluginList") {}
+
+    // A format that finds one plugin in any file whose name ends in ".plugin",
+    // and counts how many times it has been asked to scan a file.
+    struct TestFormat  : public AudioPluginFormat
+    {
+        TestFormat() : numScans (0) {}
+
+        String getName() const override     { return "Test"; }
+
+        void findAllTypesForFile (OwnedArray <PluginDescription>& results, const String& fileOrIdentifier) override
+        {
+            ++numScans;
+
+            if (fileOrIdentifier.endsWith (".plugin"))
+            {
+                PluginDescription* const desc = new PluginDescription();
+                desc->name = "Test plugin";
+                desc->pluginFormatName = getName();
+                desc->fileOrIdentifier = fileOrIdentifier;
+                results.add (desc);
+            }
+        }
+
+        AudioPluginInstance* createInstanceFromDescription (const PluginDescription&) override   { return nullptr; }
+        bool fileMightContainThisPluginType (const String&) override                             { return true; }
+        String getNameOfPluginFromIdentifier (const String& fileOrIdentifier) override          { return fileOrIdentifier; }
+        bool pluginNeedsRescanning (const PluginDescription&) override                           { return false; }
+        bool doesPluginStillExist (const PluginDescription&) override                            { return true; }
+        bool canScanForPlugins() const override                                                  { return true; }
+        StringArray searchPathsForPlugins (const FileSearchPath&, bool) override                 { return StringArray(); }
+        FileSearchPath getDefaultLocationsToSearch() override                                    { return FileSearchPath(); }
+
+        int numScans;
+    };
+
+    void runTest()
+    {
+        beginTest ("Files with no plugins");
+
+        const TemporaryFile emptyTemp (".dll"), pluginTemp (".plugin");
+        const File& emptyFile = emptyTemp.getFile();
+        const File& pluginFile = pluginTemp.getFile();
+        expect (emptyFile.replaceWithText ("not a plugin"));
+        expect (pluginFile.replaceWithText ("a plugin"));
+
+        TestFormat format;
+        KnownPluginList list;
+        OwnedArray <PluginDescription> found;
+
+        expect (! list.scanAndAddFile (emptyFile.getFullPathName(), true, found, format));
+        expect (list.scanAndAddFile (pluginFile.getFullPathName(), true, found, format));
+        expect (! list.scanAndAddFile ("not-a-file", true, found, format));
+        expectEquals (format.numScans, 3);
+        expectEquals (list.getNumTypes(), 1);
+
+        // identifiers that aren't files have no modification time, so aren't remembered
+        expectEquals (list.getNumFilesWithNoPlugins(), 1);
+        expect (list.isListingUpToDate (emptyFile.getFullPathName(), format));
+        expect (! list.isListingUpToDate ("not-a-file", format));
+
+        expect (! list.scanAndAddFile (emptyFile.getFullPathName(), true, found, format));
+        expectEquals (format.numScans, 3);
+
+        expect (! list.scanAndAddFile (emptyFile.getFullPathName(), false, found, format));
+        expectEquals (format.numScans, 4);
+
+        beginTest ("Saving files with no plugins");
+
+        const ScopedPointer<XmlElement> xml (list.createXml());
+        KnownPluginList restored;
+        restored.recreateFromXml (*xml);
+
+        expectEquals (restored.getNumTypes(), 1);
+        expectEquals (restored.getNumFilesWithNoPlugins(), 1);
+        expect (restored.isListingUpToDate (emptyFile.getFullPathName(), format));
+
+        beginTest ("Modified files are rescanned");
+
+        expect (emptyFile.setLastModificationTime (emptyFile.getLastModificationTime() + RelativeTime::seconds (10.0)));
+        expect (! restored.isListingUpToDate (emptyFile.getFullPathName(), format));
+
+        expect (! restored.scanAndAddFile (emptyFile.getFullPathName(), true, found, format));
+        expectEquals (format.numScans, 5);
+        expect (restored.isListingUpToDate (emptyFile.getFullPathName(), format));
+
+        restored.clearFilesWithNoPlugins();
+        expectEquals (restored.getNumFilesWithNoPlugins(), 0);
+        expect (! restored.isListingUpToDate (emptyFile.getFullPathName(), format));
+    }
+};
+
+static KnownPluginListTests knownPluginListTests;
+
+#endif
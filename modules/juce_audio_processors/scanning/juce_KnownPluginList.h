@@ -102,6 +102,9 @@ public:
 
     /** Returns true if the specified file is already known about and if it
         hasn't been modified since our entry was created.
+
+        This is also true for files that have been scanned before and found to contain
+        no plugins, as long as they haven't been modified since then.
     */
     bool isListingUpToDate (const String& possiblePluginFileOrIdentifier,
                             AudioPluginFormat& formatToUse) const;
@@ -126,6 +129,20 @@ public:
     /** Clears all the blacklisted files. */
     void clearBlacklistedFiles();
 
+    //==============================================================================
+    /** Returns the number of files that have been scanned and found not to contain
+        any plugins.
+
+        These files are remembered along with their modification times (and are saved
+        by createXml()), so that they won't be scanned again unless they change.
+    */
+    int getNumFilesWithNoPlugins() const;
+
+    /** Forgets about any files that were found not to contain plugins, so that they'll
+        be scanned again.
+    */
+    void clearFilesWithNoPlugins();
+
     //==============================================================================
     /** Sort methods used to change the order of the plugins in the list.
     */
@@ -200,9 +217,12 @@ private:
     //==============================================================================
     OwnedArray <PluginDescription> types;
     StringArray blacklist;
+    HashMap<String, int64> filesWithNoPlugins;
     ScopedPointer<CustomScanner> scanner;
     CriticalSection scanLock;
 
+    bool isKnownToHaveNoPlugins (const String&) const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KnownPluginList)
 };
 
@@ -92,14 +92,19 @@ bool PluginDirectoryScanner::scanNextFile (const bool dontRescanIfAlreadyInList,
             OwnedArray <PluginDescription> typesFound;
 
             // Add this plugin to the end of the dead-man's pedal list in case it crashes...
-            StringArray crashedPlugins (readDeadMansPedalFile (deadMansPedalFile));
-            crashedPlugins.removeString (file);
-            crashedPlugins.add (file);
-            setDeadMansPedalFile (crashedPlugins);
+            {
+                const ScopedLock sl (lock);
+                StringArray crashedPlugins (readDeadMansPedalFile (deadMansPedalFile));
+                crashedPlugins.removeString (file);
+                crashedPlugins.add (file);
+                setDeadMansPedalFile (crashedPlugins);
+            }
 
             list.scanAndAddFile (file, dontRescanIfAlreadyInList, typesFound, format);
 
             // Managed to load without crashing, so remove it from the dead-man's-pedal..
+            const ScopedLock sl (lock);
+            StringArray crashedPlugins (readDeadMansPedalFile (deadMansPedalFile));
             crashedPlugins.removeString (file);
             setDeadMansPedalFile (crashedPlugins);
 
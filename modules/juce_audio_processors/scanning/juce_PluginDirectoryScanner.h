@@ -34,7 +34,12 @@
     Scans a directory for plugins, and adds them to a KnownPluginList.
 
     To use one of these, create it and call scanNextFile() repeatedly, until
-    it returns false.
+    it returns false. scanNextFile() can be called from several threads at once
+    to scan more than one file at a time - this works best when the KnownPluginList
+    has a CustomScanner that loads each plugin in a separate process, such as a
+    ChildProcessPluginScanner.
+
+    @see ChildProcessPluginScanner
 */
 class JUCE_API  PluginDirectoryScanner
 {
@@ -117,6 +122,7 @@ private:
     StringArray filesOrIdentifiersToScan;
     File deadMansPedalFile;
     StringArray failedFiles;
+    CriticalSection lock;
     Atomic<int> nextIndex;
     float progress;
 
@@ -126,6 +126,8 @@ void AudioProcessorPlayer::audioDeviceIOCallback (const float** const inputChann
     {
         const ScopedLock sl2 (processor->getCallbackLock());
 
+        processor->prepareParameterChanges (numSamples);
+
         if (processor->isSuspended())
         {
             for (int i = 0; i < numOutputChannels; ++i)
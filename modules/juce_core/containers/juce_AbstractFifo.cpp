@@ -231,4 +231,156 @@ public:
 
 static AbstractFifoTests fifoUnitTests;
 
+//==============================================================================
+class TypedFifoTests  : public UnitTest
+{
+public:
+    TypedFifoTests() : UnitTest ("Typed Fifos") {}
+
+    void runTest()
+    {
+        beginTest ("TypedFifo");
+
+        {
+            TypedFifo<String> fifo (10);
+            expectEquals (fifo.getCapacity(), 10);
+            expectEquals (fifo.getFreeSpace(), 10);
+
+            for (int i = 0; i < 10; ++i)
+                expect (fifo.push (String (i)));
+
+            expect (! fifo.push ("overflow"));
+            expectEquals (fifo.getNumReady(), 10);
+
+            String s;
+            for (int i = 0; i < 4; ++i)
+            {
+                expect (fifo.pop (s));
+                expectEquals (s, String (i));
+            }
+
+            const String more[] = { "a", "b", "c", "d", "e", "f" };
+            expectEquals (fifo.pushBlock (more, numElementsInArray (more)), 4);
+
+            String results [20];
+            expectEquals (fifo.popBlock (results, numElementsInArray (results)), 10);
+            expectEquals (results[5], String ("9"));
+            expectEquals (results[9], String ("d"));
+            expect (! fifo.pop (s));
+        }
+
+        beginTest ("ConcurrentFifo");
+
+        {
+            ConcurrentFifo<int> fifo (100);
+            expectEquals (fifo.getCapacity(), 128);
+
+            for (int i = 0; i < 128; ++i)
+                expect (fifo.push (i));
+
+            expect (! fifo.push (-1));
+
+            int n = 0;
+            for (int i = 0; i < 128; ++i)
+            {
+                expect (fifo.pop (n));
+                expectEquals (n, i);
+            }
+
+            expect (! fifo.pop (n));
+        }
+
+        for (int numThreads = 1; numThreads <= 16; numThreads *= 2)
+            testContention (numThreads);
+    }
+
+    //==============================================================================
+    // Runs equal numbers of writer and reader threads against one queue, and checks that
+    // every item is received exactly once.
+    void testContention (const int numThreads)
+    {
+        beginTest ("ConcurrentFifo contention: " + String (numThreads) + " threads");
+
+        const int itemsPerWriter = 200000 / numThreads;
+        const int64 expectedTotal = numThreads * (int64) itemsPerWriter;
+
+        ConcurrentFifo<int> fifo (1024);
+        Atomic<int> numRead;
+        Atomic<int64> sumRead;
+        OwnedArray<Thread> threads;
+
+        for (int i = 0; i < numThreads; ++i)
+        {
+            threads.add (new Writer (fifo, itemsPerWriter));
+            threads.add (new Reader (fifo, numRead, sumRead, (int) expectedTotal));
+        }
+
+        const uint32 startTime = Time::getMillisecondCounter();
+
+        for (int i = 0; i < threads.size(); ++i)
+            threads.getUnchecked(i)->startThread();
+
+        for (int i = 0; i < threads.size(); ++i)
+            threads.getUnchecked(i)->waitForThreadToExit (-1);
+
+        const uint32 elapsed = jmax ((uint32) 1, Time::getMillisecondCounter() - startTime);
+
+        expectEquals (numRead.get(), (int) expectedTotal);
+        expect (sumRead.get() == numThreads * ((int64) itemsPerWriter * (itemsPerWriter - 1) / 2));
+
+        logMessage (String (numThreads) + " writers + " + String (numThreads) + " readers: "
+                      + String ((int) (expectedTotal * 1000 / elapsed)) + " items/sec");
+    }
+
+    class Writer  : public Thread
+    {
+    public:
+        Writer (ConcurrentFifo<int>& f, int num)  : Thread ("fifo writer"), fifo (f), numToWrite (num) {}
+
+        void run()
+        {
+            for (int i = 0; i < numToWrite; ++i)
+                while (! fifo.push (i))
+                    Thread::yield();
+        }
+
+    private:
+        ConcurrentFifo<int>& fifo;
+        const int numToWrite;
+    };
+
+    class Reader  : public Thread
+    {
+    public:
+        Reader (ConcurrentFifo<int>& f, Atomic<int>& n, Atomic<int64>& s, int total)
+            : Thread ("fifo reader"), fifo (f), numRead (n), sumRead (s), totalExpected (total) {}
+
+        void run()
+        {
+            int value;
+
+            while (numRead.get() < totalExpected)
+            {
+                if (fifo.pop (value))
+                {
+                    sumRead += (int64) value;
+                    ++numRead;
+                }
+                else
+                {
+                    Thread::yield();
+                }
+            }
+        }
+
+    private:
+        ConcurrentFifo<int>& fifo;
+        Atomic<int>& numRead;
+        Atomic<int64>& sumRead;
+        const int totalExpected;
+    };
+};
+
+static TypedFifoTests typedFifoUnitTests;
+
 #endif
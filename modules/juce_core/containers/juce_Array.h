@@ -52,11 +52,16 @@
     To make all the array's methods thread-safe, pass in "CriticalSection" as the templated
     TypeOfCriticalSectionToUse parameter, instead of the default DummyCriticalSection.
 
-    @see OwnedArray, ReferenceCountedArray, StringArray, CriticalSection
+    The AllocatorType parameter chooses where the array's storage comes from - e.g. use
+    MemoryPoolAllocator to keep an array that's modified on an audio thread away from the
+    system allocator.
+
+    @see OwnedArray, ReferenceCountedArray, StringArray, CriticalSection, MemoryPoolAllocator
 */
 template <typename ElementType,
           typename TypeOfCriticalSectionToUse = DummyCriticalSection,
-          int minimumAllocatedSize = 0>
+          int minimumAllocatedSize = 0,
+          class AllocatorType = SystemAllocator>
 class Array
 {
 private:
@@ -73,7 +78,7 @@ public:
     /** Creates a copy of another array.
         @param other    the array to copy
     */
-    Array (const Array<ElementType, TypeOfCriticalSectionToUse>& other)
+    Array (const Array& other)
     {
         const ScopedLockType lock (other.getLock());
         numUsed = other.numUsed;
@@ -84,8 +89,8 @@ public:
     }
 
    #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
-    Array (Array<ElementType, TypeOfCriticalSectionToUse>&& other) noexcept
-        : data (static_cast <ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse>&&> (other.data)),
+    Array (Array&& other) noexcept
+        : data (static_cast <ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse, AllocatorType>&&> (other.data)),
           numUsed (other.numUsed)
     {
         other.numUsed = 0;
@@ -132,7 +137,7 @@ public:
     {
         if (this != &other)
         {
-            Array<ElementType, TypeOfCriticalSectionToUse> otherCopy (other);
+            Array otherCopy (other);
             swapWith (otherCopy);
         }
 
@@ -143,7 +148,7 @@ public:
     Array& operator= (Array&& other) noexcept
     {
         const ScopedLockType lock (getLock());
-        data = static_cast <ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse>&&> (other.data);
+        data = static_cast <ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse, AllocatorType>&&> (other.data);
         numUsed = other.numUsed;
         other.numUsed = 0;
         return *this;
@@ -1029,7 +1034,7 @@ public:
 
 private:
     //==============================================================================
-    ArrayAllocationBase <ElementType, TypeOfCriticalSectionToUse> data;
+    ArrayAllocationBase <ElementType, TypeOfCriticalSectionToUse, AllocatorType> data;
     int numUsed;
 
     void removeInternal (const int indexToRemove)
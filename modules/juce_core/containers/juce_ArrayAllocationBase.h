@@ -40,9 +40,12 @@
     It inherits from a critical section class to allow the arrays to use
     the "empty base class optimisation" pattern to reduce their footprint.
 
+    The AllocatorType is passed on to the HeapBlock that holds the elements - see
+    SystemAllocator and MemoryPoolAllocator.
+
     @see Array, OwnedArray, ReferenceCountedArray
 */
-template <class ElementType, class TypeOfCriticalSectionToUse>
+template <class ElementType, class TypeOfCriticalSectionToUse, class AllocatorType = SystemAllocator>
 class ArrayAllocationBase  : public TypeOfCriticalSectionToUse
 {
 public:
@@ -59,15 +62,15 @@ public:
     }
 
    #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
-    ArrayAllocationBase (ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse>&& other) noexcept
-        : elements (static_cast <HeapBlock <ElementType>&&> (other.elements)),
+    ArrayAllocationBase (ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse, AllocatorType>&& other) noexcept
+        : elements (static_cast <HeapBlock <ElementType, false, AllocatorType>&&> (other.elements)),
           numAllocated (other.numAllocated)
     {
     }
 
-    ArrayAllocationBase& operator= (ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse>&& other) noexcept
+    ArrayAllocationBase& operator= (ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse, AllocatorType>&& other) noexcept
     {
-        elements = static_cast <HeapBlock <ElementType>&&> (other.elements);
+        elements = static_cast <HeapBlock <ElementType, false, AllocatorType>&&> (other.elements);
         numAllocated = other.numAllocated;
         return *this;
     }
@@ -120,14 +123,14 @@ public:
     }
 
     /** Swap the contents of two objects. */
-    void swapWith (ArrayAllocationBase <ElementType, TypeOfCriticalSectionToUse>& other) noexcept
+    void swapWith (ArrayAllocationBase <ElementType, TypeOfCriticalSectionToUse, AllocatorType>& other) noexcept
     {
         elements.swapWith (other.elements);
         std::swap (numAllocated, other.numAllocated);
     }
 
     //==============================================================================
-    HeapBlock <ElementType> elements;
+    HeapBlock <ElementType, false, AllocatorType> elements;
     int numAllocated;
 
 private:
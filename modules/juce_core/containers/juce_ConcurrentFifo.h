@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+   This file is part of the juce_core module of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose with
+   or without fee is hereby granted, provided that the above copyright notice and this
+   permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+   ------------------------------------------------------------------------------
+
+   NOTE! This permissive ISC license applies ONLY to files within the juce_core module!
+   All other JUCE modules are covered by a dual GPL/commercial license, so if you are
+   using any other modules, be sure to check that you also comply with their license.
+
+   For more details, visit www.juce.com
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_CONCURRENTFIFO_H_INCLUDED
+#define JUCE_CONCURRENTFIFO_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A bounded, lock-free FIFO that can be used by multiple writer and reader threads.
+
+    Unlike AbstractFifo and TypedFifo, which only support a single reader and a single
+    writer, this class lets any number of threads push and pop items concurrently. It's
+    useful when events need to be funnelled in from several threads (e.g. MIDI or
+    parameter changes arriving from UI, network and timer threads) to be consumed by
+    the audio thread.
+
+    Each slot in the buffer carries a sequence number which the pushing and popping
+    threads use to claim it, so neither operation ever blocks or allocates. The read
+    and write positions are kept on separate cache lines to avoid false sharing between
+    producers and consumers.
+
+    The capacity is rounded up to a power of two. The ElementType must be
+    default-constructible and copyable.
+
+    @see TypedFifo, AbstractFifo
+*/
+template <typename ElementType>
+class ConcurrentFifo
+{
+public:
+    //==============================================================================
+    /** Creates a FIFO that can hold at least the given number of items. */
+    explicit ConcurrentFifo (const int minimumCapacity)
+        : capacity (nextPowerOfTwo (jmax (2, minimumCapacity))),
+          cells (static_cast <size_t> (capacity))
+    {
+        for (int i = 0; i < capacity; ++i)
+            new (cells + i) Cell ((uint32) i);
+    }
+
+    /** Destructor. */
+    ~ConcurrentFifo()
+    {
+        for (int i = capacity; --i >= 0;)
+            cells[i].~Cell();
+    }
+
+    //==============================================================================
+    /** Returns the maximum number of items that the FIFO can hold. */
+    int getCapacity() const noexcept        { return capacity; }
+
+    /** Returns the approximate number of items waiting to be read.
+        If other threads are using the FIFO, the value may be out-of-date by the
+        time you use it.
+    */
+    int getNumReady() const noexcept
+    {
+        const int num = (int) (writePosition.get() - readPosition.get());
+        return jlimit (0, capacity, num);
+    }
+
+    //==============================================================================
+    /** Adds an item to the FIFO.
+        This can be called safely by any number of threads at once.
+        @returns false if the FIFO was full
+    */
+    bool push (const ElementType& item)
+    {
+        const uint32 mask = (uint32) capacity - 1;
+        uint32 pos = writePosition.get();
+
+        for (;;)
+        {
+            Cell& cell = cells [pos & mask];
+            const int diff = (int) (cell.sequence.get() - pos);
+
+            if (diff == 0)
+            {
+                if (writePosition.compareAndSetBool (pos + 1, pos))
+                {
+                    cell.data = item;
+                    cell.sequence = pos + 1;
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+
+            pos = writePosition.get();
+        }
+    }
+
+    /** Removes the oldest item from the FIFO.
+        This can be called safely by any number of threads at once.
+        @returns false if the FIFO was empty, in which case the result is left unchanged
+    */
+    bool pop (ElementType& result)
+    {
+        const uint32 mask = (uint32) capacity - 1;
+        uint32 pos = readPosition.get();
+
+        for (;;)
+        {
+            Cell& cell = cells [pos & mask];
+            const int diff = (int) (cell.sequence.get() - (pos + 1));
+
+            if (diff == 0)
+            {
+                if (readPosition.compareAndSetBool (pos + 1, pos))
+                {
+                    result = cell.data;
+                    cell.sequence = pos + (uint32) capacity;
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+
+            pos = readPosition.get();
+        }
+    }
+
+    /** Adds as many items from an array as will fit.
+        Other threads may interleave their own items between the ones added here.
+        @returns the number of items that were added
+    */
+    int pushBlock (const ElementType* items, int numItems)
+    {
+        int numDone = 0;
+
+        while (numDone < numItems && push (items [numDone]))
+            ++numDone;
+
+        return numDone;
+    }
+
+    /** Removes up to the given number of items, copying them into an array.
+        @returns the number of items that were read
+    */
+    int popBlock (ElementType* destItems, int maxNumItems)
+    {
+        int numDone = 0;
+
+        while (numDone < maxNumItems && pop (destItems [numDone]))
+            ++numDone;
+
+        return numDone;
+    }
+
+private:
+    //==============================================================================
+    enum { cacheLineSize = 64 };
+
+    struct Cell
+    {
+        explicit Cell (uint32 initialSequence) noexcept  : sequence (initialSequence) {}
+
+        Atomic<uint32> sequence;
+        ElementType data;
+    };
+
+    const int capacity;
+    HeapBlock<Cell> cells;
+
+    char padding1 [cacheLineSize];
+    Atomic<uint32> writePosition;
+    char padding2 [cacheLineSize - sizeof (Atomic<uint32>)];
+    Atomic<uint32> readPosition;
+    char padding3 [cacheLineSize - sizeof (Atomic<uint32>)];
+
+    JUCE_DECLARE_NON_COPYABLE (ConcurrentFifo)
+};
+
+
+#endif   // JUCE_CONCURRENTFIFO_H_INCLUDED
@@ -47,10 +47,14 @@
     To make all the array's methods thread-safe, pass in "CriticalSection" as the templated
     TypeOfCriticalSectionToUse parameter, instead of the default DummyCriticalSection.
 
-    @see Array, ReferenceCountedArray, StringArray, CriticalSection
+    The AllocatorType parameter chooses where the array of pointers is allocated - see
+    Array and MemoryPoolAllocator.
+
+    @see Array, ReferenceCountedArray, StringArray, CriticalSection, MemoryPoolAllocator
 */
 template <class ObjectClass,
-          class TypeOfCriticalSectionToUse = DummyCriticalSection>
+          class TypeOfCriticalSectionToUse = DummyCriticalSection,
+          class AllocatorType = SystemAllocator>
 
 class OwnedArray
 {
@@ -74,7 +78,7 @@ public:
 
    #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
     OwnedArray (OwnedArray&& other) noexcept
-        : data (static_cast <ArrayAllocationBase <ObjectClass*, TypeOfCriticalSectionToUse>&&> (other.data)),
+        : data (static_cast <ArrayAllocationBase <ObjectClass*, TypeOfCriticalSectionToUse, AllocatorType>&&> (other.data)),
           numUsed (other.numUsed)
     {
         other.numUsed = 0;
@@ -85,7 +89,7 @@ public:
         const ScopedLockType lock (getLock());
         deleteAllObjects();
 
-        data = static_cast <ArrayAllocationBase <ObjectClass*, TypeOfCriticalSectionToUse>&&> (other.data);
+        data = static_cast <ArrayAllocationBase <ObjectClass*, TypeOfCriticalSectionToUse, AllocatorType>&&> (other.data);
         numUsed = other.numUsed;
         other.numUsed = 0;
         return *this;
@@ -871,7 +875,7 @@ public:
 
 private:
     //==============================================================================
-    ArrayAllocationBase <ObjectClass*, TypeOfCriticalSectionToUse> data;
+    ArrayAllocationBase <ObjectClass*, TypeOfCriticalSectionToUse, AllocatorType> data;
     int numUsed;
 
     void deleteAllObjects()
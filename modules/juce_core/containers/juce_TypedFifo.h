@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+   This file is part of the juce_core module of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose with
+   or without fee is hereby granted, provided that the above copyright notice and this
+   permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+   ------------------------------------------------------------------------------
+
+   NOTE! This permissive ISC license applies ONLY to files within the juce_core module!
+   All other JUCE modules are covered by a dual GPL/commercial license, so if you are
+   using any other modules, be sure to check that you also comply with their license.
+
+   For more details, visit www.juce.com
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_TYPEDFIFO_H_INCLUDED
+#define JUCE_TYPEDFIFO_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A single-reader, single-writer lock-free FIFO that holds a buffer of objects.
+
+    This wraps up an AbstractFifo together with the storage it manages, so that you
+    don't need to write the usual prepareToWrite/copy/finishedWrite boilerplate
+    yourself. Objects are copied in and out using their assignment operator, so the
+    ElementType must be default-constructible and copyable.
+
+    Only one thread may push items and only one thread may pop them. If you need
+    several producers or consumers, use a ConcurrentFifo instead.
+
+    e.g.
+    @code
+    TypedFifo<MidiMessage> fifo (512);
+
+    // on the writer thread:
+    fifo.push (MidiMessage::noteOn (1, 64, 0.5f));
+
+    // on the reader thread:
+    MidiMessage m;
+    while (fifo.pop (m))
+        handleMessage (m);
+    @endcode
+
+    @see AbstractFifo, ConcurrentFifo
+*/
+template <typename ElementType>
+class TypedFifo
+{
+public:
+    //==============================================================================
+    /** Creates a FIFO that can hold up to the given number of items. */
+    explicit TypedFifo (const int capacity)
+        : fifo (capacity + 1), buffer (static_cast <size_t> (capacity + 1))
+    {
+        jassert (capacity > 0);
+
+        for (int i = 0; i <= capacity; ++i)
+            new (buffer + i) ElementType();
+    }
+
+    /** Destructor. */
+    ~TypedFifo()
+    {
+        for (int i = fifo.getTotalSize(); --i >= 0;)
+            buffer[i].~ElementType();
+    }
+
+    //==============================================================================
+    /** Returns the maximum number of items that the FIFO can hold. */
+    int getCapacity() const noexcept                { return fifo.getTotalSize() - 1; }
+
+    /** Returns the number of items that can be read. */
+    int getNumReady() const noexcept                { return fifo.getNumReady(); }
+
+    /** Returns the number of items that can be added before the FIFO is full. */
+    int getFreeSpace() const noexcept               { return fifo.getFreeSpace() - 1; }
+
+    /** Empties the FIFO.
+        This isn't thread-safe, so must not be called while other threads are using it.
+    */
+    void reset() noexcept                           { fifo.reset(); }
+
+    //==============================================================================
+    /** Adds an item to the FIFO.
+        @returns false if there wasn't enough space for it
+    */
+    bool push (const ElementType& item)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 <= 0)
+            return false;
+
+        buffer [start1] = item;
+        fifo.finishedWrite (1);
+        return true;
+    }
+
+    /** Removes the next item from the FIFO.
+        @returns false if the FIFO was empty, in which case the result is left unchanged
+    */
+    bool pop (ElementType& result)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (1, start1, size1, start2, size2);
+
+        if (size1 <= 0)
+            return false;
+
+        result = buffer [start1];
+        fifo.finishedRead (1);
+        return true;
+    }
+
+    //==============================================================================
+    /** Adds as many items from an array as will fit into the free space.
+        @returns the number of items that were actually added
+    */
+    int pushBlock (const ElementType* items, int numItems)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numItems, start1, size1, start2, size2);
+
+        copyItems (buffer + start1, items, size1);
+        copyItems (buffer + start2, items + size1, size2);
+
+        fifo.finishedWrite (size1 + size2);
+        return size1 + size2;
+    }
+
+    /** Removes up to the given number of items, copying them into an array.
+        @returns the number of items that were actually read
+    */
+    int popBlock (ElementType* destItems, int maxNumItems)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (maxNumItems, start1, size1, start2, size2);
+
+        copyItems (destItems, buffer + start1, size1);
+        copyItems (destItems + size1, buffer + start2, size2);
+
+        fifo.finishedRead (size1 + size2);
+        return size1 + size2;
+    }
+
+private:
+    //==============================================================================
+    AbstractFifo fifo;
+    HeapBlock<ElementType> buffer;
+
+    static void copyItems (ElementType* dest, const ElementType* src, int num)
+    {
+        while (--num >= 0)
+            *dest++ = *src++;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (TypedFifo)
+};
+
+
+#endif   // JUCE_TYPEDFIFO_H_INCLUDED
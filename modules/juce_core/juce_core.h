@@ -91,6 +91,30 @@
  #define JUCE_CHECK_MEMORY_LEAKS 1
 #endif
 
+//=============================================================================
+/** Config: JUCE_CHECK_REALTIME_ALLOCATIONS
+
+    If enabled, HeapBlock (and therefore Array, MemoryBlock and most other containers) will
+    assert whenever it calls the system allocator on a thread that has been marked with
+    MemoryPool::setCurrentThreadIsRealtime(). The number of these allocations can be read with
+    MemoryPool::getNumRealtimeSystemAllocations().
+*/
+#ifndef JUCE_CHECK_REALTIME_ALLOCATIONS
+ #define JUCE_CHECK_REALTIME_ALLOCATIONS 0
+#endif
+
+//=============================================================================
+/** Config: JUCE_ENABLE_TRACING
+
+    Enables the JUCE_TRACE_ZONE, JUCE_TRACE_COUNTER, etc. macros, and the trace points that are
+    built into the library's own hot paths. When the TraceRecorder isn't recording, each of these
+    just costs a check of a flag, so if you need to capture traces from a release build, it's
+    usually fine to turn this on.
+*/
+#ifndef JUCE_ENABLE_TRACING
+ #define JUCE_ENABLE_TRACING 0
+#endif
+
 //=============================================================================
 /** Config: JUCE_DONT_AUTOLINK_TO_WIN32_LIBRARIES
 
@@ -159,6 +183,7 @@ class JSONFormatter;
 #include "memory/juce_MemoryBlock.h"
 #include "memory/juce_ReferenceCountedObject.h"
 #include "memory/juce_ScopedPointer.h"
+#include "memory/juce_MemoryPool.h"
 #include "memory/juce_OptionalScopedPointer.h"
 #include "memory/juce_Singleton.h"
 #include "memory/juce_WeakReference.h"
@@ -173,6 +198,8 @@ class JSONFormatter;
 #include "containers/juce_SortedSet.h"
 #include "containers/juce_SparseSet.h"
 #include "containers/juce_AbstractFifo.h"
+#include "containers/juce_TypedFifo.h"
+#include "containers/juce_ConcurrentFifo.h"
 #include "text/juce_NewLine.h"
 #include "text/juce_StringPool.h"
 #include "text/juce_Identifier.h"
@@ -237,6 +264,7 @@ class JSONFormatter;
 #include "network/juce_Socket.h"
 #include "network/juce_URL.h"
 #include "time/juce_PerformanceCounter.h"
+#include "time/juce_TraceRecorder.h"
 #include "unit_tests/juce_UnitTest.h"
 #include "xml/juce_XmlDocument.h"
 #include "xml/juce_XmlElement.h"
@@ -40,6 +40,30 @@ namespace HeapBlockHelper
 }
 #endif
 
+//==============================================================================
+/**
+    The default allocator type used by HeapBlock, which just calls the standard
+    malloc, calloc, realloc and free functions.
+
+    If JUCE_CHECK_REALTIME_ALLOCATIONS is enabled, this will also complain about any
+    allocations made on a thread that has been marked with MemoryPool::setCurrentThreadIsRealtime().
+
+    @see HeapBlock, MemoryPoolAllocator
+*/
+struct JUCE_API  SystemAllocator
+{
+    static void* allocate (size_t numBytes) noexcept                  { checkThread(); return std::malloc (numBytes); }
+    static void* allocateZeroed (size_t numBytes) noexcept            { checkThread(); return std::calloc (numBytes, 1); }
+    static void* reallocate (void* block, size_t numBytes) noexcept   { checkThread(); return std::realloc (block, numBytes); }
+    static void release (void* block) noexcept                        { std::free (block); }
+
+   #if JUCE_CHECK_REALTIME_ALLOCATIONS
+    static void checkThread() noexcept;
+   #else
+    static void checkThread() noexcept {}
+   #endif
+};
+
 //==============================================================================
 /**
     Very simple container class to hold a pointer to some data on the heap.
@@ -84,9 +108,13 @@ namespace HeapBlockHelper
     then a failed allocation will just leave the heapblock with a null pointer (assuming
     that the system's malloc() function doesn't throw).
 
-    @see Array, OwnedArray, MemoryBlock
+    The AllocatorType parameter lets you choose where the memory comes from. By default
+    it uses SystemAllocator, but you could use a MemoryPoolAllocator to make it take its
+    blocks from a MemoryPool, so that it's safe to allocate on a realtime thread.
+
+    @see Array, OwnedArray, MemoryBlock, MemoryPool
 */
-template <class ElementType, bool throwOnFailure = false>
+template <class ElementType, bool throwOnFailure = false, class AllocatorType = SystemAllocator>
 class HeapBlock
 {
 public:
@@ -109,7 +137,7 @@ public:
         other constructor that takes an InitialisationState parameter.
     */
     explicit HeapBlock (const size_t numElements)
-        : data (static_cast <ElementType*> (std::malloc (numElements * sizeof (ElementType))))
+        : data (static_cast <ElementType*> (AllocatorType::allocate (numElements * sizeof (ElementType))))
     {
         throwOnAllocationFailure();
     }
@@ -121,8 +149,8 @@ public:
     */
     HeapBlock (const size_t numElements, const bool initialiseToZero)
         : data (static_cast <ElementType*> (initialiseToZero
-                                               ? std::calloc (numElements, sizeof (ElementType))
-                                               : std::malloc (numElements * sizeof (ElementType))))
+                                               ? AllocatorType::allocateZeroed (numElements * sizeof (ElementType))
+                                               : AllocatorType::allocate (numElements * sizeof (ElementType))))
     {
         throwOnAllocationFailure();
     }
@@ -132,7 +160,7 @@ public:
     */
     ~HeapBlock()
     {
-        std::free (data);
+        AllocatorType::release (data);
     }
 
    #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
@@ -207,7 +235,7 @@ public:
     //==============================================================================
     /** Allocates a specified amount of memory.
 
-        This uses the normal malloc to allocate an amount of memory for this object.
+        This uses the block's AllocatorType (normally just malloc) to allocate an amount of memory for this object.
         Any previously allocated memory will be freed by this method.
 
         The number of bytes allocated will be (newNumElements * elementSize). Normally
@@ -219,8 +247,8 @@ public:
     */
     void malloc (const size_t newNumElements, const size_t elementSize = sizeof (ElementType))
     {
-        std::free (data);
-        data = static_cast <ElementType*> (std::malloc (newNumElements * elementSize));
+        AllocatorType::release (data);
+        data = static_cast <ElementType*> (AllocatorType::allocate (newNumElements * elementSize));
         throwOnAllocationFailure();
     }
 
@@ -229,8 +257,8 @@ public:
     */
     void calloc (const size_t newNumElements, const size_t elementSize = sizeof (ElementType))
     {
-        std::free (data);
-        data = static_cast <ElementType*> (std::calloc (newNumElements, elementSize));
+        AllocatorType::release (data);
+        data = static_cast <ElementType*> (AllocatorType::allocateZeroed (newNumElements * elementSize));
         throwOnAllocationFailure();
     }
 
@@ -240,10 +268,10 @@ public:
     */
     void allocate (const size_t newNumElements, bool initialiseToZero)
     {
-        std::free (data);
+        AllocatorType::release (data);
         data = static_cast <ElementType*> (initialiseToZero
-                                             ? std::calloc (newNumElements, sizeof (ElementType))
-                                             : std::malloc (newNumElements * sizeof (ElementType)));
+                                             ? AllocatorType::allocateZeroed (newNumElements * sizeof (ElementType))
+                                             : AllocatorType::allocate (newNumElements * sizeof (ElementType)));
         throwOnAllocationFailure();
     }
 
@@ -254,8 +282,8 @@ public:
     */
     void realloc (const size_t newNumElements, const size_t elementSize = sizeof (ElementType))
     {
-        data = static_cast <ElementType*> (data == nullptr ? std::malloc (newNumElements * elementSize)
-                                                           : std::realloc (data, newNumElements * elementSize));
+        data = static_cast <ElementType*> (data == nullptr ? AllocatorType::allocate (newNumElements * elementSize)
+                                                           : AllocatorType::reallocate (data, newNumElements * elementSize));
         throwOnAllocationFailure();
     }
 
@@ -264,7 +292,7 @@ public:
     */
     void free()
     {
-        std::free (data);
+        AllocatorType::release (data);
         data = nullptr;
     }
 
@@ -272,7 +300,7 @@ public:
         The two objects simply exchange their data pointers.
     */
     template <bool otherBlockThrows>
-    void swapWith (HeapBlock <ElementType, otherBlockThrows>& other) noexcept
+    void swapWith (HeapBlock <ElementType, otherBlockThrows, AllocatorType>& other) noexcept
     {
         std::swap (data, other.data);
     }
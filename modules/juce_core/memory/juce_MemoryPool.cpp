@@ -0,0 +1,716 @@
+/*
+  ==============================================================================
+
+   This file is part of the juce_core module of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose with
+   or without fee is hereby granted, provided that the above copyright notice and this
+   permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+   ------------------------------------------------------------------------------
+
+   NOTE! This permissive ISC license applies ONLY to files within the juce_core module!
+   All other JUCE modules are covered by a dual GPL/commercial license, so if you are
+   using any other modules, be sure to check that you also comply with their license.
+
+   For more details, visit www.juce.com
+
+  ==============================================================================
+*/
+
+class MemoryPool::Pimpl
+{
+public:
+    enum
+    {
+        minBlockSizeBits = 4,
+        numSizeClasses = 13,        // 16 bytes to 64KB
+        threadCacheSize = 32,
+        maxThreadCaches = 16
+    };
+
+    //==============================================================================
+    // A run of equally-sized blocks, with a lock-free list of the free ones. The list
+    // links are block indexes, and the head carries a counter in its upper 32 bits
+    // so that a compare-and-swap can't be fooled by a block being popped and re-pushed.
+    struct SizeClass
+    {
+        SizeClass() noexcept  : start (nullptr), blockSize (0), numBlocks (0) {}
+
+        void initialise (char* startOfBlocks, size_t size, int num)
+        {
+            start = startOfBlocks;
+            blockSize = size;
+            numBlocks = num;
+            links.malloc ((size_t) num);
+
+            for (int i = num; --i >= 0;)
+                push (i);
+        }
+
+        int pop() noexcept
+        {
+            for (;;)
+            {
+                const uint64 oldHead = (uint64) head.get();
+                const int index = (int) (oldHead & 0xffffffff) - 1;
+
+                if (index < 0)
+                    return -1;
+
+                const uint64 newHead = (((oldHead >> 32) + 1) << 32) | (uint32) (links[index] + 1);
+
+                if (head.compareAndSetBool ((int64) newHead, (int64) oldHead))
+                    return index;
+            }
+        }
+
+        void push (const int index) noexcept
+        {
+            for (;;)
+            {
+                const uint64 oldHead = (uint64) head.get();
+                links[index] = (int) (oldHead & 0xffffffff) - 1;
+
+                const uint64 newHead = (((oldHead >> 32) + 1) << 32) | (uint32) (index + 1);
+
+                if (head.compareAndSetBool ((int64) newHead, (int64) oldHead))
+                    return;
+            }
+        }
+
+        bool contains (const void* block) const noexcept
+        {
+            return block >= start && block < start + blockSize * (size_t) numBlocks;
+        }
+
+        void* getBlock (int index) const noexcept           { return start + blockSize * (size_t) index; }
+        int getIndexOf (const void* block) const noexcept   { return (int) ((size_t) getAddressDifference (block, start) / blockSize); }
+
+        char* start;
+        size_t blockSize;
+        int numBlocks;
+        HeapBlock<int> links;
+        Atomic<int64> head;
+
+        JUCE_DECLARE_NON_COPYABLE (SizeClass)
+    };
+
+    //==============================================================================
+    // Each pool has its own fixed set of thread caches, which threads claim the first time
+    // they use the pool. Because the caches hold block indexes, they must never be shared
+    // between pools, so a ThreadLocalValue can't be used here (its native TLS versions keep
+    // one object per type rather than per instance).
+    struct ThreadCache
+    {
+        ThreadCache() noexcept  { zerostruct (numFree); }
+
+        Atomic<void*> owner;
+        int numFree [numSizeClasses];
+        int freeBlocks [numSizeClasses][threadCacheSize];
+    };
+
+    static int getFirstCacheToTry (void* const threadId) noexcept
+    {
+        return (int) ((((pointer_sized_uint) threadId) >> 4) % maxThreadCaches);
+    }
+
+    ThreadCache* findThreadCache (void* const threadId) noexcept
+    {
+        const int start = getFirstCacheToTry (threadId);
+
+        for (int i = 0; i < maxThreadCaches; ++i)
+        {
+            ThreadCache& cache = threadCaches [(start + i) % maxThreadCaches];
+
+            if (cache.owner.get() == threadId)
+                return &cache;
+        }
+
+        return nullptr;
+    }
+
+    ThreadCache* getThreadCache() noexcept
+    {
+        void* const threadId = Thread::getCurrentThreadId();
+
+        if (ThreadCache* const cache = findThreadCache (threadId))
+            return cache;
+
+        const int start = getFirstCacheToTry (threadId);
+
+        for (int i = 0; i < maxThreadCaches; ++i)
+        {
+            ThreadCache& cache = threadCaches [(start + i) % maxThreadCaches];
+
+            if (cache.owner.get() == nullptr && cache.owner.compareAndSetBool (threadId, nullptr))
+                return &cache;
+        }
+
+        return nullptr; // all the caches are taken, so this thread must use the shared lists
+    }
+
+    void releaseThreadCache() noexcept
+    {
+        if (ThreadCache* const cache = findThreadCache (Thread::getCurrentThreadId()))
+        {
+            for (int i = 0; i < numSizeClasses; ++i)
+                while (cache->numFree[i] > 0)
+                    sizeClasses[i].push (cache->freeBlocks[i][--(cache->numFree[i])]);
+
+            cache->owner = nullptr;
+        }
+    }
+
+    //==============================================================================
+    // Every live pool is listed here, so that a thread which is exiting can give back
+    // the caches that it holds in all of them.
+    static Array<Pimpl*>& getLivePools()
+    {
+        static Array<Pimpl*> pools;
+        return pools;
+    }
+
+    static CriticalSection& getLivePoolsLock()
+    {
+        static CriticalSection lock;
+        return lock;
+    }
+
+    static void releaseThreadCachesInAllPools() noexcept
+    {
+        const ScopedLock sl (getLivePoolsLock());
+        const Array<Pimpl*>& pools = getLivePools();
+
+        for (int i = pools.size(); --i >= 0;)
+            pools.getUnchecked (i)->releaseThreadCache();
+    }
+
+    //==============================================================================
+    Pimpl (const size_t bytesPerSizeClass)
+    {
+        size_t total = 0;
+
+        for (int i = 0; i < numSizeClasses; ++i)
+            total += getBlockSize (i) * (size_t) getNumBlocks (i, bytesPerSizeClass);
+
+        arena.malloc (total);
+        char* start = arena;
+
+        for (int i = 0; i < numSizeClasses; ++i)
+        {
+            const size_t blockSize = getBlockSize (i);
+            const int numBlocks = getNumBlocks (i, bytesPerSizeClass);
+            sizeClasses[i].initialise (start, blockSize, numBlocks);
+            start += blockSize * (size_t) numBlocks;
+        }
+
+        arenaEnd = start;
+
+        const ScopedLock sl (getLivePoolsLock());
+        getLivePools().add (this);
+    }
+
+    ~Pimpl()
+    {
+        const ScopedLock sl (getLivePoolsLock());
+        getLivePools().removeFirstMatchingValue (this);
+    }
+
+    static size_t getBlockSize (int sizeClass) noexcept     { return ((size_t) 1) << (sizeClass + minBlockSizeBits); }
+
+    static int getNumBlocks (int sizeClass, size_t bytesPerSizeClass) noexcept
+    {
+        return (int) jmax ((size_t) 4, bytesPerSizeClass / getBlockSize (sizeClass));
+    }
+
+    static int getSizeClassFor (size_t numBytes) noexcept
+    {
+        int sizeClass = 0;
+
+        while (getBlockSize (sizeClass) < numBytes)
+            if (++sizeClass >= numSizeClasses)
+                return -1;
+
+        return sizeClass;
+    }
+
+    int getSizeClassContaining (const void* block) const noexcept
+    {
+        if (block >= arena.getData() && block < arenaEnd)
+            for (int i = 0; i < numSizeClasses; ++i)
+                if (sizeClasses[i].contains (block))
+                    return i;
+
+        return -1;
+    }
+
+    //==============================================================================
+    void* allocate (const int firstSizeClass) noexcept
+    {
+        ThreadCache* const cache = getThreadCache();
+
+        if (cache == nullptr)
+        {
+            for (int i = firstSizeClass; i < numSizeClasses; ++i)
+            {
+                const int index = sizeClasses[i].pop();
+
+                if (index >= 0)
+                    return sizeClasses[i].getBlock (index);
+            }
+
+            return nullptr;
+        }
+
+        for (int i = firstSizeClass; i < numSizeClasses; ++i)
+        {
+            int& numFree = cache->numFree[i];
+
+            if (numFree == 0)
+            {
+                // refill half of this thread's cache from the shared list in one go
+                while (numFree < threadCacheSize / 2)
+                {
+                    const int index = sizeClasses[i].pop();
+
+                    if (index < 0)
+                        break;
+
+                    cache->freeBlocks[i][numFree++] = index;
+                }
+            }
+
+            if (numFree > 0)
+                return sizeClasses[i].getBlock (cache->freeBlocks[i][--numFree]);
+        }
+
+        return nullptr;
+    }
+
+    void release (const int sizeClass, const void* block) noexcept
+    {
+        SizeClass& sc = sizeClasses[sizeClass];
+        ThreadCache* const cache = getThreadCache();
+
+        if (cache == nullptr)
+        {
+            sc.push (sc.getIndexOf (block));
+            return;
+        }
+
+        int& numFree = cache->numFree[sizeClass];
+
+        if (numFree >= threadCacheSize)
+            while (numFree > threadCacheSize / 2)
+                sc.push (cache->freeBlocks[sizeClass][--numFree]);
+
+        cache->freeBlocks[sizeClass][numFree++] = sc.getIndexOf (block);
+    }
+
+    //==============================================================================
+    HeapBlock<char> arena;
+    const char* arenaEnd;
+    SizeClass sizeClasses [numSizeClasses];
+    ThreadCache threadCaches [maxThreadCaches];
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (Pimpl)
+};
+
+//==============================================================================
+MemoryPool::MemoryPool (const size_t bytesPerSizeClass)
+    : pimpl (new Pimpl (bytesPerSizeClass))
+{
+    totalArenaSize = (size_t) getAddressDifference (pimpl->arenaEnd, pimpl->arena.getData());
+}
+
+MemoryPool::~MemoryPool()
+{
+    // Some blocks are still in use, and will now be dangling!
+    jassert (numBlocksInUse.get() == 0);
+}
+
+void* MemoryPool::allocate (const size_t numBytes) noexcept
+{
+    const int sizeClass = Pimpl::getSizeClassFor (jmax ((size_t) 1, numBytes));
+
+    if (sizeClass >= 0)
+    {
+        if (void* const block = pimpl->allocate (sizeClass))
+        {
+            ++numBlocksInUse;
+            return block;
+        }
+    }
+
+    return allocateFromSystem (numBytes, false);
+}
+
+void* MemoryPool::allocateZeroed (const size_t numBytes) noexcept
+{
+    const int sizeClass = Pimpl::getSizeClassFor (jmax ((size_t) 1, numBytes));
+
+    if (sizeClass >= 0)
+    {
+        if (void* const block = pimpl->allocate (sizeClass))
+        {
+            ++numBlocksInUse;
+            zeromem (block, numBytes);
+            return block;
+        }
+    }
+
+    return allocateFromSystem (numBytes, true);
+}
+
+void* MemoryPool::reallocate (void* const block, const size_t newNumBytes) noexcept
+{
+    if (block == nullptr)
+        return allocate (newNumBytes);
+
+    const int sizeClass = pimpl->getSizeClassContaining (block);
+
+    if (sizeClass < 0)
+    {
+        checkSystemAllocation();
+        return std::realloc (block, newNumBytes);
+    }
+
+    const size_t oldSize = pimpl->sizeClasses[sizeClass].blockSize;
+
+    if (newNumBytes <= oldSize)
+        return block;
+
+    void* const newBlock = allocate (newNumBytes);
+
+    if (newBlock != nullptr)
+    {
+        memcpy (newBlock, block, oldSize);
+        release (block);
+    }
+
+    return newBlock;
+}
+
+void MemoryPool::release (void* const block) noexcept
+{
+    if (block != nullptr)
+    {
+        const int sizeClass = pimpl->getSizeClassContaining (block);
+
+        if (sizeClass >= 0)
+        {
+            pimpl->release (sizeClass, block);
+            --numBlocksInUse;
+        }
+        else
+        {
+            std::free (block);
+        }
+    }
+}
+
+bool MemoryPool::owns (const void* const block) const noexcept
+{
+    return pimpl->getSizeClassContaining (block) >= 0;
+}
+
+void* MemoryPool::allocateFromSystem (const size_t numBytes, const bool clear) noexcept
+{
+    ++numSystemAllocations;
+    checkSystemAllocation();
+    return clear ? std::calloc (numBytes, 1) : std::malloc (numBytes);
+}
+
+MemoryPool& MemoryPool::getDefault()
+{
+    static MemoryPool defaultPool;
+    return defaultPool;
+}
+
+//==============================================================================
+namespace RealtimeThreadHelpers
+{
+    // (a private type, as native ThreadLocalValues of the same type share their storage)
+    struct RealtimeFlag
+    {
+        RealtimeFlag() noexcept : isRealtime (false) {}
+        bool isRealtime;
+    };
+
+    static ThreadLocalValue<RealtimeFlag>& getRealtimeFlag()
+    {
+        static ThreadLocalValue<RealtimeFlag> flag;
+        return flag;
+    }
+
+    static Atomic<int> numRealtimeAllocations;
+}
+
+void MemoryPool::setCurrentThreadIsRealtime (const bool isRealtime)
+{
+    RealtimeThreadHelpers::getRealtimeFlag().get().isRealtime = isRealtime;
+
+    if (isRealtime)
+        getDefault().pimpl->getThreadCache();
+}
+
+bool MemoryPool::isCurrentThreadRealtime() noexcept
+{
+    return RealtimeThreadHelpers::getRealtimeFlag().get().isRealtime;
+}
+
+void MemoryPool::releaseCurrentThreadCache() noexcept
+{
+    pimpl->releaseThreadCache();
+}
+
+void MemoryPool::releaseCurrentThreadCachesInAllPools() noexcept
+{
+    Pimpl::releaseThreadCachesInAllPools();
+}
+
+int MemoryPool::getNumRealtimeSystemAllocations() noexcept
+{
+    return RealtimeThreadHelpers::numRealtimeAllocations.get();
+}
+
+void MemoryPool::resetNumRealtimeSystemAllocations() noexcept
+{
+    RealtimeThreadHelpers::numRealtimeAllocations = 0;
+}
+
+void MemoryPool::checkSystemAllocation() noexcept
+{
+    if (isCurrentThreadRealtime())
+    {
+        ++RealtimeThreadHelpers::numRealtimeAllocations;
+
+        // This thread has been marked as realtime, so it shouldn't be using the system allocator!
+        // Have a look up the stack to find out who's responsible..
+        jassertfalse;
+    }
+}
+
+#if JUCE_CHECK_REALTIME_ALLOCATIONS
+void SystemAllocator::checkThread() noexcept
+{
+    MemoryPool::checkSystemAllocation();
+}
+#endif
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MemoryPoolTests  : public UnitTest
+{
+public:
+    MemoryPoolTests() : UnitTest ("MemoryPool") {}
+
+    class AllocatorThread  : public Thread
+    {
+    public:
+        AllocatorThread (MemoryPool& p)  : Thread ("pool test"), pool (p), failed (false) {}
+
+        void run()
+        {
+            Random r;
+            void* blocks [64] = { 0 };
+            size_t sizes [64] = { 0 };
+
+            for (int i = 0; i < 20000; ++i)
+            {
+                const int n = r.nextInt (numElementsInArray (blocks));
+
+                if (blocks[n] != nullptr)
+                {
+                    for (size_t j = 0; j < sizes[n]; ++j)
+                        if (static_cast<uint8*> (blocks[n])[j] != (uint8) n)
+                            failed = true;
+
+                    pool.release (blocks[n]);
+                    blocks[n] = nullptr;
+                }
+                else
+                {
+                    sizes[n] = (size_t) r.nextInt (2000) + 1;
+                    blocks[n] = pool.allocate (sizes[n]);
+                    memset (blocks[n], n, sizes[n]);
+                }
+            }
+
+            for (int i = 0; i < numElementsInArray (blocks); ++i)
+                pool.release (blocks[i]);
+        }
+
+        MemoryPool& pool;
+        bool failed;
+    };
+
+    // Allocates a single small block, which leaves some free blocks in its cache.
+    class ShortLivedThread  : public Thread
+    {
+    public:
+        ShortLivedThread (MemoryPool& p)  : Thread ("pool test"), pool (p) {}
+
+        void run()
+        {
+            pool.release (pool.allocate (10));
+        }
+
+        MemoryPool& pool;
+    };
+
+    void runTest()
+    {
+        beginTest ("Allocation");
+
+        {
+            MemoryPool pool (64 * 1024);
+
+            void* small = pool.allocate (10);
+            void* large = pool.allocate (100000);
+            expect (pool.owns (small));
+            expect (! pool.owns (large));
+            expectEquals (pool.getNumBlocksInUse(), 1);
+            expectEquals (pool.getNumSystemAllocations(), 1);
+
+            memset (small, 1, 10);
+            void* bigger = pool.reallocate (small, 300);
+            expect (pool.owns (bigger));
+            expectEquals (static_cast<char*> (bigger)[9], (char) 1);
+
+            pool.release (bigger);
+            pool.release (large);
+            expectEquals (pool.getNumBlocksInUse(), 0);
+        }
+
+        beginTest ("Several pools");
+
+        {
+            // blocks released into one pool must never be handed out by another
+            ScopedPointer<MemoryPool> pool1 (new MemoryPool (16 * 1024));
+            MemoryPool pool2 (16 * 1024);
+
+            for (int i = 0; i < 100; ++i)
+            {
+                void* const b1 = pool1->allocate (100);
+                void* const b2 = pool2.allocate (100);
+                expect (pool1->owns (b1) && pool2.owns (b2));
+
+                pool1->release (b1);
+                void* const b3 = pool2.allocate (100);
+                expect (pool2.owns (b3) && ! pool1->owns (b3));
+
+                pool2.release (b2);
+                pool2.release (b3);
+            }
+
+            pool1 = nullptr;
+            MemoryPool pool3 (16 * 1024);
+            void* const b4 = pool3.allocate (100);
+            void* const b5 = pool2.allocate (100);
+            expect (pool3.owns (b4) && pool2.owns (b5));
+            pool3.release (b4);
+            pool2.release (b5);
+
+            pool2.releaseCurrentThreadCache();
+            expectEquals (pool2.getNumBlocksInUse(), 0);
+        }
+
+        beginTest ("Threads");
+
+        {
+            MemoryPool pool (128 * 1024);
+            OwnedArray<AllocatorThread> threads;
+
+            for (int i = 0; i < 8; ++i)
+                threads.add (new AllocatorThread (pool))->startThread();
+
+            for (int i = 0; i < threads.size(); ++i)
+            {
+                threads.getUnchecked(i)->waitForThreadToExit (-1);
+                expect (! threads.getUnchecked(i)->failed);
+            }
+
+            expectEquals (pool.getNumBlocksInUse(), 0);
+        }
+
+        beginTest ("Threads that exit");
+
+        {
+            // each size class has only 4 blocks, so if the blocks cached by threads that
+            // have exited weren't given back, these threads would soon use up the arenas
+            MemoryPool pool (0);
+            const int numBlocks = 4 * 13;
+
+            for (int i = 0; i < 40; ++i)
+            {
+                ShortLivedThread thread (pool);
+                thread.startThread();
+                thread.waitForThreadToExit (-1);
+            }
+
+            expectEquals (pool.getNumSystemAllocations(), 0);
+
+            Array<void*> blocks;
+
+            for (int i = 0; i < numBlocks; ++i)
+                blocks.add (pool.allocate (10));
+
+            expectEquals (pool.getNumSystemAllocations(), 0);
+            expectEquals (pool.getNumBlocksInUse(), numBlocks);
+
+            for (int i = 0; i < blocks.size(); ++i)
+                pool.release (blocks.getUnchecked (i));
+
+            pool.releaseCurrentThreadCache();
+        }
+
+        beginTest ("HeapBlock");
+
+        {
+            MemoryPool::setCurrentThreadIsRealtime (true);
+            const int numBefore = MemoryPool::getNumRealtimeSystemAllocations();
+
+            {
+                HeapBlock<float, false, MemoryPoolAllocator> block;
+                block.calloc (256);
+                block.realloc (1024);
+                expect (MemoryPool::getDefault().owns (block));
+                expectEquals (block[100], 0.0f);
+            }
+
+            {
+                Array<int, DummyCriticalSection, 0, MemoryPoolAllocator> array;
+                OwnedArray<String, DummyCriticalSection, MemoryPoolAllocator> objects;
+
+                for (int i = 0; i < 1000; ++i)
+                    array.add (i);
+
+                objects.ensureStorageAllocated (64);
+
+                expect (MemoryPool::getDefault().owns (array.getRawDataPointer()));
+                expect (MemoryPool::getDefault().owns (objects.getRawDataPointer()));
+                expectEquals (array[999], 999);
+            }
+
+            expectEquals (MemoryPool::getNumRealtimeSystemAllocations(), numBefore);
+            MemoryPool::setCurrentThreadIsRealtime (false);
+        }
+    }
+};
+
+static MemoryPoolTests memoryPoolTests;
+
+#endif
@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+   This file is part of the juce_core module of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose with
+   or without fee is hereby granted, provided that the above copyright notice and this
+   permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+   ------------------------------------------------------------------------------
+
+   NOTE! This permissive ISC license applies ONLY to files within the juce_core module!
+   All other JUCE modules are covered by a dual GPL/commercial license, so if you are
+   using any other modules, be sure to check that you also comply with their license.
+
+   For more details, visit www.juce.com
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_MEMORYPOOL_H_INCLUDED
+#define JUCE_MEMORYPOOL_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A lock-free allocator that hands out blocks from a set of preallocated arenas.
+
+    All the memory that the pool uses is allocated up-front by its constructor, and is
+    divided into size classes of power-of-two block sizes, from 16 bytes up to 64KB.
+    Allocating and releasing blocks never takes a lock or calls the system allocator, so
+    it's safe to use from an audio thread. Each thread (up to a fixed number per pool) keeps
+    a small cache of free blocks for each size class, so that most allocations don't even
+    need to touch the shared free-lists.
+
+    If a request is too big for the largest size class, or if the pool has run out of
+    suitable blocks, the memory will be obtained from the system instead (and released back
+    to it correctly later), and getNumSystemAllocations() will be incremented so that you
+    can tell that your pool is too small.
+
+    You can use a MemoryPool directly, or you can make a HeapBlock, Array or OwnedArray
+    use the default pool by giving it MemoryPoolAllocator as its allocator type.
+
+    This class also keeps track of which threads have been marked as realtime by calling
+    setCurrentThreadIsRealtime(). If JUCE_CHECK_REALTIME_ALLOCATIONS is enabled, any
+    system allocation made by a HeapBlock (and so also by Array, MemoryBlock, etc) on one
+    of these threads will trigger an assertion and be counted.
+
+    @see MemoryPoolAllocator, HeapBlock
+*/
+class JUCE_API  MemoryPool
+{
+public:
+    //==============================================================================
+    /** Creates a pool, preallocating the given number of bytes for each of its size classes. */
+    explicit MemoryPool (size_t bytesPerSizeClass = 256 * 1024);
+
+    /** Destructor.
+        Any blocks that are still in use when the pool is deleted will become invalid.
+    */
+    ~MemoryPool();
+
+    //==============================================================================
+    /** Returns a block of at least the given size.
+        This will return nullptr only if the pool is exhausted and the system allocator fails.
+    */
+    void* allocate (size_t numBytes) noexcept;
+
+    /** Returns a block of at least the given size, with its contents cleared. */
+    void* allocateZeroed (size_t numBytes) noexcept;
+
+    /** Resizes a block, keeping as much of its existing content as possible.
+        The block passed in must have been allocated by this pool (or be null).
+    */
+    void* reallocate (void* block, size_t newNumBytes) noexcept;
+
+    /** Releases a block that was returned by one of the allocation methods. */
+    void release (void* block) noexcept;
+
+    /** Returns true if this block lives inside one of the pool's arenas. */
+    bool owns (const void* block) const noexcept;
+
+    /** Gives back any free blocks that the calling thread has cached, and frees up its cache.
+
+        The pool has a limited number of thread caches (threads that can't get one just use
+        the shared free-lists), so a thread that has finished using the pool, but which isn't
+        about to exit, can call this to let other threads have its cache.
+
+        A Thread gives back its caches automatically when it exits, but a thread that wasn't
+        started by the Thread class must call this (or releaseCurrentThreadCachesInAllPools())
+        before it exits, or its cache will be lost.
+    */
+    void releaseCurrentThreadCache() noexcept;
+
+    /** Calls releaseCurrentThreadCache() on every pool that exists.
+        This is called by the Thread class when its thread exits.
+    */
+    static void releaseCurrentThreadCachesInAllPools() noexcept;
+
+    //==============================================================================
+    /** Returns the number of allocations that the pool couldn't satisfy from its arenas,
+        and which had to be passed on to the system allocator.
+    */
+    int getNumSystemAllocations() const noexcept        { return numSystemAllocations.get(); }
+
+    /** Returns the number of pool blocks that are currently in use. */
+    int getNumBlocksInUse() const noexcept              { return numBlocksInUse.get(); }
+
+    /** Returns the number of bytes that were preallocated for the pool's arenas. */
+    size_t getTotalArenaSize() const noexcept           { return totalArenaSize; }
+
+    /** Returns a shared pool, which is the one used by MemoryPoolAllocator. */
+    static MemoryPool& getDefault();
+
+    //==============================================================================
+    /** Marks or unmarks the calling thread as being one that must never call the system allocator.
+
+        When a thread is marked as realtime, any system allocations made by the pool or (when
+        JUCE_CHECK_REALTIME_ALLOCATIONS is enabled) by HeapBlock will be reported. It's a
+        good idea to call this before your thread starts its realtime work, because it also
+        claims the thread's cache for the default pool.
+    */
+    static void setCurrentThreadIsRealtime (bool isRealtime);
+
+    /** Returns true if the calling thread has been marked with setCurrentThreadIsRealtime(). */
+    static bool isCurrentThreadRealtime() noexcept;
+
+    /** Returns the number of system allocations that have been made on realtime threads. */
+    static int getNumRealtimeSystemAllocations() noexcept;
+
+    /** Resets the counter returned by getNumRealtimeSystemAllocations(). */
+    static void resetNumRealtimeSystemAllocations() noexcept;
+
+    /** Records a system allocation, and asserts if it's being made on a realtime thread.
+        This is called internally, but custom allocators may want to call it too.
+    */
+    static void checkSystemAllocation() noexcept;
+
+private:
+    //==============================================================================
+    class Pimpl;
+    ScopedPointer<Pimpl> pimpl;
+
+    Atomic<int> numSystemAllocations, numBlocksInUse;
+    size_t totalArenaSize;
+
+    void* allocateFromSystem (size_t numBytes, bool clear) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (MemoryPool)
+};
+
+//==============================================================================
+/**
+    An allocator type for HeapBlock and ArrayAllocationBase that takes its memory
+    from the default MemoryPool.
+
+    Blocks that the pool can't provide are taken from the system allocator, and this
+    class knows how to release either kind correctly.
+
+    e.g.
+    @code
+    HeapBlock<float, false, MemoryPoolAllocator> scratchSpace;
+    scratchSpace.malloc (512); // doesn't call malloc()
+    @endcode
+
+    @see MemoryPool, SystemAllocator
+*/
+struct MemoryPoolAllocator
+{
+    static void* allocate (size_t numBytes) noexcept                  { return MemoryPool::getDefault().allocate (numBytes); }
+    static void* allocateZeroed (size_t numBytes) noexcept            { return MemoryPool::getDefault().allocateZeroed (numBytes); }
+    static void* reallocate (void* block, size_t numBytes) noexcept   { return MemoryPool::getDefault().reallocate (block, numBytes); }
+    static void release (void* block) noexcept                        { MemoryPool::getDefault().release (block); }
+};
+
+
+#endif   // JUCE_MEMORYPOOL_H_INCLUDED
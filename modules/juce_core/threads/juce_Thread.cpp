@@ -103,6 +103,8 @@ void Thread::threadEntryPoint()
     }
     JUCE_CATCH_ALL_ASSERT
 
+    TraceRecorder::unregisterThread();
+    MemoryPool::releaseCurrentThreadCachesInAllPools();
     currentThreadHolder->value.releaseCurrentThreadStorage();
     closeThreadHandle();
 }
@@ -151,7 +151,12 @@ void TimeSliceThread::run()
 
                 if (clientBeingCalled != nullptr)
                 {
-                    const int msUntilNextCall = clientBeingCalled->useTimeSlice();
+                    int msUntilNextCall;
+
+                    {
+                        JUCE_TRACE_ZONE ("TimeSliceClient::useTimeSlice");
+                        msUntilNextCall = clientBeingCalled->useTimeSlice();
+                    }
 
                     const ScopedLock sl2 (listLock);
 
@@ -0,0 +1,572 @@
+/*
+  ==============================================================================
+
+   This file is part of the juce_core module of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose with
+   or without fee is hereby granted, provided that the above copyright notice and this
+   permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+   ------------------------------------------------------------------------------
+
+   NOTE! This permissive ISC license applies ONLY to files within the juce_core module!
+   All other JUCE modules are covered by a dual GPL/commercial license, so if you are
+   using any other modules, be sure to check that you also comply with their license.
+
+   For more details, visit www.juce.com
+
+  ==============================================================================
+*/
+
+class TraceRecorder::ThreadBuffer
+{
+public:
+    ThreadBuffer() noexcept  : capacity (0), isRegistered (false)
+    {
+        threadName[0] = 0;
+    }
+
+    struct Event
+    {
+        const char* name;
+        int64 ticks;
+
+        union
+        {
+            int64 argument;
+            double value;
+            uint64 flowId;
+        };
+
+        char type;
+    };
+
+    void setCapacity (const int newCapacity)
+    {
+        if (capacity != newCapacity)
+        {
+            if (newCapacity > 0)
+                events.malloc ((size_t) newCapacity);
+            else
+                events.free();
+
+            capacity = newCapacity;
+        }
+    }
+
+    Atomic<Thread::ThreadID> owner;
+    Atomic<int> numEvents, busy;
+    HeapBlock<Event> events;
+    int capacity;
+    bool isRegistered;
+    char threadName [64];
+
+    JUCE_DECLARE_NON_COPYABLE (ThreadBuffer)
+};
+
+//==============================================================================
+struct TraceRecorder::SharedState
+{
+    SharedState() noexcept  : eventsPerThread (0), sessionStartTicks (0) {}
+
+    enum { maxThreads = 64 };
+
+    // Marks a buffer whose thread has exited: its events are kept until the next
+    // call to start(), but nothing else can claim it before then.
+    static Thread::ThreadID finishedThread() noexcept   { return (Thread::ThreadID) (pointer_sized_int) -1; }
+
+    static int getFirstIndexToProbe (Thread::ThreadID threadId) noexcept
+    {
+        return (int) ((((pointer_sized_uint) threadId) >> 4) % (pointer_sized_uint) maxThreads);
+    }
+
+    ThreadBuffer* findBuffer (Thread::ThreadID threadId) noexcept
+    {
+        const int first = getFirstIndexToProbe (threadId);
+
+        for (int i = 0; i < maxThreads; ++i)
+        {
+            ThreadBuffer& b = buffers [(first + i) % maxThreads];
+
+            if (b.owner.value == threadId)
+                return &b;
+        }
+
+        return nullptr;
+    }
+
+    ThreadBuffer* claimBuffer (Thread::ThreadID threadId, const bool needsStorage) noexcept
+    {
+        const int first = getFirstIndexToProbe (threadId);
+
+        for (int i = 0; i < maxThreads; ++i)
+        {
+            ThreadBuffer& b = buffers [(first + i) % maxThreads];
+
+            if (b.owner.value == nullptr && (b.capacity > 0 || ! needsStorage)
+                 && b.owner.compareAndSetBool (threadId, nullptr))
+            {
+                anyBuffersClaimed = 1;
+                return &b;
+            }
+        }
+
+        return nullptr;
+    }
+
+    int getThreadIndex (const ThreadBuffer& b) const noexcept
+    {
+        return (int) (&b - buffers) + 1;
+    }
+
+    ThreadBuffer buffers [maxThreads];
+    CriticalSection lock;
+    int eventsPerThread;
+    Atomic<int> numDropped;
+    int64 sessionStartTicks;
+};
+
+TraceRecorder::SharedState& TraceRecorder::getState()
+{
+    static SharedState state;
+    return state;
+}
+
+namespace TraceRecorderHelpers
+{
+    static void writeEscaped (OutputStream& out, const char* text)
+    {
+        for (const char* t = text; *t != 0; ++t)
+        {
+            if (*t == '"' || *t == '\\')
+                out << '\\';
+
+            out << *t;
+        }
+    }
+}
+
+Atomic<int> TraceRecorder::recording;
+Atomic<int> TraceRecorder::anyBuffersClaimed;
+
+//==============================================================================
+void TraceRecorder::start (const int maxEventsPerThread, const int numSpareThreadBuffers)
+{
+    jassert (maxEventsPerThread > 0);
+    jassert (numSpareThreadBuffers >= 0 && numSpareThreadBuffers <= SharedState::maxThreads);
+
+    SharedState& state = getState();
+    const ScopedLock sl (state.lock);
+
+    recording = 0;
+    Atomic<int>::memoryBarrier();
+
+    // wait for any threads that are half-way through writing an event to finish
+    for (int i = 0; i < SharedState::maxThreads; ++i)
+        while (state.buffers[i].busy.get() != 0)
+            Thread::yield();
+
+    state.eventsPerThread = maxEventsPerThread;
+    int numSpare = 0;
+
+    for (int i = 0; i < SharedState::maxThreads; ++i)
+    {
+        ThreadBuffer& b = state.buffers[i];
+        b.numEvents = 0;
+
+        if (! b.isRegistered)
+        {
+            // Buffers that were claimed implicitly may belong to threads that have since
+            // exited, so they're reclaimed and get claimed again by the next event.
+            b.owner = nullptr;
+            b.threadName[0] = 0;
+        }
+
+        if (b.isRegistered || numSpare++ < numSpareThreadBuffers)
+            b.setCapacity (maxEventsPerThread);
+        else
+            b.setCapacity (0);
+    }
+
+    state.numDropped = 0;
+    state.sessionStartTicks = Time::getHighResolutionTicks();
+    recording = 1;
+}
+
+void TraceRecorder::stop() noexcept
+{
+    recording = 0;
+}
+
+void TraceRecorder::registerThread (const String& name)
+{
+    SharedState& state = getState();
+    const ScopedLock sl (state.lock);
+
+    const Thread::ThreadID threadId = Thread::getCurrentThreadId();
+    ThreadBuffer* b = state.findBuffer (threadId);
+
+    if (b == nullptr)
+        b = state.claimBuffer (threadId, false);
+
+    if (b == nullptr)
+    {
+        jassertfalse; // too many threads are being traced!
+        return;
+    }
+
+    b->isRegistered = true;
+
+    String threadName (name);
+
+    if (threadName.isEmpty())
+        if (const Thread* const thread = Thread::getCurrentThread())
+            threadName = thread->getThreadName();
+
+    threadName.copyToUTF8 (b->threadName, sizeof (b->threadName));
+
+    if (state.eventsPerThread > 0 && b->numEvents.get() == 0)
+        b->setCapacity (state.eventsPerThread);
+}
+
+void TraceRecorder::unregisterThread() noexcept
+{
+    if (anyBuffersClaimed.get() == 0)
+        return;
+
+    SharedState& state = getState();
+    const ScopedLock sl (state.lock);
+
+    if (ThreadBuffer* const b = state.findBuffer (Thread::getCurrentThreadId()))
+    {
+        b->isRegistered = false;
+        b->owner = SharedState::finishedThread();
+    }
+}
+
+void TraceRecorder::addEvent (const char type, const char* const name, const int64 argument,
+                              const double value, const uint64 flowId) noexcept
+{
+    SharedState& state = getState();
+    const Thread::ThreadID threadId = Thread::getCurrentThreadId();
+    ThreadBuffer* b;
+
+    for (;;)
+    {
+        b = state.findBuffer (threadId);
+
+        if (b == nullptr)
+        {
+            b = state.claimBuffer (threadId, true);
+
+            if (b == nullptr)
+            {
+                ++state.numDropped;
+                return;
+            }
+        }
+
+        // The busy flag stops start() resizing or resetting the buffer while the event's
+        // being written. It's set with a compare-and-swap, which is a full barrier, so
+        // either start() sees it and waits, or the recording flag below is already clear.
+        // But start() may have reset the buffer after it was found, so the owner is
+        // checked again, and if it's changed, this thread has to find a buffer afresh.
+        if (b->busy.compareAndSetBool (1, 0))
+        {
+            if (recording.get() == 0)
+            {
+                b->busy = 0;
+                return;
+            }
+
+            if (b->owner.get() == threadId)
+                break;
+
+            b->busy = 0;
+        }
+    }
+
+    const int index = b->numEvents.value;
+
+    if (index < b->capacity)
+    {
+        ThreadBuffer::Event& e = b->events[index];
+        e.type = type;
+        e.name = name;
+        e.ticks = Time::getHighResolutionTicks();
+
+        switch (type)
+        {
+            case 'C':   e.value = value; break;
+            case 's':
+            case 't':
+            case 'f':   e.flowId = flowId; break;
+            default:    e.argument = argument; break;
+        }
+
+        b->numEvents = index + 1;
+    }
+    else
+    {
+        ++state.numDropped;
+    }
+
+    b->busy = 0;
+}
+
+void TraceRecorder::beginZone (const char* name, int64 argument) noexcept   { addEvent ('B', name, argument, 0, 0); }
+void TraceRecorder::endZone (const char* name) noexcept                     { addEvent ('E', name, 0, 0, 0); }
+void TraceRecorder::instant (const char* name) noexcept                     { addEvent ('i', name, 0, 0, 0); }
+void TraceRecorder::counter (const char* name, double value) noexcept       { addEvent ('C', name, 0, value, 0); }
+void TraceRecorder::flowBegin (const char* name, uint64 flowId) noexcept    { addEvent ('s', name, 0, 0, flowId); }
+void TraceRecorder::flowStep (const char* name, uint64 flowId) noexcept     { addEvent ('t', name, 0, 0, flowId); }
+void TraceRecorder::flowEnd (const char* name, uint64 flowId) noexcept      { addEvent ('f', name, 0, 0, flowId); }
+
+//==============================================================================
+int TraceRecorder::getNumEventsRecorded() noexcept
+{
+    SharedState& state = getState();
+    const ScopedLock sl (state.lock);
+    int total = 0;
+
+    for (int i = 0; i < SharedState::maxThreads; ++i)
+        total += state.buffers[i].numEvents.get();
+
+    return total;
+}
+
+int TraceRecorder::getNumEventsDropped() noexcept
+{
+    return getState().numDropped.get();
+}
+
+void TraceRecorder::writeChromeTraceJSON (OutputStream& out)
+{
+    SharedState& state = getState();
+    const ScopedLock sl (state.lock);
+
+    const double microsecondsPerTick = 1.0e6 / (double) Time::getHighResolutionTicksPerSecond();
+    bool isFirst = true;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (int i = 0; i < SharedState::maxThreads; ++i)
+    {
+        const ThreadBuffer& b = state.buffers[i];
+        const int num = b.numEvents.get();
+
+        if (num == 0)
+            continue;
+
+        const int threadIndex = state.getThreadIndex (b);
+        const String threadName (b.threadName[0] != 0 ? String::fromUTF8 (b.threadName)
+                                                      : ("Thread " + String (threadIndex)));
+
+        out << (isFirst ? "" : ",") << newLine
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadIndex
+            << ",\"args\":{\"name\":" << threadName.quoted() << "}}";
+
+        isFirst = false;
+
+        for (int j = 0; j < num; ++j)
+        {
+            const ThreadBuffer::Event& e = b.events[j];
+
+            out << "," << newLine << "{\"name\":\"";
+            TraceRecorderHelpers::writeEscaped (out, e.name);
+            out << "\",\"ph\":\"" << e.type
+                << "\",\"pid\":1,\"tid\":" << threadIndex
+                << ",\"ts\":" << String ((e.ticks - state.sessionStartTicks) * microsecondsPerTick, 3);
+
+            switch (e.type)
+            {
+                case 'B':   if (e.argument != 0) out << ",\"args\":{\"arg\":" << e.argument << "}"; break;
+                case 'C':   out << ",\"args\":{\"value\":" << e.value << "}"; break;
+                case 'i':   out << ",\"s\":\"t\""; break;
+                case 's':
+                case 't':   out << ",\"cat\":\"flow\",\"id\":" << (int64) e.flowId; break;
+                case 'f':   out << ",\"cat\":\"flow\",\"bp\":\"e\",\"id\":" << (int64) e.flowId; break;
+                default:    break;
+            }
+
+            out << "}";
+        }
+    }
+
+    out << newLine << "]}" << newLine;
+}
+
+bool TraceRecorder::writeChromeTraceJSON (const File& file)
+{
+    file.deleteFile();
+    FileOutputStream out (file);
+
+    if (out.failedToOpen())
+        return false;
+
+    writeChromeTraceJSON (out);
+    out.flush();
+    return out.getStatus().wasOk();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TraceRecorderTests  : public UnitTest
+{
+public:
+    TraceRecorderTests() : UnitTest ("TraceRecorder") {}
+
+    class TracedThread  : public Thread
+    {
+    public:
+        TracedThread() : Thread ("traced thread") {}
+
+        void run()
+        {
+            TraceRecorder::registerThread();
+
+            for (int i = 0; i < 10; ++i)
+            {
+                TraceRecorder::ScopedZone zone ("worker \"zone\"", i);
+                TraceRecorder::counter ("progress", i);
+            }
+
+            TraceRecorder::flowEnd ("handoff", 1234);
+        }
+    };
+
+    class InstantThread  : public Thread
+    {
+    public:
+        InstantThread() : Thread ("instant thread") {}
+
+        void run()
+        {
+            TraceRecorder::instant ("tick");
+        }
+    };
+
+    // Keeps adding events until it's told to stop, without registering itself.
+    class BusyThread  : public Thread
+    {
+    public:
+        BusyThread() : Thread ("busy thread") {}
+
+        void run()
+        {
+            while (! threadShouldExit())
+                TraceRecorder::instant ("tick");
+        }
+    };
+
+    void runInstantThreads (const int numThreads)
+    {
+        for (int i = 0; i < numThreads; ++i)
+        {
+            InstantThread thread;
+            thread.startThread();
+            thread.waitForThreadToExit (-1);
+        }
+    }
+
+    void runTest()
+    {
+        beginTest ("Recording");
+
+        TraceRecorder::start (100);
+
+        {
+            TraceRecorder::ScopedZone zone ("main zone");
+            TraceRecorder::flowBegin ("handoff", 1234);
+
+            TracedThread thread;
+            thread.startThread();
+            thread.waitForThreadToExit (-1);
+        }
+
+        TraceRecorder::stop();
+
+        {
+            TraceRecorder::ScopedZone ignored ("not recorded");
+        }
+
+        expectEquals (TraceRecorder::getNumEventsRecorded(), 3 + 31);
+        expectEquals (TraceRecorder::getNumEventsDropped(), 0);
+
+        MemoryOutputStream mo;
+        TraceRecorder::writeChromeTraceJSON (mo);
+
+        var json;
+        expect (JSON::parse (mo.toString(), json).wasOk());
+
+        const Array<var>* const events = json ["traceEvents"].getArray();
+        expect (events != nullptr && events->size() == 2 + 3 + 31);
+        expect (mo.toString().contains ("\"traced thread\""));
+
+        beginTest ("Overflow");
+
+        TraceRecorder::start (4);
+
+        for (int i = 0; i < 10; ++i)
+            TraceRecorder::instant ("tick");
+
+        TraceRecorder::stop();
+
+        expectEquals (TraceRecorder::getNumEventsRecorded(), 4);
+        expectEquals (TraceRecorder::getNumEventsDropped(), 6);
+
+        beginTest ("Spare buffers");
+
+        TraceRecorder::start (10, 2);
+        runInstantThreads (5);
+        TraceRecorder::stop();
+
+        // exited threads keep their events, so only the first two get a buffer
+        expectEquals (TraceRecorder::getNumEventsRecorded(), 2);
+        expectEquals (TraceRecorder::getNumEventsDropped(), 3);
+
+        // ..but restarting reclaims their buffers
+        TraceRecorder::start (10, 2);
+        runInstantThreads (2);
+        TraceRecorder::stop();
+
+        expectEquals (TraceRecorder::getNumEventsRecorded(), 2);
+        expectEquals (TraceRecorder::getNumEventsDropped(), 0);
+
+        beginTest ("Restarting while threads are recording");
+
+        {
+            // each restart resizes and reclaims the buffers that these threads are writing to
+            OwnedArray<BusyThread> threads;
+
+            TraceRecorder::start (10, 4);
+
+            for (int i = 0; i < 4; ++i)
+                threads.add (new BusyThread())->startThread();
+
+            for (int i = 0; i < 200; ++i)
+                TraceRecorder::start ((i & 1) != 0 ? 1000 : 10, 4);
+
+            for (int i = 0; i < threads.size(); ++i)
+                threads.getUnchecked (i)->stopThread (-1);
+
+            TraceRecorder::stop();
+
+            expect (TraceRecorder::getNumEventsRecorded() <= 4 * 1000);
+        }
+    }
+};
+
+static TraceRecorderTests traceRecorderTests;
+
+#endif
@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+   This file is part of the juce_core module of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission to use, copy, modify, and/or distribute this software for any purpose with
+   or without fee is hereby granted, provided that the above copyright notice and this
+   permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+   NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+   DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+   IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+   CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+   ------------------------------------------------------------------------------
+
+   NOTE! This permissive ISC license applies ONLY to files within the juce_core module!
+   All other JUCE modules are covered by a dual GPL/commercial license, so if you are
+   using any other modules, be sure to check that you also comply with their license.
+
+   For more details, visit www.juce.com
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_TRACERECORDER_H_INCLUDED
+#define JUCE_TRACERECORDER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Records timestamped trace events from any number of threads, and exports them
+    in the Chrome trace-event JSON format, which can be loaded by chrome://tracing
+    or the Perfetto UI.
+
+    Each thread writes its events into its own buffer, and all the buffers are allocated by
+    start() and registerThread(), so recording an event never takes a lock or allocates
+    memory. When recording is stopped, the cost of each trace point is just a check of a
+    global flag, so it's fine to leave them in a release build and switch recording on
+    when you need to capture a trace.
+
+    A thread that records an event without having called registerThread() takes one of the
+    spare buffers that start() allocated, or has its events dropped if there are none left.
+
+    Rather than calling this class's methods directly, it's easiest to use the macros:
+    @code
+    void MyProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midi)
+    {
+        JUCE_TRACE_ZONE ("MyProcessor::processBlock");   // times this scope
+        JUCE_TRACE_COUNTER ("voices", numActiveVoices);   // records a value
+        ...
+    }
+    @endcode
+
+    ..and then somewhere else in your app:
+    @code
+    TraceRecorder::start();
+    ...
+    TraceRecorder::stop();
+    TraceRecorder::writeChromeTraceJSON (File ("~/trace.json"));
+    @endcode
+
+    All the names passed to these functions must be string literals (or other strings
+    that will outlive the recording), because only their pointers are stored.
+
+    If JUCE_ENABLE_TRACING is 0, the macros compile to nothing.
+*/
+class JUCE_API  TraceRecorder
+{
+public:
+    //==============================================================================
+    /** Clears any previously-recorded events and starts recording.
+
+        This allocates a buffer for each registered thread, plus some spare ones for
+        any other threads that record events, and frees the buffers of threads that
+        have exited.
+
+        @param maxEventsPerThread       the number of events each thread can record before its
+                                        buffer is full, after which its events are dropped
+        @param numSpareThreadBuffers    the number of buffers to allocate for threads that
+                                        haven't called registerThread()
+    */
+    static void start (int maxEventsPerThread = 65536, int numSpareThreadBuffers = 8);
+
+    /** Stops recording. The events that were captured are kept until the next call to start(). */
+    static void stop() noexcept;
+
+    /** Returns true if events are currently being recorded. */
+    static bool isRecording() noexcept          { return recording.value != 0; }
+
+    /** Reserves a buffer for the calling thread, which it'll keep across sessions until it
+        exits, and gives it a name to appear in the trace.
+
+        If no name is given, the name of the current juce Thread is used. Call this before a
+        thread starts any realtime work, and it'll never have to compete for a spare buffer.
+        It may allocate memory, so don't call it from a realtime thread.
+        @see unregisterThread
+    */
+    static void registerThread (const String& threadName = String());
+
+    /** Releases the calling thread's buffer. The events it has recorded are kept until the
+        next call to start().
+
+        Threads that were created by the juce Thread class call this automatically when they
+        exit, but any other threads that record events should call it before they finish.
+    */
+    static void unregisterThread() noexcept;
+
+    //==============================================================================
+    /** Records the start of a timed zone on the calling thread. @see ScopedZone */
+    static void beginZone (const char* name, int64 argument = 0) noexcept;
+
+    /** Records the end of the zone most recently begun on the calling thread. */
+    static void endZone (const char* name) noexcept;
+
+    /** Records a momentary event. */
+    static void instant (const char* name) noexcept;
+
+    /** Records the current value of a named counter. */
+    static void counter (const char* name, double value) noexcept;
+
+    /** Records the start of a flow, which links events on different threads.
+        The id must be unique among the flows that are currently in progress, and is
+        used to match this with the corresponding flowStep() and flowEnd() calls.
+    */
+    static void flowBegin (const char* name, uint64 flowId) noexcept;
+
+    /** Records an intermediate step in a flow. @see flowBegin */
+    static void flowStep (const char* name, uint64 flowId) noexcept;
+
+    /** Records the end of a flow. @see flowBegin */
+    static void flowEnd (const char* name, uint64 flowId) noexcept;
+
+    //==============================================================================
+    /** Writes the events recorded in the last session as Chrome trace-event JSON.
+        It's best to call stop() first, because any events recorded while this is running
+        may or may not be included.
+    */
+    static void writeChromeTraceJSON (OutputStream& output);
+
+    /** Writes the events recorded in the last session to a file as Chrome trace-event JSON. */
+    static bool writeChromeTraceJSON (const File& file);
+
+    /** Returns the total number of events recorded in the last session. */
+    static int getNumEventsRecorded() noexcept;
+
+    /** Returns the number of events that were lost because a thread's buffer was full. */
+    static int getNumEventsDropped() noexcept;
+
+    //==============================================================================
+    /** Records a zone for the lifetime of this object.
+        Normally you'd use the JUCE_TRACE_ZONE macro to create one of these.
+    */
+    class ScopedZone
+    {
+    public:
+        ScopedZone (const char* zoneName, int64 argument = 0) noexcept
+            : name (isRecording() ? zoneName : nullptr)
+        {
+            if (name != nullptr)
+                beginZone (name, argument);
+        }
+
+        ~ScopedZone() noexcept
+        {
+            if (name != nullptr)
+                endZone (name);
+        }
+
+    private:
+        const char* const name;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedZone)
+    };
+
+private:
+    //==============================================================================
+    class ThreadBuffer;
+    struct SharedState;
+    static Atomic<int> recording, anyBuffersClaimed;
+
+    static SharedState& getState();
+
+    static void addEvent (char type, const char* name, int64 argument, double value, uint64 flowId) noexcept;
+
+    TraceRecorder();
+    JUCE_DECLARE_NON_COPYABLE (TraceRecorder)
+};
+
+//==============================================================================
+#if JUCE_ENABLE_TRACING || DOXYGEN
+ /** Records a zone in the TraceRecorder that lasts until the end of the current scope. */
+ #define JUCE_TRACE_ZONE(name)                       const juce::TraceRecorder::ScopedZone JUCE_JOIN_MACRO (traceZone_, __LINE__) (name);
+
+ /** Records a zone in the TraceRecorder that lasts until the end of the current scope,
+     with an integer argument (e.g. an ID or size) that will appear in the zone's details. */
+ #define JUCE_TRACE_ZONE_WITH_ARG(name, argument)    const juce::TraceRecorder::ScopedZone JUCE_JOIN_MACRO (traceZone_, __LINE__) (name, (juce::int64) (argument));
+
+ /** Records the value of a counter in the TraceRecorder. */
+ #define JUCE_TRACE_COUNTER(name, value)             { if (juce::TraceRecorder::isRecording()) juce::TraceRecorder::counter (name, (double) (value)); }
+
+ /** Records a momentary event in the TraceRecorder. */
+ #define JUCE_TRACE_INSTANT(name)                    { if (juce::TraceRecorder::isRecording()) juce::TraceRecorder::instant (name); }
+
+ /** Records the start of a flow in the TraceRecorder. */
+ #define JUCE_TRACE_FLOW_BEGIN(name, flowId)         { if (juce::TraceRecorder::isRecording()) juce::TraceRecorder::flowBegin (name, (juce::uint64) (flowId)); }
+
+ /** Records a step in a flow in the TraceRecorder. */
+ #define JUCE_TRACE_FLOW_STEP(name, flowId)          { if (juce::TraceRecorder::isRecording()) juce::TraceRecorder::flowStep (name, (juce::uint64) (flowId)); }
+
+ /** Records the end of a flow in the TraceRecorder. */
+ #define JUCE_TRACE_FLOW_END(name, flowId)           { if (juce::TraceRecorder::isRecording()) juce::TraceRecorder::flowEnd (name, (juce::uint64) (flowId)); }
+#else
+ #define JUCE_TRACE_ZONE(name)
+ #define JUCE_TRACE_ZONE_WITH_ARG(name, argument)
+ #define JUCE_TRACE_COUNTER(name, value)             {}
+ #define JUCE_TRACE_INSTANT(name)                    {}
+ #define JUCE_TRACE_FLOW_BEGIN(name, flowId)         {}
+ #define JUCE_TRACE_FLOW_STEP(name, flowId)          {}
+ #define JUCE_TRACE_FLOW_END(name, flowId)           {}
+#endif
+
+
+#endif   // JUCE_TRACERECORDER_H_INCLUDED
@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+BatchedChangeDispatcher::Stats::Stats() noexcept
+    : numBatches (0), numBroadcastersNotified (0), numListenerCallbacks (0),
+      numMessagesCoalesced (0), dispatchTimeMs (0)
+{
+}
+
+//==============================================================================
+BatchedChangeDispatcher::BatchedChangeDispatcher()
+    : dispatchIndex (0)
+{
+}
+
+BatchedChangeDispatcher::~BatchedChangeDispatcher()
+{
+    clearSingletonInstance();
+}
+
+juce_ImplementSingleton (BatchedChangeDispatcher)
+
+//==============================================================================
+void BatchedChangeDispatcher::addBroadcaster (ChangeBroadcaster* const broadcaster)
+{
+    {
+        const ScopedLock sl (lock);
+        broadcaster->batchedDispatchIndex = pending.size();
+        pending.add (broadcaster);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void BatchedChangeDispatcher::removeBroadcaster (ChangeBroadcaster* const broadcaster)
+{
+    // The broadcaster remembers where it was added, so this doesn't need to search
+    // the lists. Its slot is left empty, and will just be skipped when the batch is delivered.
+    const ScopedLock sl (lock);
+    const int index = broadcaster->batchedDispatchIndex;
+    broadcaster->batchedDispatchIndex = -1;
+
+    if (isPositiveAndBelow (index, pending.size()) && pending.getUnchecked (index) == broadcaster)
+        pending.set (index, nullptr);
+    else if (isPositiveAndBelow (index, beingDispatched.size()) && beingDispatched.getUnchecked (index) == broadcaster)
+        beingDispatched.set (index, nullptr);
+}
+
+void BatchedChangeDispatcher::messageCoalesced() noexcept
+{
+    ++numCoalesced;
+}
+
+void BatchedChangeDispatcher::handleAsyncUpdate()
+{
+    const double startTime = Time::getMillisecondCounterHiRes();
+
+    Stats batch;
+    batch.numBatches = 1;
+
+    {
+        const ScopedLock sl (lock);
+        beingDispatched.swapWith (pending);
+        dispatchIndex = 0;
+    }
+
+    for (;;)
+    {
+        ChangeBroadcaster* broadcaster;
+
+        {
+            const ScopedLock sl (lock);
+
+            if (dispatchIndex >= beingDispatched.size())
+                break;
+
+            broadcaster = beingDispatched.getUnchecked (dispatchIndex++);
+
+            if (broadcaster == nullptr)
+                continue;
+
+            broadcaster->batchedMessagePending = 0;
+        }
+
+        ++batch.numBroadcastersNotified;
+        batch.numListenerCallbacks += broadcaster->changeListeners.size();
+        broadcaster->callListeners();
+    }
+
+    {
+        const ScopedLock sl (lock);
+        beingDispatched.clearQuick();
+    }
+
+    batch.numMessagesCoalesced = numCoalesced.exchange (0);
+    batch.dispatchTimeMs = Time::getMillisecondCounterHiRes() - startTime;
+
+    lastBatch = batch;
+    totals.numBatches              += batch.numBatches;
+    totals.numBroadcastersNotified += batch.numBroadcastersNotified;
+    totals.numListenerCallbacks    += batch.numListenerCallbacks;
+    totals.numMessagesCoalesced    += batch.numMessagesCoalesced;
+    totals.dispatchTimeMs          += batch.dispatchTimeMs;
+}
+
+//==============================================================================
+BatchedChangeDispatcher::Stats BatchedChangeDispatcher::getLastBatchStats()
+{
+    jassert (MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+
+    if (BatchedChangeDispatcher* const d = getInstanceWithoutCreating())
+        return d->lastBatch;
+
+    return Stats();
+}
+
+BatchedChangeDispatcher::Stats BatchedChangeDispatcher::getTotalStats()
+{
+    jassert (MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+
+    if (BatchedChangeDispatcher* const d = getInstanceWithoutCreating())
+        return d->totals;
+
+    return Stats();
+}
+
+void BatchedChangeDispatcher::resetTotalStats()
+{
+    jassert (MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+
+    if (BatchedChangeDispatcher* const d = getInstanceWithoutCreating())
+        d->totals = Stats();
+}
+
+void BatchedChangeDispatcher::dispatchAllPendingMessages()
+{
+    // This can only be called by the event thread.
+    jassert (MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+
+    if (BatchedChangeDispatcher* const d = getInstanceWithoutCreating())
+        d->handleUpdateNowIfNeeded();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class BatchedChangeDispatcherTests  : public UnitTest
+{
+public:
+    BatchedChangeDispatcherTests()  : UnitTest ("BatchedChangeDispatcher") {}
+
+    struct TestBroadcaster  : public ChangeBroadcaster,
+                              public ChangeListener
+    {
+        TestBroadcaster (Array<int>& log, int i)
+            : callLog (log), id (i), numCalls (0), resendCount (0)
+        {
+            setUsesBatchedDispatch (true);
+            addChangeListener (this);
+        }
+
+        void changeListenerCallback (ChangeBroadcaster*) override
+        {
+            callLog.add (id);
+            ++numCalls;
+
+            if (resendCount > 0)
+            {
+                --resendCount;
+                sendChangeMessage();
+            }
+        }
+
+        Array<int>& callLog;
+        const int id;
+        int numCalls, resendCount;
+
+        JUCE_DECLARE_NON_COPYABLE (TestBroadcaster)
+    };
+
+    void runTest()
+    {
+        MessageManager::getInstance();
+        BatchedChangeDispatcher::dispatchAllPendingMessages();
+
+        beginTest ("Coalescing");
+
+        {
+            Array<int> log;
+            OwnedArray<TestBroadcaster> broadcasters;
+
+            for (int i = 0; i < 100; ++i)
+                broadcasters.add (new TestBroadcaster (log, i));
+
+            for (int j = 0; j < 3; ++j)
+                for (int i = broadcasters.size(); --i >= 0;)
+                    broadcasters.getUnchecked(i)->sendChangeMessage();
+
+            BatchedChangeDispatcher::dispatchAllPendingMessages();
+
+            const BatchedChangeDispatcher::Stats stats (BatchedChangeDispatcher::getLastBatchStats());
+            expectEquals (stats.numBroadcastersNotified, 100);
+            expectEquals (stats.numMessagesCoalesced, 200);
+            expectEquals (log.size(), 100);
+
+            // delivered in the order the broadcasters were first flagged
+            for (int i = 0; i < log.size(); ++i)
+                expectEquals (log[i], 99 - i);
+        }
+
+        beginTest ("Removal during dispatch");
+
+        {
+            Array<int> log;
+            OwnedArray<TestBroadcaster> first, second;
+
+            for (int i = 0; i < 50; ++i)
+            {
+                first.add (new TestBroadcaster (log, i));
+                second.add (new TestBroadcaster (log, 100 + i));
+            }
+
+            first.getFirst()->resendCount = 1;
+
+            for (int i = 0; i < 50; ++i)
+            {
+                first.getUnchecked(i)->sendChangeMessage();
+                second.getUnchecked(i)->sendChangeMessage();
+            }
+
+            // deleting a pending broadcaster takes it out of the batch
+            second.remove (10);
+            second.remove (20);
+
+            // and one broadcaster's listener deletes all the broadcasters that are still due to be called
+            struct Deleter  : public ChangeListener
+            {
+                Deleter (OwnedArray<TestBroadcaster>& b) : broadcasters (b) {}
+                void changeListenerCallback (ChangeBroadcaster*) override   { broadcasters.clear(); }
+                OwnedArray<TestBroadcaster>& broadcasters;
+            };
+
+            Deleter deleter (second);
+            first.getUnchecked (25)->addChangeListener (&deleter);
+
+            BatchedChangeDispatcher::dispatchAllPendingMessages();
+            first.getUnchecked (25)->removeChangeListener (&deleter);
+
+            // (of the second set, only the 23 that came before first[25] got called)
+            expectEquals (log.size(), 50 + 23);
+
+            for (int i = 0; i < log.size(); ++i)
+                expect (log[i] != 110 && log[i] != 121);
+
+            expectEquals (first.getFirst()->numCalls, 1);
+
+            // the broadcaster that re-sent from its callback is called again in the next batch
+            BatchedChangeDispatcher::dispatchAllPendingMessages();
+            expectEquals (first.getFirst()->numCalls, 2);
+            expectEquals (BatchedChangeDispatcher::getLastBatchStats().numBroadcastersNotified, 1);
+        }
+    }
+};
+
+static BatchedChangeDispatcherTests batchedChangeDispatcherTests;
+
+#endif
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_BATCHEDCHANGEDISPATCHER_H_INCLUDED
+#define JUCE_BATCHEDCHANGEDISPATCHER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Collects asynchronous change messages from many ChangeBroadcasters and delivers
+    them all from a single message-thread callback.
+
+    Normally each ChangeBroadcaster posts its own message to the event queue when you
+    call sendChangeMessage(). If you've got thousands of broadcasters changing at once,
+    that means thousands of messages to post and dispatch. A broadcaster which has had
+    ChangeBroadcaster::setUsesBatchedDispatch() enabled will instead just flag itself as
+    dirty with this object, which posts a single message per batch, and then calls all the
+    dirty broadcasters' listeners in one pass, in the order they were first flagged.
+
+    Broadcasters that send more messages while a batch is being delivered will be called
+    again in the next batch.
+
+    The class also keeps some counters that are handy when profiling: see getLastBatchStats()
+    and getTotalStats().
+
+    @see ChangeBroadcaster
+*/
+class JUCE_API  BatchedChangeDispatcher  : private AsyncUpdater,
+                                           private DeletedAtShutdown
+{
+public:
+    //==============================================================================
+    /** Some counters describing the work done by the dispatcher. */
+    struct Stats
+    {
+        Stats() noexcept;
+
+        /** The number of batches (i.e. message callbacks) that were delivered. */
+        int numBatches;
+
+        /** The number of broadcasters whose listeners were called. */
+        int numBroadcastersNotified;
+
+        /** The number of individual ChangeListener callbacks that were made. */
+        int numListenerCallbacks;
+
+        /** The number of sendChangeMessage() calls that were merged into a pending notification. */
+        int numMessagesCoalesced;
+
+        /** The time spent delivering the callbacks, in milliseconds. */
+        double dispatchTimeMs;
+    };
+
+    /** Returns the counters for the most recently-delivered batch.
+        This must only be called on the message thread.
+    */
+    static Stats getLastBatchStats();
+
+    /** Returns the counters accumulated since the app started, or since resetTotalStats()
+        was last called. This must only be called on the message thread.
+    */
+    static Stats getTotalStats();
+
+    /** Clears the counters returned by getTotalStats().
+        This must only be called on the message thread.
+    */
+    static void resetTotalStats();
+
+    /** Immediately delivers any pending notifications, rather than waiting for the
+        next batch. This must only be called on the message thread.
+    */
+    static void dispatchAllPendingMessages();
+
+    //==============================================================================
+    /** @internal */
+    ~BatchedChangeDispatcher();
+
+    juce_DeclareSingleton (BatchedChangeDispatcher, true)
+
+private:
+    //==============================================================================
+    friend class ChangeBroadcaster;
+
+    CriticalSection lock;
+    Array<ChangeBroadcaster*> pending, beingDispatched;
+    int dispatchIndex;
+    Stats lastBatch, totals;
+    Atomic<int> numCoalesced;
+
+    BatchedChangeDispatcher();
+
+    void addBroadcaster (ChangeBroadcaster*);
+    void removeBroadcaster (ChangeBroadcaster*);
+    void messageCoalesced() noexcept;
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE (BatchedChangeDispatcher)
+};
+
+
+#endif   // JUCE_BATCHEDCHANGEDISPATCHER_H_INCLUDED
@@ -23,12 +23,14 @@
 */
 
 ChangeBroadcaster::ChangeBroadcaster() noexcept
+    : batchedDispatchIndex (-1), batchedDispatch (false)
 {
     callback.owner = this;
 }
 
 ChangeBroadcaster::~ChangeBroadcaster()
 {
+    cancelBatchedMessage();
 }
 
 void ChangeBroadcaster::addChangeListener (ChangeListener* const listener)
@@ -61,7 +63,14 @@ void ChangeBroadcaster::removeAllChangeListeners()
 void ChangeBroadcaster::sendChangeMessage()
 {
     if (changeListeners.size() > 0)
-        callback.triggerAsyncUpdate();
+    {
+        if (! batchedDispatch)
+            callback.triggerAsyncUpdate();
+        else if (batchedMessagePending.compareAndSetBool (1, 0))
+            BatchedChangeDispatcher::getInstance()->addBroadcaster (this);
+        else
+            BatchedChangeDispatcher::getInstance()->messageCoalesced();
+    }
 }
 
 void ChangeBroadcaster::sendSynchronousChangeMessage()
@@ -70,12 +79,38 @@ void ChangeBroadcaster::sendSynchronousChangeMessage()
     jassert (MessageManager::getInstance()->isThisTheMessageThread());
 
     callback.cancelPendingUpdate();
+    cancelBatchedMessage();
     callListeners();
 }
 
 void ChangeBroadcaster::dispatchPendingMessages()
 {
     callback.handleUpdateNowIfNeeded();
+
+    if (cancelBatchedMessage())
+        callListeners();
+}
+
+void ChangeBroadcaster::setUsesBatchedDispatch (const bool shouldUseBatchedDispatch)
+{
+    if (batchedDispatch != shouldUseBatchedDispatch)
+    {
+        batchedDispatch = shouldUseBatchedDispatch;
+
+        if (cancelBatchedMessage())
+            callback.triggerAsyncUpdate();
+    }
+}
+
+bool ChangeBroadcaster::cancelBatchedMessage()
+{
+    if (batchedMessagePending.get() == 0)
+        return false;
+
+    if (BatchedChangeDispatcher* const dispatcher = BatchedChangeDispatcher::getInstanceWithoutCreating())
+        dispatcher->removeBroadcaster (this);
+
+    return batchedMessagePending.exchange (0) != 0;
 }
 
 void ChangeBroadcaster::callListeners()
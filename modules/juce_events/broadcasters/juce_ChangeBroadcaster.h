@@ -81,6 +81,24 @@ public:
     */
     void dispatchPendingMessages();
 
+    //==============================================================================
+    /** Chooses whether sendChangeMessage() should deliver its messages via the shared
+        BatchedChangeDispatcher.
+
+        By default, each broadcaster posts its own message when it needs to call its listeners.
+        If you have large numbers of broadcasters that change together, enabling this lets
+        their callbacks all be made in one pass from a single message, which is much cheaper.
+        The listener callbacks are the same, but their order relative to other messages may differ.
+
+        @see BatchedChangeDispatcher
+    */
+    void setUsesBatchedDispatch (bool shouldUseBatchedDispatch);
+
+    /** Returns true if this broadcaster is using the BatchedChangeDispatcher.
+        @see setUsesBatchedDispatch
+    */
+    bool usesBatchedDispatch() const noexcept           { return batchedDispatch; }
+
 private:
     //==============================================================================
     class ChangeBroadcasterCallback  : public AsyncUpdater
@@ -93,10 +111,15 @@ private:
     };
 
     friend class ChangeBroadcasterCallback;
+    friend class BatchedChangeDispatcher;
     ChangeBroadcasterCallback callback;
     ListenerList <ChangeListener> changeListeners;
+    Atomic<int> batchedMessagePending;
+    int batchedDispatchIndex;
+    bool batchedDispatch;
 
     void callListeners();
+    bool cancelBatchedMessage();
 
     JUCE_DECLARE_NON_COPYABLE (ChangeBroadcaster)
 };
@@ -71,6 +71,7 @@ namespace juce
 #include "broadcasters/juce_ActionBroadcaster.cpp"
 #include "broadcasters/juce_AsyncUpdater.cpp"
 #include "broadcasters/juce_ChangeBroadcaster.cpp"
+#include "broadcasters/juce_BatchedChangeDispatcher.cpp"
 #include "timers/juce_MultiTimer.cpp"
 #include "timers/juce_Timer.cpp"
 #include "interprocess/juce_InterprocessConnection.cpp"
@@ -44,6 +44,7 @@ namespace juce
 #include "broadcasters/juce_AsyncUpdater.h"
 #include "broadcasters/juce_ChangeListener.h"
 #include "broadcasters/juce_ChangeBroadcaster.h"
+#include "broadcasters/juce_BatchedChangeDispatcher.h"
 #include "timers/juce_Timer.h"
 #include "timers/juce_MultiTimer.h"
 #include "interprocess/juce_InterprocessConnection.h"
@@ -47,7 +47,12 @@ JUCE_JNI_CALLBACK (JUCE_ANDROID_ACTIVITY_CLASSNAME, deliverMessage, void, (jobje
     JUCE_TRY
     {
         MessageManager::MessageBase* const message = (MessageManager::MessageBase*) (pointer_sized_uint) value;
-        message->messageCallback();
+
+        {
+            JUCE_TRACE_ZONE ("MessageManager dispatch");
+            message->messageCallback();
+        }
+
         message->decReferenceCount();
     }
     JUCE_CATCH_EXCEPTION
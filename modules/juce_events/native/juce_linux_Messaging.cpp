@@ -199,6 +199,7 @@ private:
         {
             JUCE_TRY
             {
+                JUCE_TRACE_ZONE ("MessageManager dispatch");
                 msg->messageCallback();
                 return true;
             }
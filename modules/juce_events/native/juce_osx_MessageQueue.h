@@ -76,6 +76,7 @@ private:
         {
             JUCE_TRY
             {
+                JUCE_TRACE_ZONE ("MessageManager dispatch");
                 nextMessage->messageCallback();
             }
             JUCE_CATCH_EXCEPTION
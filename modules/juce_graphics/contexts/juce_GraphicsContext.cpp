@@ -40,6 +40,11 @@ namespace
 LowLevelGraphicsContext::LowLevelGraphicsContext() {}
 LowLevelGraphicsContext::~LowLevelGraphicsContext() {}
 
+void LowLevelGraphicsContext::fillPreparedPath (const PreparedPath& path, const AffineTransform& transform)
+{
+    fillPath (path.getOutline (transform, getPhysicalPixelScaleFactor()), AffineTransform::identity);
+}
+
 //==============================================================================
 Graphics::Graphics (const Image& imageToDrawOnto)
     : context (*imageToDrawOnto.createLowLevelContext()),
@@ -388,6 +393,12 @@ void Graphics::strokePath (const Path& path,
     fillPath (stroke);
 }
 
+void Graphics::drawPath (const PreparedPath& path, const AffineTransform& transform) const
+{
+    if ((! context.isClipEmpty()) && ! path.isEmpty())
+        context.fillPreparedPath (path, transform);
+}
+
 //==============================================================================
 void Graphics::drawRect (const int x, const int y, const int width, const int height,
                          const int lineThickness) const
@@ -426,6 +426,14 @@ public:
                      const PathStrokeType& strokeType,
                      const AffineTransform& transform = AffineTransform::identity) const;
 
+    /** Fills or strokes a PreparedPath using the currently selected colour or brush.
+
+        This draws the same thing as fillPath() or strokePath() would, but re-uses any
+        stroke outline and edge table that the PreparedPath has cached for this transform.
+    */
+    void drawPath (const PreparedPath& path,
+                   const AffineTransform& transform = AffineTransform::identity) const;
+
     /** Draws a line with an arrowhead at its end.
 
         @param line             the line to draw
@@ -86,6 +86,7 @@ public:
     //==============================================================================
     virtual void fillRect (const Rectangle<int>&, bool replaceExistingContents) = 0;
     virtual void fillPath (const Path&, const AffineTransform&) = 0;
+    virtual void fillPreparedPath (const PreparedPath&, const AffineTransform&);
 
     virtual void drawImage (const Image&, const AffineTransform&) = 0;
 
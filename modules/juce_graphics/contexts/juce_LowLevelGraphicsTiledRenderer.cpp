@@ -0,0 +1,865 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+class LowLevelGraphicsTiledRenderer::StateTracker  : public RenderingHelpers::StackBasedLowLevelGraphicsContext<RenderingHelpers::SoftwareRendererSavedState>
+{
+public:
+    StateTracker (RenderingHelpers::SoftwareRendererSavedState* initialState)
+        : RenderingHelpers::StackBasedLowLevelGraphicsContext<RenderingHelpers::SoftwareRendererSavedState> (initialState)
+    {
+    }
+
+    // A layer doesn't change the clip region or the coordinates being used, so while
+    // recording there's no need to allocate a real one.
+    void beginTransparencyLayer (float) override    { stack.save(); }
+    void endTransparencyLayer() override            { stack.restore(); }
+
+    Rectangle<int> getDeviceClipBounds() const
+    {
+        return stack->clip != nullptr ? stack->clip->getClipBounds() : Rectangle<int>();
+    }
+
+    /** Returns a conservative estimate of the device-space area that an operation
+        which fills the given shape could touch.
+    */
+    Rectangle<int> getDeviceBounds (const Rectangle<float>& area, const AffineTransform& t) const
+    {
+        return getDeviceClipBounds().getIntersection (area.transformedBy (stack->transform.getTransformWith (t))
+                                                          .getSmallestIntegerContainer().expanded (2));
+    }
+
+    /** Returns true if the software renderer would draw a glyph with this transform
+        using the glyph cache, rather than by asking the typeface for its outline.
+    */
+    bool canUseGlyphCache (const AffineTransform& t) const noexcept
+    {
+        return t.isOnlyTranslation() && ! stack->transform.isRotated;
+    }
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (StateTracker)
+};
+
+//==============================================================================
+class LowLevelGraphicsTiledRenderer::DisplayListOp
+{
+public:
+    DisplayListOp() noexcept : isDrawingOp (false) {}
+    virtual ~DisplayListOp() {}
+
+    virtual void perform (LowLevelGraphicsContext&) const = 0;
+
+    bool needsToBePerformedIn (const Rectangle<int>& area) const noexcept
+    {
+        return ! isDrawingOp || deviceBounds.intersects (area);
+    }
+
+    Rectangle<int> deviceBounds;
+    bool isDrawingOp;
+
+    class SetOrigin;
+    class AddTransform;
+    class ClipToRectangle;
+    class ClipToRectangleList;
+    class ExcludeClipRectangle;
+    class ClipToPath;
+    class ClipToImageAlpha;
+    class SaveState;
+    class RestoreState;
+    class BeginTransparencyLayer;
+    class EndTransparencyLayer;
+    class SetFill;
+    class SetOpacity;
+    class SetInterpolationQuality;
+    class SetFont;
+    class FillRect;
+    class FillPath;
+    class FillPreparedPath;
+    class DrawImage;
+    class DrawLine;
+    class DrawVerticalLine;
+    class DrawHorizontalLine;
+    class DrawGlyph;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (DisplayListOp)
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::SetOrigin  : public DisplayListOp
+{
+public:
+    SetOrigin (int x_, int y_) noexcept : x (x_), y (y_) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.setOrigin (x, y); }
+
+private:
+    const int x, y;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::AddTransform  : public DisplayListOp
+{
+public:
+    AddTransform (const AffineTransform& t) noexcept : transform (t) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.addTransform (transform); }
+
+private:
+    const AffineTransform transform;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::ClipToRectangle  : public DisplayListOp
+{
+public:
+    ClipToRectangle (const Rectangle<int>& r) noexcept : area (r) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.clipToRectangle (area); }
+
+private:
+    const Rectangle<int> area;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::ClipToRectangleList  : public DisplayListOp
+{
+public:
+    ClipToRectangleList (const RectangleList<int>& r) : list (r) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.clipToRectangleList (list); }
+
+private:
+    const RectangleList<int> list;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::ExcludeClipRectangle  : public DisplayListOp
+{
+public:
+    ExcludeClipRectangle (const Rectangle<int>& r) noexcept : area (r) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.excludeClipRectangle (area); }
+
+private:
+    const Rectangle<int> area;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::ClipToPath  : public DisplayListOp
+{
+public:
+    ClipToPath (const Path& p, const AffineTransform& t) : path (p), transform (t) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.clipToPath (path, transform); }
+
+private:
+    const Path path;
+    const AffineTransform transform;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::ClipToImageAlpha  : public DisplayListOp
+{
+public:
+    ClipToImageAlpha (const Image& im, const AffineTransform& t) : image (im), transform (t) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.clipToImageAlpha (image, transform); }
+
+private:
+    const Image image;
+    const AffineTransform transform;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::SaveState  : public DisplayListOp
+{
+public:
+    void perform (LowLevelGraphicsContext& g) const override     { g.saveState(); }
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::RestoreState  : public DisplayListOp
+{
+public:
+    void perform (LowLevelGraphicsContext& g) const override     { g.restoreState(); }
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::BeginTransparencyLayer  : public DisplayListOp
+{
+public:
+    BeginTransparencyLayer (float opacity_) noexcept : opacity (opacity_) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.beginTransparencyLayer (opacity); }
+
+private:
+    const float opacity;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::EndTransparencyLayer  : public DisplayListOp
+{
+public:
+    void perform (LowLevelGraphicsContext& g) const override     { g.endTransparencyLayer(); }
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::SetFill  : public DisplayListOp
+{
+public:
+    SetFill (const FillType& f) : fill (f) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.setFill (fill); }
+
+private:
+    const FillType fill;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::SetOpacity  : public DisplayListOp
+{
+public:
+    SetOpacity (float opacity_) noexcept : opacity (opacity_) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.setOpacity (opacity); }
+
+private:
+    const float opacity;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::SetInterpolationQuality  : public DisplayListOp
+{
+public:
+    SetInterpolationQuality (Graphics::ResamplingQuality q) noexcept : quality (q) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.setInterpolationQuality (quality); }
+
+private:
+    const Graphics::ResamplingQuality quality;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::SetFont  : public DisplayListOp
+{
+public:
+    SetFont (const Font& f) : font (f) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.setFont (font); }
+
+private:
+    const Font font;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::FillRect  : public DisplayListOp
+{
+public:
+    FillRect (const Rectangle<int>& r, bool replace) noexcept : area (r), replaceExistingContents (replace) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.fillRect (area, replaceExistingContents); }
+
+private:
+    const Rectangle<int> area;
+    const bool replaceExistingContents;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::FillPath  : public DisplayListOp
+{
+public:
+    FillPath (const Path& p, const AffineTransform& t) : path (p), transform (t) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.fillPath (path, transform); }
+
+private:
+    const Path path;
+    const AffineTransform transform;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::FillPreparedPath  : public DisplayListOp
+{
+public:
+    FillPreparedPath (const PreparedPath& p, const AffineTransform& t) : path (p), transform (t) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.fillPreparedPath (path, transform); }
+
+private:
+    const PreparedPath path;
+    const AffineTransform transform;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::DrawImage  : public DisplayListOp
+{
+public:
+    DrawImage (const Image& im, const AffineTransform& t) : image (im), transform (t) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.drawImage (image, transform); }
+
+private:
+    const Image image;
+    const AffineTransform transform;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::DrawLine  : public DisplayListOp
+{
+public:
+    DrawLine (const Line<float>& l) noexcept : line (l) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.drawLine (line); }
+
+private:
+    const Line<float> line;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::DrawVerticalLine  : public DisplayListOp
+{
+public:
+    DrawVerticalLine (int x_, float top_, float bottom_) noexcept : x (x_), top (top_), bottom (bottom_) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.drawVerticalLine (x, top, bottom); }
+
+private:
+    const int x;
+    const float top, bottom;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::DrawHorizontalLine  : public DisplayListOp
+{
+public:
+    DrawHorizontalLine (int y_, float left_, float right_) noexcept : y (y_), left (left_), right (right_) {}
+    void perform (LowLevelGraphicsContext& g) const override     { g.drawHorizontalLine (y, left, right); }
+
+private:
+    const int y;
+    const float left, right;
+};
+
+class LowLevelGraphicsTiledRenderer::DisplayListOp::DrawGlyph  : public DisplayListOp
+{
+public:
+    DrawGlyph (int glyph_, const AffineTransform& t, bool usesGlyphCache_) noexcept
+        : glyph (glyph_), transform (t), usesGlyphCache (usesGlyphCache_)
+    {
+    }
+
+    typedef RenderingHelpers::GlyphCache <RenderingHelpers::CachedGlyphEdgeTable <RenderingHelpers::SoftwareRendererSavedState>,
+                                          RenderingHelpers::SoftwareRendererSavedState> GlyphCacheType;
+
+    void perform (LowLevelGraphicsContext& g) const override
+    {
+        if (usesGlyphCache)
+        {
+            g.drawGlyph (glyph, transform);
+        }
+        else
+        {
+            // Glyphs that can't be cached are rendered directly from the typeface, which
+            // isn't safe to use from more than one thread at once.
+            const ScopedLock sl (GlyphCacheType::getInstance().getLock());
+            g.drawGlyph (glyph, transform);
+        }
+    }
+
+private:
+    const int glyph;
+    const AffineTransform transform;
+    const bool usesGlyphCache;
+};
+
+//==============================================================================
+class LowLevelGraphicsTiledRenderer::TileThreadPool  : public ThreadPool,
+                                                       private DeletedAtShutdown
+{
+public:
+    TileThreadPool() : ThreadPool (jmax (1, SystemStats::getNumCpus() - 1)) {}
+    ~TileThreadPool()   { clearSingletonInstance(); }
+
+    juce_DeclareSingleton (TileThreadPool, false)
+};
+
+juce_ImplementSingleton (LowLevelGraphicsTiledRenderer::TileThreadPool)
+
+//==============================================================================
+class LowLevelGraphicsTiledRenderer::TileJob  : public ThreadPoolJob
+{
+public:
+    TileJob (const LowLevelGraphicsTiledRenderer& owner_, const Rectangle<int>& area_)
+        : ThreadPoolJob ("Tiled renderer"), owner (owner_), area (area_)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        owner.renderTile (area);
+        return jobHasFinished;
+    }
+
+private:
+    const LowLevelGraphicsTiledRenderer& owner;
+    const Rectangle<int> area;
+
+    JUCE_DECLARE_NON_COPYABLE (TileJob)
+};
+
+//==============================================================================
+LowLevelGraphicsTiledRenderer::LowLevelGraphicsTiledRenderer (const Image& im, int tiles)
+    : image (im), initialClip (im.getBounds()), numTiles (tiles),
+      state (new StateTracker (new RenderingHelpers::SoftwareRendererSavedState (im, im.getBounds())))
+{
+}
+
+LowLevelGraphicsTiledRenderer::LowLevelGraphicsTiledRenderer (const Image& im, Point<int> o,
+                                                              const RectangleList<int>& clip, int tiles)
+    : image (im), origin (o), initialClip (clip), numTiles (tiles),
+      state (new StateTracker (new RenderingHelpers::SoftwareRendererSavedState (im, clip, o)))
+{
+}
+
+LowLevelGraphicsTiledRenderer::~LowLevelGraphicsTiledRenderer()
+{
+    renderAll();
+}
+
+//==============================================================================
+void LowLevelGraphicsTiledRenderer::addStateChange (DisplayListOp* const op)
+{
+    displayList.add (op);
+}
+
+void LowLevelGraphicsTiledRenderer::addDrawingOp (DisplayListOp* const op, const Rectangle<int>& deviceBounds)
+{
+    if (deviceBounds.isEmpty())
+    {
+        delete op;
+    }
+    else
+    {
+        op->isDrawingOp = true;
+        op->deviceBounds = deviceBounds;
+        displayList.add (op);
+    }
+}
+
+void LowLevelGraphicsTiledRenderer::renderTile (const Rectangle<int>& area) const
+{
+    RectangleList<int> clip (initialClip);
+    clip.clipTo (area);
+
+    if (! clip.isEmpty())
+    {
+        LowLevelGraphicsSoftwareRenderer g (image, origin, clip);
+
+        for (int i = 0; i < displayList.size(); ++i)
+        {
+            const DisplayListOp& op = *displayList.getUnchecked (i);
+
+            if (op.needsToBePerformedIn (area))
+                op.perform (g);
+        }
+    }
+}
+
+void LowLevelGraphicsTiledRenderer::renderAll()
+{
+    const Rectangle<int> area (initialClip.getBounds().getIntersection (image.getBounds()));
+
+    if (area.isEmpty() || displayList.size() == 0)
+        return;
+
+    enum { minimumTileHeight = 16 };
+
+    const int tiles = jmax (1, jmin (numTiles > 0 ? numTiles : SystemStats::getNumCpus(),
+                                     area.getHeight() / minimumTileHeight));
+
+    if (tiles == 1)
+    {
+        renderTile (area);
+        return;
+    }
+
+    // make sure these exist before any of the worker threads need them
+    TileThreadPool& pool = *TileThreadPool::getInstance();
+    DisplayListOp::DrawGlyph::GlyphCacheType::getInstance();
+
+    const int tileHeight = (area.getHeight() + tiles - 1) / tiles;
+    OwnedArray<TileJob> jobs;
+
+    for (int y = area.getY() + tileHeight; y < area.getBottom(); y += tileHeight)
+    {
+        TileJob* const job = new TileJob (*this, Rectangle<int> (area.getX(), y, area.getWidth(),
+                                                                 jmin (tileHeight, area.getBottom() - y)));
+        jobs.add (job);
+        pool.addJob (job, false);
+    }
+
+    // this thread takes care of the first strip while the pool does the rest..
+    renderTile (area.withHeight (tileHeight));
+
+    for (int i = 0; i < jobs.size(); ++i)
+        pool.waitForJobToFinish (jobs.getUnchecked (i), -1);
+}
+
+//==============================================================================
+bool LowLevelGraphicsTiledRenderer::isVectorDevice() const                             { return false; }
+float LowLevelGraphicsTiledRenderer::getPhysicalPixelScaleFactor()                     { return state->getPhysicalPixelScaleFactor(); }
+bool LowLevelGraphicsTiledRenderer::clipRegionIntersects (const Rectangle<int>& r)     { return state->clipRegionIntersects (r); }
+Rectangle<int> LowLevelGraphicsTiledRenderer::getClipBounds() const                   { return state->getClipBounds(); }
+bool LowLevelGraphicsTiledRenderer::isClipEmpty() const                                { return state->isClipEmpty(); }
+const Font& LowLevelGraphicsTiledRenderer::getFont()                                   { return state->getFont(); }
+
+void LowLevelGraphicsTiledRenderer::setOrigin (int x, int y)
+{
+    state->setOrigin (x, y);
+    addStateChange (new DisplayListOp::SetOrigin (x, y));
+}
+
+void LowLevelGraphicsTiledRenderer::addTransform (const AffineTransform& t)
+{
+    state->addTransform (t);
+    addStateChange (new DisplayListOp::AddTransform (t));
+}
+
+bool LowLevelGraphicsTiledRenderer::clipToRectangle (const Rectangle<int>& r)
+{
+    addStateChange (new DisplayListOp::ClipToRectangle (r));
+    return state->clipToRectangle (r);
+}
+
+bool LowLevelGraphicsTiledRenderer::clipToRectangleList (const RectangleList<int>& r)
+{
+    addStateChange (new DisplayListOp::ClipToRectangleList (r));
+    return state->clipToRectangleList (r);
+}
+
+void LowLevelGraphicsTiledRenderer::excludeClipRectangle (const Rectangle<int>& r)
+{
+    state->excludeClipRectangle (r);
+    addStateChange (new DisplayListOp::ExcludeClipRectangle (r));
+}
+
+void LowLevelGraphicsTiledRenderer::clipToPath (const Path& path, const AffineTransform& t)
+{
+    state->clipToPath (path, t);
+    addStateChange (new DisplayListOp::ClipToPath (path, t));
+}
+
+void LowLevelGraphicsTiledRenderer::clipToImageAlpha (const Image& im, const AffineTransform& t)
+{
+    state->clipToImageAlpha (im, t);
+    addStateChange (new DisplayListOp::ClipToImageAlpha (im, t));
+}
+
+void LowLevelGraphicsTiledRenderer::saveState()
+{
+    state->saveState();
+    addStateChange (new DisplayListOp::SaveState());
+}
+
+void LowLevelGraphicsTiledRenderer::restoreState()
+{
+    state->restoreState();
+    addStateChange (new DisplayListOp::RestoreState());
+}
+
+void LowLevelGraphicsTiledRenderer::beginTransparencyLayer (float opacity)
+{
+    state->beginTransparencyLayer (opacity);
+    addStateChange (new DisplayListOp::BeginTransparencyLayer (opacity));
+}
+
+void LowLevelGraphicsTiledRenderer::endTransparencyLayer()
+{
+    state->endTransparencyLayer();
+    addStateChange (new DisplayListOp::EndTransparencyLayer());
+}
+
+void LowLevelGraphicsTiledRenderer::setFill (const FillType& fill)
+{
+    state->setFill (fill);
+    addStateChange (new DisplayListOp::SetFill (fill));
+}
+
+void LowLevelGraphicsTiledRenderer::setOpacity (float opacity)
+{
+    state->setOpacity (opacity);
+    addStateChange (new DisplayListOp::SetOpacity (opacity));
+}
+
+void LowLevelGraphicsTiledRenderer::setInterpolationQuality (Graphics::ResamplingQuality quality)
+{
+    state->setInterpolationQuality (quality);
+    addStateChange (new DisplayListOp::SetInterpolationQuality (quality));
+}
+
+void LowLevelGraphicsTiledRenderer::setFont (const Font& font)
+{
+    state->setFont (font);
+    addStateChange (new DisplayListOp::SetFont (font));
+}
+
+//==============================================================================
+void LowLevelGraphicsTiledRenderer::fillRect (const Rectangle<int>& r, bool replaceExistingContents)
+{
+    if (! state->isClipEmpty())
+        addDrawingOp (new DisplayListOp::FillRect (r, replaceExistingContents),
+                      state->getDeviceBounds (r.toFloat(), AffineTransform::identity));
+}
+
+void LowLevelGraphicsTiledRenderer::fillPath (const Path& path, const AffineTransform& t)
+{
+    if (! state->isClipEmpty())
+        addDrawingOp (new DisplayListOp::FillPath (path, t),
+                      state->getDeviceBounds (path.getBounds(), t));
+}
+
+void LowLevelGraphicsTiledRenderer::fillPreparedPath (const PreparedPath& path, const AffineTransform& t)
+{
+    if (! state->isClipEmpty())
+    {
+        // Creating the outline here means that the tiles will all find it in the cache,
+        // rather than several rendering threads trying to build it at the same time.
+        const Path outline (path.getOutline (t, state->getPhysicalPixelScaleFactor()));
+
+        addDrawingOp (new DisplayListOp::FillPreparedPath (path, t),
+                      state->getDeviceBounds (outline.getBounds(), AffineTransform::identity));
+    }
+}
+
+void LowLevelGraphicsTiledRenderer::drawImage (const Image& im, const AffineTransform& t)
+{
+    if (! state->isClipEmpty())
+        addDrawingOp (new DisplayListOp::DrawImage (im, t),
+                      state->getDeviceBounds (im.getBounds().toFloat(), t));
+}
+
+void LowLevelGraphicsTiledRenderer::drawLine (const Line<float>& line)
+{
+    if (! state->isClipEmpty())
+        addDrawingOp (new DisplayListOp::DrawLine (line),
+                      state->getDeviceBounds (Rectangle<float> (line.getStart(), line.getEnd()).expanded (1.0f),
+                                              AffineTransform::identity));
+}
+
+void LowLevelGraphicsTiledRenderer::drawVerticalLine (int x, float top, float bottom)
+{
+    if (top < bottom && ! state->isClipEmpty())
+        addDrawingOp (new DisplayListOp::DrawVerticalLine (x, top, bottom),
+                      state->getDeviceBounds (Rectangle<float> ((float) x, top, 1.0f, bottom - top), AffineTransform::identity));
+}
+
+void LowLevelGraphicsTiledRenderer::drawHorizontalLine (int y, float left, float right)
+{
+    if (left < right && ! state->isClipEmpty())
+        addDrawingOp (new DisplayListOp::DrawHorizontalLine (y, left, right),
+                      state->getDeviceBounds (Rectangle<float> (left, (float) y, right - left, 1.0f), AffineTransform::identity));
+}
+
+void LowLevelGraphicsTiledRenderer::drawGlyph (int glyphNumber, const AffineTransform& t)
+{
+    if (! state->isClipEmpty())
+    {
+        // Working out the real bounds of a glyph would mean loading it, so this uses an
+        // area around its origin that's generously bigger than any glyph should be.
+        const Font& font = state->getFont();
+        const float h = font.getHeight(), w = h * font.getHorizontalScale();
+
+        // Fonts find their typefaces lazily, so this makes sure it happens now rather
+        // than on several of the rendering threads at once.
+        font.getTypeface();
+
+        addDrawingOp (new DisplayListOp::DrawGlyph (glyphNumber, t, state->canUseGlyphCache (t)),
+                      state->getDeviceBounds (Rectangle<float> (-2.0f * w, -2.0f * h, 5.0f * w, 4.0f * h), t));
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class LowLevelGraphicsTiledRendererTests  : public UnitTest
+{
+public:
+    LowLevelGraphicsTiledRendererTests()  : UnitTest ("LowLevelGraphicsTiledRenderer") {}
+
+    enum { numScenes = 4, width = 1600, height = 1000 };
+
+    static const char* getSceneName (int scene)
+    {
+        const char* const names[] = { "Mixer strips", "Images", "Text", "Layers and clipping" };
+        return names [scene];
+    }
+
+    static void drawMixerStrips (Graphics& g)
+    {
+        g.fillAll (Colour (0xff202428));
+
+        for (int strip = 0; strip < 40; ++strip)
+        {
+            const float x = strip * 40.0f + 2.0f;
+
+            g.setGradientFill (ColourGradient (Colour (0xff505860), x, 0.0f,
+                                               Colour (0xff303438), x + 36.0f, (float) height, false));
+            g.fillRoundedRectangle (x, 4.0f, 36.0f, height - 8.0f, 4.0f);
+
+            for (int knob = 0; knob < 6; ++knob)
+            {
+                const float cx = x + 18.0f, cy = 30.0f + knob * 40.0f;
+
+                g.setColour (Colours::black.withAlpha (0.5f));
+                g.fillEllipse (cx - 14.0f, cy - 14.0f, 28.0f, 28.0f);
+
+                Path arc;
+                arc.addPieSegment (cx - 12.0f, cy - 12.0f, 24.0f, 24.0f, -2.4f, -2.4f + (strip + knob) * 0.1f, 0.7f);
+                g.setColour (Colours::orange);
+                g.fillPath (arc);
+            }
+
+            const float level = (float) ((strip * 37) % 100) / 100.0f;
+            g.setGradientFill (ColourGradient (Colours::red, 0.0f, 300.0f, Colours::green, 0.0f, (float) height, false));
+            g.fillRect (x + 8.0f, 300.0f + (1.0f - level) * (height - 320), 8.0f, level * (height - 320));
+
+            g.setColour (Colours::white.withAlpha (0.3f));
+
+            for (int tick = 300; tick < height - 20; tick += 25)
+                g.drawHorizontalLine (tick, x + 20.0f, x + 30.0f);
+
+            g.drawLine (x + 25.0f, 300.0f, x + 31.0f, (float) height - 20.0f, 1.5f);
+        }
+    }
+
+    static Image createTestImage (Image::PixelFormat format)
+    {
+        Image image (format, 120, 90, true);
+        Graphics g (image);
+        g.setGradientFill (ColourGradient (Colours::blue.withAlpha (0.8f), 0.0f, 0.0f,
+                                           Colours::yellow.withAlpha (0.4f), 60.0f, 90.0f, true));
+        g.fillEllipse (0.0f, 0.0f, 120.0f, 90.0f);
+        return image;
+    }
+
+    static void drawImages (Graphics& g)
+    {
+        g.fillAll (Colours::white);
+
+        const Image argb (createTestImage (Image::ARGB)), rgb (createTestImage (Image::RGB));
+
+        for (int i = 0; i < 60; ++i)
+        {
+            const int x = (i % 10) * 160, y = (i / 10) * 160;
+
+            if (i % 3 == 0)
+            {
+                g.drawImageAt (i % 2 == 0 ? argb : rgb, x, y);
+            }
+            else
+            {
+                g.setImageResamplingQuality (i % 3 == 1 ? Graphics::mediumResamplingQuality
+                                                        : Graphics::highResamplingQuality);
+                g.drawImageTransformed (argb, AffineTransform::rotation (i * 0.2f, 60.0f, 45.0f)
+                                                              .scaled (1.3f).translated ((float) x, (float) y));
+            }
+        }
+
+        g.setTiledImageFill (rgb, 0, 0, 0.5f);
+        g.fillEllipse (200.0f, 300.0f, 900.0f, 500.0f);
+    }
+
+    static void drawText (Graphics& g)
+    {
+        g.fillAll (Colours::lightgrey);
+
+        for (int line = 0; line < 60; ++line)
+        {
+            g.setColour (Colour::fromHSV (line / 60.0f, 0.8f, 0.5f, 1.0f));
+            g.setFont (10.0f + (line % 8) * 2.0f);
+            g.drawText ("The quick brown fox jumps over the lazy dog, channel " + String (line),
+                        10, line * 16, width - 20, 16, Justification::centredLeft, false);
+        }
+
+        g.setFont (40.0f);
+        g.setColour (Colours::darkred);
+        g.addTransform (AffineTransform::rotation (0.3f).translated (800.0f, 400.0f));
+        g.drawSingleLineText ("Rotated", 0, 0);
+    }
+
+    static void drawLayersAndClipping (Graphics& g)
+    {
+        g.fillAll (Colours::darkblue);
+
+        for (int i = 0; i < 12; ++i)
+        {
+            Graphics::ScopedSaveState ss (g);
+
+            Path clip;
+            clip.addStar (Point<float> (150.0f + (i % 4) * 400.0f, 150.0f + (i / 4) * 330.0f), 7, 60.0f, 150.0f, i * 0.3f);
+            g.reduceClipRegion (clip);
+
+            g.beginTransparencyLayer (0.6f);
+            g.setColour (Colours::lime);
+            g.fillRect ((i % 4) * 400, (i / 4) * 330, 300, 300);
+            g.setColour (Colours::magenta);
+            g.fillEllipse ((i % 4) * 400.0f + 50.0f, (i / 4) * 330.0f + 50.0f, 200.0f, 200.0f);
+            g.endTransparencyLayer();
+        }
+
+        g.excludeClipRegion (Rectangle<int> (700, 100, 200, 800));
+        g.setColour (Colours::white.withAlpha (0.25f));
+        g.fillRect (0, 480, width, 40);
+    }
+
+    static void drawScene (Graphics& g, int scene)
+    {
+        switch (scene)
+        {
+            case 0:   drawMixerStrips (g); break;
+            case 1:   drawImages (g); break;
+            case 2:   drawText (g); break;
+            default:  drawLayersAndClipping (g); break;
+        }
+    }
+
+    static bool imagesAreIdentical (const Image& a, const Image& b)
+    {
+        const Image::BitmapData da (a, Image::BitmapData::readOnly);
+        const Image::BitmapData db (b, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < da.height; ++y)
+            if (memcmp (da.getLinePointer (y), db.getLinePointer (y), (size_t) (da.width * da.pixelStride)) != 0)
+                return false;
+
+        return true;
+    }
+
+    void runTest()
+    {
+        const int numRepeats = 5;
+
+        for (int scene = 0; scene < numScenes; ++scene)
+        {
+            beginTest (getSceneName (scene));
+
+            Image single (Image::RGB, width, height, true);
+            Image tiled (Image::RGB, width, height, true);
+            double singleSeconds = 0, tiledSeconds = 0;
+
+            for (int i = 0; i < numRepeats; ++i)
+            {
+                int64 start = Time::getHighResolutionTicks();
+
+                {
+                    Graphics g (single);
+                    drawScene (g, scene);
+                }
+
+                singleSeconds += Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+                start = Time::getHighResolutionTicks();
+
+                {
+                    LowLevelGraphicsTiledRenderer context (tiled, 4);
+                    Graphics g (&context);
+                    drawScene (g, scene);
+                }
+
+                tiledSeconds += Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+            }
+
+            expect (imagesAreIdentical (single, tiled));
+
+            logMessage (String (getSceneName (scene)) + ": single-threaded "
+                          + String (1000.0 * singleSeconds / numRepeats, 2) + "ms, tiled "
+                          + String (1000.0 * tiledSeconds / numRepeats, 2) + "ms ("
+                          + String (SystemStats::getNumCpus()) + " CPUs)");
+        }
+    }
+};
+
+static LowLevelGraphicsTiledRendererTests lowLevelGraphicsTiledRendererTests;
+
+#endif
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_LOWLEVELGRAPHICSTILEDRENDERER_H_INCLUDED
+#define JUCE_LOWLEVELGRAPHICSTILEDRENDERER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A software renderer that records everything drawn into it and then renders it
+    using several threads at once.
+
+    Instead of rasterising each operation as it arrives, this context keeps a display
+    list of all the drawing and state-change calls that it receives. When the context
+    is deleted, the target area is split into horizontal strips, and the whole list is
+    replayed into each strip by a LowLevelGraphicsSoftwareRenderer on a separate thread.
+    Each strip skips any operations that can't touch it, and because every strip uses
+    the same rasterising code as a normal LowLevelGraphicsSoftwareRenderer, the pixels
+    that are produced are the same as if it had all been drawn on one thread.
+
+    Queries such as getClipBounds() are answered straight away, so code that draws into
+    this context can't tell that its drawing is being deferred. The only thing to
+    bear in mind is that any images that are drawn are referenced rather than copied,
+    so they mustn't be modified until this context has been deleted.
+
+    To make the windows of your app use this renderer, you can override
+    LookAndFeel::createGraphicsContext() and return one of these.
+
+    @see LowLevelGraphicsSoftwareRenderer
+*/
+class JUCE_API  LowLevelGraphicsTiledRenderer    : public LowLevelGraphicsContext
+{
+public:
+    //==============================================================================
+    /** Creates a context to render into an image.
+
+        The numTiles parameter sets the number of strips the image is divided into;
+        if it's 0, it uses one strip per CPU core.
+    */
+    LowLevelGraphicsTiledRenderer (const Image& imageToRenderOnto, int numTiles = 0);
+
+    /** Creates a context to render into a clipped subsection of an image. */
+    LowLevelGraphicsTiledRenderer (const Image& imageToRenderOnto, Point<int> origin,
+                                   const RectangleList<int>& initialClip, int numTiles = 0);
+
+    /** Destructor.
+        This is where the recorded drawing actually gets rendered onto the image.
+    */
+    ~LowLevelGraphicsTiledRenderer();
+
+    //==============================================================================
+    /** Returns the number of operations that have been recorded so far. */
+    int getNumRecordedOperations() const noexcept       { return displayList.size(); }
+
+    //==============================================================================
+    bool isVectorDevice() const override;
+    void setOrigin (int x, int y) override;
+    void addTransform (const AffineTransform&) override;
+    float getPhysicalPixelScaleFactor() override;
+    bool clipToRectangle (const Rectangle<int>&) override;
+    bool clipToRectangleList (const RectangleList<int>&) override;
+    void excludeClipRectangle (const Rectangle<int>&) override;
+    void clipToPath (const Path&, const AffineTransform&) override;
+    void clipToImageAlpha (const Image&, const AffineTransform&) override;
+    bool clipRegionIntersects (const Rectangle<int>&) override;
+    Rectangle<int> getClipBounds() const override;
+    bool isClipEmpty() const override;
+    void saveState() override;
+    void restoreState() override;
+    void beginTransparencyLayer (float opacity) override;
+    void endTransparencyLayer() override;
+    void setFill (const FillType&) override;
+    void setOpacity (float) override;
+    void setInterpolationQuality (Graphics::ResamplingQuality) override;
+    void fillRect (const Rectangle<int>&, bool replaceExistingContents) override;
+    void fillPath (const Path&, const AffineTransform&) override;
+    void fillPreparedPath (const PreparedPath&, const AffineTransform&) override;
+    void drawImage (const Image&, const AffineTransform&) override;
+    void drawLine (const Line <float>&) override;
+    void drawVerticalLine (int x, float top, float bottom) override;
+    void drawHorizontalLine (int y, float left, float right) override;
+    void setFont (const Font&) override;
+    const Font& getFont() override;
+    void drawGlyph (int glyphNumber, const AffineTransform&) override;
+
+private:
+    //==============================================================================
+    class StateTracker;
+    class DisplayListOp;
+    class TileJob;
+    class TileThreadPool;
+    friend class StateTracker;
+    friend class DisplayListOp;
+    friend class TileJob;
+
+    Image image;
+    Point<int> origin;
+    RectangleList<int> initialClip;
+    int numTiles;
+    ScopedPointer<StateTracker> state;
+    OwnedArray<DisplayListOp> displayList;
+
+    void addStateChange (DisplayListOp*);
+    void addDrawingOp (DisplayListOp*, const Rectangle<int>& deviceBounds);
+    void renderAll();
+    void renderTile (const Rectangle<int>& area) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LowLevelGraphicsTiledRenderer)
+};
+
+
+#endif   // JUCE_LOWLEVELGRAPHICSTILEDRENDERER_H_INCLUDED
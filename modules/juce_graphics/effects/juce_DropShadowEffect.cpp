@@ -22,45 +22,194 @@
   ==============================================================================
 */
 
-static inline void blurDataTriplets (uint8* d, int num, const int delta) noexcept
+static void blurSingleChannelImage (Image& image, int radius)
+{
+    // This matches the spread of the 2 * radius repeated 3-pixel averaging passes that
+    // shadows have always used, each of which has a variance of 2/3.
+    ImageBlur::applyGaussianBlur (image, (float) std::sqrt (4.0 * radius / 3.0));
+}
+
+//==============================================================================
+/* Keeps the most recently rendered shadow images, so that components which have
+   the same shape, and so cast identical shadows, only need to be blurred once.
+*/
+class DropShadowCache  : private DeletedAtShutdown
 {
-    uint32 last = d[0];
-    d[0] = (uint8) ((d[0] + d[delta] + 1) / 3);
-    d += delta;
+public:
+    DropShadowCache()  : maxNumBytes (2 * 1024 * 1024), totalBytes (0) {}
+    ~DropShadowCache()  { clearSingletonInstance(); }
 
-    num -= 2;
+    juce_DeclareSingleton (DropShadowCache, false)
 
-    do
+    /* Returns a key for an image's alpha channel, made from a sparse grid of its pixels
+       rather than all of them. Different images can share a key, so a match has to be
+       checked with isSameAlpha(), but that's only needed when the key does match.
+    */
+    static int64 getSampledKey (const Image& image)
     {
-        const uint32 newLast = d[0];
-        d[0] = (uint8) ((last + d[0] + d[delta] + 1) / 3);
-        d += delta;
-        last = newLast;
+        const Image::BitmapData data (image, Image::BitmapData::readOnly);
+        const int stepX = jmax (1, data.width / 32), stepY = jmax (1, data.height / 32);
+        uint64 hash = (uint64) 0xcbf29ce484222325ULL;
+
+        for (int y = 0; y < data.height; y += stepY)
+            for (int x = 0; x < data.width; x += stepX)
+                hash = (hash ^ getAlpha (data, x, y)) * (uint64) 0x100000001b3ULL;
+
+        return (int64) hash;
     }
-    while (--num > 0);
 
-    d[0] = (uint8) ((last + d[0] + 1) / 3);
-}
+    Image findShadow (const Path& path, const int width, const int height, const int radius)
+    {
+        const ScopedLock sl (lock);
 
-static void blurSingleChannelImage (uint8* const data, const int width, const int height,
-                                    const int lineStride, const int repetitions) noexcept
-{
-    jassert (width > 2 && height > 2);
+        for (int i = items.size(); --i >= 0;)
+        {
+            Item* const item = items.getUnchecked (i);
 
-    for (int y = 0; y < height; ++y)
-        for (int i = repetitions; --i >= 0;)
-            blurDataTriplets (data + lineStride * y, width, 1);
+            if (! item->source.isValid() && item->radius == radius
+                 && item->shadow.getWidth() == width && item->shadow.getHeight() == height
+                 && item->path == path)
+                return useItem (i);
+        }
 
-    for (int x = 0; x < width; ++x)
-        for (int i = repetitions; --i >= 0;)
-            blurDataTriplets (data + x, height, lineStride);
-}
+        return Image();
+    }
 
-static void blurSingleChannelImage (Image& image, int radius)
-{
-    const Image::BitmapData bm (image, Image::BitmapData::readWrite);
-    blurSingleChannelImage (bm.data, bm.width, bm.height, bm.lineStride, 2 * radius);
-}
+    Image findShadow (const Image& source, const int64 key, const int radius)
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = items.size(); --i >= 0;)
+        {
+            Item* const item = items.getUnchecked (i);
+
+            if (item->source.isValid() && item->key == key && item->radius == radius
+                 && isSameAlpha (source, item->source))
+                return useItem (i);
+        }
+
+        return Image();
+    }
+
+    void addShadow (const Path& path, const int radius, const Image& shadow)
+    {
+        addItem (new Item (path, Image(), 0, radius, shadow));
+    }
+
+    void addShadow (const Image& source, const int64 key, const int radius, const Image& shadow)
+    {
+        addItem (new Item (Path(), source, key, radius, shadow));
+    }
+
+    void setMaxNumBytes (const int newMaxNumBytes)
+    {
+        const ScopedLock sl (lock);
+        maxNumBytes = jmax (0, newMaxNumBytes);
+        removeOldItems();
+    }
+
+private:
+    // A path's shadow is identified by the path. An image's shadow keeps the image's
+    // unblurred alpha channel, to confirm matches against.
+    struct Item
+    {
+        Item (const Path& p, const Image& src, const int64 k, const int r, const Image& im)
+            : path (p), source (src), key (k), radius (r), shadow (im)
+        {
+        }
+
+        int getNumBytes() const noexcept
+        {
+            return shadow.getWidth() * shadow.getHeight()
+                     + source.getWidth() * source.getHeight();
+        }
+
+        Path path;
+        Image source;
+        int64 key;
+        int radius;
+        Image shadow;
+
+        JUCE_DECLARE_NON_COPYABLE (Item)
+    };
+
+    OwnedArray<Item> items;
+    CriticalSection lock;
+    int maxNumBytes, totalBytes;
+
+    static uint8 getAlpha (const Image::BitmapData& data, const int x, const int y) noexcept
+    {
+        switch (data.pixelFormat)
+        {
+            case Image::ARGB:           return ((const PixelARGB*) data.getPixelPointer (x, y))->getAlpha();
+            case Image::SingleChannel:  return *data.getPixelPointer (x, y);
+            default:                    return 0xff;
+        }
+    }
+
+    // Compares an image's alpha channel with a single-channel image
+    static bool isSameAlpha (const Image& image, const Image& alpha)
+    {
+        if (image.getWidth() != alpha.getWidth() || image.getHeight() != alpha.getHeight())
+            return false;
+
+        const Image::BitmapData data (image, Image::BitmapData::readOnly);
+        const Image::BitmapData alphaData (alpha, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < data.height; ++y)
+        {
+            const uint8* const alphaLine = alphaData.getLinePointer (y);
+
+            if (data.pixelFormat == Image::SingleChannel)
+            {
+                if (memcmp (data.getLinePointer (y), alphaLine, (size_t) data.width) != 0)
+                    return false;
+            }
+            else
+            {
+                for (int x = 0; x < data.width; ++x)
+                    if (getAlpha (data, x, y) != alphaLine[x])
+                        return false;
+            }
+        }
+
+        return true;
+    }
+
+    Image useItem (const int index)
+    {
+        items.move (index, -1);
+        return items.getLast()->shadow;
+    }
+
+    void addItem (Item* const item)
+    {
+        const ScopedLock sl (lock);
+        ScopedPointer<Item> newItem (item);
+        const int numBytes = item->getNumBytes();
+
+        // avoid letting a single huge shadow push everything else out of the cache..
+        if (numBytes > maxNumBytes / 4)
+            return;
+
+        items.add (newItem.release());
+        totalBytes += numBytes;
+        removeOldItems();
+    }
+
+    void removeOldItems()
+    {
+        while (totalBytes > maxNumBytes && items.size() > 0)
+        {
+            totalBytes -= items.getFirst()->getNumBytes();
+            items.remove (0);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (DropShadowCache)
+};
+
+juce_ImplementSingleton (DropShadowCache)
 
 //==============================================================================
 DropShadow::DropShadow() noexcept
@@ -80,10 +229,18 @@ void DropShadow::drawForImage (Graphics& g, const Image& srcImage) const
 
     if (srcImage.isValid())
     {
-        Image shadowImage (srcImage.convertedToFormat (Image::SingleChannel));
-        shadowImage.duplicateIfShared();
+        DropShadowCache& cache = *DropShadowCache::getInstance();
+        const int64 key = DropShadowCache::getSampledKey (srcImage);
+        Image shadowImage (cache.findShadow (srcImage, key, radius));
 
-        blurSingleChannelImage (shadowImage, radius);
+        if (! shadowImage.isValid())
+        {
+            const Image alpha (srcImage.convertedToFormat (Image::SingleChannel).createCopy());
+
+            shadowImage = alpha.createCopy();
+            blurSingleChannelImage (shadowImage, radius);
+            cache.addShadow (alpha, key, radius, shadowImage);
+        }
 
         g.setColour (colour);
         g.drawImageAt (shadowImage, offset.x, offset.y, true);
@@ -100,16 +257,26 @@ void DropShadow::drawForPath (Graphics& g, const Path& path) const
 
     if (area.getWidth() > 2 && area.getHeight() > 2)
     {
-        Image renderedPath (Image::SingleChannel, area.getWidth(), area.getHeight(), true);
+        Path shape (path);
+        shape.applyTransform (AffineTransform::translation ((float) (offset.x - area.getX()),
+                                                            (float) (offset.y - area.getY())));
 
+        DropShadowCache& cache = *DropShadowCache::getInstance();
+        Image renderedPath (cache.findShadow (shape, area.getWidth(), area.getHeight(), radius));
+
+        if (! renderedPath.isValid())
         {
-            Graphics g2 (renderedPath);
-            g2.setColour (Colours::white);
-            g2.fillPath (path, AffineTransform::translation ((float) (offset.x - area.getX()),
-                                                             (float) (offset.y - area.getY())));
-        }
+            renderedPath = Image (Image::SingleChannel, area.getWidth(), area.getHeight(), true);
 
-        blurSingleChannelImage (renderedPath, radius);
+            {
+                Graphics g2 (renderedPath);
+                g2.setColour (Colours::white);
+                g2.fillPath (shape);
+            }
+
+            blurSingleChannelImage (renderedPath, radius);
+            cache.addShadow (shape, radius, renderedPath);
+        }
 
         g.setColour (colour);
         g.drawImageAt (renderedPath, area.getX(), area.getY(), true);
@@ -158,6 +325,11 @@ void DropShadow::drawForRectangle (Graphics& g, const Rectangle<int>& targetArea
     g.fillRect (area);
 }
 
+void DropShadow::setCacheSize (const int maxNumBytes)
+{
+    DropShadowCache::getInstance()->setMaxNumBytes (maxNumBytes);
+}
+
 //==============================================================================
 DropShadowEffect::DropShadowEffect() {}
 DropShadowEffect::~DropShadowEffect() {}
@@ -49,6 +49,14 @@ struct JUCE_API  DropShadow
     */
     void drawForRectangle (Graphics& g, const Rectangle<int>& area) const;
 
+    /** Sets the amount of memory that may be used to keep recently-rendered shadows.
+
+        The blurred shadows drawn by drawForImage() and drawForPath() are cached, so that
+        components with identical shapes only need to have their shadows rendered once.
+        The default size is 2MB, and setting it to 0 turns the cache off.
+    */
+    static void setCacheSize (int maxNumBytes);
+
     /** The colour with which to render the shadow.
         In most cases you'll probably want to leave this as black with an alpha
         value of around 0.5
@@ -72,9 +80,9 @@ struct JUCE_API  DropShadow
     shadow based on what gets drawn inside it. The shadow will also
     be applied to the component's children.
 
-    For speed, this doesn't use a proper gaussian blur, but cheats by
-    using a simple bilinear filter. If you need a really high-quality
-    shadow, check out ImageConvolutionKernel::createGaussianBlur()
+    The shadow is blurred with ImageBlur, whose speed doesn't depend on the
+    radius, and identically-shaped shadows are cached, so that they only
+    need to be rendered once.
 
     @see Component::setComponentEffect
 */
@@ -41,14 +41,25 @@ void GlowEffect::setGlowProperties (const float newRadius,
 
 void GlowEffect::applyEffect (Image& image, Graphics& g, float scaleFactor, float alpha)
 {
-    Image temp (image.getFormat(), image.getWidth(), image.getHeight(), true);
+    // Only the alpha channel is needed, as the glow is drawn as a solid colour
+    Image temp (image.convertedToFormat (Image::SingleChannel));
+    temp.duplicateIfShared();
 
-    ImageConvolutionKernel blurKernel (roundToInt (radius * scaleFactor * 2.0f));
+    ImageBlur::applyGaussianBlur (temp, radius * scaleFactor);
 
-    blurKernel.createGaussianBlur (radius);
-    blurKernel.rescaleAllValues (radius);
+    // ..and then brightened by the radius, so that the glow spreads further than the blur alone would
+    if (radius != 1.0f)
+    {
+        const Image::BitmapData data (temp, Image::BitmapData::readWrite);
 
-    blurKernel.applyToImage (temp, image, image.getBounds());
+        for (int y = 0; y < data.height; ++y)
+        {
+            uint8* const line = data.getLinePointer (y);
+
+            for (int x = 0; x < data.width; ++x)
+                line[x] = (uint8) jmin (0xff, roundToInt (line[x] * radius));
+        }
+    }
 
     g.setColour (colour.withMultipliedAlpha (alpha));
     g.drawImageAt (temp, 0, 0, true);
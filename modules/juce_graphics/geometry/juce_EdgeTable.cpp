@@ -24,6 +24,22 @@
 
 const int juce_edgeTableDefaultEdgesPerLine = 32;
 
+namespace EdgeTableHelpers
+{
+    struct EdgePoint
+    {
+        int x, level;
+    };
+
+    struct EdgePointComparator
+    {
+        static int compareElements (const EdgePoint& first, const EdgePoint& second) noexcept
+        {
+            return first.x - second.x;
+        }
+    };
+}
+
 //==============================================================================
 EdgeTable::EdgeTable (const Rectangle<int>& area,
                       const Path& path, const AffineTransform& transform)
@@ -32,14 +48,15 @@ EdgeTable::EdgeTable (const Rectangle<int>& area,
      lineStrideElements ((juce_edgeTableDefaultEdgesPerLine << 1) + 1),
      needToCheckEmptinesss (true)
 {
-    table.malloc ((size_t) ((bounds.getHeight() + 1) * lineStrideElements));
-    int* t = table;
-
-    for (int i = bounds.getHeight(); --i >= 0;)
-    {
-        *t = 0;
-        t += lineStrideElements;
-    }
+    // The edge points are collected and counted per line first, so that the table can be
+    // allocated at its final size and each line filled and sorted in one go, rather than
+    // inserting the points one at a time and re-allocating whenever a line overflows.
+    // Any points that lie outside the clip area on the left or right would all be merged
+    // into a single point at its edge, so clippedEdges just keeps a flag and a total level
+    // for each side of each line.
+    HeapBlock<int> points, pointsPerLine ((size_t) jmax (1, bounds.getHeight()), true),
+                   clippedEdges ((size_t) jmax (1, bounds.getHeight()) * 4, true);
+    int numPoints = 0, numPointsAllocated = 0;
 
     const int leftLimit   = bounds.getX() << 8;
     const int topLimit    = bounds.getY() << 8;
@@ -82,14 +99,36 @@ EdgeTable::EdgeTable (const Rectangle<int>& area,
                 do
                 {
                     const int step = jmin (stepSize, y2 - y1, 256 - (y1 & 255));
-                    int x = roundToInt (startX + multiplier * ((y1 + (step >> 1)) - startY));
-
-                    if (x < leftLimit)
-                        x = leftLimit;
-                    else if (x >= rightLimit)
-                        x = rightLimit - 1;
+                    const int x = roundToInt (startX + multiplier * ((y1 + (step >> 1)) - startY));
+                    const int line = y1 >> 8;
+
+                    if (x < leftLimit || x >= rightLimit)
+                    {
+                        int* const clipped = clippedEdges + line * 4 + (x < leftLimit ? 0 : 2);
+
+                        if (clipped[0] == 0)
+                        {
+                            clipped[0] = 1;
+                            ++pointsPerLine [line];
+                        }
+
+                        clipped[1] += direction * step;
+                    }
+                    else
+                    {
+                        if (numPoints >= numPointsAllocated)
+                        {
+                            numPointsAllocated = jmax (256, numPointsAllocated * 2);
+                            points.realloc ((size_t) numPointsAllocated * 3);
+                        }
+
+                        int* const p = points + numPoints++ * 3;
+                        p[0] = x;
+                        p[1] = line;
+                        p[2] = direction * step;
+                        ++pointsPerLine [line];
+                    }
 
-                    addEdgePoint (x, y1 >> 8, direction * step);
                     y1 += step;
                 }
                 while (y1 < y2);
@@ -97,6 +136,54 @@ EdgeTable::EdgeTable (const Rectangle<int>& area,
         }
     }
 
+    int maxPointsPerLine = 0;
+
+    for (int i = bounds.getHeight(); --i >= 0;)
+        maxPointsPerLine = jmax (maxPointsPerLine, pointsPerLine[i]);
+
+    if (maxPointsPerLine > maxEdgesPerLine)
+    {
+        maxEdgesPerLine = maxPointsPerLine;
+        lineStrideElements = (maxEdgesPerLine << 1) + 1;
+    }
+
+    table.malloc ((size_t) ((bounds.getHeight() + 1) * lineStrideElements));
+    int* t = table;
+
+    for (int i = bounds.getHeight(); --i >= 0;)
+    {
+        *t = 0;
+        t += lineStrideElements;
+    }
+
+    for (const int* p = points, * const end = points + numPoints * 3; p != end; p += 3)
+    {
+        int* const line = table + lineStrideElements * p[1];
+        const int n = (line[0]++) << 1;
+        line [n + 1] = p[0];
+        line [n + 2] = p[2];
+    }
+
+    t = table;
+
+    for (int i = 0; i < bounds.getHeight(); ++i)
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            if (clippedEdges [i * 4 + side * 2] != 0)
+            {
+                const int n = (t[0]++) << 1;
+                t [n + 1] = side == 0 ? leftLimit : rightLimit - 1;
+                t [n + 2] = clippedEdges [i * 4 + side * 2 + 1];
+            }
+        }
+
+        if (*t > 1)
+            sortEdgePoints (t);
+
+        t += lineStrideElements;
+    }
+
     sanitiseLevels (path.isUsingNonZeroWinding());
 }
 
@@ -266,6 +353,45 @@ void EdgeTable::copyEdgeTableData (int* dest, const int destLineStride, const in
     }
 }
 
+void EdgeTable::sortEdgePoints (int* const line) noexcept
+{
+    // Sorts the line's points by x position, merging any points that share the same x.
+    using namespace EdgeTableHelpers;
+    EdgePoint* const points = reinterpret_cast <EdgePoint*> (line + 1);
+    const int numPoints = line[0];
+
+    if (numPoints > 16)
+    {
+        EdgePointComparator comparator;
+        sortArray (comparator, points, 0, numPoints - 1, false);
+    }
+    else
+    {
+        for (int i = 1; i < numPoints; ++i)
+        {
+            const EdgePoint p (points[i]);
+            int j = i;
+
+            for (; j > 0 && p.x < points [j - 1].x; --j)
+                points[j] = points [j - 1];
+
+            points[j] = p;
+        }
+    }
+
+    int n = 0;
+
+    for (int i = 1; i < numPoints; ++i)
+    {
+        if (points[i].x == points[n].x)
+            points[n].level += points[i].level;
+        else
+            points[++n] = points[i];
+    }
+
+    line[0] = n + 1;
+}
+
 void EdgeTable::sanitiseLevels (const bool useNonZeroWinding) noexcept
 {
     // Convert the table from relative windings to absolute levels..
@@ -345,6 +471,11 @@ void EdgeTable::optimiseTable()
     remapTableForNumEdges (maxLineElements);
 }
 
+size_t EdgeTable::getMemoryUsage() const noexcept
+{
+    return sizeof (*this) + sizeof (int) * (size_t) ((bounds.getHeight() + 1) * lineStrideElements);
+}
+
 void EdgeTable::addEdgePoint (const int x, const int y, const int winding)
 {
     jassert (y >= 0 && y < bounds.getHeight());
@@ -436,7 +567,7 @@ void EdgeTable::intersectWithEdgeTableLine (const int y, const int* otherLine)
 
     ++otherLine;
     const size_t lineSizeBytes = (size_t) (dest[0] * 2 + 1) * sizeof (int);
-    int* temp = static_cast<int*> (alloca (lineSizeBytes));
+    int* temp = static_cast<int*> (alloca (lineSizeBytes + sizeof (int))); // (the loop below reads one value past the last point)
     memcpy (temp, dest, lineSizeBytes);
 
     const int* src1 = temp;
@@ -724,3 +855,327 @@ bool EdgeTable::isEmpty() noexcept
 
     return bounds.getHeight() == 0;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class EdgeTableTests  : public UnitTest
+{
+public:
+    EdgeTableTests()  : UnitTest ("EdgeTable") {}
+
+    // Records everything that an iteration produces, so that two tables can be compared
+    struct IterationRecorder
+    {
+        Array<int> calls;
+
+        void setEdgeTableYPos (int y)                           { calls.add (-1 - y); }
+        void handleEdgeTablePixel (int x, int alpha)            { calls.add (x); calls.add (alpha); }
+        void handleEdgeTablePixelFull (int x)                   { calls.add (x); calls.add (255); }
+        void handleEdgeTableLine (int x, int width, int alpha)  { calls.add (x); calls.add (width); calls.add (alpha); }
+        void handleEdgeTableLineFull (int x, int width)         { calls.add (x); calls.add (width); calls.add (255); }
+    };
+
+    static Array<int> iterateTable (const EdgeTable& table)
+    {
+        IterationRecorder recorder;
+        table.iterate (recorder);
+        return recorder.calls;
+    }
+
+    // Records the alpha level that an iteration gives each pixel
+    struct CoverageRecorder
+    {
+        CoverageRecorder (const Rectangle<int>& area_)  : area (area_), y (0)
+        {
+            alphas.insertMultiple (0, 0, area.getWidth() * area.getHeight());
+        }
+
+        void setEdgeTableYPos (int newY)                        { y = newY - area.getY(); }
+        void handleEdgeTablePixel (int x, int alpha)            { alphas.set (y * area.getWidth() + x - area.getX(), alpha); }
+        void handleEdgeTablePixelFull (int x)                   { handleEdgeTablePixel (x, 255); }
+        void handleEdgeTableLine (int x, int width, int alpha)  { while (--width >= 0) handleEdgeTablePixel (x++, alpha); }
+        void handleEdgeTableLineFull (int x, int width)         { handleEdgeTableLine (x, width, 255); }
+
+        const Rectangle<int> area;
+        Array<int> alphas;
+        int y;
+    };
+
+    static Array<int> getCoverage (const Rectangle<int>& area, const Path& path, const AffineTransform& transform)
+    {
+        const EdgeTable table (area, path, transform);
+        CoverageRecorder recorder (area);
+        table.iterate (recorder);
+        return recorder.alphas;
+    }
+
+    //==============================================================================
+    // A straightforward rasteriser to compare the tables against. It steps along the
+    // flattened path in the same way as the EdgeTable, but inserts each edge point into
+    // its line in order as it's found (clamping any that are outside the area on the left
+    // or right to its edges), and then measures how much of each pixel is covered.
+    static Array<int> getReferenceCoverage (const Rectangle<int>& area, const Path& path, const AffineTransform& transform)
+    {
+        OwnedArray<Array<int> > lines; // each line holds pairs of (x, winding), sorted by x
+
+        for (int i = area.getHeight(); --i >= 0;)
+            lines.add (new Array<int>());
+
+        const int leftLimit = area.getX() << 8, rightLimit = area.getRight() << 8;
+        PathFlatteningIterator iter (path, transform);
+
+        while (iter.next())
+        {
+            int y1 = roundToInt (iter.y1 * 256.0f) - (area.getY() << 8);
+            int y2 = roundToInt (iter.y2 * 256.0f) - (area.getY() << 8);
+
+            if (y1 == y2)
+                continue;
+
+            const int startY = y1;
+            int direction = -1;
+
+            if (y1 > y2)
+            {
+                std::swap (y1, y2);
+                direction = 1;
+            }
+
+            y1 = jmax (0, y1);
+            y2 = jmin (area.getHeight() << 8, y2);
+
+            const double startX = 256.0f * iter.x1;
+            const double multiplier = (iter.x2 - iter.x1) / (iter.y2 - iter.y1);
+            const int stepSize = jlimit (1, 256, 256 / (1 + (int) std::abs (multiplier)));
+
+            while (y1 < y2)
+            {
+                const int step = jmin (stepSize, y2 - y1, 256 - (y1 & 255));
+                const int x = roundToInt (startX + multiplier * ((y1 + (step >> 1)) - startY));
+
+                addPoint (*lines.getUnchecked (y1 >> 8), jlimit (leftLimit, rightLimit - 1, x), direction * step);
+                y1 += step;
+            }
+        }
+
+        Array<int> alphas;
+
+        for (int y = 0; y < area.getHeight(); ++y)
+        {
+            const Array<int>& line = *lines.getUnchecked (y);
+            Array<int> sums;
+            sums.insertMultiple (0, 0, area.getWidth());
+            int winding = 0;
+
+            for (int i = 0; i + 2 < line.size(); i += 2)
+            {
+                winding += line.getUnchecked (i + 1);
+                const int level = getLevel (winding, path.isUsingNonZeroWinding());
+
+                for (int x = line.getUnchecked (i), end = line.getUnchecked (i + 2); x < end;)
+                {
+                    const int pixelEnd = jmin (end, ((x >> 8) + 1) << 8);
+                    sums.getReference ((x >> 8) - area.getX()) += (pixelEnd - x) * level;
+                    x = pixelEnd;
+                }
+            }
+
+            for (int x = 0; x < area.getWidth(); ++x)
+                alphas.add (jmin (255, sums.getUnchecked (x) >> 8));
+        }
+
+        return alphas;
+    }
+
+    static void addPoint (Array<int>& line, const int x, const int winding)
+    {
+        int i = 0;
+
+        while (i < line.size() && line.getUnchecked (i) < x)
+            i += 2;
+
+        if (i < line.size() && line.getUnchecked (i) == x)
+        {
+            line.getReference (i + 1) += winding;
+        }
+        else
+        {
+            line.insert (i, winding);
+            line.insert (i, x);
+        }
+    }
+
+    static int getLevel (const int winding, const bool useNonZeroWinding) noexcept
+    {
+        const int level = std::abs (winding);
+
+        if (useNonZeroWinding)
+            return jmin (255, level);
+
+        const int folded = level & 511;
+        return folded > 255 ? 511 - folded : folded;
+    }
+
+    void expectMatchesReference (const Rectangle<int>& area, const Path& path, const AffineTransform& transform)
+    {
+        expect (getCoverage (area, path, transform) == getReferenceCoverage (area, path, transform));
+    }
+
+    static Path createCurvedPath (Random& r)
+    {
+        Path path;
+        path.addEllipse (20.0f, 15.0f, 150.0f, 90.0f);
+        path.addRoundedRectangle (120.0f, 60.0f, 140.0f, 110.0f, 25.0f);
+        path.addStar (Point<float> (220.0f, 50.0f), 7, 20.0f, 45.0f, 0.3f);
+
+        path.startNewSubPath (10.0f, 190.0f);
+
+        for (int i = 0; i < 8; ++i)
+            path.cubicTo (r.nextFloat() * 280.0f, r.nextFloat() * 200.0f,
+                          r.nextFloat() * 280.0f, r.nextFloat() * 200.0f,
+                          r.nextFloat() * 280.0f, r.nextFloat() * 200.0f);
+
+        path.quadraticTo (150.0f, 250.0f, 10.0f, 190.0f);
+        path.closeSubPath();
+        return path;
+    }
+
+    static Path createTextPath()
+    {
+        String text;
+
+        for (int i = 0; i < 30; ++i)
+            text << "The quick brown fox jumps over the lazy dog. ";
+
+        GlyphArrangement glyphs;
+        glyphs.addFittedText (Font (11.0f), text, 0, 0, 800.0f, 400.0f, Justification::topLeft, 40);
+
+        Path path;
+        glyphs.createPath (path);
+        return path;
+    }
+
+    static Path createWaveformPath (Random& r)
+    {
+        const int numPoints = 10000;
+
+        Path path;
+        path.startNewSubPath (0, 200.0f);
+
+        for (int i = 0; i < numPoints; ++i)
+            path.lineTo (i * 800.0f / numPoints, 200.0f + 180.0f * std::sin (i * 0.05f) * r.nextFloat());
+
+        path.lineTo (800.0f, 200.0f);
+        path.closeSubPath();
+        return path;
+    }
+
+    void runTest()
+    {
+        beginTest ("Construction");
+
+        {
+            // A grid of narrow columns gives lines with more edges than the default table width
+            Random r (0x1234);
+            RectangleList<int> rects;
+            Path path;
+
+            for (int y = 0; y < 10; ++y)
+            {
+                for (int x = 0; x < 60; ++x)
+                {
+                    const Rectangle<int> rect (x * 10 + r.nextInt (3), y * 20 + r.nextInt (3), 3 + r.nextInt (5), 5 + r.nextInt (12));
+                    rects.addWithoutMerging (rect);
+                    path.addRectangle (rect);
+                }
+            }
+
+            // (the path's clip area is expanded, as edges on its right-hand side would be nudged inside it)
+            const EdgeTable fromPath (rects.getBounds().expanded (1), path, AffineTransform::identity);
+            const EdgeTable fromRects (rects);
+
+            expect (iterateTable (fromPath) == iterateTable (fromRects));
+        }
+
+        Random r (0x9abc);
+        const Path curves (createCurvedPath (r));
+
+        beginTest ("Curved paths");
+
+        for (int i = 0; i < 4; ++i)
+            expectMatchesReference (Rectangle<int> (-20, -20, 420, 320), curves,
+                                    AffineTransform::rotation (i * 0.3f, 140.0f, 100.0f)
+                                        .scaled (1.0f + i * 0.15f)
+                                        .translated (r.nextFloat() * 20.0f, r.nextFloat() * 20.0f));
+
+        beginTest ("Clipped paths");
+
+        {
+            // These areas cut through the paths on all sides, so that there are plenty of edge
+            // points to the left and right of them, which get clamped to the area's edges
+            const Path paths[] = { curves, createTextPath(), createWaveformPath (r) };
+            const Rectangle<int> areas[] = { Rectangle<int> (60, 40, 100, 80),
+                                             Rectangle<int> (137, 13, 301, 97),
+                                             Rectangle<int> (-30, 150, 120, 70),
+                                             Rectangle<int> (250, -10, 9, 300) };
+
+            for (int i = 0; i < numElementsInArray (paths); ++i)
+                for (int j = 0; j < numElementsInArray (areas); ++j)
+                    expectMatchesReference (areas[j], paths[i], AffineTransform::translation (r.nextFloat(), r.nextFloat()));
+        }
+
+        beginTest ("Even-odd paths");
+
+        {
+            Path evenOdd (curves);
+            evenOdd.addEllipse (50.0f, 40.0f, 200.0f, 120.0f);
+            evenOdd.addEllipse (70.0f, 50.0f, 160.0f, 100.0f);
+            evenOdd.setUsingNonZeroWinding (false);
+
+            Path waveform (createWaveformPath (r));
+            waveform.setUsingNonZeroWinding (false);
+
+            const Rectangle<int> area (0, 0, 300, 220), clip (90, 30, 120, 100);
+
+            expectMatchesReference (area, evenOdd, AffineTransform::identity);
+            expectMatchesReference (clip, evenOdd, AffineTransform::translation (0.3f, 0.7f));
+            expectMatchesReference (Rectangle<int> (0, 0, 800, 400), waveform, AffineTransform::identity);
+
+            // ..and check that the winding rule really made a difference
+            Path nonZero (evenOdd);
+            nonZero.setUsingNonZeroWinding (true);
+            expect (getCoverage (area, evenOdd, AffineTransform::identity) != getCoverage (area, nonZero, AffineTransform::identity));
+        }
+
+        beginTest ("Speed");
+
+        {
+            Random r (0x5678);
+            const Path paths[] = { createTextPath(), createWaveformPath (r) };
+            const char* const names[] = { "glyphs", "waveform" };
+            const Rectangle<int> clip (0, 0, 800, 400);
+            const int numTables = 10;
+
+            for (int i = 0; i < numElementsInArray (paths); ++i)
+            {
+                const double startTime = Time::getMillisecondCounterHiRes();
+                size_t numBytes = 0;
+
+                for (int j = 0; j < numTables; ++j)
+                {
+                    EdgeTable table (clip, paths[i], AffineTransform::translation (j * 0.1f, 0));
+                    numBytes = table.getMemoryUsage();
+                    expect (! table.isEmpty());
+                }
+
+                logMessage (String (names[i]) + ": " + String ((Time::getMillisecondCounterHiRes() - startTime) / numTables, 2)
+                              + " ms per table, " + String ((int) (numBytes / 1024)) + " KB");
+            }
+        }
+    }
+};
+
+static EdgeTableTests edgeTableTests;
+
+#endif
@@ -83,6 +83,9 @@ public:
     */
     void optimiseTable();
 
+    /** Returns the number of bytes of memory that the table is using. */
+    size_t getMemoryUsage() const noexcept;
+
 
     //==============================================================================
     /** Iterates the lines in the table, for rendering.
@@ -194,6 +197,7 @@ private:
     void remapTableForNumEdges (int newNumEdgesPerLine);
     void intersectWithEdgeTableLine (int y, const int* otherLine);
     void clipEdgeTableLineToRange (int* line, int x1, int x2) noexcept;
+    static void sortEdgePoints (int* line) noexcept;
     void sanitiseLevels (bool useNonZeroWinding) noexcept;
     static void copyEdgeTableData (int* dest, int destLineStride, const int* src, int srcLineStride, int numLines) noexcept;
 
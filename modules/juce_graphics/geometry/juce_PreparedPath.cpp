@@ -0,0 +1,376 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace PreparedPathHelpers
+{
+    struct Counters
+    {
+        Atomic<int64> numOutlineHits, numOutlineMisses,
+                      numEdgeTableHits, numEdgeTableMisses, numBytes;
+    };
+
+    static Counters counters;
+
+    // Each path only holds on to the results for a handful of transforms, which
+    // is enough for things that get drawn in a few different places or sizes.
+    enum { maxCachedTransforms = 4 };
+}
+
+//==============================================================================
+class PreparedPath::SharedData  : public ReferenceCountedObject
+{
+public:
+    SharedData (const Path& p)
+        : path (p), strokeType (1.0f), isStroked (false)
+    {
+    }
+
+    SharedData (const Path& p, const PathStrokeType& s)
+        : path (p), strokeType (s), isStroked (true)
+    {
+    }
+
+    Path getOutline (const AffineTransform& transform, const float extraAccuracy)
+    {
+        using namespace PreparedPathHelpers;
+        const ScopedLock sl (lock);
+
+        for (int i = 0; i < outlines.size(); ++i)
+        {
+            if (outlines.getUnchecked(i)->matches (transform, extraAccuracy))
+            {
+                ++counters.numOutlineHits;
+                outlines.move (i, 0);
+                return outlines.getUnchecked(0)->outline;
+            }
+        }
+
+        ++counters.numOutlineMisses;
+        return createOutline (transform, extraAccuracy).outline;
+    }
+
+    EdgeTable getEdgeTable (const AffineTransform& transform, const float extraAccuracy,
+                            const AffineTransform& deviceTransform)
+    {
+        using namespace PreparedPathHelpers;
+
+        // Any whole-pixel part of the device translation gets applied to the table afterwards.
+        const float dx = std::floor (deviceTransform.mat02);
+        const float dy = std::floor (deviceTransform.mat12);
+
+        const AffineTransform tableTransform (deviceTransform.mat00, deviceTransform.mat01, deviceTransform.mat02 - dx,
+                                              deviceTransform.mat10, deviceTransform.mat11, deviceTransform.mat12 - dy);
+
+        const ScopedLock sl (lock);
+        CachedTable* table = nullptr;
+
+        for (int i = 0; i < tables.size(); ++i)
+        {
+            if (tables.getUnchecked(i)->matches (transform, extraAccuracy, tableTransform))
+            {
+                ++counters.numEdgeTableHits;
+                tables.move (i, 0);
+                table = tables.getUnchecked(0);
+                break;
+            }
+        }
+
+        if (table == nullptr)
+        {
+            ++counters.numEdgeTableMisses;
+
+            const CachedOutline* outline = nullptr;
+
+            for (int i = 0; i < outlines.size(); ++i)
+                if (outlines.getUnchecked(i)->matches (transform, extraAccuracy))
+                    outline = outlines.getUnchecked(i);
+
+            if (outline == nullptr)
+                outline = &createOutline (transform, extraAccuracy);
+
+            table = new CachedTable (transform, extraAccuracy, tableTransform, outline->outline);
+            tables.insert (0, table);
+            tables.removeRange (maxCachedTransforms, tables.size());
+        }
+
+        EdgeTable result (table->edgeTable);
+        result.translate (dx, (int) dy);
+        return result;
+    }
+
+    const Path path;
+    const PathStrokeType strokeType;
+    const bool isStroked;
+
+private:
+    struct CachedOutline
+    {
+        CachedOutline (const AffineTransform& t, const float accuracy)
+            : transform (t), extraAccuracy (accuracy)
+        {
+        }
+
+        bool matches (const AffineTransform& t, const float accuracy) const noexcept
+        {
+            return transform == t && extraAccuracy == accuracy;
+        }
+
+        const AffineTransform transform;
+        const float extraAccuracy;
+        Path outline;
+    };
+
+    struct CachedTable
+    {
+        CachedTable (const AffineTransform& t, const float accuracy,
+                     const AffineTransform& tableTransform_, const Path& outline)
+            : transform (t), extraAccuracy (accuracy), tableTransform (tableTransform_),
+              edgeTable (outline.getBoundsTransformed (tableTransform_).getSmallestIntegerContainer().expanded (1),
+                         outline, tableTransform_)
+        {
+            edgeTable.optimiseTable();
+            PreparedPathHelpers::counters.numBytes += (int64) edgeTable.getMemoryUsage();
+        }
+
+        ~CachedTable()
+        {
+            PreparedPathHelpers::counters.numBytes -= (int64) edgeTable.getMemoryUsage();
+        }
+
+        bool matches (const AffineTransform& t, const float accuracy, const AffineTransform& tt) const noexcept
+        {
+            return transform == t && extraAccuracy == accuracy && tableTransform == tt;
+        }
+
+        const AffineTransform transform;
+        const float extraAccuracy;
+        const AffineTransform tableTransform;
+        EdgeTable edgeTable;
+
+        JUCE_DECLARE_NON_COPYABLE (CachedTable)
+    };
+
+    CriticalSection lock;
+    OwnedArray<CachedOutline> outlines;
+    OwnedArray<CachedTable> tables;
+
+    const CachedOutline& createOutline (const AffineTransform& transform, const float extraAccuracy)
+    {
+        CachedOutline* const o = new CachedOutline (transform, extraAccuracy);
+
+        if (isStroked)
+        {
+            strokeType.createStrokedPath (o->outline, path, transform, extraAccuracy);
+        }
+        else
+        {
+            o->outline = path;
+            o->outline.applyTransform (transform);
+        }
+
+        outlines.insert (0, o);
+        outlines.removeRange (PreparedPathHelpers::maxCachedTransforms, outlines.size());
+        return *o;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (SharedData)
+};
+
+//==============================================================================
+PreparedPath::PreparedPath()                                            : data (new SharedData (Path())) {}
+PreparedPath::PreparedPath (const Path& p)                              : data (new SharedData (p)) {}
+PreparedPath::PreparedPath (const Path& p, const PathStrokeType& s)     : data (new SharedData (p, s)) {}
+PreparedPath::PreparedPath (const PreparedPath& other) noexcept         : data (other.data) {}
+PreparedPath::~PreparedPath() {}
+
+PreparedPath& PreparedPath::operator= (const PreparedPath& other) noexcept
+{
+    data = other.data;
+    return *this;
+}
+
+// The cached data may still be in use by other copies of this object (e.g. in a
+// display list that's being rendered), so a new path always gets a new SharedData.
+void PreparedPath::setPath (const Path& p)                              { data = new SharedData (p); }
+void PreparedPath::setPath (const Path& p, const PathStrokeType& s)     { data = new SharedData (p, s); }
+
+const Path& PreparedPath::getPath() const noexcept                      { return data->path; }
+bool PreparedPath::isStroked() const noexcept                           { return data->isStroked; }
+const PathStrokeType& PreparedPath::getStrokeType() const noexcept      { return data->strokeType; }
+bool PreparedPath::isEmpty() const noexcept                             { return data->path.isEmpty(); }
+
+Path PreparedPath::getOutline (const AffineTransform& transform, const float extraAccuracy) const
+{
+    return data->getOutline (transform, extraAccuracy);
+}
+
+EdgeTable PreparedPath::getEdgeTable (const AffineTransform& transform, const float extraAccuracy,
+                                      const AffineTransform& deviceTransform) const
+{
+    return data->getEdgeTable (transform, extraAccuracy, deviceTransform);
+}
+
+//==============================================================================
+double PreparedPath::Statistics::getEdgeTableHitRate() const noexcept
+{
+    const int64 total = numEdgeTableHits + numEdgeTableMisses;
+    return total > 0 ? numEdgeTableHits / (double) total : 0.0;
+}
+
+PreparedPath::Statistics PreparedPath::getStatistics() noexcept
+{
+    using namespace PreparedPathHelpers;
+
+    Statistics s;
+    s.numOutlineHits     = counters.numOutlineHits.get();
+    s.numOutlineMisses   = counters.numOutlineMisses.get();
+    s.numEdgeTableHits   = counters.numEdgeTableHits.get();
+    s.numEdgeTableMisses = counters.numEdgeTableMisses.get();
+    s.numBytes           = counters.numBytes.get();
+    return s;
+}
+
+void PreparedPath::resetStatistics() noexcept
+{
+    using namespace PreparedPathHelpers;
+
+    counters.numOutlineHits = 0;
+    counters.numOutlineMisses = 0;
+    counters.numEdgeTableHits = 0;
+    counters.numEdgeTableMisses = 0;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PreparedPathTests  : public UnitTest
+{
+public:
+    PreparedPathTests()  : UnitTest ("PreparedPath") {}
+
+    void runTest()
+    {
+        Path meter;
+        meter.addPieSegment (10.0f, 10.0f, 180.0f, 180.0f, -2.4f, 2.4f, 0.6f);
+        meter.addStar (Point<float> (100.0f, 100.0f), 7, 20.0f, 45.0f, 0.3f);
+
+        const PathStrokeType stroke (3.5f, PathStrokeType::curved, PathStrokeType::rounded);
+        const AffineTransform transform (AffineTransform::rotation (0.3f, 100.0f, 100.0f).scaled (1.3f));
+
+        beginTest ("Rendering");
+
+        {
+            PreparedPath prepared (meter, stroke);
+            PreparedPath::resetStatistics();
+
+            for (int i = 0; i < 4; ++i)
+            {
+                const Point<int> origin (i * 3, i * 2);
+
+                Image expected (Image::ARGB, 300, 300, true);
+                Image actual   (Image::ARGB, 300, 300, true);
+
+                {
+                    Graphics g (expected);
+                    g.setOrigin (origin.x, origin.y);
+                    g.setColour (Colours::darkblue);
+                    g.strokePath (meter, stroke, transform);
+                }
+
+                {
+                    Graphics g (actual);
+                    g.setOrigin (origin.x, origin.y);
+                    g.setColour (Colours::darkblue);
+                    g.drawPath (prepared, transform);
+                }
+
+                expect (imagesAreAlmostIdentical (expected, actual));
+            }
+
+            const PreparedPath::Statistics stats (PreparedPath::getStatistics());
+            expectEquals ((int) stats.numEdgeTableMisses, 1);
+            expectEquals ((int) stats.numEdgeTableHits, 3);
+            expect (stats.numBytes > 0);
+
+            prepared.setPath (meter);
+            expect (! prepared.isStroked());
+            expect (PreparedPath::getStatistics().numBytes == 0);
+
+            Image expected (Image::ARGB, 300, 300, true);
+            Image actual   (Image::ARGB, 300, 300, true);
+            Graphics (expected).fillPath (meter, transform);
+            Graphics (actual).drawPath (prepared, transform);
+            expect (imagesAreAlmostIdentical (expected, actual));
+        }
+
+        beginTest ("Speed");
+
+        {
+            const int numRepaints = 200;
+            Image image (Image::ARGB, 300, 300, true);
+            Graphics g (image);
+
+            double startTime = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numRepaints; ++i)
+                g.strokePath (meter, stroke, transform);
+
+            const double strokeTime = Time::getMillisecondCounterHiRes() - startTime;
+
+            PreparedPath prepared (meter, stroke);
+            PreparedPath::resetStatistics();
+            startTime = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numRepaints; ++i)
+                g.drawPath (prepared, transform);
+
+            const double preparedTime = Time::getMillisecondCounterHiRes() - startTime;
+
+            logMessage ("strokePath: " + String (1000.0 * strokeTime / numRepaints, 1) + " us, drawPath: "
+                          + String (1000.0 * preparedTime / numRepaints, 1) + " us, EdgeTable hit rate: "
+                          + String (PreparedPath::getStatistics().getEdgeTableHitRate() * 100.0, 1) + "%");
+        }
+    }
+
+    static bool imagesAreAlmostIdentical (const Image& a, const Image& b)
+    {
+        for (int y = 0; y < a.getHeight(); ++y)
+        {
+            for (int x = 0; x < a.getWidth(); ++x)
+            {
+                const Colour c1 (a.getPixelAt (x, y)), c2 (b.getPixelAt (x, y));
+
+                if (std::abs (c1.getAlpha() - c2.getAlpha()) > 2
+                     || std::abs (c1.getBlue() - c2.getBlue()) > 2)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+static PreparedPathTests preparedPathTests;
+
+#endif
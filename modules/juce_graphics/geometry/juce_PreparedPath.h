@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_PREPAREDPATH_H_INCLUDED
+#define JUCE_PREPAREDPATH_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A path which caches the work needed to render it, so that it can be drawn
+    repeatedly without being re-stroked and re-rasterised each time.
+
+    Calling Graphics::strokePath() creates a new stroke outline every time, and then
+    the renderer has to convert that into an EdgeTable. If you're drawing the same
+    shape on every repaint (e.g. a meter outline or a knob), you can instead keep a
+    PreparedPath and draw it with Graphics::drawPath(). It keeps the stroke outlines
+    and edge tables that it has created for the last few transforms that were used,
+    and re-uses them until you give it a new path.
+
+    PreparedPath objects are small, reference-counted handles, so they're cheap
+    to copy, and are safe to use from multiple threads.
+
+    @see Graphics::drawPath, Path, PathStrokeType
+*/
+class JUCE_API  PreparedPath
+{
+public:
+    //==============================================================================
+    /** Creates an empty PreparedPath. */
+    PreparedPath();
+
+    /** Creates a PreparedPath which will fill the given path. */
+    explicit PreparedPath (const Path& pathToFill);
+
+    /** Creates a PreparedPath which will draw the outline of a path with a given stroke. */
+    PreparedPath (const Path& pathToStroke, const PathStrokeType& strokeType);
+
+    /** Creates a copy of another PreparedPath. Both will share the same cached data. */
+    PreparedPath (const PreparedPath&) noexcept;
+
+    /** Makes this refer to the same path as another PreparedPath. */
+    PreparedPath& operator= (const PreparedPath&) noexcept;
+
+    /** Destructor. */
+    ~PreparedPath();
+
+    //==============================================================================
+    /** Changes this to fill a new path, discarding any cached data. */
+    void setPath (const Path& pathToFill);
+
+    /** Changes this to stroke a new path, discarding any cached data. */
+    void setPath (const Path& pathToStroke, const PathStrokeType& strokeType);
+
+    /** Returns the path that this object draws. */
+    const Path& getPath() const noexcept;
+
+    /** Returns true if this path is stroked rather than filled. */
+    bool isStroked() const noexcept;
+
+    /** Returns the stroke that will be used, if isStroked() is true. */
+    const PathStrokeType& getStrokeType() const noexcept;
+
+    /** Returns true if there's nothing to draw. */
+    bool isEmpty() const noexcept;
+
+    //==============================================================================
+    /** Returns the shape that should be filled to render this path with a given transform.
+
+        For a filled path, this is just a transformed copy of the path. For a stroked path,
+        it's the outline created by PathStrokeType::createStrokedPath(). Either way, the
+        result is cached, so asking for the same transform again is very cheap.
+    */
+    Path getOutline (const AffineTransform& transform, float extraAccuracy = 1.0f) const;
+
+    /** Returns an EdgeTable for this path.
+
+        This is used by the software renderer. The table contains the outline that
+        getOutline() returns for the given transform and extraAccuracy, rasterised
+        using deviceTransform. Tables are cached for each transform, ignoring any
+        whole-pixel translation in the device transform, so a path that moves by whole
+        pixels between repaints doesn't need re-rasterising.
+    */
+    EdgeTable getEdgeTable (const AffineTransform& transform, float extraAccuracy,
+                            const AffineTransform& deviceTransform) const;
+
+    //==============================================================================
+    /** Counts the number of times cached data was or wasn't available.
+        @see getStatistics
+    */
+    struct Statistics
+    {
+        int64 numOutlineHits;       /**< Number of times an outline was found in a cache. */
+        int64 numOutlineMisses;     /**< Number of times an outline had to be created. */
+        int64 numEdgeTableHits;     /**< Number of times an EdgeTable was found in a cache. */
+        int64 numEdgeTableMisses;   /**< Number of times an EdgeTable had to be created. */
+        int64 numBytes;             /**< The total memory used by all the cached EdgeTables. */
+
+        /** Returns the proportion of EdgeTable requests that were cache hits, from 0 to 1. */
+        double getEdgeTableHitRate() const noexcept;
+    };
+
+    /** Returns the counters for all the PreparedPath objects in the app. */
+    static Statistics getStatistics() noexcept;
+
+    /** Resets the hit and miss counters to zero. */
+    static void resetStatistics() noexcept;
+
+private:
+    //==============================================================================
+    class SharedData;
+    ReferenceCountedObjectPtr<SharedData> data;
+
+    JUCE_LEAK_DETECTOR (PreparedPath)
+};
+
+
+#endif   // JUCE_PREPAREDPATH_H_INCLUDED
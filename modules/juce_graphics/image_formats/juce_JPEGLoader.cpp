@@ -238,11 +238,12 @@ bool JPEGImageFormat::canUnderstand (InputStream& in)
  Image juce_loadWithCoreImage (InputStream& input);
 #endif
 
-Image JPEGImageFormat::decodeImage (InputStream& in)
+#if ! JUCE_USING_COREIMAGE_LOADER
+// If maxWidth and maxHeight are > 0, this uses the decoder's reduced-size IDCT to
+// produce the smallest image (1/2, 1/4 or 1/8 of the original size) that is still
+// at least as big as the thumbnail that will eventually be made from it.
+static Image decodeJPEGImage (InputStream& in, const int maxWidth, const int maxHeight)
 {
-#if JUCE_USING_COREIMAGE_LOADER
-    return juce_loadWithCoreImage (in);
-#else
     using namespace jpeglibNamespace;
     using namespace JPEGHelpers;
 
@@ -277,6 +278,20 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
         {
             jpeg_read_header (&jpegDecompStruct, TRUE);
 
+            if (maxWidth > 0 && maxHeight > 0)
+            {
+                const double scale = jmin (maxWidth  / (double) jpegDecompStruct.image_width,
+                                           maxHeight / (double) jpegDecompStruct.image_height);
+
+                unsigned int denominator = 1;
+
+                while (denominator < 8 && scale * (denominator * 2) <= 1.0)
+                    denominator *= 2;
+
+                jpegDecompStruct.scale_num = 1;
+                jpegDecompStruct.scale_denom = denominator;
+            }
+
             jpeg_calc_output_dimensions (&jpegDecompStruct);
 
             const int width  = (int) jpegDecompStruct.output_width;
@@ -337,7 +352,25 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
     }
 
     return image;
+}
 #endif
+
+Image JPEGImageFormat::decodeImage (InputStream& in)
+{
+   #if JUCE_USING_COREIMAGE_LOADER
+    return juce_loadWithCoreImage (in);
+   #else
+    return decodeJPEGImage (in, 0, 0);
+   #endif
+}
+
+Image JPEGImageFormat::decodeThumbnail (InputStream& in, const int maxWidth, const int maxHeight)
+{
+   #if JUCE_USING_COREIMAGE_LOADER
+    return ImageFileFormat::decodeThumbnail (in, maxWidth, maxHeight);
+   #else
+    return rescaledToFit (decodeJPEGImage (in, maxWidth, maxHeight), maxWidth, maxHeight);
+   #endif
 }
 
 bool JPEGImageFormat::writeImageToStream (const Image& image, OutputStream& out)
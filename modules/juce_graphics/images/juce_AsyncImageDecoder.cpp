@@ -0,0 +1,381 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+struct AsyncImageDecoder::DecodedImage
+{
+    DecodedImage (const int requestId_, Listener* const listener_, const Image& image_)
+        : requestId (requestId_), listener (listener_), image (image_)
+    {
+    }
+
+    const int requestId;
+    Listener* const listener;
+    const Image image;
+};
+
+//==============================================================================
+class AsyncImageDecoder::DecodeJob  : public ThreadPoolJob
+{
+public:
+    DecodeJob (AsyncImageDecoder& owner_, Listener* const listener_,
+               const File& file_, const MemoryBlock& data_,
+               const int maxWidth_, const int maxHeight_)
+        : ThreadPoolJob ("Image decoder"),
+          owner (owner_), listener (listener_), file (file_), data (data_),
+          maxWidth (maxWidth_), maxHeight (maxHeight_),
+          requestId (0), cancelled (false)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        bool needsDecoding;
+
+        {
+            const ScopedLock sl (owner.lock);
+            needsDecoding = ! cancelled;
+        }
+
+        owner.decodingFinished (*this, needsDecoding ? decode() : Image::null);
+        return jobHasFinished;
+    }
+
+    AsyncImageDecoder& owner;
+    Listener* const listener;
+    const File file;
+    const MemoryBlock data;
+    const int maxWidth, maxHeight;
+    int requestId;
+    bool cancelled; // (protected by the owner's lock)
+
+private:
+    Image decode() const
+    {
+        if (file != File::nonexistent)
+            return ImageFileFormat::loadThumbnailFrom (file, maxWidth, maxHeight);
+
+        MemoryInputStream in (data, false);
+        return ImageFileFormat::loadThumbnailFrom (in, maxWidth, maxHeight);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (DecodeJob)
+};
+
+//==============================================================================
+AsyncImageDecoder::AsyncImageDecoder (const int numThreads)
+    : pool (numThreads > 0 ? numThreads : jmax (1, SystemStats::getNumCpus() - 1)),
+      lastRequestId (0)
+{
+}
+
+AsyncImageDecoder::~AsyncImageDecoder()
+{
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = activeJobs.size(); --i >= 0;)
+            activeJobs.getUnchecked(i)->cancelled = true;
+    }
+
+    pool.removeAllJobs (true, 10000);
+    cancelPendingUpdate();
+}
+
+int AsyncImageDecoder::decodeFile (const File& file, Listener* const listener,
+                                   const int maxWidth, const int maxHeight)
+{
+    jassert (listener != nullptr);
+    return addJob (new DecodeJob (*this, listener, file, MemoryBlock(), maxWidth, maxHeight));
+}
+
+int AsyncImageDecoder::decodeData (const MemoryBlock& encodedData, Listener* const listener,
+                                   const int maxWidth, const int maxHeight)
+{
+    jassert (listener != nullptr);
+    return addJob (new DecodeJob (*this, listener, File::nonexistent, encodedData, maxWidth, maxHeight));
+}
+
+int AsyncImageDecoder::addJob (DecodeJob* const job)
+{
+    {
+        const ScopedLock sl (lock);
+        job->requestId = ++lastRequestId;
+        activeJobs.add (job);
+    }
+
+    const int requestId = job->requestId;
+    pool.addJob (job, true);
+    return requestId;
+}
+
+void AsyncImageDecoder::cancelRequest (const int requestId)
+{
+    const ScopedLock sl (lock);
+
+    for (int i = activeJobs.size(); --i >= 0;)
+        if (activeJobs.getUnchecked(i)->requestId == requestId)
+            activeJobs.getUnchecked(i)->cancelled = true;
+
+    for (int i = decodedImages.size(); --i >= 0;)
+        if (decodedImages.getUnchecked(i)->requestId == requestId)
+            decodedImages.remove (i);
+}
+
+void AsyncImageDecoder::cancelAllRequestsFor (Listener* const listener)
+{
+    const ScopedLock sl (lock);
+
+    for (int i = activeJobs.size(); --i >= 0;)
+        if (activeJobs.getUnchecked(i)->listener == listener)
+            activeJobs.getUnchecked(i)->cancelled = true;
+
+    for (int i = decodedImages.size(); --i >= 0;)
+        if (decodedImages.getUnchecked(i)->listener == listener)
+            decodedImages.remove (i);
+}
+
+int AsyncImageDecoder::getNumPendingRequests() const
+{
+    const ScopedLock sl (lock);
+    int num = decodedImages.size();
+
+    for (int i = activeJobs.size(); --i >= 0;)
+        if (! activeJobs.getUnchecked(i)->cancelled)
+            ++num;
+
+    return num;
+}
+
+void AsyncImageDecoder::decodingFinished (DecodeJob& job, const Image& image)
+{
+    const ScopedLock sl (lock);
+    activeJobs.removeFirstMatchingValue (&job);
+
+    if (! job.cancelled)
+    {
+        decodedImages.add (new DecodedImage (job.requestId, job.listener, image));
+        triggerAsyncUpdate();
+    }
+}
+
+void AsyncImageDecoder::deliverDecodedImages()
+{
+    handleUpdateNowIfNeeded();
+}
+
+void AsyncImageDecoder::handleAsyncUpdate()
+{
+    // The images are handed out one at a time, so that a listener callback can safely
+    // cancel any other requests which are still waiting to be delivered.
+    for (;;)
+    {
+        ScopedPointer<DecodedImage> decoded;
+
+        {
+            const ScopedLock sl (lock);
+
+            if (decodedImages.size() == 0)
+                break;
+
+            decoded = decodedImages.removeAndReturn (0);
+        }
+
+        decoded->listener->imageDecoded (decoded->requestId, decoded->image);
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AsyncImageDecoderTests  : public UnitTest,
+                                private AsyncImageDecoder::Listener
+{
+public:
+    AsyncImageDecoderTests()  : UnitTest ("AsyncImageDecoder") {}
+
+    void runTest()
+    {
+        beginTest ("Thumbnails");
+
+        const int width = 2048, height = 1536;
+        const Image source (createTestImage (width, height));
+
+        MemoryBlock jpegData, pngData;
+
+        {
+            MemoryOutputStream out (jpegData, false);
+            JPEGImageFormat().writeImageToStream (source, out);
+        }
+
+        {
+            MemoryOutputStream out (pngData, false);
+            PNGImageFormat().writeImageToStream (source, out);
+        }
+
+        for (int divisor = 1; divisor <= 16; divisor *= 2)
+        {
+            MemoryInputStream in (jpegData, false);
+            const Image thumbnail (ImageFileFormat::loadThumbnailFrom (in, width / divisor, height));
+
+            expectEquals (thumbnail.getWidth(),  width  / divisor);
+            expectEquals (thumbnail.getHeight(), height / divisor);
+            expect (coloursAreClose (thumbnail.getPixelAt (thumbnail.getWidth() / 4, thumbnail.getHeight() / 2),
+                                     source.getPixelAt (width / 4, height / 2)));
+        }
+
+        {
+            MemoryInputStream in (pngData, false);
+            const Image thumbnail (ImageFileFormat::loadThumbnailFrom (in, 100, 100));
+
+            expectEquals (thumbnail.getWidth(),  100);
+            expectEquals (thumbnail.getHeight(), 75);
+        }
+
+        beginTest ("Decoding speed");
+
+        logDecodingSpeed ("PNG, full size", pngData, 0);
+        logDecodingSpeed ("JPEG, full size", jpegData, 0);
+
+        for (int divisor = 2; divisor <= 8; divisor *= 2)
+            logDecodingSpeed ("JPEG, 1/" + String (divisor) + " size", jpegData, width / divisor);
+
+        beginTest ("Asynchronous decoding");
+
+        const int numImages = 16;
+        const double startTime = Time::getMillisecondCounterHiRes();
+
+        {
+            AsyncImageDecoder decoder;
+            Array<int> requestIds;
+
+            for (int i = 0; i < numImages; ++i)
+                requestIds.add (decoder.decodeData (jpegData, this));
+
+            // cancelled requests mustn't be delivered..
+            decoder.cancelRequest (decoder.decodeData (jpegData, this));
+            expectEquals (decoder.getNumPendingRequests(), numImages);
+
+            waitForAllImages (decoder);
+
+            expectEquals (decodedIds.size(), numImages);
+
+            for (int i = 0; i < decodedIds.size(); ++i)
+                expect (requestIds.contains (decodedIds.getUnchecked(i)));
+
+            for (int i = 0; i < decodedImages.size(); ++i)
+                expect (decodedImages.getReference(i).getWidth() == width);
+        }
+
+        logMessage (String (numImages * 1000.0 / (Time::getMillisecondCounterHiRes() - startTime), 1)
+                      + " images/sec using " + String (jmax (1, SystemStats::getNumCpus() - 1)) + " threads");
+
+        decodedIds.clear();
+        decodedImages.clear();
+
+        {
+            AsyncImageDecoder decoder;
+            const File file (File::createTempFile (".png"));
+            file.replaceWithData (pngData.getData(), pngData.getSize());
+
+            decoder.decodeFile (file, this, 64, 64);
+            decoder.decodeFile (File::createTempFile (".png"), this);
+            waitForAllImages (decoder);
+
+            expectEquals (decodedImages.size(), 2);
+            expect (decodedImages.getReference(0).getWidth() == 64 || decodedImages.getReference(1).getWidth() == 64);
+            expect (decodedImages.getReference(0).isNull() || decodedImages.getReference(1).isNull());
+
+            file.deleteFile();
+        }
+
+        decodedIds.clear();
+        decodedImages.clear();
+    }
+
+private:
+    Array<int> decodedIds;
+    Array<Image> decodedImages;
+
+    void imageDecoded (int requestId, const Image& image) override
+    {
+        decodedIds.add (requestId);
+        decodedImages.add (image);
+    }
+
+    void waitForAllImages (AsyncImageDecoder& decoder)
+    {
+        for (int i = 0; i < 2000 && decoder.getNumPendingRequests() > 0; ++i)
+        {
+            Thread::sleep (10);
+            decoder.deliverDecodedImages();
+        }
+
+        expectEquals (decoder.getNumPendingRequests(), 0);
+    }
+
+    void logDecodingSpeed (const String& description, const MemoryBlock& data, const int maxWidth)
+    {
+        const int numRuns = 5;
+        const double startTime = Time::getMillisecondCounterHiRes();
+
+        for (int i = 0; i < numRuns; ++i)
+        {
+            MemoryInputStream in (data, false);
+            ImageFileFormat::loadThumbnailFrom (in, maxWidth, maxWidth);
+        }
+
+        logMessage (description + ": " + String ((Time::getMillisecondCounterHiRes() - startTime) / numRuns, 1) + " ms per image");
+    }
+
+    static Image createTestImage (const int width, const int height)
+    {
+        Image image (Image::RGB, width, height, false);
+        Graphics g (image);
+
+        g.setGradientFill (ColourGradient (Colours::red, 0.0f, 0.0f,
+                                           Colours::blue, (float) width, (float) height, false));
+        g.fillAll();
+
+        Random r (123);
+
+        for (int i = 0; i < 500; ++i)
+        {
+            g.setColour (Colour ((uint32) r.nextInt()).withAlpha (0.5f));
+            g.fillEllipse (r.nextFloat() * width, r.nextFloat() * height, 40.0f, 40.0f);
+        }
+
+        return image;
+    }
+
+    static bool coloursAreClose (const Colour& c1, const Colour& c2)
+    {
+        return std::abs (c1.getRed()   - c2.getRed())   < 48
+            && std::abs (c1.getGreen() - c2.getGreen()) < 48
+            && std::abs (c1.getBlue()  - c2.getBlue())  < 48;
+    }
+};
+
+static AsyncImageDecoderTests asyncImageDecoderTests;
+
+#endif
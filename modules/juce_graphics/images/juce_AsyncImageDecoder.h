@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_ASYNCIMAGEDECODER_H_INCLUDED
+#define JUCE_ASYNCIMAGEDECODER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Decodes image files on a pool of background threads.
+
+    Loading a folder full of artwork with ImageFileFormat::loadFrom() or
+    ImageCache::getFromFile() will block the message thread until every image has
+    been decoded. An AsyncImageDecoder lets you queue up any number of files or blocks
+    of data, which are then decoded in parallel, and each decoded image is passed back
+    to a Listener on the message thread.
+
+    Requests can also ask for a thumbnail instead of the full-sized image, in which case
+    ImageFileFormat::decodeThumbnail() is used, so that formats which can decode at a
+    reduced resolution (e.g. JPEG) never need to create the full-sized image.
+
+    E.g.
+    @code
+    void MyBrowser::loadThumbnails (const Array<File>& files)
+    {
+        for (int i = 0; i < files.size(); ++i)
+            requestIds.add (decoder.decodeFile (files.getReference(i), this, 128, 128));
+    }
+
+    void MyBrowser::imageDecoded (int requestId, const Image& image)
+    {
+        thumbnails [requestIds.indexOf (requestId)]->setImage (image);
+    }
+    @endcode
+
+    @see ImageFileFormat, ImageCache
+*/
+class JUCE_API  AsyncImageDecoder  : private AsyncUpdater
+{
+public:
+    //==============================================================================
+    /** Creates a decoder.
+
+        @param numThreads   the number of background threads to use. If this is zero or
+                            less, it'll use one thread per CPU core, leaving one free for
+                            the message thread.
+    */
+    explicit AsyncImageDecoder (int numThreads = 0);
+
+    /** Destructor.
+        Any requests that are still waiting to be decoded are cancelled, and no further
+        callbacks will be made.
+    */
+    ~AsyncImageDecoder();
+
+    //==============================================================================
+    /** Receives the images decoded by an AsyncImageDecoder. */
+    class JUCE_API  Listener
+    {
+    public:
+        /** Destructor. */
+        virtual ~Listener()  {}
+
+        /** Called on the message thread when a request has been decoded.
+            If the data couldn't be decoded, the image will be invalid.
+        */
+        virtual void imageDecoded (int requestId, const Image& image) = 0;
+    };
+
+    //==============================================================================
+    /** Queues a file to be decoded.
+
+        If maxWidth and maxHeight are greater than zero, the image that's delivered will be
+        scaled down to fit within that size (see ImageFileFormat::decodeThumbnail()).
+
+        @returns    an ID for the request, which will be passed to the listener's
+                    imageDecoded() method, and which can be used to cancel the request
+    */
+    int decodeFile (const File& file, Listener* listener,
+                    int maxWidth = 0, int maxHeight = 0);
+
+    /** Queues a block of encoded image data to be decoded.
+        The data is copied, so the caller doesn't need to keep it around.
+        @see decodeFile
+    */
+    int decodeData (const MemoryBlock& encodedData, Listener* listener,
+                    int maxWidth = 0, int maxHeight = 0);
+
+    /** Cancels a request.
+        If the request hasn't yet been delivered, its listener won't get a callback for it.
+        This must be called on the message thread.
+    */
+    void cancelRequest (int requestId);
+
+    /** Cancels all the requests that were made for a particular listener.
+        You should call this before deleting a listener which may still have requests
+        outstanding. This must be called on the message thread.
+    */
+    void cancelAllRequestsFor (Listener* listener);
+
+    /** Returns the number of requests that haven't yet been delivered to their listeners. */
+    int getNumPendingRequests() const;
+
+    /** Immediately delivers any images that have been decoded but whose listener callbacks
+        are still waiting to be made.
+
+        Callbacks are normally made asynchronously, so you won't usually need to call this
+        yourself. It must be called on the message thread.
+    */
+    void deliverDecodedImages();
+
+private:
+    //==============================================================================
+    class DecodeJob;
+    struct DecodedImage;
+    friend class DecodeJob;
+
+    ThreadPool pool;
+    CriticalSection lock;
+    Array<DecodeJob*> activeJobs;
+    OwnedArray<DecodedImage> decodedImages;
+    int lastRequestId;
+
+    int addJob (DecodeJob*);
+    void decodingFinished (DecodeJob&, const Image&);
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE (AsyncImageDecoder)
+};
+
+
+#endif   // JUCE_ASYNCIMAGEDECODER_H_INCLUDED
@@ -0,0 +1,470 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+class ImageBlur::BlurThreadPool  : public ThreadPool,
+                                   private DeletedAtShutdown
+{
+public:
+    BlurThreadPool() : ThreadPool (jmax (1, SystemStats::getNumCpus() - 1)) {}
+    ~BlurThreadPool()   { clearSingletonInstance(); }
+
+    juce_DeclareSingleton (BlurThreadPool, false)
+};
+
+juce_ImplementSingleton (ImageBlur::BlurThreadPool)
+
+//==============================================================================
+struct ImageBlur::BlurTask
+{
+    BlurTask (const Image::BitmapData& data, const int* radii_, const int numRadii_, const bool horizontal_) noexcept
+        : bitmap (data), radii (radii_), numRadii (numRadii_), horizontal (horizontal_)
+    {
+    }
+
+    // The vertical pass works on strips of this many adjacent byte columns at once, so
+    // that it reads and writes whole runs of each row rather than one byte per row.
+    enum { stripWidth = 32 };
+
+    // The number of separate lines or columns of values that make up this task
+    int getNumLines() const noexcept
+    {
+        return horizontal ? bitmap.height : bitmap.width * bitmap.pixelStride;
+    }
+
+    // The number of lines that should be given to each thread, so that the vertical
+    // pass's strips aren't split between them
+    int getLinesPerThread (const int numThreads) const noexcept
+    {
+        const int linesPerThread = (getNumLines() + numThreads - 1) / numThreads;
+
+        return horizontal ? linesPerThread
+                          : ((linesPerThread + stripWidth - 1) / stripWidth) * stripWidth;
+    }
+
+    void process (const int start, const int end) const
+    {
+        const int length = horizontal ? bitmap.width : bitmap.height;
+
+        if (horizontal)
+        {
+            HeapBlock<int> buffer1 ((size_t) length), buffer2 ((size_t) length);
+
+            for (int i = start; i < end; ++i)
+            {
+                uint8* const line = bitmap.getLinePointer (i);
+
+                for (int channel = 0; channel < bitmap.pixelStride; ++channel)
+                    blurLine (line + channel, length, bitmap.pixelStride, buffer1, buffer2);
+            }
+        }
+        else
+        {
+            HeapBlock<int> buffer1 ((size_t) length * stripWidth), buffer2 ((size_t) length * stripWidth);
+
+            for (int i = start; i < end; i += stripWidth)
+                blurStrip (bitmap.data + i, jmin ((int) stripWidth, end - i), length, buffer1, buffer2);
+        }
+    }
+
+    // Blurs a run of values in-place, making a running-sum box pass for each radius
+    void blurLine (uint8* const data, const int num, const int stride, int* in, int* out) const noexcept
+    {
+        for (int i = 0; i < num; ++i)
+            in[i] = data [i * stride];
+
+        for (int pass = 0; pass < numRadii; ++pass)
+        {
+            const int r = radii [pass];
+
+            if (r <= 0)
+                continue;
+
+            // Dividing by multiplying with a 32-bit fixed-point reciprocal gives exactly rounded
+            // results for any sum of 8-bit values that this can produce.
+            const uint64 boxSize = (uint64) (2 * r + 1);
+            const uint64 reciprocal = ((((uint64) 1) << 32) + boxSize / 2) / boxSize;
+            const int numInitial = jmin (r, num);
+            uint64 sum = 0;
+
+            for (int i = 0; i < numInitial; ++i)
+                sum += (uint64) in[i];
+
+            for (int i = 0; i < num; ++i)
+            {
+                if (i + r < num)
+                    sum += (uint64) in [i + r];
+
+                out[i] = (int) ((sum * reciprocal + 0x80000000) >> 32);
+
+                if (i >= r)
+                    sum -= (uint64) in [i - r];
+            }
+
+            std::swap (in, out);
+        }
+
+        for (int i = 0; i < num; ++i)
+            data [i * stride] = (uint8) in[i];
+    }
+
+    // Blurs a strip of adjacent columns in-place. This does the same as calling blurLine()
+    // on each column, but the values for each row of the strip are kept together.
+    void blurStrip (uint8* const data, const int numColumns, const int num, int* in, int* out) const noexcept
+    {
+        const int lineStride = bitmap.lineStride;
+
+        for (int i = 0; i < num; ++i)
+            for (int c = 0; c < numColumns; ++c)
+                in [i * stripWidth + c] = data [i * lineStride + c];
+
+        for (int pass = 0; pass < numRadii; ++pass)
+        {
+            const int r = radii [pass];
+
+            if (r <= 0)
+                continue;
+
+            const uint64 boxSize = (uint64) (2 * r + 1);
+            const uint64 reciprocal = ((((uint64) 1) << 32) + boxSize / 2) / boxSize;
+            const int numInitial = jmin (r, num);
+            uint64 sums [stripWidth] = { 0 };
+
+            for (int i = 0; i < numInitial; ++i)
+                for (int c = 0; c < numColumns; ++c)
+                    sums[c] += (uint64) in [i * stripWidth + c];
+
+            for (int i = 0; i < num; ++i)
+            {
+                if (i + r < num)
+                {
+                    const int* const added = in + (i + r) * stripWidth;
+
+                    for (int c = 0; c < numColumns; ++c)
+                        sums[c] += (uint64) added[c];
+                }
+
+                int* const dest = out + i * stripWidth;
+
+                for (int c = 0; c < numColumns; ++c)
+                    dest[c] = (int) ((sums[c] * reciprocal + 0x80000000) >> 32);
+
+                if (i >= r)
+                {
+                    const int* const removed = in + (i - r) * stripWidth;
+
+                    for (int c = 0; c < numColumns; ++c)
+                        sums[c] -= (uint64) removed[c];
+                }
+            }
+
+            std::swap (in, out);
+        }
+
+        for (int i = 0; i < num; ++i)
+            for (int c = 0; c < numColumns; ++c)
+                data [i * lineStride + c] = (uint8) in [i * stripWidth + c];
+    }
+
+    const Image::BitmapData& bitmap;
+    const int* const radii;
+    const int numRadii;
+    const bool horizontal;
+
+    JUCE_DECLARE_NON_COPYABLE (BlurTask)
+};
+
+//==============================================================================
+class ImageBlur::BlurJob  : public ThreadPoolJob
+{
+public:
+    BlurJob (const BlurTask& task_, const int start_, const int end_)
+        : ThreadPoolJob ("Image blur"), task (task_), start (start_), end (end_)
+    {
+    }
+
+    JobStatus runJob()
+    {
+        task.process (start, end);
+        return jobHasFinished;
+    }
+
+private:
+    const BlurTask& task;
+    const int start, end;
+
+    JUCE_DECLARE_NON_COPYABLE (BlurJob)
+};
+
+//==============================================================================
+void ImageBlur::applyBoxBlurs (Image& image, const int* radii, const int numRadii)
+{
+    if (! image.isValid())
+        return;
+
+    const Image::BitmapData bitmap (image, Image::BitmapData::readWrite);
+
+    // below this size, it's not worth the overhead of using other threads..
+    const int minBytesPerThread = 64 * 1024;
+    const int numBytes = bitmap.width * bitmap.height * bitmap.pixelStride;
+    const int numThreads = jmin (SystemStats::getNumCpus(), numBytes / minBytesPerThread);
+
+    for (int direction = 0; direction < 2; ++direction)
+    {
+        const BlurTask task (bitmap, radii, numRadii, direction == 0);
+        const int numLines = task.getNumLines();
+
+        if (numThreads <= 1)
+        {
+            task.process (0, numLines);
+            continue;
+        }
+
+        ThreadPool& pool = *BlurThreadPool::getInstance();
+        const int linesPerThread = task.getLinesPerThread (numThreads);
+        OwnedArray<BlurJob> jobs;
+
+        for (int start = linesPerThread; start < numLines; start += linesPerThread)
+        {
+            BlurJob* const job = new BlurJob (task, start, jmin (numLines, start + linesPerThread));
+            jobs.add (job);
+            pool.addJob (job, false);
+        }
+
+        task.process (0, jmin (numLines, linesPerThread));
+
+        for (int i = 0; i < jobs.size(); ++i)
+            pool.waitForJobToFinish (jobs.getUnchecked (i), -1);
+    }
+}
+
+void ImageBlur::applyBoxBlur (Image& image, const int boxRadius, const int numPasses)
+{
+    jassert (boxRadius >= 0 && numPasses >= 0);
+
+    HeapBlock<int> radii ((size_t) jmax (1, numPasses));
+
+    for (int i = 0; i < numPasses; ++i)
+        radii[i] = boxRadius;
+
+    applyBoxBlurs (image, radii, numPasses);
+}
+
+void ImageBlur::applyGaussianBlur (Image& image, const float standardDeviation)
+{
+    // Chooses three box sizes whose combined variance matches that of the gaussian, as
+    // described in "Fast Almost-Gaussian Filtering" by Peter Kovesi.
+    const int numBoxes = 3;
+    const double variance = standardDeviation * (double) standardDeviation;
+
+    int smallerSize = (int) std::floor (std::sqrt (12.0 * variance / numBoxes + 1.0));
+
+    if ((smallerSize & 1) == 0)
+        --smallerSize;
+
+    const int numSmaller = roundToInt ((12.0 * variance - numBoxes * smallerSize * smallerSize
+                                          - 4.0 * numBoxes * smallerSize - 3.0 * numBoxes)
+                                        / (-4.0 * smallerSize - 4.0));
+
+    int radii [numBoxes];
+
+    for (int i = 0; i < numBoxes; ++i)
+        radii[i] = ((i < numSmaller ? smallerSize : smallerSize + 2) - 1) / 2;
+
+    applyBoxBlurs (image, radii, numBoxes);
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageBlurTests  : public UnitTest
+{
+public:
+    ImageBlurTests()  : UnitTest ("ImageBlur") {}
+
+    static Image createRandomImage (Random& r, Image::PixelFormat format, int w, int h)
+    {
+        Image image (format, w, h, false);
+        const Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < h; ++y)
+        {
+            uint8* line = data.getLinePointer (y);
+
+            for (int x = 0; x < w * data.pixelStride; ++x)
+                line[x] = (uint8) r.nextInt (256);
+        }
+
+        return image;
+    }
+
+    // A straightforward convolution to compare the results against
+    static void applyReferenceBoxBlur (Image& image, int radius)
+    {
+        const Image::BitmapData data (image, Image::BitmapData::readWrite);
+        const int boxSize = 2 * radius + 1;
+
+        for (int direction = 0; direction < 2; ++direction)
+        {
+            const int num = direction == 0 ? data.width : data.height;
+            const int stride = direction == 0 ? data.pixelStride : data.lineStride;
+            const int numLines = direction == 0 ? data.height : data.width * data.pixelStride;
+            HeapBlock<int> source ((size_t) num);
+
+            for (int line = 0; line < numLines; ++line)
+            {
+                for (int channel = 0; channel < (direction == 0 ? data.pixelStride : 1); ++channel)
+                {
+                    uint8* const d = direction == 0 ? data.getLinePointer (line) + channel : data.data + line;
+
+                    for (int i = 0; i < num; ++i)
+                        source[i] = d [i * stride];
+
+                    for (int i = 0; i < num; ++i)
+                    {
+                        int sum = 0;
+
+                        for (int j = i - radius; j <= i + radius; ++j)
+                            if (isPositiveAndBelow (j, num))
+                                sum += source[j];
+
+                        d [i * stride] = (uint8) ((sum + boxSize / 2) / boxSize);
+                    }
+                }
+            }
+        }
+    }
+
+    static bool imagesAreIdentical (const Image& a, const Image& b)
+    {
+        const Image::BitmapData da (a, Image::BitmapData::readOnly);
+        const Image::BitmapData db (b, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < a.getHeight(); ++y)
+            if (memcmp (da.getLinePointer (y), db.getLinePointer (y), (size_t) (a.getWidth() * da.pixelStride)) != 0)
+                return false;
+
+        return true;
+    }
+
+    void runTest()
+    {
+        Random r (0x12345);
+
+        beginTest ("Box blur");
+
+        const Image::PixelFormat formats[] = { Image::SingleChannel, Image::RGB, Image::ARGB };
+
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int radius = 0; radius < 40; radius += 13)
+            {
+                const Image original (createRandomImage (r, formats[i], 57 + r.nextInt (200), 1 + r.nextInt (300)));
+
+                Image expected (original.createCopy());
+                applyReferenceBoxBlur (expected, radius);
+
+                Image result (original.createCopy());
+                ImageBlur::applyBoxBlur (result, radius);
+
+                expect (imagesAreIdentical (result, expected));
+            }
+        }
+
+        beginTest ("Gaussian blur");
+
+        {
+            // A band of constant intensity should keep its total, and spread out with the
+            // gaussian's profile, so that its edges drop to half their original level..
+            const float sigma = 10.0f;
+            const int x = 100;
+            Image image (Image::SingleChannel, 2 * x + 1, 401, true);
+
+            {
+                const Image::BitmapData data (image, Image::BitmapData::readWrite);
+
+                for (int y = 150; y < 251; ++y)
+                    memset (data.getLinePointer (y), 200, (size_t) data.width);
+            }
+
+            ImageBlur::applyGaussianBlur (image, sigma);
+
+            const Image::BitmapData data (image, Image::BitmapData::readOnly);
+            double total = 0;
+
+            for (int y = 0; y < 401; ++y)
+                total += data.getLinePointer (y)[x];
+
+            expect (std::abs (total - 200.0 * 101) < 401.0);
+            expect (data.getLinePointer (200)[x] == 200);
+            expect (std::abs (data.getLinePointer (150)[x] - 100) < 8);
+            expect (data.getLinePointer (150 - (int) (4 * sigma))[x] == 0);
+        }
+
+        beginTest ("Cached drop shadows");
+
+        {
+            // These two images only differ at a pixel that the shadow cache's key doesn't
+            // sample, so the second must still get its own shadow rather than the first's..
+            Image withDot (Image::ARGB, 100, 100, true);
+            withDot.setPixelAt (50, 50, Colours::white);
+            const Image empty (Image::ARGB, 100, 100, true);
+
+            const DropShadow shadow (Colours::black, 4, Point<int>());
+            Image first (Image::ARGB, 100, 100, true), second (Image::ARGB, 100, 100, true);
+
+            {
+                Graphics g (first);
+                shadow.drawForImage (g, withDot);
+            }
+
+            {
+                Graphics g (second);
+                shadow.drawForImage (g, empty);
+            }
+
+            expect (first.getPixelAt (50, 50).getAlpha() > 0);
+            expect (second.getPixelAt (50, 50).getAlpha() == 0);
+        }
+
+        beginTest ("Speed");
+
+        {
+            Image image (createRandomImage (r, Image::ARGB, 1024, 768));
+            String timings;
+
+            for (int radius = 2; radius <= 128; radius *= 4)
+            {
+                const double start = Time::getMillisecondCounterHiRes();
+                ImageBlur::applyBoxBlur (image, radius, 3);
+                timings << "radius " << radius << ": " << String (Time::getMillisecondCounterHiRes() - start, 1) << "ms  ";
+            }
+
+            logMessage ("1024x768 ARGB, 3 passes - " + timings);
+        }
+    }
+};
+
+static ImageBlurTests imageBlurTests;
+
+#endif
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_IMAGEBLUR_H_INCLUDED
+#define JUCE_IMAGEBLUR_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Fast blurring functions for images.
+
+    These use separable running sums, so the time they take per pixel stays the same
+    no matter how large the blur radius is. Large images are divided up between
+    several threads.
+
+    Pixels outside the image are treated as being zero, so the image's content will
+    fade out towards its edges. Each channel is blurred independently, which is
+    correct for the premultiplied pixel formats that JUCE uses.
+
+    @see ImageConvolutionKernel, DropShadow, GlowEffect
+*/
+class JUCE_API  ImageBlur
+{
+public:
+    //==============================================================================
+    /** Applies a blur that closely approximates a gaussian blur.
+
+        This makes three box-blur passes in each direction, with their sizes chosen
+        so that the result matches a gaussian of the given standard deviation.
+    */
+    static void applyGaussianBlur (Image& image, float standardDeviation);
+
+    /** Applies a box blur to an image.
+
+        @param image        the image to blur
+        @param boxRadius    each pixel becomes the average of a (2 * boxRadius + 1) square
+                            of its neighbours
+        @param numPasses    the number of times to repeat the blur - 3 passes will
+                            give a good approximation of a gaussian blur
+    */
+    static void applyBoxBlur (Image& image, int boxRadius, int numPasses = 1);
+
+private:
+    //==============================================================================
+    class BlurThreadPool;
+    struct BlurTask;
+    class BlurJob;
+
+    static void applyBoxBlurs (Image&, const int* radii, int numRadii);
+
+    ImageBlur();
+    JUCE_DECLARE_NON_COPYABLE (ImageBlur)
+};
+
+
+#endif   // JUCE_IMAGEBLUR_H_INCLUDED
@@ -23,15 +23,23 @@
 */
 
 class ImageCache::Pimpl     : private Timer,
+                              private AsyncImageDecoder::Listener,
                               private DeletedAtShutdown
 {
 public:
-    Pimpl()  : cacheTimeout (5000)
+    Pimpl()
+        : cacheTimeout (5000), maxNumBytes (64 * 1024 * 1024),
+          oldest (nullptr), newest (nullptr)
     {
     }
 
     ~Pimpl()
     {
+        decoder = nullptr; // (cancels any files that are still waiting to be decoded)
+
+        while (oldest != nullptr)
+            removeItem (oldest);
+
         clearSingletonInstance();
     }
 
@@ -39,14 +47,15 @@ public:
     {
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
+        if (Item* const item = items [hashCode])
         {
-            const Item* const item = images.getUnchecked(i);
-
-            if (item->hashCode == hashCode)
-                return item->image;
+            ++stats.numHits;
+            item->lastUseTime = Time::getApproximateMillisecondCounter();
+            moveToNewest (item);
+            return item->image;
         }
 
+        ++stats.numMisses;
         return Image::null;
     }
 
@@ -57,14 +66,55 @@ public:
             if (! isTimerRunning())
                 startTimer (2000);
 
-            Item* const item = new Item();
-            item->hashCode = hashCode;
-            item->image = image;
-            item->lastUseTime = Time::getApproximateMillisecondCounter();
+            const ScopedLock sl (lock);
+
+            if (Item* const existing = items [hashCode])
+                removeItem (existing);
+
+            Item* const item = new Item (image, hashCode);
+            items.set (hashCode, item);
+            addAsNewest (item);
+
+            ++stats.numImages;
+            stats.numBytes += item->numBytes;
+
+            removeLeastRecentlyUsed();
+        }
+    }
 
+    Image getFromFileAsync (const File& file, const Image& placeholder)
+    {
+        const int64 hashCode = file.hashCode64();
+        const Image image (getFromHashCode (hashCode));
+
+        if (image.isValid())
+            return image;
+
+        const ScopedLock sl (lock);
+
+        if (indexOfPendingFile (hashCode) < 0 && ! failedHashCodes.contains (hashCode))
+        {
+            if (decoder == nullptr)
+                decoder = new AsyncImageDecoder (jlimit (1, 4, SystemStats::getNumCpus() - 1));
+
+            const PendingFile pending = { decoder->decodeFile (file, this), hashCode, file };
+            pendingFiles.add (pending);
+        }
+
+        return placeholder;
+    }
+
+    void deliverLoadedImages()
+    {
+        AsyncImageDecoder* d;
+
+        {
             const ScopedLock sl (lock);
-            images.add (item);
+            d = decoder;
         }
+
+        if (d != nullptr)
+            d->deliverDecodedImages();
     }
 
     void timerCallback() override
@@ -73,22 +123,27 @@ public:
 
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
+        for (Item* item = oldest; item != nullptr;)
         {
-            Item* const item = images.getUnchecked(i);
+            Item* const next = item->next;
 
             if (item->image.getReferenceCount() <= 1)
             {
                 if (now > item->lastUseTime + cacheTimeout || now < item->lastUseTime - 1000)
-                    images.remove (i);
+                {
+                    removeItem (item);
+                    ++stats.numEvictions;
+                }
             }
             else
             {
                 item->lastUseTime = now; // multiply-referenced, so this image is still in use.
             }
+
+            item = next;
         }
 
-        if (images.size() == 0)
+        if (oldest == nullptr)
             stopTimer();
     }
 
@@ -96,25 +151,190 @@ public:
     {
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
-            if (images.getUnchecked(i)->image.getReferenceCount() <= 1)
-                images.remove (i);
+        for (Item* item = oldest; item != nullptr;)
+        {
+            Item* const next = item->next;
+
+            if (item->image.getReferenceCount() <= 1)
+                removeItem (item);
+
+            item = next;
+        }
+    }
+
+    void setCacheSizeLimit (const int64 newMaxNumBytes)
+    {
+        const ScopedLock sl (lock);
+        maxNumBytes = jmax ((int64) 0, newMaxNumBytes);
+        removeLeastRecentlyUsed();
+    }
+
+    Statistics getStatistics() const
+    {
+        const ScopedLock sl (lock);
+        return stats;
+    }
+
+    void resetStatistics()
+    {
+        const ScopedLock sl (lock);
+        stats.numHits = stats.numMisses = stats.numEvictions = 0;
     }
 
+    unsigned int cacheTimeout;
+    ListenerList<ImageCache::Listener> listeners;
+
+    juce_DeclareSingleton_SingleThreaded_Minimal (ImageCache::Pimpl);
+
+private:
+    //==============================================================================
+    // Items are kept in a linked list in order of use, so that the least recently
+    // used ones can be found quickly when the cache needs to shrink.
     struct Item
     {
+        Item (const Image& im, const int64 hash)
+            : image (im), hashCode (hash),
+              lastUseTime (Time::getApproximateMillisecondCounter()),
+              numBytes (getNumBytes (im)), previous (nullptr), next (nullptr)
+        {
+        }
+
         Image image;
-        int64 hashCode;
+        const int64 hashCode;
         uint32 lastUseTime;
+        const int64 numBytes;
+        Item* previous;
+        Item* next;
+
+        JUCE_DECLARE_NON_COPYABLE (Item)
     };
 
-    unsigned int cacheTimeout;
+    struct HashCodeHashFunction
+    {
+        int generateHash (const int64 key, const int upperLimit) const noexcept
+        {
+            return (int) ((((uint64) key) ^ (((uint64) key) >> 32)) % (uint64) upperLimit);
+        }
+    };
 
-    juce_DeclareSingleton_SingleThreaded_Minimal (ImageCache::Pimpl);
+    // A file that getFromFileAsync() has asked the decoder for
+    struct PendingFile
+    {
+        int requestId;
+        int64 hashCode;
+        File file;
+    };
 
-private:
-    OwnedArray<Item> images;
+    //==============================================================================
+    HashMap<int64, Item*, HashCodeHashFunction> items;
     CriticalSection lock;
+    int64 maxNumBytes;
+    Item* oldest;
+    Item* newest;
+    Statistics stats;
+
+    ScopedPointer<AsyncImageDecoder> decoder;
+    Array<PendingFile> pendingFiles;
+    SortedSet<int64> failedHashCodes;
+
+    static int64 getNumBytes (const Image& image) noexcept
+    {
+        const int bytesPerPixel = image.isARGB() ? 4 : (image.isRGB() ? 3 : 1);
+        return image.getWidth() * (int64) image.getHeight() * bytesPerPixel;
+    }
+
+    void addAsNewest (Item* const item) noexcept
+    {
+        item->previous = newest;
+        item->next = nullptr;
+
+        if (newest != nullptr)
+            newest->next = item;
+        else
+            oldest = item;
+
+        newest = item;
+    }
+
+    void unlink (Item* const item) noexcept
+    {
+        if (item->previous != nullptr)  item->previous->next = item->next;
+        else                            oldest = item->next;
+
+        if (item->next != nullptr)      item->next->previous = item->previous;
+        else                            newest = item->previous;
+    }
+
+    void moveToNewest (Item* const item) noexcept
+    {
+        if (item != newest)
+        {
+            unlink (item);
+            addAsNewest (item);
+        }
+    }
+
+    void removeItem (Item* const item)
+    {
+        unlink (item);
+        items.remove (item->hashCode);
+
+        --stats.numImages;
+        stats.numBytes -= item->numBytes;
+
+        delete item;
+    }
+
+    void removeLeastRecentlyUsed()
+    {
+        for (Item* item = oldest; item != nullptr && stats.numBytes > maxNumBytes;)
+        {
+            Item* const next = item->next;
+
+            if (item->image.getReferenceCount() <= 1)
+            {
+                removeItem (item);
+                ++stats.numEvictions;
+            }
+
+            item = next;
+        }
+    }
+
+    int indexOfPendingFile (const int64 hashCode) const noexcept
+    {
+        for (int i = pendingFiles.size(); --i >= 0;)
+            if (pendingFiles.getReference (i).hashCode == hashCode)
+                return i;
+
+        return -1;
+    }
+
+    void imageDecoded (int requestId, const Image& image) override
+    {
+        PendingFile pending;
+
+        {
+            const ScopedLock sl (lock);
+            int index = pendingFiles.size();
+
+            while (--index >= 0)
+                if (pendingFiles.getReference (index).requestId == requestId)
+                    break;
+
+            if (index < 0)
+                return;
+
+            pending = pendingFiles.remove (index);
+
+            addImageToCache (image, pending.hashCode);
+
+            if (! image.isValid())
+                failedHashCodes.add (pending.hashCode);
+        }
+
+        listeners.call (&ImageCache::Listener::imageLoaded, pending.file, image);
+    }
 
     JUCE_DECLARE_NON_COPYABLE (Pimpl)
 };
@@ -150,6 +370,17 @@ Image ImageCache::getFromFile (const File& file)
     return image;
 }
 
+Image ImageCache::getFromFileAsync (const File& file, const Image& placeholder)
+{
+    return Pimpl::getInstance()->getFromFileAsync (file, placeholder);
+}
+
+void ImageCache::deliverLoadedImages()
+{
+    if (Pimpl::getInstanceWithoutCreating() != nullptr)
+        Pimpl::getInstanceWithoutCreating()->deliverLoadedImages();
+}
+
 Image ImageCache::getFromMemory (const void* imageData, const int dataSize)
 {
     const int64 hashCode = (int64) (pointer_sized_int) imageData;
@@ -164,13 +395,132 @@ Image ImageCache::getFromMemory (const void* imageData, const int dataSize)
     return image;
 }
 
+void ImageCache::addListener (Listener* const listener)
+{
+    Pimpl::getInstance()->listeners.add (listener);
+}
+
+void ImageCache::removeListener (Listener* const listener)
+{
+    if (Pimpl::getInstanceWithoutCreating() != nullptr)
+        Pimpl::getInstanceWithoutCreating()->listeners.remove (listener);
+}
+
 void ImageCache::setCacheTimeout (const int millisecs)
 {
     jassert (millisecs >= 0);
     Pimpl::getInstance()->cacheTimeout = (unsigned int) millisecs;
 }
 
+void ImageCache::setCacheSizeLimit (const int64 maxNumBytes)
+{
+    Pimpl::getInstance()->setCacheSizeLimit (maxNumBytes);
+}
+
+ImageCache::Statistics ImageCache::getStatistics()
+{
+    if (Pimpl::getInstanceWithoutCreating() != nullptr)
+        return Pimpl::getInstanceWithoutCreating()->getStatistics();
+
+    return Statistics();
+}
+
+void ImageCache::resetStatistics()
+{
+    if (Pimpl::getInstanceWithoutCreating() != nullptr)
+        Pimpl::getInstanceWithoutCreating()->resetStatistics();
+}
+
 void ImageCache::releaseUnusedImages()
 {
     Pimpl::getInstance()->releaseUnusedImages();
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageCacheTests  : public UnitTest
+{
+public:
+    ImageCacheTests()  : UnitTest ("ImageCache") {}
+
+    void runTest()
+    {
+        const int64 firstHashCode = 0x7654321000000000LL;
+        const int64 imageSize = 100 * 100 * 4;
+
+        beginTest ("Size limit and LRU eviction");
+
+        ImageCache::releaseUnusedImages();
+        ImageCache::setCacheSizeLimit (imageSize * 3);
+        ImageCache::resetStatistics();
+
+        for (int i = 0; i < 3; ++i)
+            ImageCache::addImageToCache (Image (Image::ARGB, 100, 100, true), firstHashCode + i);
+
+        expect (ImageCache::getFromHashCode (firstHashCode).isValid());
+        expect (ImageCache::getStatistics().numImages == 3);
+        expect (ImageCache::getStatistics().numBytes == imageSize * 3);
+
+        // This should push out the least recently used image, which is now the second one..
+        ImageCache::addImageToCache (Image (Image::ARGB, 100, 100, true), firstHashCode + 3);
+
+        expect (ImageCache::getFromHashCode (firstHashCode).isValid());
+        expect (ImageCache::getFromHashCode (firstHashCode + 1).isNull());
+        expect (ImageCache::getFromHashCode (firstHashCode + 2).isValid());
+        expect (ImageCache::getFromHashCode (firstHashCode + 3).isValid());
+
+        {
+            // ..and images that are still in use mustn't be removed
+            const Image inUse (ImageCache::getFromHashCode (firstHashCode));
+            ImageCache::setCacheSizeLimit (0);
+
+            expect (ImageCache::getFromHashCode (firstHashCode) == inUse);
+            expect (ImageCache::getStatistics().numImages == 1);
+        }
+
+        const ImageCache::Statistics stats (ImageCache::getStatistics());
+        expectEquals ((int) stats.numMisses, 1);
+        expectEquals ((int) stats.numEvictions, 3);
+
+        ImageCache::setCacheSizeLimit (64 * 1024 * 1024);
+        ImageCache::releaseUnusedImages();
+        expect (ImageCache::getStatistics().numImages == 0);
+
+        beginTest ("Asynchronous loading");
+
+        {
+            const File file (File::createTempFile (".png"));
+
+            {
+                Image image (Image::RGB, 32, 16, true);
+                image.setPixelAt (3, 4, Colours::red);
+
+                FileOutputStream out (file);
+                PNGImageFormat().writeImageToStream (image, out);
+            }
+
+            const Image placeholder (Image::RGB, 1, 1, true);
+            expect (ImageCache::getFromFileAsync (file, placeholder) == placeholder);
+
+            Image loaded;
+
+            for (int i = 0; i < 500 && loaded.isNull(); ++i)
+            {
+                Thread::sleep (10);
+                ImageCache::deliverLoadedImages();
+                loaded = ImageCache::getFromHashCode (file.hashCode64());
+            }
+
+            expect (loaded.getWidth() == 32 && loaded.getHeight() == 16);
+            expect (loaded.getPixelAt (3, 4) == Colours::red);
+            expect (ImageCache::getFromFileAsync (file, placeholder) == loaded);
+
+            file.deleteFile();
+        }
+    }
+};
+
+static ImageCacheTests imageCacheTests;
+
+#endif
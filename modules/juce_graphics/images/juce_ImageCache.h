@@ -39,6 +39,9 @@
     loading/deleting the same image, it'll reduce the chances of having to reload it
     each time.
 
+    Images are looked up by hash code, and once the cache grows beyond its size limit,
+    the least-recently-used images that aren't referenced anywhere else are removed.
+
     @see Image, ImageFileFormat
 */
 class JUCE_API  ImageCache
@@ -78,6 +81,58 @@ public:
     */
     static Image getFromMemory (const void* imageData, int dataSize);
 
+    //==============================================================================
+    /** Returns an image from the cache, or starts loading it on a background thread.
+
+        If the cache already contains an image that was loaded from this file, it's
+        returned straight away. Otherwise, this returns the placeholder image that you
+        pass in (which can just be an invalid Image), and the file gets decoded on a
+        background thread by an AsyncImageDecoder. When the decoded image arrives on the
+        message thread, it's added to the cache and any registered Listener objects are
+        called, and subsequent calls to this method or getFromFile() will return it.
+
+        A file that couldn't be decoded isn't tried again by this method, so it'll just
+        keep returning the placeholder for it.
+
+        @see getFromFile, addListener, AsyncImageDecoder
+    */
+    static Image getFromFileAsync (const File& file, const Image& placeholder);
+
+    /** Immediately adds any images that getFromFileAsync() has finished decoding to the
+        cache, and calls the listeners for them.
+
+        This normally happens asynchronously, so you won't usually need to call it
+        yourself. It must be called on the message thread.
+
+        @see AsyncImageDecoder::deliverDecodedImages
+    */
+    static void deliverLoadedImages();
+
+    /** Receives callbacks when images requested with getFromFileAsync() have been loaded.
+        @see ImageCache::addListener
+    */
+    class JUCE_API  Listener
+    {
+    public:
+        Listener()          {}
+        virtual ~Listener() {}
+
+        /** Called on the message thread when a file requested with getFromFileAsync()
+            has been decoded. If the file couldn't be loaded, the image will be invalid.
+        */
+        virtual void imageLoaded (const File& file, const Image& image) = 0;
+    };
+
+    /** Registers a listener to be told when asynchronously-loaded images are ready.
+        This must only be called on the message thread.
+    */
+    static void addListener (Listener* listener);
+
+    /** Unregisters a listener that was added with addListener().
+        This must only be called on the message thread.
+    */
+    static void removeListener (Listener* listener);
+
     //==============================================================================
     /** Checks the cache for an image with a particular hashcode.
 
@@ -106,6 +161,35 @@ public:
     */
     static void setCacheTimeout (int millisecs);
 
+    /** Sets the amount of memory that the cache can use before it starts removing the
+        least-recently-used images. By default this is 64MB.
+
+        Only images that aren't being referenced by any other Image objects can be
+        removed, so the total may still exceed this if many of them are in use.
+    */
+    static void setCacheSizeLimit (int64 maxNumBytes);
+
+    //==============================================================================
+    /** Describes how well the cache is working.
+        @see getStatistics
+    */
+    struct JUCE_API  Statistics
+    {
+        Statistics() noexcept  : numHits (0), numMisses (0), numEvictions (0), numBytes (0), numImages (0) {}
+
+        int64 numHits;        /**< The number of lookups that found an image in the cache. */
+        int64 numMisses;      /**< The number of lookups that didn't find one. */
+        int64 numEvictions;   /**< The number of images removed because of the size limit or timeout. */
+        int64 numBytes;       /**< The approximate amount of memory used by the cached images. */
+        int numImages;        /**< The number of images currently in the cache. */
+    };
+
+    /** Returns the cache's current statistics. */
+    static Statistics getStatistics();
+
+    /** Resets the hit, miss and eviction counters to zero. */
+    static void resetStatistics();
+
     /** Releases any images in the cache that aren't being referenced by active
         Image objects.
     */
@@ -98,6 +98,108 @@ void ImageConvolutionKernel::createGaussianBlur (const float radius)
 }
 
 //==============================================================================
+namespace ConvolutionHelpers
+{
+    // If the kernel is the product of a row and a column vector, as gaussian kernels are,
+    // this finds those vectors, so that it can be applied in two much cheaper passes.
+    static bool findSeparableFactors (const float* values, const int size, float* rowFactors, float* columnFactors) noexcept
+    {
+        int pivot = 0;
+
+        for (int i = size * size; --i > 0;)
+            if (std::abs (values[i]) > std::abs (values[pivot]))
+                pivot = i;
+
+        const float pivotValue = values[pivot];
+
+        if (pivotValue == 0)
+            return false;
+
+        const int pivotX = pivot % size;
+        const int pivotY = pivot / size;
+
+        for (int i = 0; i < size; ++i)
+        {
+            rowFactors[i] = values [i + pivotY * size];
+            columnFactors[i] = values [pivotX + i * size] / pivotValue;
+        }
+
+        const float tolerance = std::abs (pivotValue) * 1.0e-5f;
+
+        for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x)
+                if (std::abs (columnFactors[y] * rowFactors[x] - values [x + y * size]) > tolerance)
+                    return false;
+
+        return true;
+    }
+
+    static void applySeparable (const Image::BitmapData& destData, const Image::BitmapData& srcData,
+                                const Rectangle<int>& area, const float* rowFactors, const float* columnFactors,
+                                const int size)
+    {
+        const int numChannels = destData.pixelStride;
+        const int centre = size >> 1;
+        const int lineLength = area.getWidth() * numChannels;
+
+        // Convolve the source rows horizontally into a temporary buffer first, which also means
+        // that the source and destination can be the same image..
+        const int firstRow = jmax (0, area.getY() - centre);
+        const int lastRow  = jmin (srcData.height, area.getBottom() - centre + size - 1);
+
+        if (firstRow >= lastRow)
+            return;
+
+        HeapBlock<float> rows ((size_t) (lineLength * (lastRow - firstRow)));
+
+        for (int sy = firstRow; sy < lastRow; ++sy)
+        {
+            float* dest = rows + lineLength * (sy - firstRow);
+
+            for (int x = area.getX(); x < area.getRight(); ++x)
+            {
+                for (int c = 0; c < numChannels; ++c)
+                    dest[c] = 0;
+
+                for (int xx = 0; xx < size; ++xx)
+                {
+                    const int sx = x + xx - centre;
+
+                    if (isPositiveAndBelow (sx, srcData.width))
+                    {
+                        const uint8* const src = srcData.getPixelPointer (sx, sy);
+
+                        for (int c = 0; c < numChannels; ++c)
+                            dest[c] += rowFactors[xx] * src[c];
+                    }
+                }
+
+                dest += numChannels;
+            }
+        }
+
+        for (int y = area.getY(); y < area.getBottom(); ++y)
+        {
+            uint8* const dest = destData.getLinePointer (y - area.getY());
+
+            for (int i = 0; i < lineLength; ++i)
+            {
+                float total = 0;
+
+                for (int yy = 0; yy < size; ++yy)
+                {
+                    const int sy = y + yy - centre;
+
+                    if (sy >= firstRow && sy < lastRow)
+                        total += columnFactors[yy] * rows [lineLength * (sy - firstRow) + i];
+                }
+
+                dest[i] = (uint8) jlimit (0, 0xff, roundToInt (total));
+            }
+        }
+    }
+}
+
 void ImageConvolutionKernel::applyToImage (Image& destImage,
                                            const Image& sourceImage,
                                            const Rectangle<int>& destinationArea) const
@@ -131,6 +233,16 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
 
     const Image::BitmapData srcData (sourceImage, Image::BitmapData::readOnly);
 
+    {
+        HeapBlock<float> rowFactors ((size_t) size), columnFactors ((size_t) size);
+
+        if (ConvolutionHelpers::findSeparableFactors (values, size, rowFactors, columnFactors))
+        {
+            ConvolutionHelpers::applySeparable (destData, srcData, area, rowFactors, columnFactors, size);
+            return;
+        }
+    }
+
     if (destData.pixelStride == 4)
     {
         for (int y = area.getY(); y < bottom; ++y)
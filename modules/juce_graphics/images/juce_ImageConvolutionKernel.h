@@ -89,6 +89,11 @@ public:
     //==============================================================================
     /** Applies the kernel to an image.
 
+        If the kernel is separable (i.e. it's the product of a row and a column, as a
+        gaussian blur is), this is done as two one-dimensional passes, so the cost per
+        pixel is proportional to the kernel's size rather than its area. For large blurs,
+        ImageBlur::applyGaussianBlur() is much faster still.
+
         @param destImage        the image that will receive the resultant convoluted pixels.
         @param sourceImage      the source image to read from - this can be the same image as
                                 the destination, but if different, it must be exactly the same
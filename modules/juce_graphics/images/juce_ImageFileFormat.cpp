@@ -71,6 +71,27 @@ ImageFileFormat* ImageFileFormat::findImageFormatForFileExtension (const File& f
     return nullptr;
 }
 
+//==============================================================================
+Image ImageFileFormat::decodeThumbnail (InputStream& input, const int maxWidth, const int maxHeight)
+{
+    return rescaledToFit (decodeImage (input), maxWidth, maxHeight);
+}
+
+Image ImageFileFormat::rescaledToFit (const Image& image, const int maxWidth, const int maxHeight)
+{
+    if (image.isValid() && maxWidth > 0 && maxHeight > 0
+         && (image.getWidth() > maxWidth || image.getHeight() > maxHeight))
+    {
+        const double scale = jmin (maxWidth  / (double) image.getWidth(),
+                                   maxHeight / (double) image.getHeight());
+
+        return image.rescaled (jmax (1, roundToInt (image.getWidth()  * scale)),
+                               jmax (1, roundToInt (image.getHeight() * scale)));
+    }
+
+    return image;
+}
+
 //==============================================================================
 Image ImageFileFormat::loadFrom (InputStream& input)
 {
@@ -105,3 +126,27 @@ Image ImageFileFormat::loadFrom (const void* rawData, const size_t numBytes)
 
     return Image::null;
 }
+
+//==============================================================================
+Image ImageFileFormat::loadThumbnailFrom (InputStream& input, const int maxWidth, const int maxHeight)
+{
+    ImageFileFormat* const format = findImageFormatForStream (input);
+
+    if (format != nullptr)
+        return format->decodeThumbnail (input, maxWidth, maxHeight);
+
+    return Image::null;
+}
+
+Image ImageFileFormat::loadThumbnailFrom (const File& file, const int maxWidth, const int maxHeight)
+{
+    FileInputStream stream (file);
+
+    if (stream.openedOk())
+    {
+        BufferedInputStream b (stream, 8192);
+        return loadThumbnailFrom (b, maxWidth, maxHeight);
+    }
+
+    return Image::null;
+}
@@ -82,6 +82,21 @@ public:
     */
     virtual Image decodeImage (InputStream& input) = 0;
 
+    /** Tries to decode a reduced-size version of the image in the given stream.
+
+        The image that's returned will keep the original's proportions, and will be scaled
+        down to fit within maxWidth x maxHeight. Images that already fit are returned at
+        their original size.
+
+        The default implementation simply decodes the whole image and rescales it, but
+        formats that can cheaply decode at a lower resolution will override this. E.g. the
+        JPEG decoder can scale by 1/2, 1/4 or 1/8 while decoding, which makes thumbnails of
+        large photos several times faster to create than the full-size images.
+
+        @see loadThumbnailFrom, decodeImage
+    */
+    virtual Image decodeThumbnail (InputStream& input, int maxWidth, int maxHeight);
+
     //==============================================================================
     /** Attempts to write an image to a stream.
 
@@ -135,6 +150,28 @@ public:
     */
     static Image loadFrom (const void* rawData,
                            size_t numBytesOfData);
+
+    //==============================================================================
+    /** Tries to load a reduced-size version of an image from a stream.
+
+        This finds a suitable codec in the same way as loadFrom(), and then uses
+        its decodeThumbnail() method to create an image that fits within the given size.
+
+        @returns        the image that was decoded, or an invalid image if it fails.
+        @see decodeThumbnail, AsyncImageDecoder
+    */
+    static Image loadThumbnailFrom (InputStream& input, int maxWidth, int maxHeight);
+
+    /** Tries to load a reduced-size version of an image from a file.
+        @see decodeThumbnail
+    */
+    static Image loadThumbnailFrom (const File& file, int maxWidth, int maxHeight);
+
+protected:
+    /** Returns a copy of an image that has been scaled down to fit within the given
+        size, or the original image if it's already small enough.
+    */
+    static Image rescaledToFit (const Image& image, int maxWidth, int maxHeight);
 };
 
 //==============================================================================
@@ -185,6 +222,7 @@ public:
     bool usesFileExtension (const File&) override;
     bool canUnderstand (InputStream&) override;
     Image decodeImage (InputStream&) override;
+    Image decodeThumbnail (InputStream&, int maxWidth, int maxHeight) override;
     bool writeImageToStream (const Image&, OutputStream&) override;
 
 private:
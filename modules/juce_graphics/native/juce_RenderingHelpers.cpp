@@ -0,0 +1,489 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace RenderingHelpers
+{
+namespace SpanBlenders
+{
+    static bool spanBlendersEnabled = true;
+
+    void setEnabled (const bool shouldBeEnabled) noexcept
+    {
+        spanBlendersEnabled = shouldBeEnabled;
+    }
+
+   #if JUCE_USE_SSE_INTRINSICS
+    static bool sse2Present = false;
+
+    static bool canUseSSE2() noexcept
+    {
+        if (! spanBlendersEnabled)
+            return false;
+
+        if (! sse2Present)
+            sse2Present = SystemStats::hasSSE2();
+
+        return sse2Present;
+    }
+
+    // Blends a source pattern which repeats every 48 bytes (i.e. a whole number of 1, 3 or
+    // 4-byte pixels) over the destination. Each byte is blended independently as
+    // dest = src + ((dest * inverseAlpha) >> 8), saturated to 255, which is the same
+    // per-component arithmetic that the pixel classes use.
+    static int blendRepeatingPattern (uint8* dest, const uint8* pattern, const int numBytes, const int inverseAlpha) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alpha = _mm_set1_epi16 ((short) inverseAlpha);
+        __m128i src[6];
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const __m128i p = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (pattern + i * 16));
+            src[i * 2]     = _mm_unpacklo_epi8 (p, zero);
+            src[i * 2 + 1] = _mm_unpackhi_epi8 (p, zero);
+        }
+
+        int numDone = 0;
+
+        for (; numDone + 48 <= numBytes; numDone += 48)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                __m128i* const d = reinterpret_cast<__m128i*> (dest + numDone + i * 16);
+                const __m128i v = _mm_loadu_si128 (d);
+
+                const __m128i lo = _mm_add_epi16 (src[i * 2],     _mm_srli_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (v, zero), alpha), 8));
+                const __m128i hi = _mm_add_epi16 (src[i * 2 + 1], _mm_srli_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (v, zero), alpha), 8));
+
+                _mm_storeu_si128 (d, _mm_packus_epi16 (lo, hi));
+            }
+        }
+
+        return numDone;
+    }
+
+    template <class PixelType>
+    static int blendSolidColourSSE2 (PixelType* dest, const PixelARGB colour, const int numPixels) noexcept
+    {
+        enum { patternSize = 48 / sizeof (PixelType) };
+        static_jassert (sizeof (PixelType) * patternSize == 48);
+
+        if (numPixels < (int) patternSize || ! canUseSSE2())
+            return 0;
+
+        PixelType pattern [patternSize];
+
+        for (int i = 0; i < (int) patternSize; ++i)
+            pattern[i].set (colour);
+
+        return blendRepeatingPattern (reinterpret_cast<uint8*> (dest), reinterpret_cast<const uint8*> (pattern),
+                                      numPixels * (int) sizeof (PixelType), 0x100 - colour.getAlpha())
+                 / (int) sizeof (PixelType);
+    }
+
+    int blendSolidColour (PixelARGB* dest, const PixelARGB colour, const int numPixels) noexcept   { return blendSolidColourSSE2 (dest, colour, numPixels); }
+    int blendSolidColour (PixelRGB* dest, const PixelARGB colour, const int numPixels) noexcept    { return blendSolidColourSSE2 (dest, colour, numPixels); }
+    int blendSolidColour (PixelAlpha* dest, const PixelARGB colour, const int numPixels) noexcept  { return blendSolidColourSSE2 (dest, colour, numPixels); }
+
+    int blendPixels (PixelARGB* dest, const PixelARGB* src, const int numPixels, const uint32 extraAlpha) noexcept
+    {
+        if (numPixels < 4 || ! canUseSSE2())
+            return 0;
+
+        jassert (extraAlpha <= 0x100);
+        const bool scaleSource = extraAlpha < 0x100;
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i maxAlpha = _mm_set1_epi16 (0x100);
+        const __m128i extra = _mm_set1_epi16 ((short) extraAlpha);
+
+        int numDone = 0;
+
+        for (; numDone + 4 <= numPixels; numDone += 4)
+        {
+            const __m128i s = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + numDone));
+            __m128i* const d = reinterpret_cast<__m128i*> (dest + numDone);
+            const __m128i v = _mm_loadu_si128 (d);
+
+            __m128i srcLo = _mm_unpacklo_epi8 (s, zero);
+            __m128i srcHi = _mm_unpackhi_epi8 (s, zero);
+
+            if (scaleSource)
+            {
+                srcLo = _mm_srli_epi16 (_mm_mullo_epi16 (srcLo, extra), 8);
+                srcHi = _mm_srli_epi16 (_mm_mullo_epi16 (srcHi, extra), 8);
+            }
+
+            // The alpha is the highest-addressed byte of each pixel, so the 4th 16-bit lane of
+            // each unpacked group gets broadcast across the other three..
+            const __m128i alphaLo = _mm_sub_epi16 (maxAlpha, _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (srcLo, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3)));
+            const __m128i alphaHi = _mm_sub_epi16 (maxAlpha, _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (srcHi, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3)));
+
+            const __m128i lo = _mm_add_epi16 (srcLo, _mm_srli_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (v, zero), alphaLo), 8));
+            const __m128i hi = _mm_add_epi16 (srcHi, _mm_srli_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (v, zero), alphaHi), 8));
+
+            _mm_storeu_si128 (d, _mm_packus_epi16 (lo, hi));
+        }
+
+        return numDone;
+    }
+
+   #else
+    int blendSolidColour (PixelARGB*, const PixelARGB, const int) noexcept              { return 0; }
+    int blendSolidColour (PixelRGB*, const PixelARGB, const int) noexcept               { return 0; }
+    int blendSolidColour (PixelAlpha*, const PixelARGB, const int) noexcept             { return 0; }
+    int blendPixels (PixelARGB*, const PixelARGB*, const int, const uint32) noexcept    { return 0; }
+   #endif
+}
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SpanBlendersTests  : public UnitTest
+{
+public:
+    SpanBlendersTests()  : UnitTest ("SpanBlenders") {}
+
+    enum { width = 1024, height = 768 };
+
+    static const char* getFillName (int fill)
+    {
+        const char* const names[] = { "Translucent colour", "Linear gradient", "Radial gradient",
+                                      "Image", "Translucent image", "Transformed image" };
+        return names [fill];
+    }
+
+    static Image createSourceImage()
+    {
+        Image image (Image::ARGB, 200, 150, true);
+        Graphics g (image);
+        g.setGradientFill (ColourGradient (Colours::blue.withAlpha (0.9f), 0.0f, 0.0f,
+                                           Colours::yellow.withAlpha (0.3f), 100.0f, 150.0f, true));
+        g.fillEllipse (0.0f, 0.0f, 200.0f, 150.0f);
+        return image;
+    }
+
+    static void drawFill (Graphics& g, const int fill, const Image& source)
+    {
+        switch (fill)
+        {
+            case 0:
+                g.setColour (Colours::orange.withAlpha (0.6f));
+                g.fillRect (10, 10, width - 20, height - 20);
+                g.setColour (Colours::darkblue.withAlpha (0.3f));
+                g.fillEllipse (20.5f, 20.5f, width - 40.0f, height - 40.0f);
+                break;
+
+            case 1:
+            case 2:
+                g.setGradientFill (ColourGradient (Colours::red.withAlpha (0.8f), 100.0f, 100.0f,
+                                                   Colours::green.withAlpha (0.2f), width - 100.0f, height - 100.0f, fill == 2));
+                g.fillRect (10, 10, width - 20, height - 20);
+                g.fillEllipse (20.5f, 20.5f, width - 40.0f, height - 40.0f);
+                break;
+
+            case 3:
+            case 4:
+                g.setOpacity (fill == 3 ? 1.0f : 0.7f);
+
+                for (int y = 0; y < height; y += 150)
+                    for (int x = 0; x < width; x += 200)
+                        g.drawImageAt (source, x, y);
+
+                break;
+
+            default:
+                g.drawImageTransformed (source, AffineTransform::scale (5.0f, 5.0f).rotated (0.1f));
+                break;
+        }
+    }
+
+    static bool imagesAreIdentical (const Image& a, const Image& b)
+    {
+        const Image::BitmapData da (a, Image::BitmapData::readOnly);
+        const Image::BitmapData db (b, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < a.getHeight(); ++y)
+            if (memcmp (da.getLinePointer (y), db.getLinePointer (y), (size_t) (a.getWidth() * da.pixelStride)) != 0)
+                return false;
+
+        return true;
+    }
+
+    static Image render (const Image::PixelFormat format, const int fill, const Image& source, const int numRepeats, double& megapixelsPerSecond)
+    {
+        Image image (format, width, height, false);
+        image.clear (image.getBounds(), Colours::grey.withAlpha (0.5f));
+        double bestTime = 1.0e10;
+
+        for (int i = 0; i < numRepeats; ++i)
+        {
+            if (i > 0)
+                image.clear (image.getBounds(), Colours::grey.withAlpha (0.5f));
+
+            const double start = Time::getMillisecondCounterHiRes();
+
+            {
+                Graphics g (image);
+                drawFill (g, fill, source);
+            }
+
+            bestTime = jmin (bestTime, Time::getMillisecondCounterHiRes() - start);
+        }
+
+        megapixelsPerSecond = (width * height) / (jmax (0.001, bestTime) * 1000.0);
+        return image;
+    }
+
+    void runTest()
+    {
+        const Image source (createSourceImage());
+        const Image::PixelFormat formats[] = { Image::ARGB, Image::RGB, Image::SingleChannel };
+        const char* const formatNames[] = { "ARGB", "RGB", "SingleChannel" };
+
+        for (int fill = 0; fill < 6; ++fill)
+        {
+            beginTest (getFillName (fill));
+
+            for (int format = 0; format < 3; ++format)
+            {
+                double scalarSpeed, vectorSpeed;
+
+                RenderingHelpers::SpanBlenders::setEnabled (false);
+                const Image scalar (render (formats[format], fill, source, 3, scalarSpeed));
+
+                RenderingHelpers::SpanBlenders::setEnabled (true);
+                const Image vector (render (formats[format], fill, source, 3, vectorSpeed));
+
+                expect (imagesAreIdentical (scalar, vector));
+
+                logMessage (String (formatNames[format]) + ": scalar " + String (scalarSpeed, 1)
+                              + " Mpixels/s, vectorised " + String (vectorSpeed, 1) + " Mpixels/s");
+            }
+        }
+    }
+};
+
+static SpanBlendersTests spanBlendersTests;
+
+//==============================================================================
+class GlyphCacheTests  : public UnitTest
+{
+public:
+    GlyphCacheTests()  : UnitTest ("GlyphCache") {}
+
+    struct Target
+    {
+        Target() : glyph (-1) {}
+
+        Font font;
+        int glyph;
+    };
+
+    // A glyph that counts how many of its kind exist, so that the tests can see when the
+    // cache's references to them have really gone
+    class TestGlyph  : public ReferenceCountedObject
+    {
+    public:
+        TestGlyph() : glyph (0)     { ++getNumLive(); }
+        ~TestGlyph()                { --getNumLive(); }
+
+        typedef ReferenceCountedObjectPtr<TestGlyph> Ptr;
+
+        void generate (const Font& f, const int glyphNumber)    { font = f; glyph = glyphNumber; ++getNumGenerated(); }
+        void draw (Target& target, Point<float>) const          { target.font = font; target.glyph = glyph; }
+        bool matches (const Font& f, const int glyphNumber) const noexcept  { return glyph == glyphNumber && font == f; }
+        size_t getMemoryUsage() const noexcept                  { return glyphSize; }
+
+        static Atomic<int>& getNumLive() noexcept               { static Atomic<int> n; return n; }
+        static Atomic<int>& getNumGenerated() noexcept          { static Atomic<int> n; return n; }
+
+        enum { glyphSize = 100 };
+
+    private:
+        Font font;
+        int glyph;
+    };
+
+    typedef RenderingHelpers::GlyphCache<TestGlyph, Target> CacheType;
+
+    // Draws a glyph, waits until it's told to carry on, then draws it again
+    class DrawingThread  : public Thread
+    {
+    public:
+        DrawingThread (CacheType& c, const int g)
+            : Thread ("GlyphCache test"), cache (c), glyph (g), secondDrawWasCorrect (false)
+        {
+        }
+
+        void run() override
+        {
+            Target target;
+            cache.drawGlyph (target, Font(), glyph, Point<float>());
+            firstDrawDone.signal();
+
+            carryOn.wait();
+
+            if (! threadShouldExit())
+            {
+                cache.drawGlyph (target, Font(), glyph, Point<float>());
+                secondDrawWasCorrect = (target.glyph == glyph);
+            }
+        }
+
+        CacheType& cache;
+        const int glyph;
+        WaitableEvent firstDrawDone, carryOn;
+        bool secondDrawWasCorrect;
+    };
+
+    void runTest()
+    {
+        beginTest ("Hashing");
+
+        {
+            const Font font (14.0f);
+            expect (CacheType::getHashCode (font, 65) == CacheType::getHashCode (Font (14.0f), 65));
+
+            // consecutive glyph numbers should all land in different front-cache slots..
+            BigInteger slotsUsed;
+
+            for (int i = 0; i < 256; ++i)
+                slotsUsed.setBit (CacheType::getHashCode (font, 1000 + i) & 255);
+
+            expect (slotsUsed.countNumberOfSetBits() == 256);
+
+            SortedSet<int> hashes;
+
+            for (int height = 8; height < 72; ++height)
+                hashes.add (CacheType::getHashCode (Font ((float) height), 65));
+
+            expect (hashes.size() == 64);
+        }
+
+        beginTest ("Lookup");
+
+        {
+            CacheType cache;
+            Target target;
+            const int numGeneratedAtStart = TestGlyph::getNumGenerated().get();
+
+            cache.drawGlyph (target, Font (14.0f), 65, Point<float>());
+            cache.drawGlyph (target, Font (14.0f), 65, Point<float>());
+            expect (TestGlyph::getNumGenerated().get() == numGeneratedAtStart + 1);
+
+            // These fonts aren't equal, but the hash doesn't include the kerning, so they share a hash and a front-cache slot
+            const Font plain (14.0f), kerned (Font (14.0f).withExtraKerningFactor (0.1f));
+            expect (plain != kerned);
+            expect (CacheType::getHashCode (plain, 66) == CacheType::getHashCode (kerned, 66));
+
+            for (int i = 0; i < 4; ++i)
+            {
+                const Font& font = (i & 1) != 0 ? kerned : plain;
+                cache.drawGlyph (target, font, 66, Point<float>());
+                expect (target.glyph == 66 && target.font == font);
+            }
+
+            expect (TestGlyph::getNumGenerated().get() == numGeneratedAtStart + 3);
+            expect (cache.getMemoryUsage() == 3 * TestGlyph::glyphSize);
+        }
+
+        expect (TestGlyph::getNumLive().get() == 0);
+
+        beginTest ("Memory limit");
+
+        {
+            CacheType cache;
+            cache.setMaxMemoryUsage (10 * TestGlyph::glyphSize);
+            Target target;
+
+            for (int i = 0; i < 50; ++i)
+            {
+                cache.drawGlyph (target, Font(), i, Point<float>());
+                expect (target.glyph == i);
+                expect (cache.getMemoryUsage() <= 10 * TestGlyph::glyphSize);
+            }
+
+            // only the glyphs in the shared cache should still exist, not any that the front cache was holding..
+            expect (TestGlyph::getNumLive().get() == 10);
+
+            cache.setMaxMemoryUsage (0);
+            expect (cache.getMemoryUsage() == 0);
+            expect (TestGlyph::getNumLive().get() == 0);
+        }
+
+        beginTest ("Eviction from other threads' front caches");
+
+        {
+            CacheType cache;
+            DrawingThread thread (cache, 65);
+            thread.startThread();
+            thread.firstDrawDone.wait();
+
+            expect (TestGlyph::getNumLive().get() == 1);
+            cache.setMaxMemoryUsage (0);
+            expect (TestGlyph::getNumLive().get() == 0);
+
+            thread.carryOn.signal();
+            thread.stopThread (5000);
+            expect (thread.secondDrawWasCorrect);
+        }
+
+        beginTest ("Idle front caches are reused");
+
+        {
+            CacheType cache;
+            DrawingThread first (cache, 65);
+            first.startThread();
+            first.firstDrawDone.wait();
+            expect (cache.getNumFrontCaches() == 1);
+
+            Thread::sleep (CacheType::frontCacheIdleTimeMs + 200);
+
+            // The first thread has been idle for long enough to lose its front cache..
+            {
+                DrawingThread second (cache, 66);
+                second.startThread();
+                second.firstDrawDone.wait();
+                second.signalThreadShouldExit();
+                second.carryOn.signal();
+                second.stopThread (5000);
+            }
+
+            expect (cache.getNumFrontCaches() == 1);
+
+            // ..so now it must get another one rather than sharing the second thread's
+            first.carryOn.signal();
+            first.stopThread (5000);
+            expect (first.secondDrawWasCorrect);
+            expect (cache.getNumFrontCaches() == 2);
+        }
+
+        expect (TestGlyph::getNumLive().get() == 0);
+    }
+};
+
+static GlyphCacheTests glyphCacheTests;
+
+#endif
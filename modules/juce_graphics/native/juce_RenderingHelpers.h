@@ -131,18 +131,40 @@ public:
 };
 
 //==============================================================================
-/** Holds a cache of recently-used glyph objects of some type. */
+/** Holds a cache of recently-used glyph objects of some type.
+
+    The glyphs are kept in a hash table whose total memory use is limited, with the
+    least-recently-used ones being removed when it gets too big. Each thread also has
+    its own small front cache of glyphs that it has drawn recently, which it can use
+    without taking any locks, so that renderers running on several threads don't
+    contend with each other.
+
+    When glyphs are removed, the front caches drop their references to them too, so
+    that the memory is really freed. Idle threads' front caches are emptied straight
+    away, and busy ones empty themselves before they're next used. A front cache that
+    hasn't been used for a while is handed on to the next new thread that needs one,
+    so threads that have finished don't leave their caches behind.
+
+    The CachedGlyphType class must be a ReferenceCountedObject with a Ptr typedef, and
+    have generate(), draw(), matches() and getMemoryUsage() methods - see
+    CachedGlyphEdgeTable for an example.
+*/
 template <class CachedGlyphType, class RenderTargetType>
 class GlyphCache  : private DeletedAtShutdown
 {
 public:
     GlyphCache()
+        : instanceId (++getInstanceCounter()),
+          maxMemoryUsage (4 * 1024 * 1024), memoryUsage (0),
+          oldest (nullptr), newest (nullptr), nextTicket (0)
     {
-        addNewGlyphSlots (120);
     }
 
     ~GlyphCache()
     {
+        while (oldest != nullptr)
+            removeEntry (oldest);
+
         getSingletonPointer() = nullptr;
     }
 
@@ -159,79 +181,291 @@ public:
     //==============================================================================
     void drawGlyph (RenderTargetType& target, const Font& font, const int glyphNumber, Point<float> pos)
     {
-        ++accessCounter;
-        CachedGlyphType* glyph = nullptr;
+        const int hash = getHashCode (font, glyphNumber);
+        FrontCacheRef& ref = threadFrontCache.get();
+
+        if (ref.ownerId != instanceId || ! ref.cache->tryToUse (ref.ticket))
+            claimFrontCache (ref);
+
+        FrontCache& front = *ref.cache;
+        const int currentGeneration = generation.get();
+
+        if (front.generation != currentGeneration)
+            front.clear (currentGeneration);
+
+        typename CachedGlyphType::Ptr& slot = front.glyphs [hash & (FrontCache::numSlots - 1)];
 
-        const ScopedReadLock srl (lock);
+        if (slot == nullptr || ! slot->matches (font, glyphNumber))
+            slot = findOrCreateGlyph (font, glyphNumber, hash);
+
+        slot->draw (target, pos);
+        front.finishedUsing (ref.ticket);
+    }
+
+    /** Sets the amount of memory that the shared cache may use. */
+    void setMaxMemoryUsage (const size_t newMaxBytes)
+    {
+        const ScopedLock sl (lock);
+        maxMemoryUsage = newMaxBytes;
+        removeLeastRecentlyUsed();
+    }
+
+    /** Returns the amount of memory that the glyphs in the shared cache are using. */
+    size_t getMemoryUsage() const
+    {
+        const ScopedLock sl (lock);
+        return memoryUsage;
+    }
+
+    /** Returns the lock that's held while new glyphs are being generated.
+        Typefaces aren't thread-safe, so any other code that needs to use them from
+        several threads at once can hold this lock while it does so.
+    */
+    const CriticalSection& getLock() const noexcept     { return lock; }
+
+    /** Returns the number of front caches that have been created for threads. */
+    int getNumFrontCaches() const
+    {
+        const ScopedLock sl (lock);
+        return frontCaches.size();
+    }
+
+    /** Returns the hash code that's used to look up a glyph. */
+    static int getHashCode (const Font& font, const int glyphNumber) noexcept
+    {
+        return (int) (((uint32) glyphNumber * 31u)
+                        ^ (uint32) font.getTypefaceName().hashCode()
+                        ^ ((uint32) font.getTypefaceStyle().hashCode() * 7u)
+                        ^ ((uint32) roundToInt (font.getHeight() * 64.0f) * 101u)
+                        ^ ((uint32) roundToInt (font.getHorizontalScale() * 256.0f) * 65537u));
+    }
 
-        for (int i = glyphs.size(); --i >= 0;)
+    /** How long a thread's front cache must go unused before it can be given to another thread. */
+    enum { frontCacheIdleTimeMs = 2000 };
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        typename CachedGlyphType::Ptr glyph;
+        size_t memoryUsage;
+        int hash;
+        Entry* nextWithSameHash;
+        Entry* previous;
+        Entry* next;
+    };
+
+    // A front cache's state is 0 when it's free, 2 * ticket when it belongs to the thread
+    // holding that ticket, and 2 * ticket + 1 while something is using it. A thread can
+    // only use its cache by swapping the state from one of its own values to the other,
+    // so it'll notice if the cache has been taken away and given to another thread.
+    struct FrontCache
+    {
+        FrontCache() noexcept : generation (0) {}
+
+        enum { numSlots = 256 };
+
+        bool tryToUse (const int ticket) noexcept           { return state.compareAndSetBool (ticket * 2 + 1, ticket * 2); }
+
+        void finishedUsing (const int ticket) noexcept
+        {
+            lastUsedTime = Time::getMillisecondCounter();
+            state = ticket * 2;
+        }
+
+        void clear (const int newGeneration)
         {
-            CachedGlyphType* const g = glyphs.getUnchecked (i);
+            for (int i = 0; i < numSlots; ++i)
+                glyphs[i] = nullptr;
 
-            if (g->glyph == glyphNumber && g->font == font)
-            {
-                glyph = g;
-                ++hits;
-                break;
-            }
+            generation = newGeneration;
+        }
+
+        typename CachedGlyphType::Ptr glyphs [numSlots];
+        Atomic<int> state;
+        Atomic<uint32> lastUsedTime;
+        int generation;
+
+        JUCE_DECLARE_NON_COPYABLE (FrontCache)
+    };
+
+    // This needs to be a POD type so that it can live in thread-local storage. The
+    // instance ID makes sure that a thread can't use a front cache that belonged to
+    // an earlier instance of the glyph cache.
+    struct FrontCacheRef
+    {
+        FrontCache* cache;
+        int ownerId, ticket;
+    };
+
+    const int instanceId;
+    HashMap<int, Entry*> entries;
+    OwnedArray<FrontCache> frontCaches;
+    ThreadLocalValue<FrontCacheRef> threadFrontCache;
+    CriticalSection lock;
+    size_t maxMemoryUsage, memoryUsage;
+    Entry* oldest;
+    Entry* newest;
+    Atomic<int> generation;
+    int nextTicket;
+
+    // Gives the calling thread a front cache, either a free one, one that's been left
+    // idle for long enough that its thread has probably gone, or a new one.
+    void claimFrontCache (FrontCacheRef& ref)
+    {
+        const ScopedLock sl (lock);
+
+        // (the thread's own cache may just have been busy being emptied)
+        if (ref.ownerId == instanceId && ref.cache->tryToUse (ref.ticket))
+            return;
+
+        const uint32 now = Time::getMillisecondCounter();
+        FrontCache* cache = nullptr;
+
+        for (int i = 0; i < frontCaches.size() && cache == nullptr; ++i)
+        {
+            FrontCache* const c = frontCaches.getUnchecked (i);
+            const int state = c->state.get();
+
+            if (state == 0
+                 || ((state & 1) == 0 && now - c->lastUsedTime.get() > (uint32) frontCacheIdleTimeMs
+                      && c->state.compareAndSetBool (0, state)))
+                cache = c;
         }
 
-        if (glyph == nullptr)
+        if (cache == nullptr)
+            cache = frontCaches.add (new FrontCache());
+
+        nextTicket = (nextTicket % 0x3fffffff) + 1;
+        cache->clear (generation.get());
+        cache->state = nextTicket * 2 + 1;
+
+        ref.cache = cache;
+        ref.ownerId = instanceId;
+        ref.ticket = nextTicket;
+    }
+
+    // Empties all the front caches that aren't in use, and makes the others empty
+    // themselves before they're next used.
+    void releaseFrontCacheGlyphs()
+    {
+        ++generation;
+
+        for (int i = frontCaches.size(); --i >= 0;)
         {
-            ++misses;
-            const ScopedWriteLock swl (lock);
+            FrontCache* const c = frontCaches.getUnchecked (i);
+            const int state = c->state.get();
 
-            if (hits.value + misses.value > glyphs.size() * 16)
+            if (state != 0 && (state & 1) == 0 && c->state.compareAndSetBool (state + 1, state))
             {
-                if (misses.value * 2 > hits.value)
-                    addNewGlyphSlots (32);
-
-                hits.set (0);
-                misses.set (0);
-                glyph = glyphs.getLast();
+                c->clear (generation.get());
+                c->state = state;
             }
-            else
+        }
+    }
+
+    typename CachedGlyphType::Ptr findOrCreateGlyph (const Font& font, const int glyphNumber, const int hash)
+    {
+        const ScopedLock sl (lock);
+
+        for (Entry* e = entries [hash]; e != nullptr; e = e->nextWithSameHash)
+        {
+            if (e->glyph->matches (font, glyphNumber))
             {
-                glyph = findLeastRecentlyUsedGlyph();
+                moveToNewest (e);
+                return e->glyph;
             }
-
-            jassert (glyph != nullptr);
-            glyph->generate (font, glyphNumber);
         }
 
-        glyph->lastAccessCount = accessCounter.value;
-        glyph->draw (target, pos);
+        // Glyphs are generated while the lock is held, because the typefaces aren't thread-safe
+        Entry* const e = new Entry();
+        e->glyph = new CachedGlyphType();
+        e->glyph->generate (font, glyphNumber);
+        e->memoryUsage = e->glyph->getMemoryUsage();
+        e->hash = hash;
+        e->nextWithSameHash = entries [hash];
+        entries.set (hash, e);
+
+        e->next = nullptr;
+        e->previous = newest;
+        linkIn (e);
+
+        memoryUsage += e->memoryUsage;
+
+        const typename CachedGlyphType::Ptr glyph (e->glyph);
+        removeLeastRecentlyUsed();
+        return glyph;
     }
 
-private:
-    friend struct ContainerDeletePolicy<CachedGlyphType>;
-    OwnedArray<CachedGlyphType> glyphs;
-    Atomic<int> accessCounter, hits, misses;
-    ReadWriteLock lock;
+    void linkIn (Entry* const e) noexcept
+    {
+        if (newest != nullptr)
+            newest->next = e;
+        else
+            oldest = e;
 
-    void addNewGlyphSlots (int num)
+        newest = e;
+    }
+
+    void unlink (Entry* const e) noexcept
+    {
+        if (e->previous != nullptr)  e->previous->next = e->next;
+        else                         oldest = e->next;
+
+        if (e->next != nullptr)      e->next->previous = e->previous;
+        else                         newest = e->previous;
+    }
+
+    void moveToNewest (Entry* const e) noexcept
     {
-        while (--num >= 0)
-            glyphs.add (new CachedGlyphType());
+        if (e != newest)
+        {
+            unlink (e);
+            e->next = nullptr;
+            e->previous = newest;
+            linkIn (e);
+        }
     }
 
-    CachedGlyphType* findLeastRecentlyUsedGlyph() const noexcept
+    void removeEntry (Entry* const e)
     {
-        CachedGlyphType* oldest = glyphs.getLast();
-        int oldestCounter = oldest->lastAccessCount;
+        unlink (e);
 
-        for (int i = glyphs.size() - 1; --i >= 0;)
+        Entry* const first = entries [e->hash];
+
+        if (first == e)
         {
-            CachedGlyphType* const glyph = glyphs.getUnchecked(i);
+            if (e->nextWithSameHash != nullptr)
+                entries.set (e->hash, e->nextWithSameHash);
+            else
+                entries.remove (e->hash);
+        }
+        else
+        {
+            Entry* prev = first;
 
-            if (glyph->lastAccessCount <= oldestCounter)
-            {
-                oldestCounter = glyph->lastAccessCount;
-                oldest = glyph;
-            }
+            while (prev->nextWithSameHash != e)
+                prev = prev->nextWithSameHash;
+
+            prev->nextWithSameHash = e->nextWithSameHash;
         }
 
-        return oldest;
+        memoryUsage -= e->memoryUsage;
+        delete e;
+    }
+
+    void removeLeastRecentlyUsed()
+    {
+        bool anyHeldByFrontCaches = false;
+
+        while (oldest != nullptr && memoryUsage > maxMemoryUsage)
+        {
+            anyHeldByFrontCaches = anyHeldByFrontCaches || oldest->glyph->getReferenceCount() > 1;
+            removeEntry (oldest);
+        }
+
+        if (anyHeldByFrontCaches)
+            releaseFrontCacheGlyphs();
     }
 
     static GlyphCache*& getSingletonPointer() noexcept
@@ -240,16 +474,24 @@ private:
         return g;
     }
 
+    static Atomic<int>& getInstanceCounter() noexcept
+    {
+        static Atomic<int> counter;
+        return counter;
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GlyphCache)
 };
 
 //==============================================================================
 /** Caches a glyph as an edge-table. */
 template <class RendererType>
-class CachedGlyphEdgeTable
+class CachedGlyphEdgeTable  : public ReferenceCountedObject
 {
 public:
-    CachedGlyphEdgeTable() : glyph (0), lastAccessCount (0) {}
+    CachedGlyphEdgeTable() : glyph (0), snapToIntegerCoordinate (false) {}
+
+    typedef ReferenceCountedObjectPtr<CachedGlyphEdgeTable> Ptr;
 
     void draw (RendererType& state, Point<float> pos) const
     {
@@ -274,10 +516,23 @@ public:
                                                                     .translated (0.0f, -0.5f)
                                                                   #endif
                                                     );
+
+        if (edgeTable != nullptr && edgeTable->getMaximumBounds().getHeight() > 0)
+            edgeTable->optimiseTable();
+    }
+
+    bool matches (const Font& f, const int glyphNumber) const noexcept
+    {
+        return glyph == glyphNumber && font == f;
+    }
+
+    size_t getMemoryUsage() const noexcept
+    {
+        return sizeof (*this) + (edgeTable != nullptr ? edgeTable->getMemoryUsage() : 0);
     }
 
     Font font;
-    int glyph, lastAccessCount;
+    int glyph;
     bool snapToIntegerCoordinate;
 
 private:
@@ -543,10 +798,72 @@ namespace GradientPixelIterators
     do { dest->op; dest = addBytesToPointer (dest, destStride); } while (--width > 0); \
 }
 
+//==============================================================================
+/** Vectorised blending functions for runs of contiguous pixels.
+
+    Each function blends as many pixels as it can from the start of the run and returns
+    the number it has done, leaving the caller to finish off any remaining pixels in the
+    normal way. If the CPU has no suitable instructions, they just return 0. The results
+    are exactly the same as those of the scalar PixelARGB, PixelRGB and PixelAlpha blend()
+    methods.
+*/
+namespace SpanBlenders
+{
+    /** Blends a premultiplied colour over a run of pixels. */
+    JUCE_API int blendSolidColour (PixelARGB* dest, PixelARGB colour, int numPixels) noexcept;
+    /** Blends a premultiplied colour over a run of pixels. */
+    JUCE_API int blendSolidColour (PixelRGB* dest, PixelARGB colour, int numPixels) noexcept;
+    /** Blends a premultiplied colour over a run of pixels. */
+    JUCE_API int blendSolidColour (PixelAlpha* dest, PixelARGB colour, int numPixels) noexcept;
+
+    /** Blends a run of source pixels over the destination, using the same extra alpha
+        as PixelARGB::blend (src, extraAlpha), i.e. 0 to 0x100, where 0x100 is opaque.
+    */
+    JUCE_API int blendPixels (PixelARGB* dest, const PixelARGB* src, int numPixels, uint32 extraAlpha) noexcept;
+
+    /** Lets the vectorised code be turned off, so that its speed and results can be
+        compared with the scalar versions.
+    */
+    JUCE_API void setEnabled (bool shouldBeEnabled) noexcept;
+}
+
 //==============================================================================
 /** Contains classes for filling edge tables with various fill types. */
 namespace EdgeTableFillers
 {
+    /** Blends a run of source pixels onto a destination line. */
+    template <class DestPixelType, class SrcPixelType>
+    forcedinline void blendPixelRun (DestPixelType* dest, const int destStride,
+                                     const SrcPixelType* src, const int srcStride,
+                                     int width, const uint32 extraAlpha) noexcept
+    {
+        do
+        {
+            dest->blend (*src, extraAlpha);
+            dest = addBytesToPointer (dest, destStride);
+            src = addBytesToPointer (src, srcStride);
+        } while (--width > 0);
+    }
+
+    forcedinline void blendPixelRun (PixelARGB* dest, const int destStride,
+                                     const PixelARGB* src, const int srcStride,
+                                     int width, const uint32 extraAlpha) noexcept
+    {
+        if (destStride == sizeof (PixelARGB) && srcStride == sizeof (PixelARGB))
+        {
+            const int numDone = SpanBlenders::blendPixels (dest, src, width, extraAlpha);
+
+            if (numDone >= width)
+                return;
+
+            dest += numDone;
+            src += numDone;
+            width -= numDone;
+        }
+
+        blendPixelRun<PixelARGB, PixelARGB> (dest, destStride, src, srcStride, width, extraAlpha);
+    }
+
     /** Fills an edge-table with a solid colour. */
     template <class PixelType, bool replaceExisting = false>
     class SolidColour
@@ -624,6 +941,17 @@ namespace EdgeTableFillers
 
         inline void blendLine (PixelType* dest, const PixelARGB colour, int width) const noexcept
         {
+            if (destData.pixelStride == sizeof (PixelType))
+            {
+                const int numDone = SpanBlenders::blendSolidColour (dest, colour, width);
+
+                if (numDone >= width)
+                    return;
+
+                dest += numDone;
+                width -= numDone;
+            }
+
             JUCE_PERFORM_PIXEL_OP_LOOP (blend (colour))
         }
 
@@ -722,15 +1050,14 @@ namespace EdgeTableFillers
             PixelType* dest = getPixel (x);
 
             if (alphaLevel < 0xff)
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++), (uint32) alphaLevel))
+                blendLine (dest, x, width, (uint32) alphaLevel);
             else
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++)))
+                blendLine (dest, x, width, 0x100);
         }
 
         void handleEdgeTableLineFull (int x, int width) const noexcept
         {
-            PixelType* dest = getPixel (x);
-            JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++)))
+            blendLine (getPixel (x), x, width, 0x100);
         }
 
     private:
@@ -742,6 +1069,30 @@ namespace EdgeTableFillers
             return addBytesToPointer (linePixels, x * destData.pixelStride);
         }
 
+        template <class DestPixelType>
+        forcedinline void blendLine (DestPixelType* dest, int x, int width, const uint32 extraAlpha) const noexcept
+        {
+            JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++), extraAlpha))
+        }
+
+        void blendLine (PixelARGB* dest, int x, int width, const uint32 extraAlpha) const noexcept
+        {
+            // generate the gradient in chunks, so that each chunk can be blended as a run
+            PixelARGB span [128];
+
+            while (width > 0)
+            {
+                const int num = jmin (width, (int) numElementsInArray (span));
+
+                for (int i = 0; i < num; ++i)
+                    span[i] = GradientType::getPixel (x++);
+
+                blendPixelRun (dest, destData.pixelStride, span, (int) sizeof (PixelARGB), num, extraAlpha);
+                dest = addBytesToPointer (dest, num * destData.pixelStride);
+                width -= num;
+            }
+        }
+
         JUCE_DECLARE_NON_COPYABLE (Gradient)
     };
 
@@ -797,7 +1148,10 @@ namespace EdgeTableFillers
 
             if (alphaLevel < 0xfe)
             {
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (repeatPattern ? (x++ % srcData.width) : x++), (uint32) alphaLevel))
+                if (repeatPattern)
+                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width), (uint32) alphaLevel))
+                else
+                    blendPixelRun (dest, destData.pixelStride, getSrcPixel (x), srcData.pixelStride, width, (uint32) alphaLevel);
             }
             else
             {
@@ -817,7 +1171,10 @@ namespace EdgeTableFillers
 
             if (extraAlpha < 0xfe)
             {
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (repeatPattern ? (x++ % srcData.width) : x++), (uint32) extraAlpha))
+                if (repeatPattern)
+                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width), (uint32) extraAlpha))
+                else
+                    blendPixelRun (dest, destData.pixelStride, getSrcPixel (x), srcData.pixelStride, width, (uint32) extraAlpha);
             }
             else
             {
@@ -860,21 +1217,9 @@ namespace EdgeTableFillers
         forcedinline void copyRow (DestPixelType* dest, SrcPixelType const* src, int width) const noexcept
         {
             if (srcData.pixelStride == 3 && destData.pixelStride == 3)
-            {
                 memcpy (dest, src, sizeof (PixelRGB) * (size_t) width);
-            }
             else
-            {
-                const int destStride = destData.pixelStride;
-                const int srcStride = srcData.pixelStride;
-
-                do
-                {
-                    dest->blend (*src);
-                    dest = addBytesToPointer (dest, destStride);
-                    src = addBytesToPointer (src, srcStride);
-                } while (--width > 0);
-            }
+                blendPixelRun (dest, destData.pixelStride, src, srcData.pixelStride, width, 0x100);
         }
 
         JUCE_DECLARE_NON_COPYABLE (ImageFill)
@@ -939,10 +1284,8 @@ namespace EdgeTableFillers
             alphaLevel *= extraAlpha;
             alphaLevel >>= 8;
 
-            if (alphaLevel < 0xfe)
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (*span++, (uint32) alphaLevel))
-            else
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (*span++))
+            blendPixelRun (dest, destData.pixelStride, span, (int) sizeof (SrcPixelType),
+                           width, alphaLevel < 0xfe ? (uint32) alphaLevel : 0x100u);
         }
 
         forcedinline void handleEdgeTableLineFull (const int x, int width) noexcept
@@ -2213,6 +2556,25 @@ public:
             fillShape (new EdgeTableRegionType (clip->getClipBounds(), path, transform.getTransformWith (t)), false);
     }
 
+    void fillPreparedPath (const PreparedPath& path, const AffineTransform& t)
+    {
+        if (clip != nullptr)
+        {
+            const float accuracy = transform.getPhysicalPixelScaleFactor();
+            const AffineTransform deviceTransform (transform.getTransform());
+            const Rectangle<int> clipBounds (clip->getClipBounds());
+
+            // Copying a cached table that's much taller than the clip region would be
+            // slower than just rasterising the part of the path that's visible..
+            const Rectangle<float> roughBounds (path.getPath().getBoundsTransformed (t.followedBy (deviceTransform)));
+
+            if (roughBounds.getHeight() <= jmax (256, clipBounds.getHeight() * 4))
+                fillShape (new EdgeTableRegionType (path.getEdgeTable (t, accuracy, deviceTransform)), false);
+            else
+                fillShape (new EdgeTableRegionType (clipBounds, path.getOutline (t, accuracy), deviceTransform), false);
+        }
+    }
+
     void fillEdgeTable (const EdgeTable& edgeTable, const float x, const int y)
     {
         if (clip != nullptr)
@@ -2583,6 +2945,7 @@ public:
     void setInterpolationQuality (Graphics::ResamplingQuality quality) override  { stack->interpolationQuality = quality; }
     void fillRect (const Rectangle<int>& r, bool replace) override               { stack->fillRect (r, replace); }
     void fillPath (const Path& path, const AffineTransform& t) override          { stack->fillPath (path, t); }
+    void fillPreparedPath (const PreparedPath& p, const AffineTransform& t) override { stack->fillPreparedPath (p, t); }
     void drawImage (const Image& im, const AffineTransform& t) override          { stack->drawImage (im, t); }
     void drawVerticalLine (int x, float top, float bottom) override              { if (top < bottom) stack->fillRect (Rectangle<float> ((float) x, top, 1.0f, bottom - top)); }
     void drawHorizontalLine (int y, float left, float right) override            { if (left < right) stack->fillRect (Rectangle<float> (left, (float) y, right - left, 1.0f)); }
@@ -417,6 +417,25 @@ struct Component::ComponentHelpers
 
         return Desktop::getInstance().getDisplays().getMainDisplay().userArea;
     }
+
+    static void repaintInParentOrPeer (Component& comp, const Rectangle<int>& area)
+    {
+        if (comp.flags.hasHeavyweightPeerFlag)
+        {
+            // if component methods are being called from threads other than the message
+            // thread, you'll need to use a MessageManagerLock object to make sure it's thread-safe.
+            CHECK_MESSAGE_MANAGER_IS_LOCKED
+
+            if (ComponentPeer* const peer = comp.getPeer())
+                peer->repaint (scaledScreenPosToUnscaled (comp, comp.affineTransform != nullptr ? area.transformedBy (*comp.affineTransform)
+                                                                                                  : area));
+        }
+        else
+        {
+            if (comp.parentComponent != nullptr)
+                comp.parentComponent->internalRepaint (convertToParentSpace (comp, area));
+        }
+    }
 };
 
 //==============================================================================
@@ -814,17 +833,442 @@ void Component::setCachedComponentImage (CachedComponentImage* newCachedImage)
     }
 }
 
+//==============================================================================
+/*  The CachedComponentImage used by the layer compositor.
+
+    A layer caches its component and children in an image, like StandardCachedComponentImage.
+    Any layers further down its subtree that have nothing painted over them are left out of
+    that image ("deferred") and are drawn on top of it after it has been blitted, so that
+    repainting one of them goes straight to the peer without invalidating any of the images
+    that it's composited over.
+
+    The root layer (installed by setLayerCompositingEnabled) also keeps a decaying count of
+    how often each of its descendants gets repainted, and uses it at the start of each frame
+    to promote busy components to automatic layers, and to demote ones that have gone quiet.
+*/
+class ComponentLayer  : public CachedComponentImage
+{
+public:
+    enum LayerType
+    {
+        rootLayer,
+        explicitLayer,
+        automaticLayer
+    };
+
+    ComponentLayer (Component& c, LayerType t) noexcept
+        : type (t), owner (c), scale (1.0f), compositingLayer (nullptr)
+    {
+        if (type == rootLayer)
+            ++numCompositingRoots;
+    }
+
+    ~ComponentLayer()
+    {
+        for (int i = deferredLayers.size(); --i >= 0;)
+            if (Component* const c = deferredLayers.getReference (i))
+                if (ComponentLayer* const layer = getLayer (*c))
+                    if (layer->compositingLayer == this)
+                        layer->compositingLayer = nullptr;
+
+        if (type == rootLayer)
+            --numCompositingRoots;
+    }
+
+    static ComponentLayer* getLayer (const Component& c) noexcept
+    {
+        return dynamic_cast <ComponentLayer*> (c.cachedImage.get());
+    }
+
+    //==============================================================================
+    void paint (Graphics& g) override
+    {
+        // If this layer is being composited by the layer that's currently rendering its
+        // image, then it'll get drawn later on, over the top of that image.
+        if (compositingLayer != nullptr && compositingLayer == currentlyRenderingLayer)
+            return;
+
+        if (type == rootLayer)
+            updateAutomaticLayers();
+
+        scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+        Array<Component*> layersToComposite;
+
+        if (owner.effect == nullptr && (owner.componentTransparency == 0 || owner.isOnDesktop()))
+            findLayersToComposite (owner, layersToComposite);
+
+        updateDeferredLayers (layersToComposite);
+        renderImage();
+
+        const Rectangle<int> compBounds (owner.getLocalBounds());
+
+        g.setColour (Colours::black.withAlpha (owner.isOnDesktop() ? 1.0f : owner.getAlpha()));
+        g.drawImage (image, 0, 0, compBounds.getWidth(), compBounds.getHeight(),
+                     0, 0, image.getWidth(), image.getHeight(), false);
+
+        for (int i = 0; i < layersToComposite.size(); ++i)
+        {
+            Component& c = *layersToComposite.getUnchecked (i);
+
+            g.saveState();
+
+            if (clipToComponent (g, c))
+                c.cachedImage->paint (g);
+
+            g.restoreState();
+        }
+    }
+
+    bool invalidateAll() override
+    {
+        validArea.clear();
+        return ! redirectRepaint (owner.getLocalBounds());
+    }
+
+    bool invalidate (const Rectangle<int>& area) override
+    {
+        validArea.subtract (toImageSpace (area));
+        return ! redirectRepaint (area);
+    }
+
+    void releaseResources() override
+    {
+        image = Image::null;
+        validArea.clear();
+        compositingLayer = nullptr;
+    }
+
+    //==============================================================================
+    static void noteRepaint (Component& c)
+    {
+        if (numCompositingRoots > 0)
+        {
+            for (Component* p = c.parentComponent; p != nullptr; p = p->parentComponent)
+            {
+                if (p->flags.layerCompositingFlag)
+                {
+                    if (ComponentLayer* const root = getLayer (*p))
+                        root->addRepaint (c);
+
+                    break;
+                }
+            }
+        }
+    }
+
+    const LayerType type;
+
+private:
+    Image image;
+    RectangleList<int> validArea;
+    Component& owner;
+    float scale;
+
+    ComponentLayer* compositingLayer;
+    Array<WeakReference<Component> > deferredLayers;
+
+    struct RepaintHistory
+    {
+        RepaintHistory (Component& c) noexcept
+            : key (&c), component (&c), score (0), repaintedThisFrame (true)
+        {
+        }
+
+        Component* const key; // (only used to look up the entry, as the component may have been deleted)
+        WeakReference<Component> component;
+        float score;
+        bool repaintedThisFrame;
+
+        JUCE_DECLARE_NON_COPYABLE (RepaintHistory)
+    };
+
+    struct ComponentPointerHash
+    {
+        int generateHash (Component* const key, const int upperLimit) const noexcept
+        {
+            return (int) ((((pointer_sized_uint) key) >> 4) % (pointer_sized_uint) upperLimit);
+        }
+    };
+
+    OwnedArray<RepaintHistory> history;
+    HashMap<Component*, RepaintHistory*, ComponentPointerHash> historyIndex;
+
+    static int numCompositingRoots;
+    static ComponentLayer* currentlyRenderingLayer;
+
+    Rectangle<int> toImageSpace (const Rectangle<int>& area) const
+    {
+        return (area.toFloat() * scale).getSmallestIntegerContainer();
+    }
+
+    void renderImage()
+    {
+        const Rectangle<int> imageBounds (owner.getLocalBounds() * scale);
+
+        if (image.isNull() || image.getBounds() != imageBounds)
+        {
+            image = Image (owner.isOpaque() ? Image::RGB
+                                            : Image::ARGB,
+                           jmax (1, imageBounds.getWidth()),
+                           jmax (1, imageBounds.getHeight()),
+                           ! owner.isOpaque());
+
+            validArea.clear();
+        }
+
+        {
+            Graphics imG (image);
+            LowLevelGraphicsContext& lg = imG.getInternalContext();
+
+            for (const Rectangle<int>* i = validArea.begin(), * const e = validArea.end(); i != e; ++i)
+                lg.excludeClipRectangle (*i);
+
+            if (! lg.isClipEmpty())
+            {
+                if (! owner.isOpaque())
+                {
+                    lg.setFill (Colours::transparentBlack);
+                    lg.fillRect (imageBounds, true);
+                    lg.setFill (Colours::black);
+                }
+
+                lg.addTransform (AffineTransform::scale (scale));
+
+                const ScopedValueSetter<ComponentLayer*> renderingLayerSetter (currentlyRenderingLayer, this);
+                owner.paintEntireComponent (imG, true);
+            }
+        }
+
+        validArea = imageBounds;
+    }
+
+    //==============================================================================
+    // A repaint of a deferred layer is sent straight to whatever displays the layer that
+    // ultimately composites it, bypassing the images of the layers it's drawn over.
+    bool redirectRepaint (Rectangle<int> area) const
+    {
+        if (compositingLayer == nullptr)
+            return false;
+
+        Component* c = &owner;
+
+        for (const ComponentLayer* layer = compositingLayer; layer != nullptr; layer = layer->compositingLayer)
+        {
+            for (; c != &(layer->owner); c = c->parentComponent)
+            {
+                if (c == nullptr)
+                    return false;
+
+                if (! c->flags.visibleFlag)
+                    return true;
+
+                area = Component::ComponentHelpers::convertToParentSpace (*c, area);
+            }
+        }
+
+        if (c->flags.visibleFlag)
+            Component::ComponentHelpers::repaintInParentOrPeer (*c, area.getIntersection (c->getLocalBounds()));
+
+        return true;
+    }
+
+    // Finds the layers in the subtree that can be drawn over this layer's image rather than
+    // into it: only components that nothing else is painted on top of qualify.
+    static void findLayersToComposite (Component& parent, Array<Component*>& result)
+    {
+        const Array<Component*>& children = parent.childComponentList;
+
+        for (int i = 0; i < children.size(); ++i)
+        {
+            Component& child = *children.getUnchecked (i);
+
+            if (child.flags.visibleFlag
+                 && ! child.flags.dontClipGraphicsFlag
+                 && ! isOverlappedByLaterSibling (children, i))
+            {
+                if (child.cachedImage != nullptr)
+                {
+                    if (getLayer (child) != nullptr)
+                        result.add (&child);
+                }
+                else if (child.effect == nullptr && child.componentTransparency == 0)
+                {
+                    findLayersToComposite (child, result);
+                }
+            }
+        }
+    }
+
+    static bool isOverlappedByLaterSibling (const Array<Component*>& children, const int index)
+    {
+        const Rectangle<int> area (children.getUnchecked (index)->getBoundsInParent());
+
+        for (int i = index + 1; i < children.size(); ++i)
+        {
+            const Component& sibling = *children.getUnchecked (i);
+
+            if (sibling.flags.visibleFlag
+                 && (sibling.flags.dontClipGraphicsFlag || sibling.getBoundsInParent().intersects (area)))
+                return true;
+        }
+
+        return false;
+    }
+
+    void updateDeferredLayers (const Array<Component*>& newLayers)
+    {
+        for (int i = deferredLayers.size(); --i >= 0;)
+        {
+            if (Component* const c = deferredLayers.getReference (i))
+            {
+                if (! newLayers.contains (c))
+                {
+                    if (ComponentLayer* const layer = getLayer (*c))
+                        if (layer->compositingLayer == this)
+                            layer->compositingLayer = nullptr;
+
+                    // this layer's image doesn't contain the component, so needs redrawing there..
+                    validArea.subtract (toImageSpace (owner.getLocalArea (c, c->getLocalBounds())));
+                }
+            }
+        }
+
+        deferredLayers.clearQuick();
+
+        for (int i = 0; i < newLayers.size(); ++i)
+        {
+            Component& c = *newLayers.getUnchecked (i);
+            ComponentLayer& layer = *getLayer (c);
+
+            if (layer.compositingLayer != this)
+            {
+                layer.compositingLayer = this;
+                validArea.subtract (toImageSpace (owner.getLocalArea (&c, c.getLocalBounds())));
+            }
+
+            deferredLayers.add (&c);
+        }
+    }
+
+    bool clipToComponent (Graphics& g, Component& c) const
+    {
+        if (&c == &owner)
+            return true;
+
+        if (c.parentComponent == nullptr || ! clipToComponent (g, *c.parentComponent))
+            return false;
+
+        if (c.affineTransform != nullptr)
+            g.addTransform (*c.affineTransform);
+
+        if (! g.reduceClipRegion (c.getBounds()))
+            return false;
+
+        g.setOrigin (c.getX(), c.getY());
+        return true;
+    }
+
+    //==============================================================================
+    void addRepaint (Component& c)
+    {
+        if (RepaintHistory* const h = historyIndex [&c])
+        {
+            if (h->component != &c)
+            {
+                // the entry belonged to a deleted component which had the same address
+                h->component = &c;
+                h->score = 0;
+            }
+
+            h->repaintedThisFrame = true;
+        }
+        else
+        {
+            historyIndex.set (&c, history.add (new RepaintHistory (c)));
+        }
+    }
+
+    void removeHistory (const int index)
+    {
+        historyIndex.remove (history.getUnchecked (index)->key);
+        history.swap (index, history.size() - 1);
+        history.removeLast();
+    }
+
+    void updateAutomaticLayers()
+    {
+        const float promotionThreshold = 3.0f;  // roughly five consecutive frames
+        const float demotionThreshold  = 0.1f;
+        const int maxLayerArea = owner.getWidth() * owner.getHeight() / 2;
+
+        for (int i = history.size(); --i >= 0;)
+        {
+            RepaintHistory& h = *history.getUnchecked (i);
+            Component* const c = h.component;
+
+            if (c == nullptr || ! owner.isParentOf (c))
+            {
+                removeHistory (i);
+                continue;
+            }
+
+            h.score = h.score * 0.8f + (h.repaintedThisFrame ? 1.0f : 0.0f);
+            h.repaintedThisFrame = false;
+
+            const bool isTransformedOrTranslucent = c->isTransformed() || c->componentTransparency > 0;
+
+            if (c->cachedImage == nullptr)
+            {
+                if ((h.score > promotionThreshold || isTransformedOrTranslucent)
+                     && ! (c->flags.neverUseLayerFlag || c->flags.dontClipGraphicsFlag)
+                     && c->effect == nullptr
+                     && c->getWidth() * c->getHeight() <= maxLayerArea)
+                    c->cachedImage = new ComponentLayer (*c, automaticLayer);
+            }
+            else if (h.score < demotionThreshold && ! isTransformedOrTranslucent)
+            {
+                const ComponentLayer* const layer = getLayer (*c);
+
+                if (layer != nullptr && layer->type == automaticLayer)
+                    c->cachedImage = nullptr;
+            }
+
+            if (h.score < demotionThreshold)
+            {
+                const ComponentLayer* const layer = getLayer (*c);
+
+                if (layer == nullptr || layer->type != automaticLayer)
+                    removeHistory (i);
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ComponentLayer)
+};
+
+int ComponentLayer::numCompositingRoots = 0;
+ComponentLayer* ComponentLayer::currentlyRenderingLayer = nullptr;
+
 void Component::setBufferedToImage (const bool shouldBeBuffered)
 {
+    const ComponentLayer* const layer = ComponentLayer::getLayer (*this);
+    const bool isAutomaticLayer = (layer != nullptr && layer->type == ComponentLayer::automaticLayer);
+
     // This assertion means that this component is already using a custom CachedComponentImage,
     // so by calling setBufferedToImage, you'll be deleting the custom one - this is almost certainly
     // not what you wanted to happen... If you really do know what you're doing here, and want to
     // avoid this assertion, just call setCachedComponentImage (nullptr) before setBufferedToImage().
-    jassert (cachedImage == nullptr || dynamic_cast <StandardCachedComponentImage*> (cachedImage.get()) != nullptr);
+    jassert (cachedImage == nullptr || isAutomaticLayer
+              || dynamic_cast <StandardCachedComponentImage*> (cachedImage.get()) != nullptr);
 
     if (shouldBeBuffered)
     {
-        if (cachedImage == nullptr)
+        // (an automatic layer is replaced, as the compositor would remove it again once
+        // the component stopped repainting, and the buffering would be lost)
+        if (isAutomaticLayer)
+            setCachedComponentImage (new StandardCachedComponentImage (*this));
+        else if (cachedImage == nullptr)
             cachedImage = new StandardCachedComponentImage (*this);
     }
     else
@@ -833,6 +1277,47 @@ void Component::setBufferedToImage (const bool shouldBeBuffered)
     }
 }
 
+void Component::setLayerCompositingEnabled (const bool shouldBeEnabled)
+{
+    if (flags.layerCompositingFlag != shouldBeEnabled)
+    {
+        flags.layerCompositingFlag = shouldBeEnabled;
+        setCachedComponentImage (shouldBeEnabled ? new ComponentLayer (*this, ComponentLayer::rootLayer) : nullptr);
+    }
+}
+
+bool Component::isLayerCompositingEnabled() const noexcept
+{
+    return flags.layerCompositingFlag;
+}
+
+void Component::setLayerPolicy (const LayerPolicy newPolicy)
+{
+    flags.alwaysUseLayerFlag = (newPolicy == alwaysUseLayer);
+    flags.neverUseLayerFlag  = (newPolicy == neverUseLayer);
+
+    if (! flags.layerCompositingFlag)
+    {
+        const ComponentLayer* const layer = ComponentLayer::getLayer (*this);
+
+        if (newPolicy == alwaysUseLayer)
+        {
+            if (cachedImage == nullptr || (layer != nullptr && layer->type == ComponentLayer::automaticLayer))
+                setCachedComponentImage (new ComponentLayer (*this, ComponentLayer::explicitLayer));
+        }
+        else if (layer != nullptr && (newPolicy == neverUseLayer || layer->type == ComponentLayer::explicitLayer))
+        {
+            setCachedComponentImage (nullptr);
+        }
+    }
+}
+
+Component::LayerPolicy Component::getLayerPolicy() const noexcept
+{
+    return flags.alwaysUseLayerFlag ? alwaysUseLayer
+                                    : (flags.neverUseLayerFlag ? neverUseLayer : layerIfUseful);
+}
+
 //==============================================================================
 void Component::reorderChildInternal (const int sourceIndex, const int destIndex)
 {
@@ -1811,16 +2296,19 @@ float Component::getAlpha() const
 //==============================================================================
 void Component::repaint()
 {
+    ComponentLayer::noteRepaint (*this);
     internalRepaintUnchecked (getLocalBounds(), true);
 }
 
 void Component::repaint (const int x, const int y, const int w, const int h)
 {
+    ComponentLayer::noteRepaint (*this);
     internalRepaint (Rectangle<int> (x, y, w, h));
 }
 
 void Component::repaint (const Rectangle<int>& area)
 {
+    ComponentLayer::noteRepaint (*this);
     internalRepaint (area);
 }
 
@@ -1847,22 +2335,7 @@ void Component::internalRepaintUnchecked (const Rectangle<int>& area, const bool
                                      : cachedImage->invalidate (area)))
                 return;
 
-        if (flags.hasHeavyweightPeerFlag)
-        {
-            // if component methods are being called from threads other than the message
-            // thread, you'll need to use a MessageManagerLock object to make sure it's thread-safe.
-            CHECK_MESSAGE_MANAGER_IS_LOCKED
-
-            if (ComponentPeer* const peer = getPeer())
-                peer->repaint (ComponentHelpers::scaledScreenPosToUnscaled (*this,
-                                                                            affineTransform != nullptr ? area.transformedBy (*affineTransform)
-                                                                                                       : area));
-        }
-        else
-        {
-            if (parentComponent != nullptr)
-                parentComponent->internalRepaint (ComponentHelpers::convertToParentSpace (*this, area));
-        }
+        ComponentHelpers::repaintInParentOrPeer (*this, area);
     }
 }
 
@@ -1963,6 +2436,8 @@ void Component::paintComponentAndChildren (Graphics& g)
 
 void Component::paintEntireComponent (Graphics& g, const bool ignoreAlphaLevel)
 {
+    JUCE_TRACE_ZONE ("Component::paintEntireComponent");
+
    #if JUCE_DEBUG
     flags.isInsidePaintCall = true;
    #endif
@@ -2976,3 +3451,157 @@ bool Component::BailOutChecker::shouldBailOut() const noexcept
 {
     return safePointer == nullptr;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ComponentLayerTests  : public UnitTest
+{
+public:
+    ComponentLayerTests()  : UnitTest ("Component layers") {}
+
+    // Fills itself, with a bar across the top whose length can be changed to animate it
+    class TestComponent  : public Component
+    {
+    public:
+        TestComponent (Colour c, bool opaque)  : colour (c), level (0), numPaints (0)
+        {
+            setOpaque (opaque);
+        }
+
+        void paint (Graphics& g) override
+        {
+            ++numPaints;
+            g.setColour (colour);
+
+            if (isOpaque())
+                g.fillAll();
+            else
+                g.fillEllipse (getLocalBounds().toFloat());
+
+            g.setColour (Colours::white);
+            g.fillRect (0, 0, level, 3);
+        }
+
+        Colour colour;
+        int level, numPaints;
+    };
+
+    static void renderFrame (Component& root, Image& screen)
+    {
+        Graphics g (screen);
+        root.getCachedComponentImage()->paint (g);
+    }
+
+    static Image renderReference (Component& root)
+    {
+        Image image (Image::RGB, root.getWidth(), root.getHeight(), true);
+        Graphics g (image);
+        root.paintEntireComponent (g, true);
+        return image;
+    }
+
+    // Where a clip region's edge cuts across an anti-aliased shape, the pixels along the
+    // clip edge can come out a couple of levels different from the same shape drawn without
+    // the clip, so the frames are allowed to differ by that much.
+    static bool imagesMatch (const Image& a, const Image& b)
+    {
+        for (int y = 0; y < a.getHeight(); ++y)
+        {
+            for (int x = 0; x < a.getWidth(); ++x)
+            {
+                const Colour ca (a.getPixelAt (x, y)), cb (b.getPixelAt (x, y));
+
+                if (std::abs (ca.getRed()   - cb.getRed())   > 2
+                     || std::abs (ca.getGreen() - cb.getGreen()) > 2
+                     || std::abs (ca.getBlue()  - cb.getBlue())  > 2)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool isAutomaticLayer (const Component& c)
+    {
+        const ComponentLayer* const layer = ComponentLayer::getLayer (c);
+        return layer != nullptr && layer->type == ComponentLayer::automaticLayer;
+    }
+
+    void runTest()
+    {
+        beginTest ("Promoted layers");
+
+        TestComponent root (Colours::darkgrey, true), panel (Colours::blue, false), meter (Colours::green, true),
+                      sibling (Colours::red, false), overlay (Colours::yellow, false);
+
+        root.setBounds (0, 0, 200, 200);
+        root.setVisible (true);
+        root.addAndMakeVisible (&panel);
+        panel.setBounds (10, 10, 120, 120);
+        panel.addAndMakeVisible (&meter);
+        meter.setBounds (20, 20, 30, 60);
+        panel.addAndMakeVisible (&sibling);
+        sibling.setBounds (60, 20, 40, 40);
+        root.addAndMakeVisible (&overlay);
+        overlay.setBounds (140, 140, 30, 30);
+        root.setLayerCompositingEnabled (true);
+
+        Image screen (Image::RGB, 200, 200, true);
+
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            meter.level = frame;
+            meter.repaint();
+
+            if (frame == 12)
+                overlay.setAlpha (0.5f);
+
+            if (frame == 15)
+            {
+                // the sibling now overlaps the meter, so the meter can't be composited separately
+                sibling.setTopLeftPosition (25, 50);
+                panel.repaint();
+            }
+
+            const int numSiblingPaints = sibling.numPaints, numRootPaints = root.numPaints;
+
+            renderFrame (root, screen);
+
+            if (frame == 10)
+            {
+                // by now the meter should be a layer, and be the only thing that gets painted
+                expect (isAutomaticLayer (meter));
+                expectEquals (sibling.numPaints, numSiblingPaints);
+                expectEquals (root.numPaints, numRootPaints);
+            }
+
+            expect (imagesMatch (screen, renderReference (root)));
+        }
+
+        beginTest ("Buffering a promoted component");
+
+        // (the components aren't on the desktop, so removing one doesn't repaint its parent)
+        panel.removeChildComponent (&sibling);
+        panel.repaint();
+        renderFrame (root, screen);
+        expect (isAutomaticLayer (meter));
+
+        meter.setBufferedToImage (true);
+        expect (dynamic_cast <StandardCachedComponentImage*> (meter.getCachedComponentImage()) != nullptr);
+
+        // once it goes quiet, the compositor mustn't remove the buffering
+        for (int frame = 0; frame < 30; ++frame)
+        {
+            renderFrame (root, screen);
+            expect (imagesMatch (screen, renderReference (root)));
+        }
+
+        expect (dynamic_cast <StandardCachedComponentImage*> (meter.getCachedComponentImage()) != nullptr);
+        meter.setBufferedToImage (false);
+    }
+};
+
+static ComponentLayerTests componentLayerTests;
+
+#endif
@@ -994,6 +994,63 @@ public:
     */
     void setBufferedToImage (bool shouldBeBuffered);
 
+    //==============================================================================
+    /** Turns this component into the root of a retained-mode layer compositor.
+
+        When enabled, the component keeps its whole subtree cached in an image, and
+        watches which of its descendants are being repainted. Components that repaint
+        frequently, or that are transformed or semi-transparent, are automatically
+        promoted to layers: each layer is cached in its own image, and when nothing
+        is drawn on top of it, it's left out of its parent's image and composited over
+        it instead. So repainting a layer (e.g. an animating level meter) just redraws
+        that layer and re-composites the cached images, without calling paint() on its
+        siblings or on the parent's background.
+
+        A component that's buffered with setBufferedToImage() or has its own
+        CachedComponentImage is never promoted, and calling setBufferedToImage (true)
+        on a component that has been promoted replaces its automatic layer.
+
+        Layers that stop repainting are demoted again, and a layer can't be composited
+        separately if a later sibling overlaps it, if it paints outside its bounds, or
+        if it sits inside a component that has an effect or an alpha level. Note that
+        a separately composited layer is drawn above anything that its ancestors draw
+        in their paintOverChildren() methods.
+
+        This replaces any CachedComponentImage that the component is using.
+
+        @see setLayerPolicy, setBufferedToImage
+    */
+    void setLayerCompositingEnabled (bool shouldBeEnabled);
+
+    /** Returns true if setLayerCompositingEnabled() has been used to turn on layer compositing.
+        @see setLayerCompositingEnabled
+    */
+    bool isLayerCompositingEnabled() const noexcept;
+
+    /** Options for how a component is treated by the layer compositor.
+        @see setLayerPolicy, setLayerCompositingEnabled
+    */
+    enum LayerPolicy
+    {
+        layerIfUseful,      /**< The compositor decides whether to promote this component to a layer (the default). */
+        alwaysUseLayer,     /**< The component is always given its own layer. */
+        neverUseLayer       /**< The component is never promoted to a layer. */
+    };
+
+    /** Changes the way the layer compositor treats this component.
+
+        This only has an effect when the component is inside a component that has had
+        setLayerCompositingEnabled() called on it.
+
+        @see getLayerPolicy, setLayerCompositingEnabled
+    */
+    void setLayerPolicy (LayerPolicy newPolicy);
+
+    /** Returns the policy that was set with setLayerPolicy().
+        @see setLayerPolicy
+    */
+    LayerPolicy getLayerPolicy() const noexcept;
+
     /** Generates a snapshot of part of this component.
 
         This will return a new Image, the size of the rectangle specified,
@@ -2218,6 +2275,7 @@ public:
 private:
     //==============================================================================
     friend class ComponentPeer;
+    friend class ComponentLayer;
     friend class MouseInputSource;
     friend class MouseInputSourceInternal;
 
@@ -2266,6 +2324,9 @@ private:
         bool childCompFocusedFlag       : 1;
         bool dontClipGraphicsFlag       : 1;
         bool mouseDownWasBlocked        : 1;
+        bool layerCompositingFlag       : 1;
+        bool alwaysUseLayerFlag         : 1;
+        bool neverUseLayerFlag          : 1;
       #if JUCE_DEBUG
         bool isInsidePaintCall          : 1;
       #endif
@@ -636,6 +636,11 @@ public:
 
     ImageType* createType() const override     { return new NativeImageType(); }
 
+   #if JUCE_USE_XSHM
+    bool isUsingXShm() const noexcept                       { return usingXShm; }
+    bool usesShmSegment (ShmSeg seg) const noexcept         { return usingXShm && segmentInfo.shmseg == seg; }
+   #endif
+
     void blitToWindow (Window window, int dx, int dy, int dw, int dh, int sx, int sy)
     {
         ScopedXLock xlock;
@@ -1225,6 +1230,11 @@ public:
         repainter->performAnyPendingRepaintsNow();
     }
 
+    RepaintStatistics getRepaintStatistics() const override
+    {
+        return repainter->getStatistics();
+    }
+
     void setIcon (const Image& newIcon) override
     {
         const int dataSize = newIcon.getWidth() * newIcon.getHeight() + 2;
@@ -1324,9 +1334,16 @@ public:
             default:
                #if JUCE_USE_XSHM
                 {
-                    ScopedXLock xlock;
-                    if (event.xany.type == XShmGetEventBase (display))
-                        repainter->notifyPaintCompleted();
+                    int shmCompletionEventType;
+
+                    {
+                        ScopedXLock xlock;
+                        shmCompletionEventType = XShmGetEventBase (display) + ShmCompletion;
+                    }
+
+                    // (this may paint the next frame, so mustn't be called while holding the X lock)
+                    if (event.xany.type == shmCompletionEventType)
+                        repainter->notifyPaintCompleted (reinterpret_cast<const XShmCompletionEvent&> (event));
                 }
                #endif
                 break;
@@ -1799,10 +1816,10 @@ private:
     {
     public:
         LinuxRepaintManager (LinuxComponentPeer& p)
-            : peer (p), lastTimeImageUsed (0)
+            : peer (p), lastTimeImageUsed (0), lastFrameStartTime (0), totalFrameTimeMs (0)
         {
            #if JUCE_USE_XSHM
-            shmPaintsPending = 0;
+            shmPaintsPending[0] = shmPaintsPending[1] = 0;
 
             useARGBImagesForRendering = XSHMHelpers::isShmAvailable();
 
@@ -1823,47 +1840,61 @@ private:
 
         void timerCallback() override
         {
-           #if JUCE_USE_XSHM
-            if (shmPaintsPending != 0)
-                return;
-           #endif
-
             if (! regionsNeedingRepaint.isEmpty())
             {
-                stopTimer();
                 performAnyPendingRepaintsNow();
             }
-            else if (Time::getApproximateMillisecondCounter() > lastTimeImageUsed + 3000)
+            else if (Time::getApproximateMillisecondCounter() > lastTimeImageUsed + 3000
+                      && ! isAnyBufferBusy())
             {
                 stopTimer();
-                image = Image::null;
+                images[0] = Image::null;
+                images[1] = Image::null;
             }
         }
 
         void repaint (const Rectangle<int>& area)
         {
-            if (! isTimerRunning())
-                startTimer (repaintTimerPeriod);
-
             regionsNeedingRepaint.add (area);
+
+            if (! isTimerRunning())
+                startTimer (jmax (1, roundToInt (lastFrameStartTime + frameInterval
+                                                   - Time::getMillisecondCounterHiRes())));
         }
 
         void performAnyPendingRepaintsNow()
         {
-           #if JUCE_USE_XSHM
-            if (shmPaintsPending != 0)
+            // Frames are rendered into whichever buffer isn't still being copied to the
+            // screen. If they're both busy, we'll try again when XShm tells us that one
+            // of them has finished (or when the timer next fires).
+            const int bufferIndex = findFreeBuffer();
+
+            if (bufferIndex < 0)
             {
-                startTimer (repaintTimerPeriod);
+                ++stats.numFramesDeferred;
+                startTimer (frameInterval);
                 return;
             }
-           #endif
 
-            RectangleList<int>  originalRepaintRegion (regionsNeedingRepaint);
+            const double frameStartTime = Time::getMillisecondCounterHiRes();
+
+            // The merged regions are what gets copied to the screen, so the whole of each
+            // one has to be repainted, not just the parts that were originally dirty.
+            Array<Rectangle<int> > regionsToBlit;
+            coalesceRegions (regionsNeedingRepaint, regionsToBlit);
             regionsNeedingRepaint.clear();
+
+            RectangleList<int> originalRepaintRegion;
+
+            for (const Rectangle<int>* i = regionsToBlit.begin(), * const e = regionsToBlit.end(); i != e; ++i)
+                originalRepaintRegion.add (*i);
+
             const Rectangle<int> totalArea (originalRepaintRegion.getBounds());
 
             if (! totalArea.isEmpty())
             {
+                Image& image = images [bufferIndex];
+
                 if (image.isNull() || image.getWidth() < totalArea.getWidth()
                      || image.getHeight() < totalArea.getHeight())
                 {
@@ -1878,8 +1909,6 @@ private:
                                                      false, peer.depth, peer.visual));
                 }
 
-                startTimer (repaintTimerPeriod);
-
                 RectangleList<int> adjustedList (originalRepaintRegion);
                 adjustedList.offsetAll (-totalArea.getX(), -totalArea.getY());
 
@@ -1893,10 +1922,11 @@ private:
                     peer.handlePaint (*context);
                 }
 
-                for (const Rectangle<int>* i = originalRepaintRegion.begin(), * const e = originalRepaintRegion.end(); i != e; ++i)
+                for (const Rectangle<int>* i = regionsToBlit.begin(), * const e = regionsToBlit.end(); i != e; ++i)
                 {
                    #if JUCE_USE_XSHM
-                    ++shmPaintsPending;
+                    if (static_cast<XBitmapImage*> (image.getPixelData())->isUsingXShm())
+                        ++shmPaintsPending [bufferIndex];
                    #endif
 
                     static_cast<XBitmapImage*> (image.getPixelData())
@@ -1904,28 +1934,124 @@ private:
                                         i->getX(), i->getY(), i->getWidth(), i->getHeight(),
                                         i->getX() - totalArea.getX(), i->getY() - totalArea.getY());
                 }
+
+                {
+                    ScopedXLock xlock;
+                    XFlush (display);
+                }
+
+                const double frameTime = Time::getMillisecondCounterHiRes() - frameStartTime;
+                totalFrameTimeMs += frameTime;
+                ++stats.numFrames;
+                stats.numRegionsBlitted += regionsToBlit.size();
+                stats.averageFrameTimeMs = totalFrameTimeMs / stats.numFrames;
+                stats.maxFrameTimeMs = jmax (stats.maxFrameTimeMs, frameTime);
+
+                lastFrameStartTime = frameStartTime;
             }
 
             lastTimeImageUsed = Time::getApproximateMillisecondCounter();
-            startTimer (repaintTimerPeriod);
+            startTimer (frameInterval);
         }
 
        #if JUCE_USE_XSHM
-        void notifyPaintCompleted() noexcept        { --shmPaintsPending; }
+        void notifyPaintCompleted (const XShmCompletionEvent& event) noexcept
+        {
+            int bufferIndex = -1;
+
+            for (int i = 0; i < numElementsInArray (images); ++i)
+                if (images[i].isValid() && static_cast<XBitmapImage*> (images[i].getPixelData())->usesShmSegment (event.shmseg))
+                    bufferIndex = i;
+
+            if (bufferIndex < 0) // (this shouldn't happen, but don't risk leaving a buffer locked forever)
+                bufferIndex = shmPaintsPending[0] > 0 ? 0 : 1;
+
+            if (shmPaintsPending [bufferIndex] > 0 && --shmPaintsPending [bufferIndex] == 0
+                 && ! regionsNeedingRepaint.isEmpty()
+                 && Time::getMillisecondCounterHiRes() >= lastFrameStartTime + frameInterval)
+                performAnyPendingRepaintsNow();
+        }
        #endif
 
+        const ComponentPeer::RepaintStatistics& getStatistics() const noexcept     { return stats; }
+
     private:
-        enum { repaintTimerPeriod = 1000 / 100 };
+        enum
+        {
+            frameInterval = 1000 / 60,
+            maxRegionsPerFrame = 8
+        };
 
         LinuxComponentPeer& peer;
-        Image image;
+        Image images[2];
         uint32 lastTimeImageUsed;
+        double lastFrameStartTime, totalFrameTimeMs;
         RectangleList<int> regionsNeedingRepaint;
+        ComponentPeer::RepaintStatistics stats;
 
        #if JUCE_USE_XSHM
         bool useARGBImagesForRendering;
-        int shmPaintsPending;
+        int shmPaintsPending[2];
        #endif
+
+        // Returns the first buffer that isn't waiting for the X server to finish
+        // reading it, or -1 if they're both busy.
+        int findFreeBuffer() const noexcept
+        {
+           #if JUCE_USE_XSHM
+            for (int i = 0; i < numElementsInArray (shmPaintsPending); ++i)
+                if (shmPaintsPending[i] == 0)
+                    return i;
+
+            return -1;
+           #else
+            return 0;
+           #endif
+        }
+
+        bool isAnyBufferBusy() const noexcept
+        {
+           #if JUCE_USE_XSHM
+            return shmPaintsPending[0] != 0 || shmPaintsPending[1] != 0;
+           #else
+            return false;
+           #endif
+        }
+
+        // Each region is a separate request to the X server, so when there are lots
+        // of small ones, they get merged into a few larger areas, picking whichever
+        // merge adds the least extra area each time.
+        static void coalesceRegions (const RectangleList<int>& regions, Array<Rectangle<int> >& result)
+        {
+            for (const Rectangle<int>* i = regions.begin(), * const e = regions.end(); i != e; ++i)
+            {
+                if (result.size() < maxRegionsPerFrame)
+                {
+                    result.add (*i);
+                    continue;
+                }
+
+                int bestIndex = 0;
+                int64 bestExtraArea = std::numeric_limits<int64>::max();
+
+                for (int j = 0; j < result.size(); ++j)
+                {
+                    const Rectangle<int>& r = result.getReference (j);
+                    const Rectangle<int> merged (r.getUnion (*i));
+                    const int64 extraArea = merged.getWidth() * (int64) merged.getHeight()
+                                              - r.getWidth() * (int64) r.getHeight();
+
+                    if (extraArea < bestExtraArea)
+                    {
+                        bestExtraArea = extraArea;
+                        bestIndex = j;
+                    }
+                }
+
+                result.getReference (bestIndex) = result.getReference (bestIndex).getUnion (*i);
+            }
+        }
+
         JUCE_DECLARE_NON_COPYABLE (LinuxRepaintManager)
     };
 
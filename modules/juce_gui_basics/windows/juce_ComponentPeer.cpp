@@ -122,7 +122,10 @@ void ComponentPeer::handlePaint (LowLevelGraphicsContext& contextToPaintTo)
 
     JUCE_TRY
     {
-        component.paintEntireComponent (g, true);
+        if (component.flags.layerCompositingFlag && component.cachedImage != nullptr)
+            component.cachedImage->paint (g);
+        else
+            component.paintEntireComponent (g, true);
     }
     JUCE_CATCH_EXCEPTION
 
@@ -573,6 +576,18 @@ void ComponentPeer::setRepresentedFile (const File&)
 {
 }
 
+//==============================================================================
+ComponentPeer::RepaintStatistics::RepaintStatistics() noexcept
+    : numFrames (0), numRegionsBlitted (0), numFramesDeferred (0),
+      averageFrameTimeMs (0), maxFrameTimeMs (0)
+{
+}
+
+ComponentPeer::RepaintStatistics ComponentPeer::getRepaintStatistics() const
+{
+    return RepaintStatistics();
+}
+
 //==============================================================================
 int ComponentPeer::getCurrentRenderingEngine() const            { return 0; }
 void ComponentPeer::setCurrentRenderingEngine (int index)       { jassert (index == 0); (void) index; }
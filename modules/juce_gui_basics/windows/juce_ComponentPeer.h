@@ -293,6 +293,25 @@ public:
     */
     virtual void performAnyPendingRepaintsNow() = 0;
 
+    /** Contains timing information about the frames that a peer has painted.
+        @see getRepaintStatistics
+    */
+    struct JUCE_API  RepaintStatistics
+    {
+        RepaintStatistics() noexcept;
+
+        int numFrames;              /**< The number of frames that have been painted. */
+        int numRegionsBlitted;      /**< The number of separate regions that have been copied to the screen. */
+        int numFramesDeferred;      /**< The number of times a frame had to wait for a previous one to reach the screen. */
+        double averageFrameTimeMs;  /**< The average time taken to render and present a frame. */
+        double maxFrameTimeMs;      /**< The longest time taken to render and present a frame. */
+    };
+
+    /** Returns timing statistics for the frames that this peer has painted.
+        Not all platforms keep track of this, in which case the values will all be zero.
+    */
+    virtual RepaintStatistics getRepaintStatistics() const;
+
     /** Changes the window's transparency. */
     virtual void setAlpha (float newAlpha) = 0;
 